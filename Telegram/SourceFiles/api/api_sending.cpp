@@ -154,6 +154,16 @@ void SendExistingMedia(
 void SendExistingDocument(
 		Api::MessageToSend &&message,
 		not_null<DocumentData*> document) {
+	SendExistingDocument(
+		std::move(message),
+		document,
+		document->stickerOrGifOrigin());
+}
+
+void SendExistingDocument(
+		Api::MessageToSend &&message,
+		not_null<DocumentData*> document,
+		Data::FileOrigin origin) {
 	SendExistingMedia(
 		std::move(message),
 		document,
@@ -161,7 +171,7 @@ void SendExistingDocument(
 			MTP_flags(0),
 			document->mtpInput(),
 			MTPint()),
-		document->stickerOrGifOrigin());
+		origin);
 
 	if (document->sticker()) {
 		if (const auto main = App::main()) {
@@ -10,6 +10,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 class History;
 class DocumentData;
 
+namespace Data {
+struct FileOrigin;
+} // namespace Data
+
 namespace Api {
 
 struct MessageToSend;
@@ -17,6 +21,10 @@ struct MessageToSend;
 void SendExistingDocument(
 	Api::MessageToSend &&message,
 	not_null<DocumentData*> document);
+void SendExistingDocument(
+	Api::MessageToSend &&message,
+	not_null<DocumentData*> document,
+	Data::FileOrigin origin);
 
 void SendExistingPhoto(
 	Api::MessageToSend &&message,
@@ -7,7 +7,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "apiwrap.h"
 
+#include "api/api_sending.h"
 #include "data/data_drafts.h"
+#include "data/data_document.h"
+#include "data/data_file_origin.h"
 #include "data/data_photo.h"
 #include "data/data_web_page.h"
 #include "data/data_poll.h"
@@ -34,6 +37,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 #include "history/history_message.h"
 #include "history/history_item_components.h"
+#include "history/view/history_view_element.h"
 //#include "history/feed/history_feed_section.h" // #feed
 #include "storage/localstorage.h"
 #include "main/main_session.h"
@@ -87,12 +91,17 @@ constexpr auto kSharedMediaLimit = 100;
 //constexpr auto kFeedMessagesLimit = 50; // #feed
 constexpr auto kReadFeaturedSetsTimeout = crl::time(1000);
 constexpr auto kFileLoaderQueueStopTimeout = crl::time(5000);
+constexpr auto kFileLoaderMaxWorkers = 4;
 //constexpr auto kFeedReadTimeout = crl::time(1000); // #feed
 constexpr auto kStickersByEmojiInvalidateTimeout = crl::time(60 * 60 * 1000);
 constexpr auto kNotifySettingSaveTimeout = crl::time(1000);
 constexpr auto kDialogsFirstLoad = 20;
 constexpr auto kDialogsPerPage = 500;
+constexpr auto kFolderDialogsPerPage = 100;
 constexpr auto kBlockedFirstSlice = 16;
+constexpr auto kHistoryPreloadLimit = 30;
+constexpr auto kHistoryPreloadMaxRequests = 2;
+constexpr auto kHistoryPreloadThumbnails = 4;
 
 using PhotoFileLocationId = Data::PhotoFileLocationId;
 using DocumentFileLocationId = Data::DocumentFileLocationId;
@@ -155,6 +164,25 @@ MTPVector<MTPDocumentAttribute> ComposeSendingDocumentAttributes(
 	return MTP_vector<MTPDocumentAttribute>(attributes);
 }
 
+// Finds the first message with date >= desired_date in the loaded part
+// of the history, if the loaded part starts before that date.
+MsgId FindLoadedMessageAfterDate(not_null<History*> history, TimeId date) {
+	auto startsBefore = history->loadedAtTop();
+	for (const auto &block : history->blocks) {
+		for (const auto &view : block->messages) {
+			const auto item = view->data();
+			if (!IsServerMsgId(item->id)) {
+				continue;
+			} else if (item->date() < date) {
+				startsBefore = true;
+			} else {
+				return startsBefore ? item->id : MsgId(0);
+			}
+		}
+	}
+	return 0;
+}
+
 } // namespace
 
 MTPInputPrivacyKey ApiWrap::Privacy::Input(Key key) {
@@ -219,11 +247,14 @@ bool ApiWrap::BlockedUsersSlice::operator!=(const BlockedUsersSlice &other) cons
 ApiWrap::ApiWrap(not_null<Main::Session*> session)
 : _session(session)
 , _messageDataResolveDelayed([=] { resolveMessageDatas(); })
+, _peersResolveDelayed([=] { resolvePeers(); })
 , _webPagesTimer([=] { resolveWebPages(); })
 , _draftsSaveTimer([=] { saveDraftsToCloud(); })
 , _featuredSetsReadTimer([=] { readFeaturedSets(); })
 , _dialogsLoadState(std::make_unique<DialogsLoadState>())
-, _fileLoader(std::make_unique<TaskQueue>(kFileLoaderQueueStopTimeout))
+, _fileLoader(std::make_unique<TaskQueue>(
+	kFileLoaderQueueStopTimeout,
+	std::clamp(QThread::idealThreadCount(), 1, kFileLoaderMaxWorkers)))
 //, _feedReadTimer([=] { readFeeds(); }) // #feed
 , _proxyPromotionTimer([=] { refreshProxyPromotion(); })
 , _updateNotifySettingsTimer([=] { sendNotifySettingsUpdates(); }) {
@@ -235,6 +266,18 @@ ApiWrap::ApiWrap(not_null<Main::Session*> session)
 			photoUploadReady(data.fullId, data.file);
 		}, _session->lifetime());
 
+		_session->data().itemIdChanged(
+		) | rpl::start_with_next([=](const Data::Session::IdChange &change) {
+			const auto oldId = FullMsgId(
+				change.item->channelId(),
+				change.oldId);
+			for (auto &[key, sent] : _sentDocumentsByContent) {
+				if (sent.itemId == oldId) {
+					sent.itemId = change.item->fullId();
+				}
+			}
+		}, _session->lifetime());
+
 		setupSupportMode();
 	});
 }
@@ -784,7 +827,11 @@ void ApiWrap::requestMoreDialogs(Data::Folder *folder) {
 	}
 
 	const auto firstLoad = !state->offsetDate;
-	const auto loadCount = firstLoad ? kDialogsFirstLoad : kDialogsPerPage;
+	const auto loadCount = firstLoad
+		? kDialogsFirstLoad
+		: folder
+		? kFolderDialogsPerPage
+		: kDialogsPerPage;
 	const auto flags = MTPmessages_GetDialogs::Flag::f_exclude_pinned
 		| MTPmessages_GetDialogs::Flag::f_folder_id;
 	const auto hash = 0;
@@ -1144,6 +1191,94 @@ void ApiWrap::requestFakeChatListMessage(
 	}).send();
 }
 
+void ApiWrap::preloadHistory(not_null<History*> history) {
+	if (!history->isEmpty()
+		|| history->loadedAtBottom()
+		|| _historyPreloadRequests.contains(history)
+		|| _historyPreloadRequests.size() >= kHistoryPreloadMaxRequests) {
+		return;
+	}
+
+	_historyPreloadRequests.emplace(history);
+	request(MTPmessages_GetHistory(
+		history->peer->input,
+		MTP_int(0),  // offset_id
+		MTP_int(0),  // offset_date
+		MTP_int(0),  // add_offset
+		MTP_int(kHistoryPreloadLimit),
+		MTP_int(0),  // max_id
+		MTP_int(0),  // min_id
+		MTP_int(0)
+	)).done([=](const MTPmessages_Messages &result) {
+		_historyPreloadRequests.erase(history);
+		historyPreloaded(history, result);
+	}).fail([=](const RPCError &error) {
+		_historyPreloadRequests.erase(history);
+	}).send();
+}
+
+void ApiWrap::historyPreloaded(
+		not_null<History*> history,
+		const MTPmessages_Messages &result) {
+	const auto peer = history->peer;
+	const auto shown = App::main() ? App::main()->peer() : nullptr;
+	if (!history->isEmpty()
+		|| history->loadedAtBottom()
+		|| (shown && (shown == peer || shown->migrateFrom() == peer))) {
+		// The history was opened while we were waiting for the result.
+		return;
+	}
+	const auto process = [&](const auto &data) {
+		_session->data().processUsers(data.vusers());
+		_session->data().processChats(data.vchats());
+		return data.vmessages().v;
+	};
+	const auto list = result.match([&](
+			const MTPDmessages_messagesNotModified &) {
+		LOG(("API Error: received messages.messagesNotModified! "
+			"(ApiWrap::historyPreloaded)"));
+		return QVector<MTPMessage>();
+	}, [&](const MTPDmessages_channelMessages &data) {
+		if (const auto channel = peer->asChannel()) {
+			channel->ptsReceived(data.vpts().v);
+		} else {
+			LOG(("API Error: received messages.channelMessages when "
+				"no channel was passed! (ApiWrap::historyPreloaded)"));
+		}
+		return process(data);
+	}, [&](const auto &data) {
+		return process(data);
+	});
+	if (list.isEmpty()) {
+		return;
+	}
+
+	// Same as HistoryWidget::firstLoadMessages() + messagesReceived().
+	history->getReadyFor(ShowAtTheEndMsgId);
+	history->addOlderSlice(list);
+	_session->data().registerHistoryPreloaded(history);
+
+	// The last photos are the first ones visible when the chat is opened.
+	auto thumbnails = 0;
+	const auto channel = peerToChannel(peer->id);
+	for (const auto &message : list) {
+		const auto item = _session->data().message(
+			channel,
+			IdFromMessage(message));
+		const auto media = item ? item->media() : nullptr;
+		if (const auto photo = media ? media->photo() : nullptr) {
+			photo->loadThumbnail(item->fullId());
+		} else if (const auto document = media ? media->document() : nullptr) {
+			document->loadThumbnail(item->fullId());
+		} else {
+			continue;
+		}
+		if (++thumbnails == kHistoryPreloadThumbnails) {
+			break;
+		}
+	}
+}
+
 void ApiWrap::requestWallPaper(
 		const QString &slug,
 		Fn<void(const Data::WallPaper &)> done,
@@ -1297,37 +1432,88 @@ void ApiWrap::requestPeer(not_null<PeerData*> peer) {
 		return;
 	}
 
-	const auto requestId = [&] {
-		const auto failHandler = [=](const RPCError &error) {
-			_peerRequests.remove(peer);
-		};
-		const auto chatHandler = [=](const MTPmessages_Chats &result) {
-			_peerRequests.remove(peer);
-			const auto &chats = result.match([](const auto &data) {
-				return data.vchats();
-			});
-			_session->data().applyMaximumChatVersions(chats);
-			_session->data().processChats(chats);
-		};
+	// Peers requested together are sent in one request for each type.
+	_peerRequests.insert(peer, 0);
+	_peersResolveDelayed.call();
+}
+
+void ApiWrap::resolvePeers() {
+	auto users = QVector<MTPInputUser>();
+	auto chats = QVector<MTPint>();
+	auto channels = QVector<MTPInputChannel>();
+	for (auto i = _peerRequests.cbegin(); i != _peerRequests.cend(); ++i) {
+		if (i.value()) {
+			continue;
+		}
+		const auto peer = i.key();
 		if (const auto user = peer->asUser()) {
-			return request(MTPusers_GetUsers(
-				MTP_vector<MTPInputUser>(1, user->inputUser)
-			)).done([=](const MTPVector<MTPUser> &result) {
-				_peerRequests.remove(user);
-				_session->data().processUsers(result);
-			}).fail(failHandler).send();
+			users.push_back(user->inputUser);
 		} else if (const auto chat = peer->asChat()) {
-			return request(MTPmessages_GetChats(
-				MTP_vector<MTPint>(1, chat->inputChat)
-			)).done(chatHandler).fail(failHandler).send();
+			chats.push_back(chat->inputChat);
 		} else if (const auto channel = peer->asChannel()) {
-			return request(MTPchannels_GetChannels(
-				MTP_vector<MTPInputChannel>(1, channel->inputChannel)
-			)).done(chatHandler).fail(failHandler).send();
+			channels.push_back(channel->inputChannel);
+		} else {
+			Unexpected("Peer type in resolvePeers.");
 		}
-		Unexpected("Peer type in requestPeer.");
-	}();
-	_peerRequests.insert(peer, requestId);
+	}
+	const auto failHandler = [=](
+			const RPCError &error,
+			mtpRequestId requestId) {
+		finishPeersRequest(requestId);
+	};
+	const auto chatsHandler = [=](
+			const MTPmessages_Chats &result,
+			mtpRequestId requestId) {
+		finishPeersRequest(requestId);
+		const auto &chats = result.match([](const auto &data) {
+			return data.vchats();
+		});
+		_session->data().applyMaximumChatVersions(chats);
+		_session->data().processChats(chats);
+	};
+	const auto assign = [&](const auto &type, mtpRequestId requestId) {
+		for (auto i = _peerRequests.begin(); i != _peerRequests.end(); ++i) {
+			if (!i.value() && type(i.key())) {
+				i.value() = requestId;
+			}
+		}
+	};
+	if (!users.isEmpty()) {
+		assign([](not_null<PeerData*> peer) {
+			return peer->isUser();
+		}, request(MTPusers_GetUsers(
+			MTP_vector<MTPInputUser>(users)
+		)).done([=](
+				const MTPVector<MTPUser> &result,
+				mtpRequestId requestId) {
+			finishPeersRequest(requestId);
+			_session->data().processUsers(result);
+		}).fail(failHandler).send());
+	}
+	if (!chats.isEmpty()) {
+		assign([](not_null<PeerData*> peer) {
+			return peer->isChat();
+		}, request(MTPmessages_GetChats(
+			MTP_vector<MTPint>(chats)
+		)).done(chatsHandler).fail(failHandler).send());
+	}
+	if (!channels.isEmpty()) {
+		assign([](not_null<PeerData*> peer) {
+			return peer->isChannel();
+		}, request(MTPchannels_GetChannels(
+			MTP_vector<MTPInputChannel>(channels)
+		)).done(chatsHandler).fail(failHandler).send());
+	}
+}
+
+void ApiWrap::finishPeersRequest(mtpRequestId requestId) {
+	for (auto i = _peerRequests.begin(); i != _peerRequests.end();) {
+		if (i.value() == requestId) {
+			i = _peerRequests.erase(i);
+		} else {
+			++i;
+		}
+	}
 }
 
 void ApiWrap::requestPeerSettings(not_null<PeerData*> peer) {
@@ -3776,6 +3962,14 @@ void ApiWrap::requestMessageAfterDate(
 	// This should give us the first message with date >= desired_date.
 	auto offsetId = 0;
 	auto offsetDate = static_cast<int>(QDateTime(date).toTime_t()) - 1;
+	if (const auto history = _session->data().historyLoaded(peer)) {
+		if (const auto resultId = FindLoadedMessageAfterDate(
+				history,
+				offsetDate + 1)) {
+			callback(resultId);
+			return;
+		}
+	}
 	auto addOffset = -1;
 	auto limit = 1;
 	auto maxId = 0;
@@ -4752,6 +4946,42 @@ void ApiWrap::sendFile(
 		caption));
 }
 
+void ApiWrap::rememberSentDocument(
+		const QByteArray &contentKey,
+		not_null<DocumentData*> document,
+		FullMsgId itemId) {
+	_sentDocumentsByContent.emplace_or_assign(
+		contentKey,
+		SentDocument{ document, itemId });
+}
+
+bool ApiWrap::sendAsSentDocument(
+		const QByteArray &contentKey,
+		MessageToSend &&message) {
+	const auto i = _sentDocumentsByContent.find(contentKey);
+	if (i == end(_sentDocumentsByContent)) {
+		return false;
+	}
+	const auto [document, itemId] = i->second;
+	if (!IsServerMsgId(itemId.msg)) {
+		// Still uploading or sending, upload this one as well.
+		return false;
+	}
+	const auto item = _session->data().message(itemId);
+	const auto media = item ? item->media() : nullptr;
+	if (!media
+		|| media->document() != document
+		|| !document->hasRemoteLocation()) {
+		_sentDocumentsByContent.erase(i);
+		return false;
+	}
+	Api::SendExistingDocument(
+		std::move(message),
+		document,
+		Data::FileOriginMessage(itemId));
+	return true;
+}
+
 void ApiWrap::sendUploadedPhoto(
 		FullMsgId localId,
 		const MTPInputFile &file,
@@ -178,6 +178,7 @@ public:
 	void changeDialogUnreadMark(not_null<History*> history, bool unread);
 	//void changeDialogUnreadMark(not_null<Data::Feed*> feed, bool unread); // #feed
 	void requestFakeChatListMessage(not_null<History*> history);
+	void preloadHistory(not_null<History*> history);
 
 	void requestWallPaper(
 		const QString &slug,
@@ -407,6 +408,16 @@ public:
 		SendMediaType type,
 		const SendAction &action);
 
+	// Files with the same content key are sent as the already sent
+	// document while its message is still there, without an upload.
+	void rememberSentDocument(
+		const QByteArray &contentKey,
+		not_null<DocumentData*> document,
+		FullMsgId itemId);
+	bool sendAsSentDocument(
+		const QByteArray &contentKey,
+		MessageToSend &&message);
+
 	void editMedia(
 		Storage::PreparedList &&list,
 		SendMediaType type,
@@ -522,6 +533,8 @@ private:
 	void saveDraftsToCloud();
 
 	void resolveMessageDatas();
+	void resolvePeers();
+	void finishPeersRequest(mtpRequestId requestId);
 	void gotMessageDatas(ChannelData *channel, const MTPmessages_Messages &result, mtpRequestId requestId);
 	void finalizeMessageDataRequest(
 		ChannelData *channel,
@@ -547,6 +560,10 @@ private:
 		not_null<ChannelData*> channel,
 		int availableCount,
 		const QVector<MTPChannelParticipant> &list);
+	void historyPreloaded(
+		not_null<History*> history,
+		const MTPmessages_Messages &result);
+
 	void resolveWebPages();
 	void gotWebPages(
 		ChannelData *channel,
@@ -698,6 +715,7 @@ private:
 	using PeerRequests = QMap<PeerData*, mtpRequestId>;
 	PeerRequests _fullPeerRequests;
 	PeerRequests _peerRequests;
+	SingleQueuedInvokation _peersResolveDelayed;
 	base::flat_set<not_null<PeerData*>> _requestedPeerSettings;
 
 	PeerRequests _participantsRequests;
@@ -764,6 +782,7 @@ private:
 		not_null<History*>,
 		std::vector<Fn<void()>>> _dialogRequestsPending;
 	base::flat_set<not_null<History*>> _fakeChatListRequests;
+	base::flat_set<not_null<History*>> _historyPreloadRequests;
 
 	base::flat_map<not_null<History*>, mtpRequestId> _unreadMentionsRequests;
 
@@ -815,6 +834,12 @@ private:
 	std::unique_ptr<TaskQueue> _fileLoader;
 	base::flat_map<uint64, std::shared_ptr<SendingAlbum>> _sendingAlbums;
 
+	struct SentDocument {
+		not_null<DocumentData*> document;
+		FullMsgId itemId;
+	};
+	base::flat_map<QByteArray, SentDocument> _sentDocumentsByContent;
+
 	base::Observable<PeerData*> _fullPeerUpdated;
 
 	rpl::event_stream<uint64> _stickerSetInstalled;
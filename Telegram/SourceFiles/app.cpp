@@ -40,6 +40,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "apiwrap.h"
 #include "numbers.h"
 #include "observer_peer.h"
+#include "core/core_trace.h"
 #include "main/main_session.h"
 #include "styles/style_overview.h"
 #include "styles/style_mediaview.h"
@@ -357,6 +358,7 @@ namespace App {
 	}
 
 	QImage readImage(QByteArray data, QByteArray *format, bool opaque, bool *animated) {
+		const auto trace = Core::Trace::Scope("App::readImage");
         QByteArray tmpFormat;
 		QImage result;
 		QBuffer buffer(&data);
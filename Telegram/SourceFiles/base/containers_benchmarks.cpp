@@ -0,0 +1,127 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "base/flat_map.h"
+#include "base/flat_set.h"
+#include "base/basic_types.h"
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+
+namespace {
+
+// Keys are generated from a fixed seed, so runs are comparable.
+constexpr auto kSeed = 20190601U;
+constexpr auto kOperationsCount = 1 << 20;
+constexpr int kSizes[] = { 16, 256, 4096, 65536 };
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps the compiler from dropping the measured lookups.
+auto Sink = uint64(0);
+
+std::vector<uint64> GenerateKeys(int count) {
+	auto generator = std::mt19937_64(kSeed);
+	auto result = std::vector<uint64>(count);
+	for (auto &key : result) {
+		key = generator();
+	}
+	return result;
+}
+
+void Report(const std::string &name, Clock::duration time, int count) {
+	const auto nanoseconds = std::chrono::duration_cast<
+		std::chrono::nanoseconds>(time).count();
+	std::cout
+		<< std::left << std::setw(48) << name
+		<< std::right << std::setw(12) << (nanoseconds / count) << " ns/op"
+		<< std::endl;
+}
+
+template <typename Map>
+void MeasureMap(const char *name, int size) {
+	const auto keys = GenerateKeys(size);
+	const auto rounds = std::max(kOperationsCount / size, 1);
+
+	auto insert = Clock::duration();
+	auto find = Clock::duration();
+	for (auto round = 0; round != rounds; ++round) {
+		auto map = Map();
+
+		const auto insertStart = Clock::now();
+		for (const auto key : keys) {
+			map.emplace(key, key);
+		}
+		const auto findStart = Clock::now();
+		for (const auto key : keys) {
+			Sink += map.find(key)->second;
+		}
+		const auto findFinish = Clock::now();
+
+		insert += findStart - insertStart;
+		find += findFinish - findStart;
+	}
+	const auto label = std::string(name) + ", " + std::to_string(size);
+	Report(label + " insert", insert, rounds * size);
+	Report(label + " find", find, rounds * size);
+}
+
+template <typename Set>
+void MeasureSet(const char *name, int size) {
+	const auto keys = GenerateKeys(size);
+	const auto rounds = std::max(kOperationsCount / size, 1);
+
+	auto insert = Clock::duration();
+	auto find = Clock::duration();
+	for (auto round = 0; round != rounds; ++round) {
+		auto set = Set();
+
+		const auto insertStart = Clock::now();
+		for (const auto key : keys) {
+			set.emplace(key);
+		}
+		const auto findStart = Clock::now();
+		for (const auto key : keys) {
+			Sink += *set.find(key);
+		}
+		const auto findFinish = Clock::now();
+
+		insert += findStart - insertStart;
+		find += findFinish - findStart;
+	}
+	const auto label = std::string(name) + ", " + std::to_string(size);
+	Report(label + " insert", insert, rounds * size);
+	Report(label + " find", find, rounds * size);
+}
+
+} // namespace
+
+TEST_CASE("maps insert and find", "[containers_benchmark]") {
+	for (const auto size : kSizes) {
+		MeasureMap<base::flat_map<uint64, uint64>>("base::flat_map", size);
+		MeasureMap<std::map<uint64, uint64>>("std::map", size);
+		MeasureMap<std::unordered_map<uint64, uint64>>(
+			"std::unordered_map",
+			size);
+	}
+	REQUIRE(Sink != 0);
+}
+
+TEST_CASE("sets insert and find", "[containers_benchmark]") {
+	for (const auto size : kSizes) {
+		MeasureSet<base::flat_set<uint64>>("base::flat_set", size);
+		MeasureSet<std::set<uint64>>("std::set", size);
+	}
+	REQUIRE(Sink != 0);
+}
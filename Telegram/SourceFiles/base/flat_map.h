@@ -329,7 +329,7 @@ public:
 		typename = typename std::iterator_traits<Iterator>::iterator_category>
 	flat_multi_map(Iterator first, Iterator last)
 	: _data(first, last) {
-		std::sort(std::begin(impl()), std::end(impl()), compare());
+		std::stable_sort(std::begin(impl()), std::end(impl()), compare());
 	}
 
 	flat_multi_map(std::initializer_list<pair_type> iter)
@@ -506,6 +506,10 @@ public:
 	bool contains(const Key &key) const {
 		return findFirst(key) != end();
 	}
+	template <typename OtherKey>
+	bool contains(const OtherKey &key) const {
+		return findFirst(key) != end();
+	}
 	int count(const Key &key) const {
 		if (empty()
 			|| compare()(key, front().first)
@@ -516,6 +520,33 @@ public:
 		return (range.second - range.first);
 	}
 
+	// Sorts only the appended elements and merges them with the existing
+	// ones, equal keys keep their relative order with the existing first.
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category>
+	void merge(Iterator first, Iterator last) {
+		const auto was = int(impl().size());
+		for (; first != last; ++first) {
+			impl().push_back(*first);
+		}
+		const auto middle = std::begin(impl()) + was;
+		std::stable_sort(middle, std::end(impl()), compare());
+		std::inplace_merge(
+			std::begin(impl()),
+			middle,
+			std::end(impl()),
+			compare());
+	}
+
+	void merge(const flat_multi_map<Key, Type, Compare> &other) {
+		merge(other.begin(), other.end());
+	}
+
+	void merge(std::initializer_list<pair_type> list) {
+		merge(list.begin(), list.end());
+	}
+
 private:
 	friend class flat_map<Key, Type, Compare>;
 
@@ -804,6 +835,23 @@ public:
 		return this->removeOne(key);
 	}
 
+	// Keys already in the map keep their values, as with insert().
+	template <
+		typename Iterator,
+		typename = typename std::iterator_traits<Iterator>::iterator_category>
+	void merge(Iterator first, Iterator last) {
+		parent::merge(first, last);
+		finalize();
+	}
+
+	void merge(const flat_map<Key, Type, Compare> &other) {
+		merge(other.begin(), other.end());
+	}
+
+	void merge(std::initializer_list<pair_type> list) {
+		merge(list.begin(), list.end());
+	}
+
 	iterator find(const Key &key) {
 		return this->findFirst(key);
 	}
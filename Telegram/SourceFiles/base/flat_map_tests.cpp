@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "base/flat_map.h"
 #include <string>
+#include <string_view>
 
 struct int_wrap {
 	int value;
@@ -119,3 +120,52 @@ TEST_CASE("flat_maps structured bindings", "[flat_map]") {
 		}
 	}
 }
+
+TEST_CASE("flat_maps bulk merge", "[flat_map]") {
+	base::flat_map<int, string> v = {
+		{ 1, "a" },
+		{ 3, "c" },
+		{ 5, "e" },
+	};
+
+	SECTION("merged items are placed in the right positions") {
+		v.merge({ { 4, "d" }, { 0, "z" }, { 2, "b" } });
+		REQUIRE(v.size() == 6);
+		auto index = 0;
+		for (const auto &[key, value] : v) {
+			REQUIRE(key == index++);
+		}
+		REQUIRE(v.find(0)->second == "z");
+		REQUIRE(v.find(4)->second == "d");
+	}
+
+	SECTION("existing items keep their values") {
+		v.merge({ { 3, "x" }, { 6, "f" }, { 6, "y" } });
+		REQUIRE(v.size() == 4);
+		REQUIRE(v.find(3)->second == "c");
+		REQUIRE(v.find(6)->second == "f");
+	}
+
+	SECTION("merging another map") {
+		const base::flat_map<int, string> other = {
+			{ 2, "b" },
+			{ 5, "x" },
+		};
+		v.merge(other);
+		REQUIRE(v.size() == 4);
+		REQUIRE(v.find(2)->second == "b");
+		REQUIRE(v.find(5)->second == "e");
+	}
+}
+
+TEST_CASE("flat_maps heterogeneous lookup", "[flat_map]") {
+	base::flat_map<string, int> v = {
+		{ "a", 1 },
+		{ "b", 2 },
+	};
+	const auto key = std::string_view("b");
+	REQUIRE(v.contains(key));
+	REQUIRE(!v.contains(std::string_view("c")));
+	REQUIRE(v.find(key) != v.end());
+	REQUIRE(v.find(key)->second == 2);
+}
@@ -186,7 +186,7 @@ public:
 		typename = typename std::iterator_traits<Iterator>::iterator_category>
 	flat_multi_set(Iterator first, Iterator last)
 	: _data(first, last) {
-		std::sort(std::begin(impl()), std::end(impl()), compare());
+		std::stable_sort(std::begin(impl()), std::end(impl()), compare());
 	}
 
 	flat_multi_set(std::initializer_list<Type> iter)
@@ -361,6 +361,12 @@ public:
 	bool contains(const Type &value) const {
 		return findFirst(value) != end();
 	}
+	template <
+		typename OtherType,
+		typename = typename Compare::is_transparent>
+	bool contains(const OtherType &value) const {
+		return findFirst(value) != end();
+	}
 	int count(const Type &value) const {
 		if (empty()
 			|| compare()(value, front())
@@ -396,8 +402,15 @@ public:
 		typename Iterator,
 		typename = typename std::iterator_traits<Iterator>::iterator_category>
 	void merge(Iterator first, Iterator last) {
+		const auto was = int(impl().size());
 		impl().insert(impl().end(), first, last);
-		std::sort(std::begin(impl()), std::end(impl()), compare());
+		const auto middle = std::begin(impl()) + was;
+		std::stable_sort(middle, std::end(impl()), compare());
+		std::inplace_merge(
+			std::begin(impl()),
+			middle,
+			std::end(impl()),
+			compare());
 	}
 
 	void merge(const flat_multi_set<Type, Compare> &other) {
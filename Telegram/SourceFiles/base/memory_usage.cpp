@@ -0,0 +1,62 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "base/memory_usage.h"
+
+#include <atomic>
+
+namespace base {
+namespace memory_usage {
+namespace {
+
+constexpr auto kCount = static_cast<int>(Category::kCount);
+
+std::atomic<int64> Counters[kCount];
+
+QString Name(Category category) {
+	switch (category) {
+	case Category::ImagesCache: return "Images cache";
+	case Category::DocumentsCache: return "Documents cache";
+	case Category::LottieFrames: return "Lottie frames";
+	case Category::StreamingParts: return "Streaming parts";
+	case Category::EmojiSprites: return "Emoji sprites";
+	}
+	Unexpected("Category in base::memory_usage::Name.");
+}
+
+} // namespace
+
+void Add(Category category, int64 bytes) {
+	Expects(category != Category::kCount);
+
+	Counters[static_cast<int>(category)].fetch_add(
+		bytes,
+		std::memory_order_relaxed);
+}
+
+int64 Get(Category category) {
+	Expects(category != Category::kCount);
+
+	return Counters[static_cast<int>(category)].load(
+		std::memory_order_relaxed);
+}
+
+QString Summary() {
+	auto result = QStringList();
+	for (auto i = 0; i != kCount; ++i) {
+		const auto category = static_cast<Category>(i);
+		const auto megabytes = Get(category) / double(1024 * 1024);
+		result.push_back(Name(category)
+			+ ": "
+			+ QString::number(megabytes, 'f', 1)
+			+ " MB");
+	}
+	return result.join('\n');
+}
+
+} // namespace memory_usage
+} // namespace base
@@ -0,0 +1,31 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace base {
+namespace memory_usage {
+
+enum class Category {
+	ImagesCache,
+	DocumentsCache,
+	LottieFrames,
+	StreamingParts,
+	EmojiSprites,
+
+	kCount,
+};
+
+// Thread safe, negative amounts are used when the memory is released.
+void Add(Category category, int64 bytes);
+[[nodiscard]] int64 Get(Category category);
+
+// One "Name: N MB" line for each category.
+[[nodiscard]] QString Summary();
+
+} // namespace memory_usage
+} // namespace base
@@ -0,0 +1,57 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "base/task_lanes.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace base {
+namespace details {
+namespace {
+
+constexpr auto kMaxBackgroundQueues = 4;
+
+struct Lanes {
+	Lanes();
+
+	std::vector<std::unique_ptr<crl::queue>> background;
+	std::atomic<uint32> backgroundLast = 0;
+	crl::queue bulk;
+};
+
+Lanes::Lanes() {
+	// Leave at least half of the cores to the interactive lane.
+	const auto cores = int(std::thread::hardware_concurrency());
+	const auto count = std::clamp(cores / 2, 1, kMaxBackgroundQueues);
+	background.reserve(count);
+	for (auto i = 0; i != count; ++i) {
+		background.push_back(std::make_unique<crl::queue>());
+	}
+}
+
+Lanes &Instance() {
+	static auto result = Lanes();
+	return result;
+}
+
+} // namespace
+
+crl::queue &LaneQueue(TaskLane lane) {
+	Expects(lane != TaskLane::Interactive);
+
+	auto &lanes = Instance();
+	if (lane == TaskLane::Bulk) {
+		return lanes.bulk;
+	}
+	const auto index = lanes.backgroundLast++ % lanes.background.size();
+	return *lanes.background[index];
+}
+
+} // namespace details
+} // namespace base
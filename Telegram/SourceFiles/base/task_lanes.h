@@ -0,0 +1,39 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <crl/crl_async.h>
+#include <crl/crl_queue.h>
+
+namespace base {
+
+// Interactive tasks go straight to the crl pool, the lower lanes are
+// funneled through a few serial queues, so that they never take all
+// of the pool threads away from the work somebody is waiting for.
+enum class TaskLane {
+	Interactive,
+	Background,
+	Bulk,
+};
+
+namespace details {
+
+[[nodiscard]] crl::queue &LaneQueue(TaskLane lane);
+
+} // namespace details
+
+template <typename Callable>
+void lane_async(TaskLane lane, Callable &&callable) {
+	if (lane == TaskLane::Interactive) {
+		crl::async(std::forward<Callable>(callable));
+	} else {
+		details::LaneQueue(lane).async(std::forward<Callable>(callable));
+	}
+}
+
+} // namespace base
@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #pragma once
 
+#include <atomic>
 #include <utility>
 
 namespace base {
@@ -57,4 +58,59 @@ private:
 
 };
 
+// Same interface as thread_safe_queue, but producers never take a lock:
+// emplace() pushes a node to an atomic list and take() grabs it whole.
+template <typename T, template<typename...> typename Container = std::deque>
+class lock_free_queue {
+public:
+	lock_free_queue() = default;
+	lock_free_queue(const lock_free_queue &other) = delete;
+	lock_free_queue &operator=(const lock_free_queue &other) = delete;
+	~lock_free_queue() {
+		take();
+	}
+
+	template <typename ...Args>
+	void emplace(Args &&...args) {
+		const auto node = new Node{
+			T(std::forward<Args>(args)...),
+			_head.load(std::memory_order_relaxed)
+		};
+		while (!_head.compare_exchange_weak(
+			node->next,
+			node,
+			std::memory_order_release,
+			std::memory_order_relaxed)) {
+		}
+	}
+
+	Container<T> take() {
+		auto node = _head.exchange(nullptr, std::memory_order_acquire);
+
+		// The list is in the reverse order of emplace() calls.
+		auto first = (Node*)nullptr;
+		while (node) {
+			const auto next = node->next;
+			node->next = first;
+			first = node;
+			node = next;
+		}
+		auto result = Container<T>();
+		while (first) {
+			result.push_back(std::move(first->value));
+			delete std::exchange(first, first->next);
+		}
+		return result;
+	}
+
+private:
+	struct Node {
+		T value;
+		Node *next = nullptr;
+	};
+
+	std::atomic<Node*> _head = nullptr;
+
+};
+
 } // namespace base
@@ -7,9 +7,112 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "base/timer.h"
 
+#include "base/flat_set.h"
+
+#include <QtCore/QCoreApplication>
 #include <QtCore/QTimerEvent>
 
 namespace base {
+namespace details {
+
+class TimersQueue final : public QObject {
+public:
+	[[nodiscard]] static TimersQueue *Instance();
+	[[nodiscard]] static bool Serves(not_null<const QObject*> timer);
+
+	void add(not_null<Timer*> timer);
+	void remove(not_null<Timer*> timer);
+	void restart(bool force = false);
+
+protected:
+	void timerEvent(QTimerEvent *e) override;
+
+private:
+	base::flat_set<std::pair<crl::time, Timer*>> _entries;
+	int _timerId = 0;
+	crl::time _timerWhen = 0;
+
+};
+
+TimersQueue *TimersQueue::Instance() {
+	// Left alive till the very end, timers may outlive the application.
+	static const auto result = new TimersQueue();
+	return result;
+}
+
+bool TimersQueue::Serves(not_null<const QObject*> timer) {
+	const auto application = QCoreApplication::instance();
+	return application
+		&& (timer->thread() == application->thread())
+		&& (QThread::currentThread() == application->thread());
+}
+
+void TimersQueue::add(not_null<Timer*> timer) {
+	Expects(!timer->_queued);
+
+	timer->_queued = true;
+	_entries.emplace(timer->_next, timer.get());
+	restart();
+}
+
+void TimersQueue::remove(not_null<Timer*> timer) {
+	Expects(timer->_queued);
+
+	// The Qt timer is left as is, a spurious wakeup is cheaper than
+	// restarting it each time a timer is cancelled.
+	timer->_queued = false;
+	_entries.removeOne(std::make_pair(timer->_next, timer.get()));
+}
+
+void TimersQueue::restart(bool force) {
+	if (_entries.empty()) {
+		if (_timerId) {
+			killTimer(base::take(_timerId));
+		}
+		return;
+	}
+	const auto &[when, timer] = _entries.front();
+	if (_timerId && !force && _timerWhen == when) {
+		return;
+	} else if (_timerId) {
+		killTimer(base::take(_timerId));
+	}
+	const auto now = crl::now();
+	const auto timeout = (when > now) ? (when - now) : crl::time(0);
+	_timerId = startTimer(int(timeout), timer->_type);
+	_timerWhen = when;
+}
+
+void TimersQueue::timerEvent(QTimerEvent *e) {
+	if (_timerId) {
+		killTimer(base::take(_timerId));
+	}
+
+	// Only the timers due right now are fired, the ones restarted from
+	// their callbacks with a zero timeout wait for the next event.
+	const auto now = crl::now();
+	const auto till = std::find_if(
+		_entries.begin(),
+		_entries.end(),
+		[&](const auto &entry) { return (entry.first > now); });
+	auto left = int(till - _entries.begin());
+	while (left-- > 0 && !_entries.empty()) {
+		const auto [when, timer] = _entries.front();
+		if (when > now) {
+			break;
+		}
+		_entries.erase(_entries.begin());
+		timer->_queued = false;
+
+		// The callback may enter a nested event loop, keep timers alive.
+		restart();
+		timer->queuedTimeout();
+	}
+	restart();
+}
+
+} // namespace details
+
 namespace {
 
 QObject *TimersAdjuster() {
@@ -30,7 +133,8 @@ Timer::Timer(Fn<void()> callback)
 : QObject(nullptr)
 , _callback(std::move(callback))
 , _type(Qt::PreciseTimer)
-, _adjusted(false) {
+, _adjusted(false)
+, _queued(false) {
 	setRepeat(Repeat::Interval);
 	connect(
 		TimersAdjuster(),
@@ -40,6 +144,10 @@ Timer::Timer(Fn<void()> callback)
 		Qt::QueuedConnection);
 }
 
+Timer::~Timer() {
+	cancel();
+}
+
 void Timer::start(crl::time timeout, Qt::TimerType type, Repeat repeat) {
 	cancel();
 
@@ -47,6 +155,11 @@ void Timer::start(crl::time timeout, Qt::TimerType type, Repeat repeat) {
 	setRepeat(repeat);
 	_adjusted = false;
 	setTimeout(timeout);
+	if (details::TimersQueue::Serves(this)) {
+		_next = crl::now() + _timeout;
+		details::TimersQueue::Instance()->add(this);
+		return;
+	}
 	_timerId = startTimer(_timeout, _type);
 	if (_timerId) {
 		_next = crl::now() + _timeout;
@@ -56,7 +169,9 @@ void Timer::start(crl::time timeout, Qt::TimerType type, Repeat repeat) {
 }
 
 void Timer::cancel() {
-	if (isActive()) {
+	if (_queued) {
+		details::TimersQueue::Instance()->remove(this);
+	} else if (_timerId) {
 		killTimer(base::take(_timerId));
 	}
 }
@@ -79,6 +194,10 @@ void Timer::Adjust() {
 }
 
 void Timer::adjust() {
+	if (_queued) {
+		details::TimersQueue::Instance()->restart(true);
+		return;
+	}
 	auto remaining = remainingTime();
 	if (remaining >= 0) {
 		cancel();
@@ -97,6 +216,17 @@ int Timer::timeout() const {
 	return _timeout;
 }
 
+void Timer::queuedTimeout() {
+	if (repeat() == Repeat::Interval) {
+		_next = crl::now() + _timeout;
+		details::TimersQueue::Instance()->add(this);
+	}
+
+	if (_callback) {
+		_callback();
+	}
+}
+
 void Timer::timerEvent(QTimerEvent *e) {
 	if (repeat() == Repeat::Interval) {
 		if (_adjusted) {
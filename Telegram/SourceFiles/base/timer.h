@@ -14,13 +14,19 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <crl/crl_time.h>
 
 namespace base {
+namespace details {
+class TimersQueue;
+} // namespace details
 
+// Timers of the main thread share one Qt timer for the nearest deadline,
+// so that hundreds of them don't keep hundreds of system timers.
 class Timer final : private QObject {
 public:
 	explicit Timer(
 		not_null<QThread*> thread,
 		Fn<void()> callback = nullptr);
 	explicit Timer(Fn<void()> callback = nullptr);
+	~Timer();
 
 	static Qt::TimerType DefaultType(crl::time timeout) {
 		constexpr auto kThreshold = crl::time(1000);
@@ -48,7 +54,7 @@ public:
 	}
 
 	bool isActive() const {
-		return (_timerId != 0);
+		return (_timerId != 0) || _queued;
 	}
 
 	void cancel();
@@ -60,12 +66,15 @@ protected:
 	void timerEvent(QTimerEvent *e) override;
 
 private:
+	friend class details::TimersQueue;
+
 	enum class Repeat : unsigned {
 		Interval   = 0,
 		SingleShot = 1,
 	};
 	void start(crl::time timeout, Qt::TimerType type, Repeat repeat);
 	void adjust();
+	void queuedTimeout();
 
 	void setTimeout(crl::time timeout);
 	int timeout() const;
@@ -84,6 +93,7 @@ private:
 
 	Qt::TimerType _type : 2;
 	bool _adjusted : 1;
+	bool _queued : 1;
 	unsigned _repeat : 1;
 
 };
@@ -13,6 +13,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/qthelp_url.h"
 #include "core/application.h"
 #include "main/main_account.h"
+#include "mtproto/mtp_instance.h"
+#include "layout.h"
 #include "ui/widgets/checkbox.h"
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/input_fields.h"
@@ -35,6 +37,22 @@ namespace {
 
 constexpr auto kSaveSettingsDelayedTimeout = crl::time(1000);
 
+QString ConnectionMetricsText(const MTP::ConnectionMetrics &metrics) {
+	return QString(
+		"RTT: %1 ms, resent: %2\n"
+		"Containers: %3, average fill: %4\n"
+		"Sent: %5, received: %6\n"
+		"Encrypt: %7 ms, decrypt: %8 ms"
+	).arg(metrics.smoothedRtt
+	).arg(metrics.resentCount
+	).arg(metrics.containersSent
+	).arg(metrics.averageContainerFill()
+	).arg(formatSizeText(metrics.bytesSent)
+	).arg(formatSizeText(metrics.bytesReceived)
+	).arg(metrics.encryptTime / 1000
+	).arg(metrics.decryptTime / 1000);
+}
+
 class Base64UrlInput : public Ui::MaskedInputField {
 public:
 	Base64UrlInput(
@@ -594,6 +612,20 @@ void ProxiesBox::setupContent() {
 			st::proxyAboutPadding),
 		style::margins(0, 0, 0, st::proxyRowPadding.top()));
 
+	if (Logs::DebugEnabled()) {
+		if (const auto instance = MTP::MainInstance()) {
+			const auto metrics = inner->add(
+				object_ptr<Ui::FlatLabel>(inner, st::boxDividerLabel),
+				st::proxyAboutPadding);
+			instance->connectionMetricsValue(
+			) | rpl::map(
+				ConnectionMetricsText
+			) | rpl::start_with_next([=](const QString &text) {
+				metrics->setText(text);
+			}, metrics->lifetime());
+		}
+	}
+
 	_wrap = inner->add(std::move(_initialWrap));
 	inner->add(object_ptr<Ui::FixedHeightWidget>(
 		inner,
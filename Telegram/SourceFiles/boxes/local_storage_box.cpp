@@ -18,6 +18,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/localstorage.h"
 #include "storage/cache/storage_cache_database.h"
 #include "data/data_session.h"
+#include "core/application.h"
 #include "lang/lang_keys.h"
 #include "mainwindow.h"
 #include "main/main_session.h"
@@ -56,6 +57,48 @@ int64 MediaSizeLimit(int index) {
 	return MediaSizeLimitInMB(index) * kMegabyte;
 }
 
+QString OperationStatsText(
+		const QString &name,
+		const LocalStorageBox::Database::OperationStats &stats) {
+	const auto average = stats.count ? (stats.totalTime / stats.count) : 0;
+	return name
+		+ ": " + QString::number(stats.count)
+		+ ", avg " + QString::number(average)
+		+ ", p50 " + QString::number(stats.latency.percentile(0.5))
+		+ ", p99 " + QString::number(stats.latency.percentile(0.99))
+		+ " mcs";
+}
+
+QString UsageStatsText(
+		const QString &name,
+		const LocalStorageBox::Database::Stats &stats) {
+	const auto &usage = stats.usage;
+	const auto &access = usage.access;
+	const auto requests = access.hits + access.misses;
+	const auto hitRate = requests
+		? (access.hits * 100 / requests)
+		: int64(0);
+	auto lines = QStringList();
+	lines.push_back(name
+		+ ": hits " + QString::number(access.hits)
+		+ ", misses " + QString::number(access.misses)
+		+ " (" + QString::number(hitRate) + "% hit rate)");
+	for (const auto &[tag, tagged] : usage.accessTagged) {
+		lines.push_back("tag " + QString::number(tag)
+			+ ": hits " + QString::number(tagged.hits));
+	}
+	lines.push_back(OperationStatsText("get", usage.get));
+	lines.push_back(OperationStatsText("put", usage.put));
+	lines.push_back(OperationStatsText("remove", usage.remove));
+	lines.push_back("binlog written: "
+		+ formatSizeText(usage.binlogBytesWritten));
+	lines.push_back("compactor: " + QString::number(usage.compactorRuns)
+		+ " runs, " + QString::number(usage.compactorTime / 1000) + " ms");
+	lines.push_back("cleaner: " + QString::number(usage.cleanerRuns)
+		+ " runs, " + QString::number(usage.cleanerTime / 1000) + " ms");
+	return lines.join('\n');
+}
+
 QString SizeLimitText(int64 limit) {
 	const auto mb = (limit / (1024 * 1024));
 	const auto gb = (mb / 1024);
@@ -322,6 +365,7 @@ void LocalStorageBox::update(
 		i->second->entity()->toggleProgress(
 			_stats.clearing || _statsBig.clearing);
 	}
+	updateDebugLabel();
 	for (const auto &entry : _rows) {
 		if (entry.first == kFakeMediaCacheTag) {
 			updateRow(entry.second, &_statsBig.full);
@@ -337,6 +381,15 @@ void LocalStorageBox::update(
 	}
 }
 
+void LocalStorageBox::updateDebugLabel() {
+	if (!_debugLabel) {
+		return;
+	}
+	_debugLabel->setText(UsageStatsText("cache", _stats)
+		+ "\n\n"
+		+ UsageStatsText("media cache", _statsBig));
+}
+
 auto LocalStorageBox::summary() const -> Database::TaggedSummary {
 	auto result = _stats.full;
 	result.count += _statsBig.full.count;
@@ -425,6 +478,12 @@ void LocalStorageBox::setupControls() {
 	shadow->toggleOn(
 		std::move(tracker).atLeastOneShownValue()
 	);
+	if (Logs::DebugEnabled()) {
+		_debugLabel = container->add(
+			object_ptr<Ui::FlatLabel>(container, st::boxLabel),
+			st::localStorageRowPadding);
+		updateDebugLabel();
+	}
 	container->resizeToWidth(st::boxWidth);
 	container->heightValue(
 	) | rpl::start_with_next([=](int height) {
@@ -590,7 +649,9 @@ void LocalStorageBox::save() {
 	updateBig.totalSizeLimit = _mediaSizeLimit;
 	updateBig.totalTimeLimit = _timeLimit;
 	Local::updateCacheSettings(update, updateBig);
-	_session->data().cache().updateSettings(update);
+	auto &databases = Core::App().databases();
+	databases.updateSettings(&_session->data().cache(), update);
+	databases.updateSettings(&_session->data().cacheBigFile(), updateBig);
 	closeBox();
 }
 
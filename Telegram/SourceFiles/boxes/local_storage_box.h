@@ -25,6 +25,7 @@ class VerticalLayout;
 template <typename Widget>
 class SlideWrap;
 class LabelSimple;
+class FlatLabel;
 class MediaSlider;
 } // namespace Ui
 
@@ -61,6 +62,7 @@ private:
 	void updateTotalLimit();
 	void updateTotalLabel();
 	void updateMediaLabel();
+	void updateDebugLabel();
 	void limitsChanged();
 	void save();
 
@@ -95,6 +97,7 @@ private:
 	Ui::LabelSimple *_totalLabel = nullptr;
 	Ui::MediaSlider *_mediaSlider = nullptr;
 	Ui::LabelSimple *_mediaLabel = nullptr;
+	Ui::FlatLabel *_debugLabel = nullptr;
 
 	int64 _totalSizeLimit = 0;
 	int64 _mediaSizeLimit = 0;
@@ -664,7 +664,18 @@ void PeerListContent::invalidatePixmapsCache() {
 
 bool PeerListContent::addingToSearchIndex() const {
 	// If we started indexing already, we continue.
-	return (_searchMode != PeerListSearchMode::Disabled) || !_searchIndex.empty();
+	return !_searchIndex.empty();
+}
+
+void PeerListContent::ensureSearchIndex() {
+	// Large lists are often opened without searching, so the index
+	// is built only when the first local search query comes.
+	if (!_searchIndex.empty()) {
+		return;
+	}
+	for (const auto &row : _rows) {
+		addToSearchIndex(row.get());
+	}
 }
 
 void PeerListContent::addToSearchIndex(not_null<PeerListRow*> row) {
@@ -677,6 +688,11 @@ void PeerListContent::addToSearchIndex(not_null<PeerListRow*> row) {
 	for (auto ch : row->nameFirstLetters()) {
 		_searchIndex[ch].push_back(row);
 	}
+	const auto &words = row->peer()->nameWords();
+	for (const auto &word : words) {
+		_searchWordsIndex.emplace(word, row.get());
+	}
+	_searchIndexedWords.emplace(row, words);
 }
 
 void PeerListContent::removeFromSearchIndex(not_null<PeerListRow*> row) {
@@ -694,6 +710,26 @@ void PeerListContent::removeFromSearchIndex(not_null<PeerListRow*> row) {
 		}
 		row->setNameFirstLetters({});
 	}
+	const auto i = _searchIndexedWords.find(row);
+	if (i != end(_searchIndexedWords)) {
+		for (const auto &word : i->second) {
+			_searchWordsIndex.erase({ word, row.get() });
+		}
+		_searchIndexedWords.erase(i);
+	}
+}
+
+auto PeerListContent::rowsByWordPrefix(const QString &prefix) const
+-> std::vector<not_null<PeerListRow*>> {
+	auto result = std::vector<not_null<PeerListRow*>>();
+	for (auto i = _searchWordsIndex.lower_bound({ prefix, nullptr })
+		; i != end(_searchWordsIndex) && i->first.startsWith(prefix)
+		; ++i) {
+		result.push_back(i->second);
+	}
+	ranges::sort(result, std::less<>());
+	result.erase(ranges::unique(result), end(result));
+	return result;
 }
 
 void PeerListContent::prependRow(std::unique_ptr<PeerListRow> row) {
@@ -784,6 +820,8 @@ void PeerListContent::clearAllContent() {
 	_rowsByPeer.clear();
 	_filterResults.clear();
 	_searchIndex.clear();
+	_searchWordsIndex.clear();
+	_searchIndexedWords.clear();
 	_rows.clear();
 	_searchRows.clear();
 	_searchQuery
@@ -885,11 +923,6 @@ void PeerListContent::refreshRows() {
 
 void PeerListContent::setSearchMode(PeerListSearchMode mode) {
 	if (_searchMode != mode) {
-		if (!addingToSearchIndex()) {
-			for_const (auto &row, _rows) {
-				addToSearchIndex(row.get());
-			}
-		}
 		_searchMode = mode;
 		if (_controller->hasComplexSearch()) {
 			if (!_searchLoading) {
@@ -1317,46 +1350,34 @@ void PeerListContent::searchQueryChanged(QString query) {
 	if (_normalizedSearchQuery != normalizedQuery) {
 		setSearchQuery(query, normalizedQuery);
 		if (_controller->searchInLocal() && !searchWordsList.isEmpty()) {
-			auto minimalList = (const std::vector<not_null<PeerListRow*>>*)nullptr;
-			for_const (auto &searchWord, searchWordsList) {
-				auto searchWordStart = searchWord[0].toLower();
-				auto it = _searchIndex.find(searchWordStart);
-				if (it == _searchIndex.cend()) {
-					// Some word can't be found in any row.
-					minimalList = nullptr;
-					break;
-				} else if (!minimalList || minimalList->size() > it->second.size()) {
-					minimalList = &it->second;
+			ensureSearchIndex();
+
+			// Rows having a name word with each of the query words
+			// as a prefix, the sorted words index gives them by ranges.
+			auto found = std::vector<not_null<PeerListRow*>>();
+			auto first = true;
+			for (const auto &searchWord : searchWordsList) {
+				auto rows = rowsByWordPrefix(searchWord);
+				if (first) {
+					found = std::move(rows);
+					first = false;
+				} else {
+					auto both = std::vector<not_null<PeerListRow*>>();
+					std::set_intersection(
+						begin(found),
+						end(found),
+						begin(rows),
+						end(rows),
+						std::back_inserter(both),
+						std::less<>());
+					found = std::move(both);
 				}
-			}
-			if (minimalList) {
-				auto searchWordInNames = [](
-						not_null<PeerData*> peer,
-						const QString &searchWord) {
-					for (auto &nameWord : peer->nameWords()) {
-						if (nameWord.startsWith(searchWord)) {
-							return true;
-						}
-					}
-					return false;
-				};
-				auto allSearchWordsInNames = [&](
-						not_null<PeerData*> peer) {
-					for_const (auto &searchWord, searchWordsList) {
-						if (!searchWordInNames(peer, searchWord)) {
-							return false;
-						}
-					}
-					return true;
-				};
-
-				_filterResults.reserve(minimalList->size());
-				for_const (auto row, *minimalList) {
-					if (allSearchWordsInNames(row->peer())) {
-						_filterResults.push_back(row);
-					}
+				if (found.empty()) {
+					break;
 				}
 			}
+			ranges::sort(found, ranges::less(), &PeerListRow::absoluteIndex);
+			_filterResults = std::move(found);
 		}
 		if (_controller->hasComplexSearch()) {
 			_controller->search(_searchQuery);
@@ -572,6 +572,9 @@ private:
 
 	void addRowEntry(not_null<PeerListRow*> row);
 	void addToSearchIndex(not_null<PeerListRow*> row);
+	void ensureSearchIndex();
+	[[nodiscard]] std::vector<not_null<PeerListRow*>> rowsByWordPrefix(
+		const QString &prefix) const;
 	bool addingToSearchIndex() const;
 	void removeFromSearchIndex(not_null<PeerListRow*> row);
 	void setSearchQuery(const QString &query, const QString &normalizedQuery);
@@ -616,6 +619,10 @@ private:
 	std::map<PeerData*, std::vector<not_null<PeerListRow*>>> _rowsByPeer;
 
 	std::map<QChar, std::vector<not_null<PeerListRow*>>> _searchIndex;
+	std::set<std::pair<QString, PeerListRow*>> _searchWordsIndex;
+	base::flat_map<
+		not_null<PeerListRow*>,
+		base::flat_set<QString>> _searchIndexedWords;
 	QString _searchQuery;
 	QString _normalizedSearchQuery;
 	QString _mentionHighlight;
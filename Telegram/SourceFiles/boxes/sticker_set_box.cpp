@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_session.h"
 #include "lang/lang_keys.h"
 #include "chat_helpers/stickers.h"
+#include "chat_helpers/stickers_thumbnails.h"
 #include "boxes/confirm_box.h"
 #include "core/application.h"
 #include "mtproto/sender.h"
@@ -646,10 +647,15 @@ void StickerSetBox::Inner::paintSticker(
 
 		_lottiePlayer->unpause(element.animated);
 	} else if (const auto image = document->getStickerSmall()) {
-		p.drawPixmapLeft(
+		document->session().stickerThumbnails().paint(
+			p,
 			ppos,
 			width(),
-			image->pix(document->stickerSetOrigin(), w, h));
+			document,
+			image,
+			document->stickerSetOrigin(),
+			w,
+			h);
 	}
 }
 
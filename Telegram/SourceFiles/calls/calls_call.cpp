@@ -40,6 +40,7 @@ namespace {
 constexpr auto kMinLayer = 65;
 constexpr auto kHangupTimeoutMs = 5000;
 constexpr auto kSha256Size = 32;
+constexpr auto kStatsSampleInterval = 5 * crl::time(1000);
 
 void AppendEndpoint(
 		std::vector<tgvoip::Endpoint> &list,
@@ -131,6 +132,7 @@ Call::Call(
 , _user(user)
 , _type(type) {
 	_discardByTimeoutTimer.setCallback([this] { hangup(); });
+	_statsTimer.setCallback([this] { sampleStats(); });
 
 	if (_type == Type::Outgoing) {
 		setState(State::Requesting);
@@ -762,6 +764,7 @@ void Call::setState(State state) {
 		switch (_state) {
 		case State::Established:
 			_startTime = crl::now();
+			_statsTimer.callEach(kStatsSampleInterval);
 			break;
 		case State::ExchangingKeys:
 			_delegate->playSound(Delegate::Sound::Connecting);
@@ -892,8 +895,57 @@ void Call::handleControllerError(int error) {
 	finish(FinishType::Failed);
 }
 
+void Call::sampleStats() {
+	Expects(_controller != nullptr);
+
+	auto traffic = tgvoip::VoIPController::TrafficStats();
+	_controller->GetStats(&traffic);
+
+	auto stats = Stats();
+	stats.duration = getDurationMs();
+	stats.signalBarCount = _signalBarCount;
+	stats.averageRtt = _controller->GetAverageRTT();
+	stats.bytesSent = int64(traffic.bytesSentWifi + traffic.bytesSentMobile);
+	stats.bytesReceived = int64(
+		traffic.bytesRecvdWifi + traffic.bytesRecvdMobile);
+	if (const auto elapsed = stats.duration - _lastStats.duration) {
+		const auto bitrate = [&](int64 now, int64 was) {
+			return int((now - was) * 8 * 1000 / elapsed);
+		};
+		stats.sendBitrate = bitrate(stats.bytesSent, _lastStats.bytesSent);
+		stats.receiveBitrate = bitrate(
+			stats.bytesReceived,
+			_lastStats.bytesReceived);
+	}
+	++_statsCount;
+	_rttSum += stats.averageRtt;
+	_rttMax = std::max(_rttMax, stats.averageRtt);
+	_lastStats = stats;
+	_stats.fire_copy(stats);
+}
+
+void Call::logStatsSummary() const {
+	if (!_statsCount) {
+		return;
+	}
+	LOG(("Call Info: Summary, duration %1 ms, sent %2 bytes, "
+		"received %3 bytes, rtt average %4 ms, max %5 ms, "
+		"last signal bars %6."
+		).arg(_lastStats.duration
+		).arg(_lastStats.bytesSent
+		).arg(_lastStats.bytesReceived
+		).arg(int(_rttSum * 1000 / _statsCount)
+		).arg(int(_rttMax * 1000)
+		).arg(_lastStats.signalBarCount));
+}
+
 void Call::destroyController() {
+	_statsTimer.cancel();
 	if (_controller) {
+		if (_startTime) {
+			sampleStats();
+			logStatsSummary();
+		}
 		DEBUG_LOG(("Call Info: Destroying call controller.."));
 		_controller.reset();
 		DEBUG_LOG(("Call Info: Call controller destroyed."));
@@ -113,6 +113,20 @@ public:
 	crl::time getDurationMs() const;
 	float64 getWaitingSoundPeakValue() const;
 
+	// Sampled periodically while the call is established.
+	struct Stats {
+		crl::time duration = 0;
+		int signalBarCount = 0;
+		float64 averageRtt = 0.; // In seconds.
+		int64 bytesSent = 0;
+		int64 bytesReceived = 0;
+		int sendBitrate = 0; // Bits per second since the previous sample.
+		int receiveBitrate = 0;
+	};
+	rpl::producer<Stats> stats() const {
+		return _stats.events();
+	}
+
 	void answer();
 	void hangup();
 	void redial();
@@ -179,6 +193,8 @@ private:
 	void setStateQueued(State state);
 	void setFailedQueued(int error);
 	void setSignalBarCount(int count);
+	void sampleStats();
+	void logStatsSummary() const;
 	void destroyController();
 
 	not_null<Delegate*> _delegate;
@@ -211,6 +227,13 @@ private:
 
 	ControllerPointer _controller;
 
+	base::Timer _statsTimer;
+	rpl::event_stream<Stats> _stats;
+	Stats _lastStats;
+	int _statsCount = 0;
+	float64 _rttSum = 0.;
+	float64 _rttMax = 0.;
+
 	std::unique_ptr<Media::Audio::Track> _waitingTrack;
 
 };
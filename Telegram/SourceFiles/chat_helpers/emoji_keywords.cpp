@@ -25,6 +25,7 @@ namespace {
 constexpr auto kRefreshEach = 60 * 60 * crl::time(1000); // 1 hour.
 constexpr auto kKeepNotUsedLangPacksCount = 4;
 constexpr auto kKeepNotUsedInputLanguagesCount = 4;
+constexpr auto kCompactMagic = qint32(0x4B454454); // "TDEK"
 
 using namespace Ui::Emoji;
 
@@ -35,12 +36,57 @@ struct LangPackEmoji {
 	QString text;
 };
 
+// Used only while reading the legacy cache or applying a difference.
 struct LangPackData {
 	int version = 0;
 	int maxKeyLength = 0;
 	std::map<QString, std::vector<LangPackEmoji>> emoji;
 };
 
+// Keywords sorted and serialized to one buffer, that is also the cache
+// file content, and queried in place without unpacking.
+//
+// Header: magic, version, keys count, max key length (all qint32).
+// Then qint32 offsets of the key records, each record is:
+// qint32 key length, key chars, qint32 emoji count and for each emoji
+// qint32 text length, text chars. Chars are UTF-16 code units.
+class CompactLangPack {
+public:
+	CompactLangPack() = default;
+
+	[[nodiscard]] static std::optional<CompactLangPack> FromSerialized(
+		QByteArray serialized);
+	[[nodiscard]] static CompactLangPack Pack(const LangPackData &data);
+	[[nodiscard]] LangPackData unpack() const;
+
+	[[nodiscard]] const QByteArray &serialized() const;
+	[[nodiscard]] int version() const;
+	[[nodiscard]] int maxKeyLength() const;
+	[[nodiscard]] bool empty() const;
+
+	// Calls callback(key, texts) for keys equal to or starting with query.
+	template <typename Callback>
+	void enumerate(
+		const QString &query,
+		bool exact,
+		Callback &&callback) const;
+
+private:
+	static constexpr auto kHeaderSize = 4 * int(sizeof(qint32));
+
+	explicit CompactLangPack(QByteArray serialized);
+
+	[[nodiscard]] qint32 readInt(int offset) const;
+	[[nodiscard]] QString readString(int offset, int length) const;
+	[[nodiscard]] QString readKey(int index) const;
+	[[nodiscard]] int count() const;
+	[[nodiscard]] int recordOffset(int index) const;
+	[[nodiscard]] std::vector<QString> readTexts(int index) const;
+
+	QByteArray _serialized;
+
+};
+
 [[nodiscard]] bool MustAddPostfix(const QString &text) {
 	if (text.size() != 1) {
 		return false;
@@ -85,13 +131,16 @@ void CreateCacheFilePath() {
 	return internal::CacheFileFolder() + qstr("/keywords/") + id;
 }
 
-[[nodiscard]] LangPackData ReadLocalCache(const QString &id) {
-	auto file = QFile(CacheFilePath(id));
-	if (!file.open(QIODevice::ReadOnly)) {
-		return {};
-	}
+[[nodiscard]] LangPackEmoji ToLangPackEmoji(const QString &text) {
+	const auto emoji = MustAddPostfix(text)
+		? (text + QChar(Ui::Emoji::kPostfix))
+		: text;
+	return LangPackEmoji{ Find(emoji), text };
+}
+
+[[nodiscard]] LangPackData ReadLegacyCache(const QByteArray &content) {
 	auto result = LangPackData();
-	auto stream = QDataStream(&file);
+	auto stream = QDataStream(content);
 	stream.setVersion(QDataStream::Qt_5_1);
 	auto version = qint32();
 	auto count = qint32();
@@ -117,10 +166,7 @@ void CreateCacheFilePath() {
 			if (stream.status() != QDataStream::Ok) {
 				return {};
 			}
-			const auto emoji = MustAddPostfix(text)
-				? (text + QChar(Ui::Emoji::kPostfix))
-				: text;
-			const auto entry = LangPackEmoji{ Find(emoji), text };
+			const auto entry = ToLangPackEmoji(text);
 			if (!entry.emoji) {
 				return {};
 			}
@@ -132,8 +178,8 @@ void CreateCacheFilePath() {
 	return result;
 }
 
-void WriteLocalCache(const QString &id, const LangPackData &data) {
-	if (!data.version && data.emoji.empty()) {
+void WriteLocalCache(const QString &id, const CompactLangPack &data) {
+	if (!data.version() && data.empty()) {
 		return;
 	}
 	CreateCacheFilePath();
@@ -141,18 +187,224 @@ void WriteLocalCache(const QString &id, const LangPackData &data) {
 	if (!file.open(QIODevice::WriteOnly)) {
 		return;
 	}
-	auto stream = QDataStream(&file);
-	stream.setVersion(QDataStream::Qt_5_1);
-	stream
-		<< qint32(data.version)
-		<< qint32(data.emoji.size());
+	file.write(data.serialized());
+}
+
+[[nodiscard]] CompactLangPack ReadLocalCache(const QString &id) {
+	auto file = QFile(CacheFilePath(id));
+	if (!file.open(QIODevice::ReadOnly)) {
+		return {};
+	}
+	auto content = file.readAll();
+	file.close();
+
+	if (auto result = CompactLangPack::FromSerialized(content)) {
+		return std::move(*result);
+	}
+	auto result = CompactLangPack::Pack(ReadLegacyCache(content));
+	WriteLocalCache(id, result);
+	return result;
+}
+
+CompactLangPack::CompactLangPack(QByteArray serialized)
+: _serialized(std::move(serialized)) {
+}
+
+std::optional<CompactLangPack> CompactLangPack::FromSerialized(
+		QByteArray serialized) {
+	const auto size = serialized.size();
+	auto result = CompactLangPack(std::move(serialized));
+	if (size < kHeaderSize || result.readInt(0) != kCompactMagic) {
+		return std::nullopt;
+	}
+	const auto count = result.count();
+	const auto records = kHeaderSize + int64(count) * sizeof(qint32);
+	if (result.version() < 0
+		|| count < 0
+		|| result.maxKeyLength() < 0
+		|| records > size) {
+		return std::nullopt;
+	}
+	const auto readLength = [&](int64 offset, int64 limit) -> int64 {
+		if (offset < 0 || offset + int64(sizeof(qint32)) > size) {
+			return -1;
+		}
+		const auto value = result.readInt(offset);
+		return (value >= 0 && value <= limit) ? value : -1;
+	};
+	auto previous = QString();
+	for (auto i = 0; i != count; ++i) {
+		auto offset = int64(result.recordOffset(i));
+		if (offset < records || (offset % 2)) {
+			return std::nullopt;
+		}
+		const auto keyLength = readLength(offset, result.maxKeyLength());
+		if (keyLength < 0) {
+			return std::nullopt;
+		}
+		offset += sizeof(qint32) + keyLength * sizeof(ushort);
+		const auto emojiCount = readLength(offset, size);
+		if (emojiCount < 0) {
+			return std::nullopt;
+		}
+		offset += sizeof(qint32);
+		for (auto j = 0; j != emojiCount; ++j) {
+			const auto textLength = readLength(offset, size);
+			if (textLength < 0) {
+				return std::nullopt;
+			}
+			offset += sizeof(qint32) + textLength * sizeof(ushort);
+		}
+		if (offset > size) {
+			return std::nullopt;
+		}
+		auto key = result.readKey(i);
+		if (i > 0 && !(previous < key)) {
+			return std::nullopt;
+		}
+		previous = std::move(key);
+	}
+	return std::move(result);
+}
+
+CompactLangPack CompactLangPack::Pack(const LangPackData &data) {
+	auto serialized = QByteArray();
+	const auto appendInt = [&](qint32 value) {
+		serialized.append(
+			reinterpret_cast<const char*>(&value),
+			sizeof(value));
+	};
+	const auto appendString = [&](const QString &value) {
+		appendInt(value.size());
+		serialized.append(
+			reinterpret_cast<const char*>(value.utf16()),
+			value.size() * sizeof(ushort));
+	};
+	const auto setInt = [&](int offset, qint32 value) {
+		memcpy(serialized.data() + offset, &value, sizeof(value));
+	};
+
+	const auto count = int(data.emoji.size());
+	appendInt(kCompactMagic);
+	appendInt(data.version);
+	appendInt(count);
+	appendInt(data.maxKeyLength);
+	serialized.resize(kHeaderSize + count * int(sizeof(qint32)));
+
+	auto index = 0;
 	for (const auto &[key, list] : data.emoji) {
-		stream
-			<< key
-			<< qint32(list.size());
+		setInt(kHeaderSize + (index++) * sizeof(qint32), serialized.size());
+		appendString(key);
+		appendInt(list.size());
 		for (const auto &emoji : list) {
-			stream << emoji.text;
+			appendString(emoji.text);
+		}
+	}
+	return CompactLangPack(std::move(serialized));
+}
+
+LangPackData CompactLangPack::unpack() const {
+	auto result = LangPackData();
+	result.version = version();
+	result.maxKeyLength = maxKeyLength();
+	for (auto i = 0, till = count(); i != till; ++i) {
+		auto &list = result.emoji[readKey(i)];
+		for (const auto &text : readTexts(i)) {
+			if (const auto entry = ToLangPackEmoji(text); entry.emoji) {
+				list.push_back(entry);
+			}
+		}
+	}
+	return result;
+}
+
+const QByteArray &CompactLangPack::serialized() const {
+	return _serialized;
+}
+
+int CompactLangPack::version() const {
+	return _serialized.isEmpty() ? 0 : readInt(sizeof(qint32));
+}
+
+int CompactLangPack::count() const {
+	return _serialized.isEmpty() ? 0 : readInt(2 * sizeof(qint32));
+}
+
+int CompactLangPack::maxKeyLength() const {
+	return _serialized.isEmpty() ? 0 : readInt(3 * sizeof(qint32));
+}
+
+bool CompactLangPack::empty() const {
+	return !count();
+}
+
+qint32 CompactLangPack::readInt(int offset) const {
+	auto result = qint32();
+	memcpy(&result, _serialized.constData() + offset, sizeof(result));
+	return result;
+}
+
+QString CompactLangPack::readString(int offset, int length) const {
+	return QString(
+		reinterpret_cast<const QChar*>(_serialized.constData() + offset),
+		length);
+}
+
+int CompactLangPack::recordOffset(int index) const {
+	return readInt(kHeaderSize + index * sizeof(qint32));
+}
+
+QString CompactLangPack::readKey(int index) const {
+	const auto offset = recordOffset(index);
+	return readString(offset + sizeof(qint32), readInt(offset));
+}
+
+std::vector<QString> CompactLangPack::readTexts(int index) const {
+	auto offset = recordOffset(index);
+	offset += sizeof(qint32) + readInt(offset) * sizeof(ushort);
+	const auto emojiCount = readInt(offset);
+	offset += sizeof(qint32);
+
+	auto result = std::vector<QString>();
+	result.reserve(emojiCount);
+	for (auto i = 0; i != emojiCount; ++i) {
+		const auto length = readInt(offset);
+		result.push_back(readString(offset + sizeof(qint32), length));
+		offset += sizeof(qint32) + length * sizeof(ushort);
+	}
+	return result;
+}
+
+template <typename Callback>
+void CompactLangPack::enumerate(
+		const QString &query,
+		bool exact,
+		Callback &&callback) const {
+	// Keys are compared without copying them out of the buffer.
+	const auto keyAt = [&](int index) {
+		const auto offset = recordOffset(index);
+		return QString::fromRawData(
+			reinterpret_cast<const QChar*>(
+				_serialized.constData() + offset + sizeof(qint32)),
+			readInt(offset));
+	};
+	const auto total = count();
+	auto from = 0;
+	auto till = total;
+	while (from < till) {
+		const auto middle = from + (till - from) / 2;
+		if (keyAt(middle) < query) {
+			from = middle + 1;
+		} else {
+			till = middle;
+		}
+	}
+	for (auto i = from; i != total; ++i) {
+		const auto key = keyAt(i);
+		if (exact ? (key != query) : !key.startsWith(query)) {
+			break;
 		}
+		callback(readKey(i), readTexts(i));
 	}
 }
 
@@ -305,12 +557,13 @@ private:
 
 	void readLocalCache();
 	void applyDifference(const MTPEmojiKeywordsDifference &result);
-	void applyData(LangPackData &&data);
+	void applyData(CompactLangPack &&data);
 
 	not_null<Delegate*> _delegate;
 	QString _id;
 	State _state = State::ReadingCache;
-	LangPackData _data;
+	CompactLangPack _data;
+	int _version = 0;
 	crl::time _lastRefreshTime = 0;
 	mtpRequestId _requestId = 0;
 	base::binary_guard _guard;
@@ -336,7 +589,7 @@ EmojiKeywords::LangPack::~LangPack() {
 void EmojiKeywords::LangPack::readLocalCache() {
 	const auto id = _id;
 	auto callback = crl::guard(_guard.make_guard(), [=](
-			LangPackData &&result) {
+			CompactLangPack &&result) {
 		applyData(std::move(result));
 		refresh();
 	});
@@ -379,10 +632,10 @@ void EmojiKeywords::LangPack::refresh() {
 			_lastRefreshTime = crl::now();
 		}).send();
 	};
-	_requestId = (_data.version > 0)
+	_requestId = (_version > 0)
 		? send(MTPmessages_GetEmojiKeywordsDifference(
 			MTP_string(_id),
-			MTP_int(_data.version)))
+			MTP_int(_version)))
 		: send(MTPmessages_GetEmojiKeywords(
 			MTP_string(_id)));
 }
@@ -397,24 +650,26 @@ void EmojiKeywords::LangPack::applyDifference(
 			LOG(("API Error: Bad lang_code for emoji keywords %1 -> %2"
 				).arg(_id
 				).arg(code));
-			_data.version = 0;
+			_version = 0;
 			_state = State::Refreshed;
 			return;
-		} else if (keywords.isEmpty() && _data.version >= version) {
+		} else if (keywords.isEmpty() && _version >= version) {
 			_state = State::Refreshed;
 			return;
 		}
 		const auto id = _id;
 		auto copy = _data;
 		auto callback = crl::guard(_guard.make_guard(), [=](
-				LangPackData &&result) {
+				CompactLangPack &&result) {
 			applyData(std::move(result));
 		});
 		crl::async([=, callback = std::move(callback)]() mutable {
-			ApplyDifference(copy, keywords, version);
-			WriteLocalCache(id, copy);
+			auto data = copy.unpack();
+			ApplyDifference(data, keywords, version);
+			auto result = CompactLangPack::Pack(data);
+			WriteLocalCache(id, result);
 			crl::on_main([
-				result = std::move(copy),
+				result = std::move(result),
 				callback = std::move(callback)
 			]() mutable {
 				callback(std::move(result));
@@ -423,8 +678,9 @@ void EmojiKeywords::LangPack::applyDifference(
 	});
 }
 
-void EmojiKeywords::LangPack::applyData(LangPackData &&data) {
+void EmojiKeywords::LangPack::applyData(CompactLangPack &&data) {
 	_data = std::move(data);
+	_version = _data.version();
 	_state = State::Refreshed;
 	_delegate->langPackRefreshed();
 }
@@ -442,30 +698,30 @@ void EmojiKeywords::LangPack::apiChanged() {
 std::vector<Result> EmojiKeywords::LangPack::query(
 		const QString &normalized,
 		bool exact) const {
-	if (normalized.size() > _data.maxKeyLength
-		|| _data.emoji.empty()
+	if (normalized.size() > _data.maxKeyLength()
+		|| _data.empty()
 		|| (exact && SkipExactKeyword(_id, normalized))) {
 		return {};
 	}
 
-	const auto from = _data.emoji.lower_bound(normalized);
-	auto &&chosen = ranges::make_iterator_range(
-		from,
-		end(_data.emoji)
-	) | ranges::view::take_while([&](const auto &pair) {
-		const auto &key = pair.first;
-		return exact ? (key == normalized) : key.startsWith(normalized);
-	});
-
 	auto result = std::vector<Result>();
-	for (const auto &[key, list] : chosen) {
-		AppendFoundEmoji(result, key, list);
-	}
+	_data.enumerate(normalized, exact, [&](
+			const QString &key,
+			const std::vector<QString> &texts) {
+		auto &&list = ranges::view::all(
+			texts
+		) | ranges::view::transform(
+			ToLangPackEmoji
+		) | ranges::view::filter([](const LangPackEmoji &entry) {
+			return (entry.emoji != nullptr);
+		});
+		AppendFoundEmoji(result, key, list | ranges::to_vector);
+	});
 	return result;
 }
 
 int EmojiKeywords::LangPack::maxQueryLength() const {
-	return _data.maxKeyLength;
+	return _data.maxKeyLength();
 }
 
 EmojiKeywords::EmojiKeywords() {
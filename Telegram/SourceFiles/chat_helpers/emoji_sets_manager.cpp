@@ -17,6 +17,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/emoji_config.h"
 #include "lang/lang_keys.h"
 #include "base/zlib_help.h"
+#include "base/task_lanes.h"
 #include "layout.h"
 #include "core/application.h"
 #include "main/main_account.h"
@@ -294,7 +295,7 @@ void Loader::setImplementation(
 void Loader::unpack(const QString &path) {
 	const auto folder = internal::SetDataPath(_id);
 	const auto weak = make_weak(this);
-	crl::async([=] {
+	base::lane_async(base::TaskLane::Bulk, [=] {
 		if (UnpackSet(path, folder)) {
 			QFile(path).remove();
 			SwitchToSet(_id, crl::guard(weak, [=](bool success) {
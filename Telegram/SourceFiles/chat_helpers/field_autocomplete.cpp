@@ -20,6 +20,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/image/image.h"
 #include "main/main_session.h"
 #include "chat_helpers/stickers.h"
+#include "chat_helpers/stickers_thumbnails.h"
 #include "base/unixtime.h"
 #include "styles/style_history.h"
 #include "styles/style_widgets.h"
@@ -672,7 +673,15 @@ void FieldAutocompleteInner::paintEvent(QPaintEvent *e) {
 						frame);
 				} else if (const auto image = document->getStickerSmall()) {
 					QPoint ppos = pos + QPoint((st::stickerPanSize.width() - w) / 2, (st::stickerPanSize.height() - h) / 2);
-					p.drawPixmapLeft(ppos, width(), image->pix(document->stickerSetOrigin(), w, h));
+					document->session().stickerThumbnails().paint(
+						p,
+						ppos,
+						width(),
+						document,
+						image,
+						document->stickerSetOrigin(),
+						w,
+						h);
 				}
 			}
 		}
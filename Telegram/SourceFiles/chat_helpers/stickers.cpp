@@ -29,6 +29,65 @@ namespace {
 
 constexpr auto kDontCacheLottieAfterArea = 512 * 512;
 
+// Roughly from the largest box to the smallest one.
+constexpr LottieSize kLottieVariants[] = {
+	LottieSize::MessageHistory,
+	LottieSize::InlineResults,
+	LottieSize::StickerSet,
+	LottieSize::StickersPanel,
+	LottieSize::StickersFooter,
+	LottieSize::SetsListThumbnail,
+};
+
+[[nodiscard]] std::vector<uint8> LottieCacheKeyShifts(uint8 keyShift) {
+	auto result = std::vector<uint8>{ keyShift };
+	for (const auto sizeTag : kLottieVariants) {
+		const auto variant = uint8((keyShift & 0xF0) | uint8(sizeTag));
+		if (variant != keyShift) {
+			result.push_back(variant);
+		}
+	}
+	return result;
+}
+
+// If there is no cache for the requested size, Lottie::Cache tries
+// to build it by downscaling the cache of some larger size.
+void GetLottieCache(
+		not_null<Main::Session*> session,
+		Storage::Cache::Key baseKey,
+		std::vector<uint8> keyShifts,
+		FnMut<void(QByteArray &&cached)> handler) {
+	Expects(!keyShifts.empty());
+
+	const auto key = Storage::Cache::Key{
+		baseKey.high,
+		baseKey.low + keyShifts.front()
+	};
+	keyShifts.erase(begin(keyShifts));
+	const auto weak = base::make_weak(session.get());
+	session->data().cacheBigFile().get(key, [
+		=,
+		keyShifts = std::move(keyShifts),
+		handler = std::move(handler)
+	](QByteArray &&cached) mutable {
+		if (!cached.isEmpty() || keyShifts.empty()) {
+			handler(std::move(cached));
+			return;
+		}
+		crl::on_main(weak, [
+			=,
+			keyShifts = std::move(keyShifts),
+			handler = std::move(handler)
+		]() mutable {
+			GetLottieCache(
+				weak.get(),
+				baseKey,
+				std::move(keyShifts),
+				std::move(handler));
+		});
+	});
+}
+
 } // namespace
 
 void ApplyArchivedResult(const MTPDmessages_stickerSetInstallResultArchive &d) {
@@ -713,18 +772,13 @@ std::vector<not_null<DocumentData*>> GetListByEmoji(
 		uint64 seed) {
 	const auto original = emoji->original();
 
-	struct StickerWithDate {
-		not_null<DocumentData*> document;
-		TimeId date = 0;
-	};
-	auto result = std::vector<StickerWithDate>();
+	auto result = std::vector<RankedSticker>();
+	auto added = base::flat_set<not_null<DocumentData*>>();
 	auto &sets = session->data().stickerSetsRef();
 	auto setsToRequest = base::flat_map<uint64, uint64>();
 
 	const auto add = [&](not_null<DocumentData*> document, TimeId date) {
-		if (ranges::find(result, document, [](const StickerWithDate &data) {
-			return data.document;
-		}) == result.end()) {
+		if (added.emplace(document).second) {
 			result.push_back({ document, date });
 		}
 	};
@@ -776,67 +830,95 @@ std::vector<not_null<DocumentData*>> GetListByEmoji(
 		return TimeId(0);
 	};
 
-	auto recentIt = sets.find(Stickers::CloudRecentSetId);
-	if (recentIt != sets.cend()) {
-		auto i = recentIt->emoji.constFind(original);
-		if (i != recentIt->emoji.cend()) {
-			result.reserve(i->size());
-			for (const auto document : *i) {
-				const auto usageDate = [&] {
-					if (recentIt->dates.empty()) {
-						return TimeId(0);
-					}
-					const auto index = recentIt->stickers.indexOf(document);
-					if (index < 0) {
-						return TimeId(0);
-					}
-					Assert(index < recentIt->dates.size());
-					return recentIt->dates[index];
-				}();
-				const auto date = usageDate
-					? usageDate
-					: InstallDate(document);
-				result.push_back({
-					document,
-					date ? date : CreateRecentSortKey(document) });
+	auto &byEmoji = session->data().stickersByEmojiIndexRef();
+	if (byEmoji.seed != seed) {
+		byEmoji.seed = seed;
+		byEmoji.lists.clear();
+	}
+	const auto cached = byEmoji.lists.find(original);
+	const auto fillInstalled = [&] {
+		auto recentIt = sets.find(Stickers::CloudRecentSetId);
+		if (recentIt != sets.cend()) {
+			auto i = recentIt->emoji.constFind(original);
+			if (i != recentIt->emoji.cend()) {
+				result.reserve(i->size());
+				for (const auto document : *i) {
+					const auto usageDate = [&] {
+						if (recentIt->dates.empty()) {
+							return TimeId(0);
+						}
+						const auto index = recentIt->stickers.indexOf(document);
+						if (index < 0) {
+							return TimeId(0);
+						}
+						Assert(index < recentIt->dates.size());
+						return recentIt->dates[index];
+					}();
+					const auto date = usageDate
+						? usageDate
+						: InstallDate(document);
+					added.emplace(document);
+					result.push_back({
+						document,
+						date ? date : CreateRecentSortKey(document) });
+				}
 			}
 		}
-	}
-	const auto addList = [&](const Order &order, MTPDstickerSet::Flag skip) {
-		for (const auto setId : order) {
-			auto it = sets.find(setId);
-			if (it == sets.cend() || (it->flags & skip)) {
-				continue;
-			}
-			if (it->emoji.isEmpty()) {
-				setsToRequest.emplace(it->id, it->access);
-				it->flags |= MTPDstickerSet_ClientFlag::f_not_loaded;
-				continue;
-			}
-			auto i = it->emoji.constFind(original);
-			if (i == it->emoji.cend()) {
-				continue;
-			}
-			const auto my = (it->flags & MTPDstickerSet::Flag::f_installed_date);
-			result.reserve(result.size() + i->size());
-			for (const auto document : *i) {
-				const auto installDate = my ? it->installDate : TimeId(0);
-				const auto date = (installDate > 1)
-					? InstallDateAdjusted(installDate, document)
-					: my
-					? CreateMySortKey(document)
-					: CreateFeaturedSortKey(document);
-				add(document, date);
+		const auto addList = [&](
+				const Order &order,
+				MTPDstickerSet::Flag skip) {
+			for (const auto setId : order) {
+				auto it = sets.find(setId);
+				if (it == sets.cend() || (it->flags & skip)) {
+					continue;
+				}
+				if (it->emoji.isEmpty()) {
+					setsToRequest.emplace(it->id, it->access);
+					it->flags |= MTPDstickerSet_ClientFlag::f_not_loaded;
+					continue;
+				}
+				auto i = it->emoji.constFind(original);
+				if (i == it->emoji.cend()) {
+					continue;
+				}
+				const auto my = (it->flags & MTPDstickerSet::Flag::f_installed_date);
+				result.reserve(result.size() + i->size());
+				for (const auto document : *i) {
+					const auto installDate = my ? it->installDate : TimeId(0);
+					const auto date = (installDate > 1)
+						? InstallDateAdjusted(installDate, document)
+						: my
+						? CreateMySortKey(document)
+						: CreateFeaturedSortKey(document);
+					add(document, date);
+				}
 			}
-		}
+		};
+
+		addList(
+			session->data().stickerSetsOrder(),
+			MTPDstickerSet::Flag::f_archived);
+		//addList(
+		//	session->data().featuredStickerSetsOrder(),
+		//	MTPDstickerSet::Flag::f_installed_date);
 	};
 
-	addList(
-		session->data().stickerSetsOrder(),
-		MTPDstickerSet::Flag::f_archived);
-	//addList(
-	//	session->data().featuredStickerSetsOrder(),
-	//	MTPDstickerSet::Flag::f_installed_date);
+	if (cached != end(byEmoji.lists)) {
+		result = cached->second;
+		const auto documents = ranges::view::all(
+			result
+		) | ranges::view::transform(
+			&RankedSticker::document
+		) | ranges::to_vector;
+		added = base::flat_set<not_null<DocumentData*>>(
+			begin(documents),
+			end(documents));
+	} else {
+		fillInstalled();
+		if (setsToRequest.empty()) {
+			byEmoji.lists.emplace(original, result);
+		}
+	}
 
 	if (!setsToRequest.empty()) {
 		for (const auto &[setId, accessHash] : setsToRequest) {
@@ -859,13 +941,13 @@ std::vector<not_null<DocumentData*>> GetListByEmoji(
 	ranges::action::sort(
 		result,
 		std::greater<>(),
-		&StickerWithDate::date);
+		&RankedSticker::date);
 
 	return ranges::view::all(
 		result
-	) | ranges::view::transform([](const StickerWithDate &data) {
-		return data.document;
-	}) | ranges::to_vector;
+	) | ranges::view::transform(
+		&RankedSticker::document
+	) | ranges::to_vector;
 }
 
 std::optional<std::vector<not_null<EmojiPtr>>> GetEmojiListFromSet(
@@ -1124,8 +1206,10 @@ auto LottieCachedFromContent(
 		baseKey.low + keyShift
 	};
 	const auto get = [=](FnMut<void(QByteArray &&cached)> handler) {
-		session->data().cacheBigFile().get(
-			key,
+		GetLottieCache(
+			session,
+			baseKey,
+			LottieCacheKeyShifts(keyShift),
 			std::move(handler));
 	};
 	const auto weak = base::make_weak(session.get());
@@ -83,6 +83,18 @@ struct Set {
 };
 using Sets = QMap<uint64, Set>;
 
+struct RankedSticker {
+	not_null<DocumentData*> document;
+	TimeId date = 0;
+};
+
+// Recent and installed stickers for each queried emoji, ranked with the
+// seed, until the sets or the recent stickers change.
+struct ByEmojiIndex {
+	uint64 seed = 0;
+	base::flat_map<EmojiPtr, std::vector<RankedSticker>> lists;
+};
+
 inline MTPInputStickerSet inputSetId(const Set &set) {
 	if (set.id && set.access) {
 		return MTP_inputStickerSetID(MTP_long(set.id), MTP_long(set.access));
@@ -20,6 +20,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "boxes/stickers_box.h"
 #include "inline_bots/inline_bot_result.h"
 #include "chat_helpers/stickers.h"
+#include "chat_helpers/stickers_thumbnails.h"
 #include "storage/localstorage.h"
 #include "lang/lang_keys.h"
 #include "mainwindow.h"
@@ -946,8 +947,32 @@ int StickersListWidget::featuredRowHeight() const {
 
 template <typename Callback>
 bool StickersListWidget::enumerateSections(Callback callback) const {
+	for (const auto &info : sections()) {
+		if (!callback(info)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+auto StickersListWidget::sections() const
+-> const std::vector<SectionInfo> & {
+	if (!_sectionsValid) {
+		_sections = countSections();
+		_sectionsValid = true;
+	}
+	return _sections;
+}
+
+void StickersListWidget::invalidateSections() {
+	_sectionsValid = false;
+}
+
+auto StickersListWidget::countSections() const -> std::vector<SectionInfo> {
+	auto result = std::vector<SectionInfo>();
 	auto info = SectionInfo();
 	const auto &sets = shownSets();
+	result.reserve(sets.size());
 	for (auto i = 0; i != sets.size(); ++i) {
 		auto &set = sets[i];
 		info.section = i;
@@ -968,38 +993,29 @@ bool StickersListWidget::enumerateSections(Callback callback) const {
 			info.rowsCount = (info.count / _columnCount) + ((info.count % _columnCount) ? 1 : 0);
 			info.rowsBottom = info.rowsTop + info.rowsCount * _singleSize.height();
 		}
-		if (!callback(info)) {
-			return false;
-		}
+		result.push_back(info);
 		info.top = info.rowsBottom;
 	}
-	return true;
+	return result;
 }
 
 StickersListWidget::SectionInfo StickersListWidget::sectionInfo(int section) const {
 	Expects(section >= 0 && section < shownSets().size());
 
-	auto result = SectionInfo();
-	enumerateSections([searchForSection = section, &result](const SectionInfo &info) {
-		if (info.section == searchForSection) {
-			result = info;
-			return false;
-		}
-		return true;
-	});
-	return result;
+	return sections()[section];
 }
 
 StickersListWidget::SectionInfo StickersListWidget::sectionInfoByOffset(int yOffset) const {
-	auto result = SectionInfo();
-	enumerateSections([this, &result, yOffset](const SectionInfo &info) {
-		if (yOffset < info.rowsBottom || info.section == shownSets().size() - 1) {
-			result = info;
-			return false;
-		}
-		return true;
-	});
-	return result;
+	const auto &list = sections();
+	if (list.empty()) {
+		return SectionInfo();
+	}
+	const auto i = ranges::upper_bound(
+		list,
+		yOffset,
+		ranges::less(),
+		&SectionInfo::rowsBottom);
+	return (i != end(list)) ? *i : list.back();
 }
 
 int StickersListWidget::countDesiredHeight(int newWidth) {
@@ -1018,6 +1034,7 @@ int StickersListWidget::countDesiredHeight(int newWidth) {
 		- st::buttonRadius;
 	_singleSize = QSize(singleWidth, singleWidth);
 	setColumnCount(columnCount);
+	invalidateSections();
 
 	auto visibleHeight = minimalHeight();
 	auto minimalHeight = (visibleHeight - st::stickerPanPadding);
@@ -1140,6 +1157,7 @@ void StickersListWidget::refreshSearchRows(
 	});
 
 	_searchSets.clear();
+	invalidateSections();
 	fillLocalSearchRows(_searchNextQuery);
 
 	if (!cloudSets && _searchNextQuery.isEmpty()) {
@@ -1220,6 +1238,7 @@ void StickersListWidget::addSearchRow(not_null<const Stickers::Set*> set) {
 		PrepareStickers(set->stickers.empty()
 			? set->covers
 			: set->stickers));
+	invalidateSections();
 }
 
 auto StickersListWidget::shownSets() const -> const std::vector<Set> & {
@@ -1492,9 +1511,7 @@ void StickersListWidget::checkVisibleLottie() {
 		if (destroyBelow <= info.rowsTop
 			|| destroyAbove >= info.rowsBottom) {
 			destroyLottieIn(shownSets()[info.section]);
-		} else if ((visibleTop > info.rowsTop && visibleTop < info.rowsBottom)
-			|| (visibleBottom > info.rowsTop
-				&& visibleBottom < info.rowsBottom)) {
+		} else {
 			pauseInvisibleLottieIn(info);
 		}
 		return true;
@@ -1536,6 +1553,11 @@ void StickersListWidget::pauseInvisibleLottieIn(const SectionInfo &info) {
 
 	const auto visibleTop = getVisibleTop();
 	const auto visibleBottom = getVisibleBottom();
+	if (visibleTop >= info.rowsBottom || visibleBottom <= info.rowsTop) {
+		// Kept for a quick scroll back, but shouldn't play offscreen.
+		pauseInRows(0, info.rowsCount);
+		return;
+	}
 	if (visibleTop >= info.rowsTop + _singleSize.height()
 		&& visibleTop < info.rowsBottom) {
 		const auto pauseHeight = (visibleTop - info.rowsTop);
@@ -1696,18 +1718,15 @@ void StickersListWidget::paintSticker(Painter &p, Set &set, int y, int section,
 
 		set.lottiePlayer->unpause(sticker.animated);
 	} else if (const auto image = document->getStickerSmall()) {
-		if (image->loaded()) {
-			p.drawPixmapLeft(
-				ppos,
-				width(),
-				image->pixSingle(
-					document->stickerSetOrigin(),
-					w,
-					h,
-					w,
-					h,
-					ImageRoundRadius::None));
-		}
+		document->session().stickerThumbnails().paint(
+			p,
+			ppos,
+			width(),
+			document,
+			image,
+			document->stickerSetOrigin(),
+			w,
+			h);
 	}
 
 	if (selected && stickerHasDeleteButton(set, index)) {
@@ -1988,6 +2007,7 @@ void StickersListWidget::setColumnCount(int count) {
 
 	if (_columnCount != count) {
 		_columnCount = count;
+		invalidateSections();
 		refreshFooterIcons();
 	}
 }
@@ -2057,6 +2077,7 @@ void StickersListWidget::setSection(Section section) {
 	}
 	clearLottieData();
 	_section = section;
+	invalidateSections();
 }
 
 void StickersListWidget::clearLottieData() {
@@ -2099,6 +2120,7 @@ void StickersListWidget::refreshMySets() {
 		appendSet(_mySets, setId, externalLayout, AppendSkip::Archived);
 	}
 	refreshMegagroupStickers(GroupStickersPlace::Hidden);
+	invalidateSections();
 }
 
 void StickersListWidget::refreshFeaturedSets() {
@@ -2109,6 +2131,7 @@ void StickersListWidget::refreshFeaturedSets() {
 		const auto externalLayout = true;
 		appendSet(_featuredSets, setId, externalLayout, AppendSkip::Installed);
 	}
+	invalidateSections();
 }
 
 void StickersListWidget::refreshSearchSets() {
@@ -2128,6 +2151,7 @@ void StickersListWidget::refreshSearchSets() {
 			}
 		}
 	}
+	invalidateSections();
 }
 
 void StickersListWidget::refreshSearchIndex() {
@@ -2356,6 +2380,7 @@ void StickersListWidget::refreshRecentStickers(bool performResize) {
 		_lottieData.remove(recentIt->id);
 		_mySets.erase(recentIt);
 	}
+	invalidateSections();
 
 	if (performResize && (_section == Section::Stickers || _section == Section::Featured)) {
 		resizeToWidth(width());
@@ -2724,6 +2749,7 @@ void StickersListWidget::refreshMegagroupSetGeometry() {
 	_megagroupSetButtonTextWidth = st::stickerGroupCategoryAdd.font->width(_megagroupSetButtonText);
 	auto buttonWidth = _megagroupSetButtonTextWidth - st::stickerGroupCategoryAdd.width;
 	_megagroupSetButtonRect = QRect(left, top, buttonWidth, st::stickerGroupCategoryAdd.height);
+	invalidateSections();
 }
 
 void StickersListWidget::showMegagroupSet(ChannelData *megagroup) {
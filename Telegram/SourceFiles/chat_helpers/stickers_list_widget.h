@@ -198,6 +198,9 @@ private:
 	bool enumerateSections(Callback callback) const;
 	SectionInfo sectionInfo(int section) const;
 	SectionInfo sectionInfoByOffset(int yOffset) const;
+	const std::vector<SectionInfo> &sections() const;
+	std::vector<SectionInfo> countSections() const;
+	void invalidateSections();
 
 	void setSection(Section section);
 	void displaySet(uint64 setId);
@@ -303,6 +306,8 @@ private:
 	std::vector<Set> _mySets;
 	std::vector<Set> _featuredSets;
 	std::vector<Set> _searchSets;
+	mutable std::vector<SectionInfo> _sections;
+	mutable bool _sectionsValid = false;
 	base::flat_set<uint64> _installedLocallySets;
 	std::vector<bool> _custom;
 	base::flat_set<not_null<DocumentData*>> _favedStickersMap;
@@ -0,0 +1,138 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "chat_helpers/stickers_thumbnails.h"
+
+#include "data/data_document.h"
+#include "data/data_file_origin.h"
+#include "ui/image/image.h"
+
+namespace Stickers {
+namespace {
+
+constexpr auto kPageSide = 1024;
+constexpr auto kMaxPages = 8;
+constexpr auto kCellStep = 8;
+
+} // namespace
+
+ThumbnailAtlas::ThumbnailAtlas() = default;
+
+ThumbnailAtlas::~ThumbnailAtlas() = default;
+
+bool ThumbnailAtlas::paint(
+		Painter &p,
+		QPoint position,
+		int outerWidth,
+		not_null<DocumentData*> document,
+		not_null<Image*> image,
+		Data::FileOrigin origin,
+		int w,
+		int h) {
+	image->load(origin);
+	if (!image->loaded()) {
+		return false;
+	}
+	const auto factor = cIntRetinaFactor();
+	const auto key = Key{ document->id, w * factor, h * factor };
+	auto i = _entries.find(key);
+	if (i == end(_entries)) {
+		if (const auto entry = add(key, image, origin)) {
+			i = _entries.emplace(key, *entry).first;
+		} else {
+			p.drawPixmapLeft(position, outerWidth, image->pix(origin, w, h));
+			return true;
+		}
+	}
+	auto &page = _pages[i->second.page];
+	page.lastUsed = ++_paintCounter;
+	const auto from = cellRect(page, i->second.cell);
+	p.drawPixmapLeft(
+		QRect(position, QSize(w, h)),
+		outerWidth,
+		page.pixmap,
+		QRect(from.topLeft(), QSize(key.width, key.height)));
+	return true;
+}
+
+void ThumbnailAtlas::clear() {
+	_entries.clear();
+	_pages.clear();
+}
+
+QRect ThumbnailAtlas::cellRect(const Page &page, int cell) const {
+	const auto columns = kPageSide / page.side;
+	return QRect(
+		(cell % columns) * page.side,
+		(cell / columns) * page.side,
+		page.side,
+		page.side);
+}
+
+int ThumbnailAtlas::pageForSide(int side) {
+	const auto capacity = (kPageSide / side) * (kPageSide / side);
+	for (auto i = 0, count = int(_pages.size()); i != count; ++i) {
+		if (_pages[i].side == side && _pages[i].used < capacity) {
+			return i;
+		}
+	}
+	if (_pages.size() < kMaxPages) {
+		auto page = Page();
+		page.pixmap = QPixmap(kPageSide, kPageSide);
+		page.pixmap.fill(Qt::transparent);
+		page.side = side;
+		_pages.push_back(std::move(page));
+		return int(_pages.size()) - 1;
+	}
+	return recyclePage(side);
+}
+
+int ThumbnailAtlas::recyclePage(int side) {
+	Expects(!_pages.empty());
+
+	const auto i = ranges::min_element(_pages, ranges::less(), &Page::lastUsed);
+	const auto index = int(i - begin(_pages));
+	for (auto j = begin(_entries); j != end(_entries);) {
+		if (j->second.page == index) {
+			j = _entries.erase(j);
+		} else {
+			++j;
+		}
+	}
+	i->pixmap.fill(Qt::transparent);
+	i->side = side;
+	i->used = 0;
+	return index;
+}
+
+auto ThumbnailAtlas::add(
+		const Key &key,
+		not_null<Image*> image,
+		Data::FileOrigin origin) -> std::optional<Entry> {
+	const auto larger = std::max(key.width, key.height);
+	const auto side = ((larger + kCellStep - 1) / kCellStep) * kCellStep;
+	if (side > kPageSide) {
+		return std::nullopt;
+	}
+	const auto index = pageForSide(side);
+	auto &page = _pages[index];
+	const auto result = Entry{ index, page.used++ };
+	const auto rect = cellRect(page, result.cell);
+
+	const auto pixmap = image->pixNoCache(
+		origin,
+		key.width,
+		key.height,
+		Images::Option::Smooth | Images::Option::None);
+	QPainter p(&page.pixmap);
+	p.setCompositionMode(QPainter::CompositionMode_Source);
+	p.fillRect(rect, Qt::transparent);
+	p.drawPixmap(rect.topLeft(), pixmap);
+	return result;
+}
+
+} // namespace Stickers
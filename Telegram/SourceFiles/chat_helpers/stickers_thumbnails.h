@@ -0,0 +1,78 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+class Painter;
+class Image;
+class DocumentData;
+
+namespace Data {
+struct FileOrigin;
+} // namespace Data
+
+namespace Stickers {
+
+// Small sticker thumbnails of the panels, packed into a few shared pages.
+// Each page holds square cells of one size, so a panel full of stickers
+// is painted from a handful of pixmaps instead of one per sticker.
+class ThumbnailAtlas final {
+public:
+	ThumbnailAtlas();
+	~ThumbnailAtlas();
+
+	// Paints the thumbnail fitted to (w, h), adding it on first use.
+	// Starts loading and returns false if the image is not loaded yet.
+	bool paint(
+		Painter &p,
+		QPoint position,
+		int outerWidth,
+		not_null<DocumentData*> document,
+		not_null<Image*> image,
+		Data::FileOrigin origin,
+		int w,
+		int h);
+
+	void clear();
+
+private:
+	struct Key {
+		uint64 documentId = 0;
+		int width = 0;
+		int height = 0;
+
+		inline bool operator<(const Key &other) const {
+			return std::tie(documentId, width, height)
+				< std::tie(other.documentId, other.width, other.height);
+		}
+	};
+	struct Entry {
+		int page = 0;
+		int cell = 0;
+	};
+	struct Page {
+		QPixmap pixmap;
+		int side = 0;
+		int used = 0;
+		uint64 lastUsed = 0;
+	};
+
+	[[nodiscard]] QRect cellRect(const Page &page, int cell) const;
+	[[nodiscard]] int pageForSide(int side);
+	[[nodiscard]] int recyclePage(int side);
+	[[nodiscard]] std::optional<Entry> add(
+		const Key &key,
+		not_null<Image*> image,
+		Data::FileOrigin origin);
+
+	base::flat_map<Key, Entry> _entries;
+	std::vector<Page> _pages;
+	uint64 _paintCounter = 0;
+
+};
+
+} // namespace Stickers
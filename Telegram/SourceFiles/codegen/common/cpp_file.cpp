@@ -84,8 +84,11 @@ bool CppFile::finalize() {
 	}
 	stream_.flush();
 
+	// Unchanged outputs are not touched, so their dependents are not rebuilt.
 	QFile file(filepath_);
-	if (!forceReGenerate_ && file.open(QIODevice::ReadOnly)) {
+	if (!forceReGenerate_
+		&& file.size() == content_.size()
+		&& file.open(QIODevice::ReadOnly)) {
 		if (file.readAll() == content_) {
 			file.close();
 			return true;
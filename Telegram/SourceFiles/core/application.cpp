@@ -19,6 +19,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/sandbox.h"
 #include "core/local_url_handlers.h"
 #include "core/launcher.h"
+#include "core/core_trace.h"
 #include "chat_helpers/emoji_keywords.h"
 #include "storage/localstorage.h"
 #include "platform/platform_specific.h"
@@ -155,6 +156,8 @@ Application::~Application() {
 }
 
 void Application::run() {
+	const auto trace = Trace::Scope("Core::Application::run");
+
 	Fonts::Start();
 
 	ThirdParty::start();
@@ -176,9 +179,15 @@ void Application::run() {
 	_translator = std::make_unique<Lang::Translator>();
 	QCoreApplication::instance()->installTranslator(_translator.get());
 
-	style::startManager();
+	{
+		const auto trace = Trace::Scope("style::startManager");
+		style::startManager();
+	}
 	Ui::InitTextOptions();
-	Ui::Emoji::Init();
+	{
+		const auto trace = Trace::Scope("Ui::Emoji::Init");
+		Ui::Emoji::Init();
+	}
 	Media::Player::start(_audio.get());
 
 	DEBUG_LOG(("Application Info: inited..."));
@@ -190,7 +199,10 @@ void Application::run() {
 	// Create mime database, so it won't be slow later.
 	QMimeDatabase().mimeTypeForName(qsl("text/plain"));
 
-	_window = std::make_unique<Window::Controller>(&activeAccount());
+	{
+		const auto trace = Trace::Scope("Window::Controller");
+		_window = std::make_unique<Window::Controller>(&activeAccount());
+	}
 
 	const auto currentGeometry = _window->widget()->geometry();
 	_mediaView = std::make_unique<Media::View::OverlayWidget>();
@@ -208,7 +220,10 @@ void Application::run() {
 	startShortcuts();
 	App::initMedia();
 
-	Local::ReadMapState state = Local::readMap(QByteArray());
+	const auto state = [&] {
+		const auto trace = Trace::Scope("Local::readMap");
+		return Local::readMap(QByteArray());
+	}();
 	if (state == Local::ReadMapPassNeeded) {
 		Global::SetLocalPasscode(true);
 		Global::RefLocalPasscodeChanged().notify();
@@ -219,6 +234,7 @@ void Application::run() {
 		activeAccount().startMtp();
 		DEBUG_LOG(("Application Info: MTP started..."));
 		if (activeAccount().sessionExists()) {
+			const auto trace = Trace::Scope("Window::Controller::setupMain");
 			_window->setupMain();
 		} else {
 			_window->setupIntro();
@@ -389,7 +405,10 @@ void Application::badMtprotoConfigurationError() {
 }
 
 void Application::startLocalStorage() {
-	Local::start();
+	{
+		const auto trace = Trace::Scope("Local::start");
+		Local::start();
+	}
 	subscribe(_dcOptions->changed(), [this](const MTP::DcOptions::Ids &ids) {
 		Local::writeSettings();
 		if (const auto instance = activeAccount().mtp()) {
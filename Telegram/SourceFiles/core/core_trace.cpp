@@ -0,0 +1,150 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "core/core_trace.h"
+
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <atomic>
+
+namespace Core {
+namespace Trace {
+namespace {
+
+constexpr auto kEventsLimit = 64 * 1024;
+
+struct Event {
+	const char *name = nullptr;
+	crl::profile_time start = 0;
+	crl::profile_time duration = 0;
+	int thread = 0;
+};
+
+std::atomic<bool> TraceEnabled = false;
+std::atomic<int> ThreadIdLast = 0;
+
+bool StartupProfile = false;
+crl::profile_time StartupProfileStart = 0;
+
+QMutex EventsMutex;
+std::vector<Event> Events;
+int EventsNext = 0;
+
+int CurrentThreadId() {
+	thread_local const auto result = ++ThreadIdLast;
+	return result;
+}
+
+} // namespace
+
+bool Enabled() {
+	return TraceEnabled.load(std::memory_order_relaxed);
+}
+
+void SetEnabled(bool enabled) {
+	QMutexLocker lock(&EventsMutex);
+	if (enabled) {
+		Events.reserve(kEventsLimit);
+	} else {
+		Events = std::vector<Event>();
+		EventsNext = 0;
+	}
+	TraceEnabled = enabled;
+}
+
+void Record(
+		const char *name,
+		crl::profile_time start,
+		crl::profile_time finish) {
+	const auto thread = CurrentThreadId();
+
+	QMutexLocker lock(&EventsMutex);
+	if (!Enabled()) {
+		return;
+	}
+	auto event = Event{ name, start, finish - start, thread };
+	if (int(Events.size()) < kEventsLimit) {
+		Events.push_back(event);
+	} else {
+		Events[EventsNext] = event;
+	}
+	EventsNext = (EventsNext + 1) % kEventsLimit;
+}
+
+QByteArray ExportChromeTrace() {
+	auto events = std::vector<Event>();
+	auto next = 0;
+	{
+		QMutexLocker lock(&EventsMutex);
+		events = Events;
+		next = EventsNext;
+	}
+
+	// The oldest event is the one that is overwritten next.
+	if (int(events.size()) == kEventsLimit) {
+		std::rotate(begin(events), begin(events) + next, end(events));
+	}
+	auto list = QJsonArray();
+	for (const auto &event : events) {
+		auto object = QJsonObject();
+		object.insert(qsl("name"), QString::fromLatin1(event.name));
+		object.insert(qsl("ph"), qsl("X"));
+		object.insert(qsl("ts"), double(event.start));
+		object.insert(qsl("dur"), double(event.duration));
+		object.insert(qsl("pid"), 1);
+		object.insert(qsl("tid"), event.thread);
+		list.append(object);
+	}
+	auto result = QJsonObject();
+	result.insert(qsl("traceEvents"), list);
+	return QJsonDocument(result).toJson(QJsonDocument::Compact);
+}
+
+void StartStartupProfile() {
+	StartupProfile = true;
+	StartupProfileStart = crl::profile();
+	SetEnabled(true);
+}
+
+bool StartupProfileActive() {
+	return StartupProfile;
+}
+
+void FinishStartupProfile(const QString &path) {
+	if (!base::take(StartupProfile)) {
+		return;
+	}
+	Record("Startup", StartupProfileStart, crl::profile());
+
+	auto events = std::vector<Event>();
+	{
+		QMutexLocker lock(&EventsMutex);
+		events = Events;
+	}
+	LOG(("Startup Info: Profile, %1 events.").arg(int(events.size())));
+	for (const auto &event : events) {
+		LOG(("Startup Info: %1 at %2 ms took %3 ms."
+			).arg(event.name
+			).arg((event.start - StartupProfileStart) / 1000.
+			).arg(event.duration / 1000.));
+	}
+
+	const auto trace = ExportChromeTrace();
+	QFile f(path);
+	if (!f.open(QIODevice::WriteOnly) || f.write(trace) != trace.size()) {
+		LOG(("Startup Error: Could not write profile to '%1'.").arg(path));
+	} else {
+		LOG(("Startup Info: Profile written to '%1'.").arg(path));
+	}
+	SetEnabled(false);
+}
+
+} // namespace Trace
+} // namespace Core
@@ -0,0 +1,55 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include <crl/crl_time.h>
+
+namespace Core {
+namespace Trace {
+
+[[nodiscard]] bool Enabled();
+void SetEnabled(bool enabled);
+
+// Name must be a string literal, only the pointer is recorded.
+void Record(
+	const char *name,
+	crl::profile_time start,
+	crl::profile_time finish);
+
+// Last recorded events as a Chrome trace ("chrome://tracing") JSON.
+[[nodiscard]] QByteArray ExportChromeTrace();
+
+// Enabled by the -profile-startup command line argument.
+// Tracing stays on till the first chat list paint, then the events
+// are logged, written to the path as a Chrome trace and dropped.
+void StartStartupProfile();
+[[nodiscard]] bool StartupProfileActive();
+void FinishStartupProfile(const QString &path);
+
+class Scope {
+public:
+	explicit Scope(const char *name)
+	: _name(Enabled() ? name : nullptr)
+	, _start(_name ? crl::profile() : crl::profile_time()) {
+	}
+	Scope(const Scope &other) = delete;
+	Scope &operator=(const Scope &other) = delete;
+	~Scope() {
+		if (_name) {
+			Record(_name, _start, crl::profile());
+		}
+	}
+
+private:
+	const char *_name = nullptr;
+	crl::profile_time _start = 0;
+
+};
+
+} // namespace Trace
+} // namespace Core
@@ -14,6 +14,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/main_queue_processor.h"
 #include "core/update_checker.h"
 #include "core/sandbox.h"
+#include "core/core_trace.h"
 #include "base/concurrent_timer.h"
 
 namespace Core {
@@ -391,6 +392,7 @@ void Launcher::processArguments() {
 		{ "-workdir"        , KeyFormat::OneValue },
 		{ "--"              , KeyFormat::OneValue },
 		{ "-scale"          , KeyFormat::OneValue },
+		{ "-profile-startup", KeyFormat::NoValues },
 	};
 	auto parseResult = QMap<QByteArray, QStringList>();
 	auto parsingKey = QByteArray();
@@ -420,6 +422,9 @@ void Launcher::processArguments() {
 	}
 	gTestMode = parseResult.contains("-testmode");
 	Logs::SetDebugEnabled(parseResult.contains("-debug"));
+	if (parseResult.contains("-profile-startup")) {
+		Trace::StartStartupProfile();
+	}
 	gManyInstance = parseResult.contains("-many");
 	gKeyFile = parseResult.value("-key", {}).join(QString()).toLower();
 	gKeyFile = gKeyFile.replace(QRegularExpression("[^a-z0-9\\-_]"), {});
@@ -36,11 +36,13 @@ void PushToMainQueueGeneric(void (*callable)(void*), void *argument) {
 	const auto fill = MainQueueProcessState.compare_exchange_strong(
 		expected,
 		ProcessState::FillingUp);
-	if (fill) {
-		MainQueueProcessCallback = callable;
-		MainQueueProcessArgument = argument;
-		MainQueueProcessState.store(ProcessState::Waiting);
+	if (!fill) {
+		// A drain is already scheduled, it will process this one as well.
+		return;
 	}
+	MainQueueProcessCallback = callable;
+	MainQueueProcessArgument = argument;
+	MainQueueProcessState.store(ProcessState::Waiting);
 
 	auto event = std::make_unique<QEvent>(kProcessorEvent);
 
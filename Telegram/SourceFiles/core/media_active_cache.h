@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/last_used_cache.h"
+#include "base/memory_usage.h"
 
 namespace Core {
 
@@ -15,7 +16,10 @@ template <typename Type>
 class MediaActiveCache {
 public:
 	template <typename Unload>
-	MediaActiveCache(int64 limit, Unload &&unload);
+	MediaActiveCache(
+		int64 limit,
+		base::memory_usage::Category category,
+		Unload &&unload);
 
 	void up(Type *entry);
 	void remove(Type *entry);
@@ -32,14 +36,19 @@ private:
 	SingleQueuedInvokation _delayed;
 	int64 _usage = 0;
 	int64 _limit = 0;
+	base::memory_usage::Category _category;
 
 };
 
 template <typename Type>
 template <typename Unload>
-MediaActiveCache<Type>::MediaActiveCache(int64 limit, Unload &&unload)
+MediaActiveCache<Type>::MediaActiveCache(
+	int64 limit,
+	base::memory_usage::Category category,
+	Unload &&unload)
 : _delayed([=] { check(unload); })
-, _limit(limit) {
+, _limit(limit)
+, _category(category) {
 }
 
 template <typename Type>
@@ -61,11 +70,13 @@ void MediaActiveCache<Type>::clear() {
 template <typename Type>
 void MediaActiveCache<Type>::increment(int64 amount) {
 	_usage += amount;
+	base::memory_usage::Add(_category, amount);
 }
 
 template <typename Type>
 void MediaActiveCache<Type>::decrement(int64 amount) {
 	_usage -= amount;
+	base::memory_usage::Add(_category, -amount);
 }
 
 template <typename Type>
@@ -16,6 +16,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "core/crash_report_window.h"
 #include "core/application.h"
 #include "core/launcher.h"
+#include "core/core_trace.h"
 #include "core/local_url_handlers.h"
 #include "core/update_checker.h"
 #include "base/timer.h"
@@ -150,6 +151,7 @@ void Sandbox::launchApplication() {
 		}
 		setupScreenScale();
 
+		const auto trace = Trace::Scope("Core::Application::Application");
 		_application = std::make_unique<Application>(_launcher);
 
 		// Ideally this should go to constructor.
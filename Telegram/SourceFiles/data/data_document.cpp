@@ -44,6 +44,7 @@ using FilePathResolve = DocumentData::FilePathResolve;
 Core::MediaActiveCache<DocumentData> &ActiveCache() {
 	static auto Instance = Core::MediaActiveCache<DocumentData>(
 		kMemoryForCache,
+		base::memory_usage::Category::DocumentsCache,
 		[](DocumentData *document) { document->unload(); });
 	return Instance;
 }
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/clip/media_clip_reader.h"
 #include "lottie/lottie_animation.h"
 #include "main/main_session.h"
+#include "base/task_lanes.h"
 
 #include <QtCore/QBuffer>
 #include <QtGui/QImageReader>
@@ -22,6 +23,7 @@ namespace {
 
 constexpr auto kGoodThumbQuality = 87;
 constexpr auto kWallPaperSize = 960;
+constexpr auto kMaxGenerationsRunning = 2;
 
 enum class FileType {
 	Video,
@@ -65,6 +67,63 @@ QImage Prepare(
 		: result;
 }
 
+// Generation decodes the whole file, so only a few run at once.
+// The last requested ones go first, they are most likely still on the
+// screen, and the requests cancelled while waiting are just dropped.
+class Generator final {
+public:
+	using Task = FnMut<void(base::binary_guard &&guard)>;
+
+	void enqueue(base::binary_guard &&guard, Task &&task);
+	void finished();
+
+private:
+	struct Waiting {
+		base::binary_guard guard;
+		Task task;
+	};
+
+	void process();
+
+	std::vector<Waiting> _waiting;
+	int _running = 0;
+
+};
+
+void Generator::enqueue(base::binary_guard &&guard, Task &&task) {
+	_waiting.push_back({ std::move(guard), std::move(task) });
+	process();
+}
+
+void Generator::finished() {
+	Expects(_running > 0);
+
+	--_running;
+	process();
+}
+
+void Generator::process() {
+	while (_running < kMaxGenerationsRunning && !_waiting.empty()) {
+		auto waiting = std::move(_waiting.back());
+		_waiting.pop_back();
+		if (waiting.guard) {
+			++_running;
+			waiting.task(std::move(waiting.guard));
+		}
+	}
+}
+
+Generator &Generations() {
+	static auto result = Generator();
+	return result;
+}
+
+void GenerationFinished() {
+	crl::on_main([] {
+		Generations().finished();
+	});
+}
+
 } // namespace
 
 GoodThumbSource::GoodThumbSource(not_null<DocumentData*> document)
@@ -88,38 +147,48 @@ void GoodThumbSource::generate(base::binary_guard &&guard) {
 		_empty = true;
 		return;
 	}
-	crl::async([
+	Generations().enqueue(std::move(guard), [
 		=,
-		guard = std::move(guard),
 		location = std::move(location)
-	]() mutable {
-		const auto filepath = (location && location->accessEnable())
-			? location->name()
-			: QString();
-		auto result = Prepare(filepath, data, type);
-		auto bytes = QByteArray();
-		if (!result.isNull()) {
-			auto buffer = QBuffer(&bytes);
-			const auto format = (type == FileType::AnimatedSticker)
-				? "WEBP"
-				: (type == FileType::WallPaper && result.hasAlphaChannel())
-				? "PNG"
-				: "JPG";
-			result.save(&buffer, format, kGoodThumbQuality);
-		}
-		if (!filepath.isEmpty()) {
-			location->accessDisable();
-		}
-		const auto bytesSize = bytes.size();
-		ready(
-			std::move(guard),
-			std::move(result),
-			bytesSize,
-			std::move(bytes));
+	](base::binary_guard &&guard) mutable {
+		base::lane_async(base::TaskLane::Background, [
+			=,
+			guard = std::move(guard),
+			location = std::move(location)
+		]() mutable {
+			if (!guard) {
+				GenerationFinished();
+				return;
+			}
+			const auto filepath = (location && location->accessEnable())
+				? location->name()
+				: QString();
+			auto result = Prepare(filepath, data, type);
+			auto bytes = QByteArray();
+			if (!result.isNull()) {
+				auto buffer = QBuffer(&bytes);
+				const auto format = (type == FileType::AnimatedSticker)
+					? "WEBP"
+					: (type == FileType::WallPaper && result.hasAlphaChannel())
+					? "PNG"
+					: "JPG";
+				result.save(&buffer, format, kGoodThumbQuality);
+			}
+			if (!filepath.isEmpty()) {
+				location->accessDisable();
+			}
+			const auto bytesSize = bytes.size();
+			ready(
+				std::move(guard),
+				std::move(result),
+				bytesSize,
+				std::move(bytes));
+			GenerationFinished();
+		});
 	});
 }
 
-// NB: This method is called from crl::async(), 'this' is unreliable.
+// NB: This method is called from a background task, 'this' is unreliable.
 void GoodThumbSource::ready(
 		base::binary_guard &&guard,
 		QImage &&image,
@@ -161,7 +230,7 @@ void GoodThumbSource::load(Data::FileOrigin origin) {
 			});
 			return;
 		}
-		crl::async([
+		base::lane_async(base::TaskLane::Background, [
 			=,
 			guard = std::move(guard),
 			value = std::move(value)
@@ -187,6 +256,10 @@ QImage GoodThumbSource::takeLoaded() {
 	return std::move(_loaded);
 }
 
+QImage GoodThumbSource::takeProgressive() {
+	return QImage();
+}
+
 void GoodThumbSource::unload() {
 	_loaded = QImage();
 	cancel();
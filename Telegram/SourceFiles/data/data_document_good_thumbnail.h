@@ -20,6 +20,7 @@ public:
 	void load(Data::FileOrigin origin) override;
 	void loadEvenCancelled(Data::FileOrigin origin) override;
 	QImage takeLoaded() override;
+	QImage takeProgressive() override;
 	void unload() override;
 
 	void automaticLoad(
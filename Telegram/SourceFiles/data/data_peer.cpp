@@ -140,7 +140,9 @@ void PeerData::updateNameDelayed(
 	Notify::PeerUpdate update(this);
 	if (nameVersion++ > 1) {
 		update.flags |= UpdateFlag::NameChanged;
-		update.oldNameFirstLetters = nameFirstLetters();
+
+		// If the words were not filled no index could use them yet.
+		update.oldNameFirstLetters = _nameFirstLetters;
 	}
 	if (isUser()) {
 		if (asUser()->username != newUsername) {
@@ -160,9 +162,11 @@ void PeerData::updateNameDelayed(
 			update.flags |= UpdateFlag::UsernameChanged;
 		}
 	}
-	fillNames();
+	_nameWordsFilled = false;
+	_nameWords.clear();
+	_nameFirstLetters.clear();
 	if (update.flags) {
-		Notify::PeerUpdated().notify(update, true);
+		Notify::peerUpdatedNow(update);
 	}
 }
 
@@ -433,7 +437,22 @@ void PeerData::checkFolder(FolderId folderId) {
 	}
 }
 
-void PeerData::fillNames() {
+const base::flat_set<QString> &PeerData::nameWords() const {
+	if (!_nameWordsFilled) {
+		fillNames();
+	}
+	return _nameWords;
+}
+
+const base::flat_set<QChar> &PeerData::nameFirstLetters() const {
+	if (!_nameWordsFilled) {
+		fillNames();
+	}
+	return _nameFirstLetters;
+}
+
+void PeerData::fillNames() const {
+	_nameWordsFilled = true;
 	_nameWords.clear();
 	_nameFirstLetters.clear();
 	auto toIndexList = QStringList();
@@ -214,12 +214,8 @@ public:
 		return int32(uint32(id & 0xFFFFFFFFULL));
 	}
 
-	[[nodiscard]] const base::flat_set<QString> &nameWords() const {
-		return _nameWords;
-	}
-	[[nodiscard]] const base::flat_set<QChar> &nameFirstLetters() const {
-		return _nameFirstLetters;
-	}
+	[[nodiscard]] const base::flat_set<QString> &nameWords() const;
+	[[nodiscard]] const base::flat_set<QChar> &nameFirstLetters() const;
 
 	void setUserpic(
 		PhotoId photoId,
@@ -343,7 +339,7 @@ protected:
 	void clearUserpic();
 
 private:
-	void fillNames();
+	void fillNames() const;
 	std::unique_ptr<Ui::EmptyUserpic> createEmptyUserpic() const;
 	void refreshEmptyUserpic() const;
 
@@ -365,8 +361,10 @@ private:
 	Data::NotifySettings _notify;
 
 	ClickHandlerPtr _openLink;
-	base::flat_set<QString> _nameWords; // for filtering
-	base::flat_set<QChar> _nameFirstLetters;
+	// For filtering, filled on the first use, most peers never need them.
+	mutable base::flat_set<QString> _nameWords;
+	mutable base::flat_set<QChar> _nameFirstLetters;
+	mutable bool _nameWordsFilled = false;
 
 	crl::time _lastFullUpdate = 0;
 	MsgId _pinnedMessageId = 0;
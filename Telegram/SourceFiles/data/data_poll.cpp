@@ -75,6 +75,7 @@ bool PollData::applyChanges(const MTPDpoll &poll) {
 		}
 	}
 	++version;
+	++layoutVersion;
 	return true;
 }
 
@@ -44,6 +44,7 @@ struct PollData {
 	crl::time lastResultsUpdate = 0;
 
 	int version = 0;
+	int layoutVersion = 0; // Changes of the question, answers or closed.
 
 	static constexpr auto kMaxOptions = 10;
 
@@ -302,6 +302,13 @@ HistoryItem *ScheduledMessages::append(
 	if (i != end(list.itemById)) {
 		const auto existing = i->second;
 		message.match([&](const MTPDmessage &data) {
+			// Content of a scheduled message changes only with an edit.
+			const auto edited = existing->Get<HistoryMessageEdited>();
+			const auto editDate = edited ? edited->date : TimeId(0);
+			if (editDate == data.vedit_date().value_or_empty()
+				&& existing->date() == data.vdate().v) {
+				return;
+			}
 			existing->updateSentContent({
 				qs(data.vmessage()),
 				TextUtilities::EntitiesFromMTP(
@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mainwidget.h"
 #include "core/application.h"
 #include "core/crash_reports.h" // CrashReports::SetAnnotation
+#include "core/core_trace.h"
 #include "ui/image/image.h"
 #include "ui/image/image_source.h" // Images::LocalFileSource
 #include "export/export_controller.h"
@@ -55,6 +56,11 @@ namespace {
 
 constexpr auto kMaxNotifyCheckDelay = 24 * 3600 * crl::time(1000);
 constexpr auto kMaxWallpaperSize = 10 * 1024 * 1024;
+constexpr auto kMaxHiddenHistoriesViews = 4096;
+constexpr auto kMinMessageTextsInChunk = 64;
+constexpr auto kHeavyViewPartsBytesLimit = int64(512 * 1024 * 1024);
+constexpr auto kHeavyViewPartShownTimeout = crl::time(5000);
+constexpr auto kMaxWebpagesByLinks = 256;
 
 using ViewElement = HistoryView::Element;
 
@@ -214,6 +220,10 @@ Session::Session(not_null<Main::Session*> session)
 , _cloudThemes(std::make_unique<CloudThemes>(session)) {
 	_cache->open(Local::cacheKey());
 	_bigFileCache->open(Local::cacheBigFileKey());
+	Core::App().databases().shareBudget({
+		_cache.get(),
+		_bigFileCache.get()
+	});
 
 	if constexpr (Platform::IsLinux()) {
 		const auto wasVersion = Local::oldMapVersion();
@@ -235,6 +245,9 @@ void Session::clear() {
 	for (const auto &[peerId, history] : _histories) {
 		history->clear(History::ClearType::Unload);
 	}
+	_shownHistories.clear();
+	_itemsToRepaint.clear();
+	_viewsToRepaint.clear();
 	_scheduledMessages = nullptr;
 	_dependentMessages.clear();
 	base::take(_messages);
@@ -1232,10 +1245,11 @@ rpl::producer<Session::IdChange> Session::itemIdChanged() const {
 }
 
 void Session::requestItemRepaint(not_null<const HistoryItem*> item) {
-	_itemRepaintRequest.fire_copy(item);
-	enumerateItemViews(item, [&](not_null<const ViewElement*> view) {
-		requestViewRepaint(view);
-	});
+	const auto invoke = !hasPendingRepaintRequests();
+	_itemsToRepaint.emplace(item);
+	if (invoke) {
+		crl::on_main(_session, [=] { sendRepaintRequests(); });
+	}
 }
 
 rpl::producer<not_null<const HistoryItem*>> Session::itemRepaintRequest() const {
@@ -1243,7 +1257,28 @@ rpl::producer<not_null<const HistoryItem*>> Session::itemRepaintRequest() const
 }
 
 void Session::requestViewRepaint(not_null<const ViewElement*> view) {
-	_viewRepaintRequest.fire_copy(view);
+	const auto invoke = !hasPendingRepaintRequests();
+	_viewsToRepaint.emplace(view);
+	if (invoke) {
+		crl::on_main(_session, [=] { sendRepaintRequests(); });
+	}
+}
+
+bool Session::hasPendingRepaintRequests() const {
+	return !_itemsToRepaint.empty() || !_viewsToRepaint.empty();
+}
+
+void Session::sendRepaintRequests() {
+	// Each item or view is repainted once, however many times requested.
+	for (const auto item : base::take(_itemsToRepaint)) {
+		_itemRepaintRequest.fire_copy(item);
+		enumerateItemViews(item, [&](not_null<const ViewElement*> view) {
+			_viewsToRepaint.emplace(view);
+		});
+	}
+	for (const auto view : base::take(_viewsToRepaint)) {
+		_viewRepaintRequest.fire_copy(view);
+	}
 }
 
 rpl::producer<not_null<const ViewElement*>> Session::viewRepaintRequest() const {
@@ -1329,6 +1364,46 @@ rpl::producer<not_null<const History*>> Session::historyUnloaded() const {
 	return _historyUnloaded.events();
 }
 
+void Session::registerHistoryPreloaded(not_null<History*> history) {
+	// Preloaded histories are the first to be unloaded on overflow.
+	if (ranges::find(_shownHistories, history) == end(_shownHistories)) {
+		_shownHistories.push_back(history);
+	}
+}
+
+void Session::registerHistoryShown(not_null<History*> history) {
+	_shownHistories.erase(
+		ranges::remove(_shownHistories, history),
+		end(_shownHistories));
+	_shownHistories.insert(begin(_shownHistories), history);
+
+	// Views of hidden histories are kept only for the most recent ones,
+	// the colder ones are unloaded and requested again when shown.
+	const auto shown = history->migrateToOrMe();
+	const auto migrated = shown->migrateFrom();
+	auto views = 0;
+	auto full = false;
+	for (auto i = begin(_shownHistories); i != end(_shownHistories);) {
+		const auto hidden = *i;
+		if (hidden == shown || hidden.get() == migrated) {
+			++i;
+			continue;
+		}
+		auto count = 0;
+		for (const auto &block : hidden->blocks) {
+			count += int(block->messages.size());
+		}
+		views += count;
+		full = full || (views > kMaxHiddenHistoriesViews);
+		if (full) {
+			hidden->clear(History::ClearType::Unload);
+			i = _shownHistories.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
 void Session::notifyHistoryCleared(not_null<const History*> history) {
 	_historyCleared.fire_copy(history);
 }
@@ -1352,12 +1427,53 @@ void Session::sendHistoryChangeNotifications() {
 	}
 }
 
-void Session::registerHeavyViewPart(not_null<ViewElement*> view) {
-	_heavyViewParts.emplace(view);
+void Session::registerHeavyViewPart(
+		not_null<ViewElement*> view,
+		int64 bytes) {
+	auto &part = _heavyViewParts[view];
+	_heavyViewPartsBytes += bytes - part.bytes;
+	part.bytes = bytes;
+	part.shown = crl::now();
+	checkHeavyViewPartsLimit();
 }
 
 void Session::unregisterHeavyViewPart(not_null<ViewElement*> view) {
-	_heavyViewParts.remove(view);
+	const auto i = _heavyViewParts.find(view);
+	if (i != end(_heavyViewParts)) {
+		_heavyViewPartsBytes -= i->second.bytes;
+		_heavyViewParts.erase(i);
+	}
+}
+
+void Session::heavyViewPartShown(not_null<ViewElement*> view) {
+	const auto i = _heavyViewParts.find(view);
+	if (i != end(_heavyViewParts)) {
+		i->second.shown = crl::now();
+	}
+}
+
+void Session::checkHeavyViewPartsLimit() {
+	if (_heavyViewPartsBytes <= kHeavyViewPartsBytesLimit) {
+		return;
+	}
+
+	// Parts shown recently are on screen in some window, keep them.
+	const auto shownBefore = crl::now() - kHeavyViewPartShownTimeout;
+	auto hidden = std::vector<std::pair<crl::time, not_null<ViewElement*>>>();
+	for (const auto &[view, part] : _heavyViewParts) {
+		if (part.shown < shownBefore) {
+			hidden.emplace_back(part.shown, view);
+		}
+	}
+	ranges::sort(hidden, std::less<>(), [](const auto &pair) {
+		return pair.first;
+	});
+	for (const auto &[shown, view] : hidden) {
+		if (_heavyViewPartsBytes <= kHeavyViewPartsBytesLimit) {
+			break;
+		}
+		view->unloadHeavyPart();
+	}
 }
 
 void Session::unloadHeavyViewParts(
@@ -1365,16 +1481,17 @@ void Session::unloadHeavyViewParts(
 	if (_heavyViewParts.empty()) {
 		return;
 	}
-	const auto remove = ranges::count(_heavyViewParts, delegate, [](not_null<ViewElement*> element) {
-		return element->delegate();
+	const auto remove = ranges::count(_heavyViewParts, delegate, [](const auto &pair) {
+		return pair.first->delegate();
 	});
 	if (remove == _heavyViewParts.size()) {
-		for (const auto view : base::take(_heavyViewParts)) {
+		_heavyViewPartsBytes = 0;
+		for (const auto &[view, part] : base::take(_heavyViewParts)) {
 			view->unloadHeavyPart();
 		}
 	} else {
 		auto remove = std::vector<not_null<ViewElement*>>();
-		for (const auto view : _heavyViewParts) {
+		for (const auto &[view, part] : _heavyViewParts) {
 			if (view->delegate() == delegate) {
 				remove.push_back(view);
 			}
@@ -1393,7 +1510,7 @@ void Session::unloadHeavyViewParts(
 		return;
 	}
 	auto remove = std::vector<not_null<ViewElement*>>();
-	for (const auto view : _heavyViewParts) {
+	for (const auto &[view, part] : _heavyViewParts) {
 		if (view->delegate() == delegate
 			&& !delegate->elementIntersectsRange(view, from, till)) {
 			remove.push_back(view);
@@ -1447,6 +1564,7 @@ rpl::producer<not_null<UserData*>> Session::megagroupParticipantAdded(
 }
 
 void Session::notifyStickersUpdated() {
+	_stickersByEmojiIndex.lists.clear();
 	_stickersUpdated.fire({});
 }
 
@@ -1455,6 +1573,7 @@ rpl::producer<> Session::stickersUpdated() const {
 }
 
 void Session::notifyRecentStickersUpdated() {
+	_stickersByEmojiIndex.lists.clear();
 	_recentStickersUpdated.fire({});
 }
 
@@ -1730,6 +1849,7 @@ void Session::updateEditedMessage(const MTPMessage &data) {
 void Session::processMessages(
 		const QVector<MTPMessage> &data,
 		NewMessageType type) {
+	const auto trace = Core::Trace::Scope("Data::Session::processMessages");
 	auto indices = base::flat_map<uint64, int>();
 	for (int i = 0, l = data.size(); i != l; ++i) {
 		const auto &message = data[i];
@@ -1744,12 +1864,14 @@ void Session::processMessages(
 		const auto id = IdFromMessage(message);
 		indices.emplace((uint64(uint32(id)) << 32) | uint64(i), i);
 	}
+	prepareMessageTexts(data);
 	for (const auto [position, index] : indices) {
 		addNewMessage(
 			data[index],
 			MTPDmessage_ClientFlags(),
 			type);
 	}
+	clearPreparedMessageTexts();
 }
 
 void Session::processMessages(
@@ -1758,6 +1880,81 @@ void Session::processMessages(
 	processMessages(data.v, type);
 }
 
+void Session::prepareMessageTexts(const QVector<MTPMessage> &data) {
+	auto messages = std::vector<not_null<const MTPDmessage*>>();
+	messages.reserve(data.size());
+	for (const auto &message : data) {
+		if (message.type() == mtpc_message) {
+			messages.push_back(&message.c_message());
+		}
+	}
+	const auto count = int(messages.size());
+	if (count < 2 * kMinMessageTextsInChunk) {
+		return;
+	}
+
+	// Only the UTF-8 decoding is done in parallel, entities, links and
+	// text blocks depend on the session and fonts, so they stay here.
+	auto texts = std::vector<QString>(count);
+	const auto threads = std::max(QThread::idealThreadCount(), 1);
+	const auto chunks = std::clamp(
+		count / kMinMessageTextsInChunk,
+		1,
+		threads);
+	const auto perChunk = (count + chunks - 1) / chunks;
+	const auto prepareChunk = [&](int index) {
+		const auto from = std::min(index * perChunk, count);
+		const auto till = std::min(from + perChunk, count);
+		for (auto i = from; i != till; ++i) {
+			texts[i] = TextUtilities::Clean(qs(messages[i]->vmessage()));
+		}
+	};
+	crl::semaphore semaphore;
+	for (auto i = 1; i != chunks; ++i) {
+		crl::async([=, &semaphore] {
+			prepareChunk(i);
+			semaphore.release();
+		});
+	}
+	prepareChunk(0);
+	for (auto i = 1; i != chunks; ++i) {
+		semaphore.acquire();
+	}
+
+	auto prepared = std::vector<std::pair<
+		not_null<const MTPDmessage*>,
+		QString>>();
+	prepared.reserve(count);
+	for (auto i = 0; i != count; ++i) {
+		prepared.emplace_back(messages[i], std::move(texts[i]));
+	}
+	std::sort(begin(prepared), end(prepared), [](
+			const auto &a,
+			const auto &b) {
+		return a.first < b.first;
+	});
+	_preparedMessageTexts = base::flat_map<
+		not_null<const MTPDmessage*>,
+		QString>(
+			std::make_move_iterator(begin(prepared)),
+			std::make_move_iterator(end(prepared)));
+}
+
+void Session::clearPreparedMessageTexts() {
+	_preparedMessageTexts.clear();
+}
+
+std::optional<QString> Session::takePreparedMessageText(
+		not_null<const MTPDmessage*> data) {
+	const auto i = _preparedMessageTexts.find(data);
+	if (i == end(_preparedMessageTexts)) {
+		return std::nullopt;
+	}
+	auto result = std::move(i->second);
+	_preparedMessageTexts.erase(i);
+	return result;
+}
+
 const Session::Messages *Session::messagesList(ChannelId channelId) const {
 	if (channelId == NoChannel) {
 		return &_messages;
@@ -1849,6 +2046,7 @@ void Session::destroyMessage(not_null<HistoryItem*> item) {
 		item->history()->itemRemoved(item);
 	}
 	_itemRemoved.fire_copy(item);
+	_itemsToRepaint.remove(item);
 	groups().unregisterMessage(item);
 	removeDependencyMessage(item);
 	session().notifications().clearFromItem(item);
@@ -2646,6 +2844,28 @@ not_null<WebPageData*> Session::webpage(WebPageId id) {
 	return i->second.get();
 }
 
+std::optional<WebPageId> Session::webpageByLinks(
+		const QString &links) const {
+	const auto i = _webpagesByLinks.find(links);
+	return (i != end(_webpagesByLinks))
+		? std::make_optional(i->second)
+		: std::nullopt;
+}
+
+void Session::rememberWebpageByLinks(const QString &links, WebPageId id) {
+	const auto i = _webpagesByLinks.find(links);
+	if (i != end(_webpagesByLinks)) {
+		i->second = id;
+		return;
+	}
+	_webpagesByLinks.emplace(links, id);
+	_webpagesByLinksOrder.push_back(links);
+	while (int(_webpagesByLinksOrder.size()) > kMaxWebpagesByLinks) {
+		_webpagesByLinks.remove(_webpagesByLinksOrder.front());
+		_webpagesByLinksOrder.pop_front();
+	}
+}
+
 not_null<WebPageData*> Session::processWebpage(const MTPWebPage &data) {
 	switch (data.type()) {
 	case mtpc_webPage:
@@ -2750,15 +2970,29 @@ not_null<WebPageData*> Session::webpage(
 void Session::webpageApplyFields(
 		not_null<WebPageData*> page,
 		const MTPDwebPage &data) {
-	auto description = TextWithEntities {
-		TextUtilities::Clean(qs(data.vdescription().value_or_empty()))
-	};
 	const auto siteName = qs(data.vsite_name().value_or_empty());
-	auto parseFlags = TextParseLinks | TextParseMultiline | TextParseRichText;
-	if (siteName == qstr("Twitter") || siteName == qstr("Instagram")) {
-		parseFlags |= TextParseHashtags | TextParseMentions;
+
+	// The same page comes with every message that links it,
+	// the links parsing is skipped while its hash stays the same.
+	const auto hash = data.vhash().v;
+	const auto parsed = hash
+		&& (page->hash == hash)
+		&& (page->pendingTill <= 0);
+	auto description = parsed
+		? page->description
+		: TextWithEntities{
+			TextUtilities::Clean(qs(data.vdescription().value_or_empty()))
+		};
+	if (!parsed) {
+		auto parseFlags = TextParseLinks
+			| TextParseMultiline
+			| TextParseRichText;
+		if (siteName == qstr("Twitter") || siteName == qstr("Instagram")) {
+			parseFlags |= TextParseHashtags | TextParseMentions;
+		}
+		TextUtilities::ParseEntities(description, parseFlags);
 	}
-	TextUtilities::ParseEntities(description, parseFlags);
+	page->hash = hash;
 	const auto pendingTill = TimeId(0);
 	const auto photo = data.vphoto();
 	const auto document = data.vdocument();
@@ -3287,7 +3521,12 @@ void Session::sendWebPageGamePollNotifications() {
 	for (const auto poll : base::take(_pollsUpdated)) {
 		if (const auto i = _pollViews.find(poll); i != _pollViews.end()) {
 			for (const auto view : i->second) {
-				requestViewResize(view);
+				const auto media = view->media();
+				if (media && media->applyDataChangesInPlace()) {
+					requestViewRepaint(view);
+				} else {
+					requestViewResize(view);
+				}
 			}
 		}
 	}
@@ -3298,6 +3537,7 @@ void Session::registerItemView(not_null<ViewElement*> view) {
 }
 
 void Session::unregisterItemView(not_null<ViewElement*> view) {
+	_viewsToRepaint.remove(view);
 	const auto i = _views.find(view->data());
 	if (i != end(_views)) {
 		auto &list = i->second;
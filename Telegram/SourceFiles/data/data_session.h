@@ -216,6 +216,10 @@ public:
 	void notifyHistoryUnloaded(not_null<const History*> history);
 	[[nodiscard]] rpl::producer<not_null<const History*>> historyUnloaded() const;
 
+	// Recently shown histories keep their views up to a common limit.
+	void registerHistoryShown(not_null<History*> history);
+	void registerHistoryPreloaded(not_null<History*> history);
+
 	[[nodiscard]] rpl::producer<not_null<const HistoryItem*>> itemRemoved() const;
 	void notifyViewRemoved(not_null<const ViewElement*> view);
 	[[nodiscard]] rpl::producer<not_null<const ViewElement*>> viewRemoved() const;
@@ -225,8 +229,11 @@ public:
 	[[nodiscard]] rpl::producer<not_null<History*>> historyChanged() const;
 	void sendHistoryChangeNotifications();
 
-	void registerHeavyViewPart(not_null<ViewElement*> view);
+	// Heavy parts over a common memory limit are unloaded,
+	// starting from the ones that were not shown for the longest time.
+	void registerHeavyViewPart(not_null<ViewElement*> view, int64 bytes);
 	void unregisterHeavyViewPart(not_null<ViewElement*> view);
+	void heavyViewPartShown(not_null<ViewElement*> view);
 	void unloadHeavyViewParts(
 		not_null<HistoryView::ElementDelegate*> delegate);
 	void unloadHeavyViewParts(
@@ -313,6 +320,9 @@ public:
 	Stickers::Order &stickerSetsOrderRef() {
 		return _stickerSetsOrder;
 	}
+	Stickers::ByEmojiIndex &stickersByEmojiIndexRef() {
+		return _stickersByEmojiIndex;
+	}
 	const Stickers::Order &featuredStickerSetsOrder() const {
 		return _featuredStickerSetsOrder;
 	}
@@ -391,6 +401,13 @@ public:
 	void processMessages(
 		const MTPVector<MTPMessage> &data,
 		NewMessageType type);
+
+	// Decodes message texts of a large slice on worker threads,
+	// HistoryMessage takes them instead of decoding on the main thread.
+	void prepareMessageTexts(const QVector<MTPMessage> &data);
+	void clearPreparedMessageTexts();
+	[[nodiscard]] std::optional<QString> takePreparedMessageText(
+		not_null<const MTPDmessage*> data);
 	void processMessagesDeleted(
 		ChannelId channelId,
 		const QVector<MTPint> &data);
@@ -516,6 +533,12 @@ public:
 		ImagePtr thumb);
 
 	[[nodiscard]] not_null<WebPageData*> webpage(WebPageId id);
+
+	// Results of the message field link previews, zero for no preview.
+	[[nodiscard]] std::optional<WebPageId> webpageByLinks(
+		const QString &links) const;
+	void rememberWebpageByLinks(const QString &links, WebPageId id);
+
 	not_null<WebPageData*> processWebpage(const MTPWebPage &data);
 	not_null<WebPageData*> processWebpage(const MTPDwebPage &data);
 	not_null<WebPageData*> processWebpage(const MTPDwebPagePending &data);
@@ -822,6 +845,10 @@ private:
 		not_null<const HistoryItem*> item,
 		Method method);
 
+	[[nodiscard]] bool hasPendingRepaintRequests() const;
+	void sendRepaintRequests();
+	void checkHeavyViewPartsLimit();
+
 	void insertCheckedServiceNotification(
 		const TextWithEntities &message,
 		const MTPMessageMedia &media,
@@ -862,6 +889,11 @@ private:
 	rpl::event_stream<not_null<const History*>> _historyUnloaded;
 	rpl::event_stream<not_null<const History*>> _historyCleared;
 	base::flat_set<not_null<History*>> _historiesChanged;
+	base::flat_set<not_null<const HistoryItem*>> _itemsToRepaint;
+	base::flat_set<not_null<const ViewElement*>> _viewsToRepaint;
+	base::flat_map<
+		not_null<const MTPDmessage*>,
+		QString> _preparedMessageTexts;
 	rpl::event_stream<not_null<History*>> _historyChanged;
 	rpl::event_stream<MegagroupParticipant> _megagroupParticipantRemoved;
 	rpl::event_stream<MegagroupParticipant> _megagroupParticipantAdded;
@@ -882,6 +914,7 @@ private:
 	Stickers::Order _featuredStickerSetsOrder;
 	Stickers::Order _archivedStickerSetsOrder;
 	Stickers::SavedGifs _savedGifs;
+	Stickers::ByEmojiIndex _stickersByEmojiIndex;
 
 	Dialogs::MainList _chatsList;
 	Dialogs::IndexedList _contactsList;
@@ -922,6 +955,8 @@ private:
 	std::unordered_map<
 		not_null<const WebPageData*>,
 		base::flat_set<not_null<HistoryItem*>>> _webpageItems;
+	base::flat_map<QString, WebPageId> _webpagesByLinks;
+	std::deque<QString> _webpagesByLinksOrder;
 	std::unordered_map<
 		not_null<const WebPageData*>,
 		base::flat_set<not_null<ViewElement*>>> _webpageViews;
@@ -965,7 +1000,12 @@ private:
 		not_null<const HistoryItem*>,
 		std::vector<not_null<ViewElement*>>> _views;
 
-	base::flat_set<not_null<ViewElement*>> _heavyViewParts;
+	struct HeavyViewPart {
+		int64 bytes = 0;
+		crl::time shown = 0;
+	};
+	base::flat_map<not_null<ViewElement*>, HeavyViewPart> _heavyViewParts;
+	int64 _heavyViewPartsBytes = 0;
 
 	PeerData *_proxyPromoted = nullptr;
 
@@ -980,6 +1020,7 @@ private:
 
 	std::unordered_map<PeerId, std::unique_ptr<PeerData>> _peers;
 	std::unordered_map<PeerId, std::unique_ptr<History>> _histories;
+	std::vector<not_null<History*>> _shownHistories; // Most recent first.
 
 	MessageIdsList _mimeForwardIds;
 
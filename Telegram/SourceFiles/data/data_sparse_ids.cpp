@@ -205,11 +205,30 @@ bool SparseIdsSliceBuilder::applyUpdate(
 	auto skippedAfter = (update.range.till == ServerMaxMsgId)
 		? 0
 		: std::optional<int> {};
+	auto messageIds = base::flat_set<MsgId>();
+	if (needMergeMessages) {
+		// Decode only the ids that may stay after sliceToLimits(),
+		// together with the ones covering the ids we already have.
+		const auto &messages = *update.messages;
+		const auto around = messages.lowerBound(_key);
+		auto from = std::max(around - _limitBefore, 0);
+		auto till = std::min(around + _limitAfter + 1, messages.size());
+		if (!_ids.empty()) {
+			accumulate_min(from, messages.lowerBound(_ids.front()));
+			accumulate_max(till, messages.lowerBound(_ids.back() + 1));
+		}
+		const auto ids = messages.slice(from, till);
+		messageIds.merge(ids.begin(), ids.end());
+		if (skippedBefore) {
+			*skippedBefore = from;
+		}
+		if (skippedAfter) {
+			*skippedAfter = messages.size() - till;
+		}
+	}
 	mergeSliceData(
 		update.count,
-		needMergeMessages
-			? *update.messages
-			: base::flat_set<MsgId> {},
+		messageIds,
 		skippedBefore,
 		skippedAfter);
 	return true;
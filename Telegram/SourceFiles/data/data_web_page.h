@@ -64,6 +64,9 @@ struct WebPageData {
 	int pendingTill = 0;
 	int version = 0;
 
+	// Server hash of the last applied webPage, zero if not known.
+	int32 hash = 0;
+
 private:
 	void replaceDocumentGoodThumbnail();
 
@@ -23,6 +23,7 @@ RowsByLetter IndexedList::addToEnd(Key key) {
 	RowsByLetter result;
 	if (!_list.contains(key)) {
 		result.emplace(0, _list.addToEnd(key));
+		indexWords(key);
 		for (const auto ch : key.entry()->chatListFirstLetters()) {
 			auto j = _index.find(ch);
 			if (j == _index.cend()) {
@@ -40,6 +41,7 @@ Row *IndexedList::addByName(Key key) {
 	}
 
 	const auto result = _list.addByName(key);
+	indexWords(key);
 	for (const auto ch : key.entry()->chatListFirstLetters()) {
 		auto j = _index.find(ch);
 		if (j == _index.cend()) {
@@ -119,6 +121,8 @@ void IndexedList::adjustByName(
 	const auto mainRow = _list.adjustByName(key);
 	if (!mainRow) return;
 
+	indexWords(key);
+
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
 	for (const auto ch : key.entry()->chatListFirstLetters()) {
@@ -156,6 +160,8 @@ void IndexedList::adjustNames(
 	auto mainRow = _list.getRow(key);
 	if (!mainRow) return;
 
+	indexWords(key);
+
 	auto toRemove = oldLetters;
 	auto toAdd = base::flat_set<QChar>();
 	for (const auto ch : key.entry()->chatListFirstLetters()) {
@@ -188,6 +194,7 @@ void IndexedList::adjustNames(
 
 void IndexedList::del(Key key, Row *replacedBy) {
 	if (_list.del(key, replacedBy)) {
+		unindexWords(key);
 		for (const auto ch : key.entry()->chatListFirstLetters()) {
 			if (auto it = _index.find(ch); it != _index.cend()) {
 				it->second.del(key, replacedBy);
@@ -200,6 +207,45 @@ void IndexedList::clear() {
 	_index.clear();
 }
 
+void IndexedList::indexWords(Key key) {
+	const auto &words = key.entry()->chatListNameWords();
+	auto &indexed = _indexedWords[key];
+	for (const auto &word : indexed) {
+		if (!words.contains(word)) {
+			_wordsIndex.erase({ word, key });
+		}
+	}
+	for (const auto &word : words) {
+		if (!indexed.contains(word)) {
+			_wordsIndex.emplace(word, key);
+		}
+	}
+	indexed = words;
+}
+
+void IndexedList::unindexWords(Key key) {
+	const auto i = _indexedWords.find(key);
+	if (i == _indexedWords.end()) {
+		return;
+	}
+	for (const auto &word : i->second) {
+		_wordsIndex.erase({ word, key });
+	}
+	_indexedWords.erase(i);
+}
+
+std::vector<Key> IndexedList::keysByWordPrefix(const QString &prefix) const {
+	auto result = std::vector<Key>();
+	for (auto i = _wordsIndex.lower_bound({ prefix, Key() })
+		; i != _wordsIndex.end() && i->first.startsWith(prefix)
+		; ++i) {
+		result.push_back(i->second);
+	}
+	ranges::sort(result);
+	result.erase(ranges::unique(result), result.end());
+	return result;
+}
+
 std::vector<not_null<Row*>> IndexedList::filtered(
 		const QStringList &words) const {
 	const auto minimal = [&]() -> const Dialogs::List* {
@@ -224,29 +270,37 @@ std::vector<not_null<Row*>> IndexedList::filtered(
 	if (!minimal || minimal->empty()) {
 		return result;
 	}
-	result.reserve(minimal->size());
-	for (const auto row : *minimal) {
-		const auto &nameWords = row->entry()->chatListNameWords();
-		const auto found = [&](const QString &word) {
-			for (const auto &name : nameWords) {
-				if (name.startsWith(word)) {
-					return true;
-				}
-			}
-			return false;
-		};
-		const auto allFound = [&] {
-			for (const auto &word : words) {
-				if (!found(word)) {
-					return false;
-				}
-			}
-			return true;
-		}();
-		if (allFound) {
+	auto keys = std::vector<Key>();
+	auto first = true;
+	for (const auto &word : words) {
+		if (word.isEmpty()) {
+			continue;
+		}
+		auto found = keysByWordPrefix(word);
+		if (first) {
+			keys = std::move(found);
+			first = false;
+		} else {
+			auto both = std::vector<Key>();
+			std::set_intersection(
+				keys.begin(),
+				keys.end(),
+				found.begin(),
+				found.end(),
+				std::back_inserter(both));
+			keys = std::move(both);
+		}
+		if (keys.empty()) {
+			return result;
+		}
+	}
+	result.reserve(keys.size());
+	for (const auto key : keys) {
+		if (const auto row = minimal->getRow(key)) {
 			result.push_back(row);
 		}
 	}
+	ranges::sort(result, std::less<>(), &Row::pos);
 	return result;
 }
 
@@ -82,10 +82,19 @@ private:
 		not_null<History*> history,
 		const base::flat_set<QChar> &oldChars);
 
+	void indexWords(Key key);
+	void unindexWords(Key key);
+	[[nodiscard]] std::vector<Key> keysByWordPrefix(
+		const QString &prefix) const;
+
 	SortMode _sortMode = SortMode();
 	List _list, _empty;
 	base::flat_map<QChar, List> _index;
 
+	// Sorted name words, all words starting with a prefix are a range here.
+	std::set<std::pair<QString, Key>> _wordsIndex;
+	std::map<Key, base::flat_set<QString>> _indexedWords;
+
 };
 
 } // namespace Dialogs
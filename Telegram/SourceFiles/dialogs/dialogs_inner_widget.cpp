@@ -14,7 +14,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 //#include "history/feed/history_feed_section.h" // #feed
 #include "history/history.h"
 #include "history/history_item.h"
+#include "history/view/history_view_element.h"
 #include "core/shortcuts.h"
+#include "core/core_trace.h"
 #include "ui/widgets/buttons.h"
 #include "ui/widgets/popup_menu.h"
 #include "ui/text_options.h"
@@ -50,6 +52,7 @@ namespace {
 
 constexpr auto kHashtagResultsLimit = 5;
 constexpr auto kStartReorderThreshold = 30;
+constexpr auto kPreloadHistoryHoverDelay = crl::time(300);
 
 int FixedOnTopDialogsCount(not_null<Dialogs::IndexedList*> list) {
 	auto result = 0;
@@ -109,7 +112,8 @@ InnerWidget::InnerWidget(
 })
 , _addContactLnk(this, tr::lng_add_contact_button(tr::now))
 , _cancelSearchInChat(this, st::dialogsCancelSearchInPeer)
-, _cancelSearchFromUser(this, st::dialogsCancelSearchInPeer) {
+, _cancelSearchFromUser(this, st::dialogsCancelSearchInPeer)
+, _preloadHistoryTimer([=] { preloadSelectedHistory(); }) {
 
 #ifndef OS_MAC_OLD // Qt 5.3.2 build is working with glitches otherwise.
 	setAttribute(Qt::WA_OpaquePaintEvent, true);
@@ -377,6 +381,15 @@ void InnerWidget::changeOpenedFolder(Data::Folder *folder) {
 }
 
 void InnerWidget::paintEvent(QPaintEvent *e) {
+	const auto startup = Core::Trace::StartupProfileActive();
+	const auto trace = Core::Trace::Scope("Dialogs::InnerWidget::paintEvent");
+	if (startup) {
+		crl::on_main(this, [] {
+			Core::Trace::FinishStartupProfile(
+				cWorkingDir() + "startup_trace.json");
+		});
+	}
+
 	Painter p(this);
 
 	const auto r = e->rect();
@@ -954,6 +967,11 @@ void InnerWidget::selectByMouse(QPoint globalPosition) {
 			setCursor((_selected || _collapsedSelected)
 				? style::cur_pointer
 				: style::cur_default);
+			if (_selected) {
+				_preloadHistoryTimer.callOnce(kPreloadHistoryHoverDelay);
+			} else {
+				_preloadHistoryTimer.cancel();
+			}
 		}
 	} else if (_state == WidgetState::Filtered) {
 		auto wasSelected = isSelected();
@@ -1638,6 +1656,15 @@ void InnerWidget::enterEventHook(QEvent *e) {
 	setMouseTracking(true);
 }
 
+void InnerWidget::preloadSelectedHistory() {
+	// The hovered chat is the most likely one to be opened next.
+	if (_state != WidgetState::Default || !_selected) {
+		return;
+	} else if (const auto history = _selected->history()) {
+		session().api().preloadHistory(history);
+	}
+}
+
 void InnerWidget::updateSelectedRow(Key key) {
 	if (_state == WidgetState::Default) {
 		if (key) {
@@ -2076,6 +2103,52 @@ bool InnerWidget::searchReceived(
 	return lastDateFound != 0;
 }
 
+void InnerWidget::searchInLoaded(const QString &query) {
+	const auto history = _searchInChat.history();
+	const auto words = TextUtilities::PrepareSearchWords(query);
+	if (!history || words.isEmpty()) {
+		return;
+	}
+	auto found = std::vector<not_null<HistoryItem*>>();
+	const auto matches = [&](not_null<HistoryItem*> item) {
+		const auto text = TextUtilities::RemoveAccents(
+			item->originalText().text.toLower());
+		for (const auto &word : words) {
+			if (!text.contains(word)) {
+				return false;
+			}
+		}
+		return true;
+	};
+	for (auto i = history->blocks.rbegin(); i != history->blocks.rend(); ++i) {
+		const auto &messages = (*i)->messages;
+		for (auto j = messages.rbegin(); j != messages.rend(); ++j) {
+			const auto item = (*j)->data();
+			if (IsServerMsgId(item->id) && !item->serviceMsg() && matches(item)) {
+				found.push_back(item);
+				if (int(found.size()) == SearchPerPage) {
+					break;
+				}
+			}
+		}
+		if (int(found.size()) == SearchPerPage) {
+			break;
+		}
+	}
+	if (found.empty()) {
+		return;
+	}
+
+	// Shown until the server results for the same query replace them.
+	clearSearchResults(false);
+	for (const auto item : found) {
+		_searchResults.push_back(
+			std::make_unique<FakeRow>(_searchInChat, item));
+	}
+	_searchedCount = int(found.size());
+	refresh();
+}
+
 void InnerWidget::peerSearchReceived(
 		const QString &query,
 		const QVector<MTPPeer> &my,
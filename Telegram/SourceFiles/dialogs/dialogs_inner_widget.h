@@ -12,6 +12,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "ui/effects/animations.h"
 #include "ui/rp_widget.h"
 #include "base/flags.h"
+#include "base/timer.h"
 
 namespace Main {
 class Session;
@@ -77,6 +78,7 @@ public:
 		const QString &query,
 		const QVector<MTPPeer> &my,
 		const QVector<MTPPeer> &result);
+	void searchInLoaded(const QString &query);
 
 	void clearSelection();
 
@@ -292,6 +294,7 @@ private:
 
 	void clearSearchResults(bool clearPeerSearchResults = true);
 	void updateSelectedRow(Key key = Key());
+	void preloadSelectedHistory();
 
 	not_null<IndexedList*> shownDialogs() const;
 
@@ -390,6 +393,8 @@ private:
 
 	base::unique_qptr<Ui::PopupMenu> _menu;
 
+	base::Timer _preloadHistoryTimer;
+
 };
 
 } // namespace Dialogs
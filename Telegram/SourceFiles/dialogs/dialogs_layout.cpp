@@ -35,6 +35,9 @@ namespace {
 // Show all dates that are in the last 20 hours in time format.
 constexpr int kRecentlyInSeconds = 20 * 3600;
 
+// Every visible row paints its date, they share one local time value.
+constexpr auto kCurrentDateTimeCacheTimeout = crl::time(1000);
+
 bool ShowUserBotIcon(not_null<UserData*> user) {
 	return user->isBot() && !user->isSupport();
 }
@@ -47,8 +50,19 @@ void PaintRowTopRight(Painter &p, const QString &text, QRect &rectForName, bool
 	p.drawText(rectForName.left() + rectForName.width() + st::dialogsDateSkip, rectForName.top() + st::msgNameFont->height - st::msgDateFont->descent, text);
 }
 
+const QDateTime &CurrentDateTime() {
+	static auto result = QDateTime();
+	static auto computed = crl::time(0);
+	const auto now = crl::now();
+	if (!computed || now - computed >= kCurrentDateTimeCacheTimeout) {
+		result = QDateTime::currentDateTime();
+		computed = now;
+	}
+	return result;
+}
+
 void PaintRowDate(Painter &p, QDateTime date, QRect &rectForName, bool active, bool selected) {
-	const auto now = QDateTime::currentDateTime();
+	const auto &now = CurrentDateTime();
 	const auto &lastTime = date;
 	const auto nowDate = now.date();
 	const auto lastDate = lastTime.date();
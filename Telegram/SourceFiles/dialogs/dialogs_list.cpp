@@ -60,21 +60,23 @@ not_null<Row*> List::addByName(Key key) {
 void List::adjustByName(not_null<Row*> row) {
 	Expects(row->pos() >= 0 && row->pos() < _rows.size());
 
+	// All the rows except this one are sorted, so binary search is used.
 	const auto &name = row->entry()->chatListName();
 	const auto index = row->pos();
 	const auto i = _rows.begin() + index;
-	const auto before = std::find_if(i + 1, _rows.end(), [&](Row *row) {
-		const auto &greater = row->entry()->chatListName();
-		return greater.compare(name, Qt::CaseInsensitive) >= 0;
+	const auto before = std::partition_point(i + 1, _rows.end(), [&](
+			Row *row) {
+		const auto &less = row->entry()->chatListName();
+		return less.compare(name, Qt::CaseInsensitive) < 0;
 	});
 	if (before != i + 1) {
 		rotate(i, i + 1, before);
 	} else if (i != _rows.begin()) {
-		const auto from = std::make_reverse_iterator(i);
-		const auto after = std::find_if(from, _rows.rend(), [&](Row *row) {
+		const auto after = std::partition_point(_rows.begin(), i, [&](
+				Row *row) {
 			const auto &less = row->entry()->chatListName();
 			return less.compare(name, Qt::CaseInsensitive) <= 0;
-		}).base();
+		});
 		if (after != i) {
 			rotate(after, i, i + 1);
 		}
@@ -84,19 +86,21 @@ void List::adjustByName(not_null<Row*> row) {
 void List::adjustByDate(not_null<Row*> row) {
 	Expects(_sortMode == SortMode::Date);
 
+	// All the rows except this one are sorted, so binary search is used.
 	const auto key = row->sortKey();
 	const auto index = row->pos();
 	const auto i = _rows.begin() + index;
-	const auto before = std::find_if(i + 1, _rows.end(), [&](Row *row) {
-		return (row->sortKey() <= key);
+	const auto before = std::partition_point(i + 1, _rows.end(), [&](
+			Row *row) {
+		return (row->sortKey() > key);
 	});
 	if (before != i + 1) {
 		rotate(i, i + 1, before);
 	} else {
-		const auto from = std::make_reverse_iterator(i);
-		const auto after = std::find_if(from, _rows.rend(), [&](Row *row) {
+		const auto after = std::partition_point(_rows.begin(), i, [&](
+				Row *row) {
 			return (row->sortKey() >= key);
-		}).base();
+		});
 		if (after != i) {
 			rotate(after, i, i + 1);
 		}
@@ -765,6 +765,9 @@ bool Widget::onSearchMessages(bool searchCache) {
 		_searchNextRate = 0;
 		_searchFull = _searchFullMigrated = false;
 		MTP::cancel(base::take(_searchRequest));
+		if (!_searchQueryFrom) {
+			_inner->searchInLoaded(_searchQuery);
+		}
 		if (const auto peer = _searchInChat.peer()) {
 			const auto flags = _searchQueryFrom
 				? MTP_flags(MTPmessages_Search::Flag::f_from_id)
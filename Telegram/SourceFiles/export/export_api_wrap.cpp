@@ -14,6 +14,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/rpc_sender.h"
 #include "base/value_ordering.h"
 #include "base/bytes.h"
+#include <QtCore/QTimer>
+
 #include <set>
 #include <deque>
 
@@ -23,9 +25,10 @@ namespace {
 constexpr auto kUserpicsSliceLimit = 100;
 constexpr auto kFileChunkSize = 128 * 1024;
 constexpr auto kFileRequestsCount = 2;
-constexpr auto kFileNextRequestDelay = crl::time(20);
+constexpr auto kFileBandwidthPeriod = crl::time(1000);
 constexpr auto kChatsSliceLimit = 100;
 constexpr auto kMessagesSliceLimit = 100;
+constexpr auto kMessagesSlicesQueued = 2;
 constexpr auto kTopPeerSliceLimit = 100;
 constexpr auto kFileMaxSize = 1500 * 1024 * 1024;
 constexpr auto kLocationCacheSize = 100'000;
@@ -170,6 +173,7 @@ struct ApiWrap::OtherDataProcess {
 struct ApiWrap::FileProcess {
 	FileProcess(const QString &path, Output::Stats *stats);
 
+	uint64 id = 0;
 	Output::File file;
 	QString relativePath;
 
@@ -179,6 +183,7 @@ struct ApiWrap::FileProcess {
 	Data::FileLocation location;
 	int offset = 0;
 	int size = 0;
+	bool waitingBandwidth = false;
 
 	struct Request {
 		int offset = 0;
@@ -190,6 +195,7 @@ struct ApiWrap::FileProcess {
 struct ApiWrap::FileProgress {
 	int ready = 0;
 	int total = 0;
+	QString path;
 };
 
 struct ApiWrap::ChatsProcess {
@@ -229,8 +235,12 @@ struct ApiWrap::ChatProcess {
 
 	Data::ParseMediaContext context;
 	std::optional<Data::MessagesSlice> slice;
+	std::deque<Data::MessagesSlice> fetchedSlices;
+	bool requestingSlice = false;
+	bool allSlicesFetched = false;
 	bool lastSlice = false;
 	int fileIndex = 0;
+	int filesLoading = 0;
 };
 
 
@@ -343,7 +353,7 @@ std::optional<QString> ApiWrap::LoadedFileCache::find(
 }
 
 ApiWrap::FileProcess::FileProcess(const QString &path, Output::Stats *stats)
-: file(path, stats) {
+: file(path, stats, true) {
 }
 
 template <typename Request>
@@ -372,7 +382,10 @@ auto ApiWrap::splitRequest(int index, Request &&request) {
 		std::forward<Request>(request)));
 }
 
-auto ApiWrap::fileRequest(const Data::FileLocation &location, int offset) {
+auto ApiWrap::fileRequest(
+		uint64 processId,
+		const Data::FileLocation &location,
+		int offset) {
 	Expects(location.dcId != 0
 		|| location.data.type() == mtpc_inputTakeoutFileLocation);
 	Expects(_takeoutId.has_value());
@@ -388,6 +401,7 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int offset) {
 		if (result.type() == qstr("TAKEOUT_FILE_EMPTY")
 			&& _otherDataProcess != nullptr) {
 			filePartDone(
+				processId,
 				0,
 				MTP_upload_file(
 					MTP_storage_filePartial(),
@@ -395,7 +409,7 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int offset) {
 					MTP_bytes()));
 		} else if (result.type() == qstr("LOCATION_INVALID")
 			|| result.type() == qstr("VERSION_INVALID")) {
-			filePartUnavailable();
+			filePartUnavailable(processId);
 		} else {
 			error(std::move(result));
 		}
@@ -403,7 +417,8 @@ auto ApiWrap::fileRequest(const Data::FileLocation &location, int offset) {
 }
 
 ApiWrap::ApiWrap(Fn<void(FnMut<void()>)> runner)
-: _mtp(std::move(runner))
+: _mtp(runner)
+, _runner(std::move(runner))
 , _fileCache(std::make_unique<LoadedFileCache>(kLocationCacheSize)) {
 }
 
@@ -813,7 +828,6 @@ void ApiWrap::finishUserpicsSlice() {
 }
 
 bool ApiWrap::loadUserpicProgress(FileProgress progress) {
-	Expects(_fileProcess != nullptr);
 	Expects(_userpicsProcess != nullptr);
 	Expects(_userpicsProcess->slice.has_value());
 	Expects((_userpicsProcess->fileIndex >= 0)
@@ -821,7 +835,7 @@ bool ApiWrap::loadUserpicProgress(FileProgress progress) {
 			< _userpicsProcess->slice->list.size()));
 
 	return _userpicsProcess->fileProgress(DownloadProgress{
-		_fileProcess->relativePath,
+		progress.path,
 		_userpicsProcess->fileIndex,
 		progress.ready,
 		progress.total });
@@ -1016,6 +1030,7 @@ void ApiWrap::messagesCountLoaded(int localSplitIndex, int count) {
 		requestMessagesCount(localSplitIndex + 1);
 	} else if (_chatProcess->start(_chatProcess->info)) {
 		requestMessagesSlice();
+		loadNextMessagesSlice();
 	}
 }
 
@@ -1271,12 +1286,21 @@ void ApiWrap::appendChatsSlice(
 void ApiWrap::requestMessagesSlice() {
 	Expects(_chatProcess != nullptr);
 
-	const auto count = _chatProcess->info.messagesCountPerSplit[
-		_chatProcess->localSplitIndex];
-	if (!count) {
-		loadMessagesFiles({});
+	// Next slices are requested while files of the current one are loaded.
+	const auto canRequest = [&] {
+		return !_chatProcess->requestingSlice
+			&& !_chatProcess->allSlicesFetched
+			&& (_chatProcess->fetchedSlices.size() < kMessagesSlicesQueued);
+	};
+	while (canRequest()
+		&& !_chatProcess->info.messagesCountPerSplit[
+			_chatProcess->localSplitIndex]) {
+		appendMessagesSlice({});
+	}
+	if (!canRequest()) {
 		return;
 	}
+	_chatProcess->requestingSlice = true;
 	requestChatMessages(
 		_chatProcess->info.splits[_chatProcess->localSplitIndex],
 		_chatProcess->largestIdPlusOne,
@@ -1285,13 +1309,14 @@ void ApiWrap::requestMessagesSlice() {
 		[=](const MTPmessages_Messages &result) {
 		Expects(_chatProcess != nullptr);
 
+		_chatProcess->requestingSlice = false;
 		result.match([&](const MTPDmessages_messagesNotModified &data) {
 			error("Unexpected messagesNotModified received.");
 		}, [&](const auto &data) {
 			if constexpr (MTPDmessages_messages::Is<decltype(data)>()) {
 				_chatProcess->lastSlice = true;
 			}
-			loadMessagesFiles(Data::ParseMessagesSlice(
+			messagesSliceFetched(Data::ParseMessagesSlice(
 				_chatProcess->context,
 				data.vmessages(),
 				data.vusers(),
@@ -1301,6 +1326,51 @@ void ApiWrap::requestMessagesSlice() {
 	});
 }
 
+void ApiWrap::messagesSliceFetched(Data::MessagesSlice &&slice) {
+	Expects(_chatProcess != nullptr);
+
+	appendMessagesSlice(std::move(slice));
+	requestMessagesSlice();
+	if (!_chatProcess->slice) {
+		loadNextMessagesSlice();
+	}
+}
+
+void ApiWrap::appendMessagesSlice(Data::MessagesSlice &&slice) {
+	Expects(_chatProcess != nullptr);
+	Expects(!_chatProcess->allSlicesFetched);
+
+	if (slice.list.empty()) {
+		_chatProcess->lastSlice = true;
+	} else {
+		_chatProcess->largestIdPlusOne = slice.list.back().id + 1;
+	}
+	if (_chatProcess->lastSlice) {
+		if (++_chatProcess->localSplitIndex
+			< _chatProcess->info.splits.size()) {
+			_chatProcess->lastSlice = false;
+			_chatProcess->largestIdPlusOne = 1;
+		} else {
+			_chatProcess->allSlicesFetched = true;
+		}
+	}
+	_chatProcess->fetchedSlices.push_back(std::move(slice));
+}
+
+void ApiWrap::loadNextMessagesSlice() {
+	Expects(_chatProcess != nullptr);
+	Expects(!_chatProcess->slice.has_value());
+
+	auto &fetched = _chatProcess->fetchedSlices;
+	if (!fetched.empty()) {
+		auto slice = std::move(fetched.front());
+		fetched.pop_front();
+		loadMessagesFiles(std::move(slice));
+	} else if (_chatProcess->allSlicesFetched) {
+		finishMessages();
+	}
+}
+
 void ApiWrap::requestChatMessages(
 		int splitIndex,
 		int offsetId,
@@ -1369,11 +1439,9 @@ void ApiWrap::loadMessagesFiles(Data::MessagesSlice &&slice) {
 	Expects(_chatProcess != nullptr);
 	Expects(!_chatProcess->slice.has_value());
 
-	if (slice.list.empty()) {
-		_chatProcess->lastSlice = true;
-	}
 	_chatProcess->slice = std::move(slice);
 	_chatProcess->fileIndex = 0;
+	_chatProcess->filesLoading = 0;
 
 	loadNextMessageFile();
 }
@@ -1382,108 +1450,113 @@ void ApiWrap::loadNextMessageFile() {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
 
-	for (auto &list = _chatProcess->slice->list
-		; _chatProcess->fileIndex < list.size()
-		; ++_chatProcess->fileIndex) {
-		const auto &message = list[_chatProcess->fileIndex];
-		if (Data::SkipMessageByDate(message, *_settings)) {
-			continue;
-		}
-		const auto fileProgress = [=](FileProgress value) {
-			return loadMessageFileProgress(value);
-		};
-		const auto ready = processFileLoad(
-			list[_chatProcess->fileIndex].file(),
-			fileProgress,
-			[=](const QString &path) { loadMessageFileDone(path); },
-			&list[_chatProcess->fileIndex]);
-		if (!ready) {
-			return;
-		}
-		const auto thumbProgress = [=](FileProgress value) {
-			return loadMessageThumbProgress(value);
-		};
-		const auto thumbReady = processFileLoad(
-			list[_chatProcess->fileIndex].thumb().file,
-			thumbProgress,
-			[=](const QString &path) { loadMessageThumbDone(path); },
-			&list[_chatProcess->fileIndex]);
-		if (!thumbReady) {
-			return;
+	const auto &list = _chatProcess->slice->list;
+	const auto parallel = std::max(_settings->media.parallelLoads, 1);
+	while (_chatProcess->fileIndex < list.size()
+		&& _chatProcess->filesLoading < parallel) {
+		const auto index = _chatProcess->fileIndex++;
+		if (!Data::SkipMessageByDate(list[index], *_settings)) {
+			loadMessageFiles(index);
 		}
 	}
-	finishMessagesSlice();
+	if (_chatProcess->fileIndex == list.size()
+		&& !_chatProcess->filesLoading) {
+		finishMessagesSlice();
+	}
 }
 
-void ApiWrap::finishMessagesSlice() {
+bool ApiWrap::loadMessageFiles(int index) {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
+	Expects((index >= 0) && (index < _chatProcess->slice->list.size()));
 
-	auto slice = *base::take(_chatProcess->slice);
-	if (!slice.list.empty()) {
-		_chatProcess->largestIdPlusOne = slice.list.back().id + 1;
-		if (!_chatProcess->handleSlice(std::move(slice))) {
-			return;
-		}
+	// The thumb is requested only when the file itself is ready,
+	// so that the thumbs of large skipped files are not loaded.
+	auto &message = _chatProcess->slice->list[index];
+	const auto fileProgress = [=](FileProgress value) {
+		return loadMessageFileProgress(index, value);
+	};
+	const auto ready = processFileLoad(
+		message.file(),
+		fileProgress,
+		[=](const QString &path) { loadMessageFileDone(index, path); },
+		&message);
+	if (!ready) {
+		++_chatProcess->filesLoading;
+		return false;
 	}
-	if (_chatProcess->lastSlice
-		&& (++_chatProcess->localSplitIndex
-			< _chatProcess->info.splits.size())) {
-		_chatProcess->lastSlice = false;
-		_chatProcess->largestIdPlusOne = 1;
+	const auto thumbProgress = [=](FileProgress value) {
+		return loadMessageThumbProgress(index, value);
+	};
+	const auto thumbReady = processFileLoad(
+		message.thumb().file,
+		thumbProgress,
+		[=](const QString &path) { loadMessageThumbDone(index, path); },
+		&message);
+	if (!thumbReady) {
+		++_chatProcess->filesLoading;
+		return false;
 	}
-	if (!_chatProcess->lastSlice) {
-		requestMessagesSlice();
-	} else {
-		finishMessages();
+	return true;
+}
+
+void ApiWrap::finishMessagesSlice() {
+	Expects(_chatProcess != nullptr);
+	Expects(_chatProcess->slice.has_value());
+
+	auto slice = *base::take(_chatProcess->slice);
+	if (!slice.list.empty()
+		&& !_chatProcess->handleSlice(std::move(slice))) {
+		return;
 	}
+	requestMessagesSlice();
+	loadNextMessagesSlice();
 }
 
-bool ApiWrap::loadMessageFileProgress(FileProgress progress) {
-	Expects(_fileProcess != nullptr);
+bool ApiWrap::loadMessageFileProgress(int index, FileProgress progress) {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
-	Expects((_chatProcess->fileIndex >= 0)
-		&& (_chatProcess->fileIndex < _chatProcess->slice->list.size()));
+	Expects((index >= 0) && (index < _chatProcess->slice->list.size()));
 
 	return _chatProcess->fileProgress(DownloadProgress{
-		_fileProcess->relativePath,
-		_chatProcess->fileIndex,
+		progress.path,
+		index,
 		progress.ready,
 		progress.total });
 }
 
-void ApiWrap::loadMessageFileDone(const QString &relativePath) {
+void ApiWrap::loadMessageFileDone(int index, const QString &relativePath) {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
-	Expects((_chatProcess->fileIndex >= 0)
-		&& (_chatProcess->fileIndex < _chatProcess->slice->list.size()));
+	Expects((index >= 0) && (index < _chatProcess->slice->list.size()));
+	Expects(_chatProcess->filesLoading > 0);
 
-	const auto index = _chatProcess->fileIndex;
 	auto &file = _chatProcess->slice->list[index].file();
 	file.relativePath = relativePath;
 	if (relativePath.isEmpty()) {
 		file.skipReason = Data::File::SkipReason::Unavailable;
 	}
+	--_chatProcess->filesLoading;
+	loadMessageFiles(index);
 	loadNextMessageFile();
 }
 
-bool ApiWrap::loadMessageThumbProgress(FileProgress progress) {
-	return loadMessageFileProgress(progress);
+bool ApiWrap::loadMessageThumbProgress(int index, FileProgress progress) {
+	return loadMessageFileProgress(index, progress);
 }
 
-void ApiWrap::loadMessageThumbDone(const QString &relativePath) {
+void ApiWrap::loadMessageThumbDone(int index, const QString &relativePath) {
 	Expects(_chatProcess != nullptr);
 	Expects(_chatProcess->slice.has_value());
-	Expects((_chatProcess->fileIndex >= 0)
-		&& (_chatProcess->fileIndex < _chatProcess->slice->list.size()));
+	Expects((index >= 0) && (index < _chatProcess->slice->list.size()));
+	Expects(_chatProcess->filesLoading > 0);
 
-	const auto index = _chatProcess->fileIndex;
 	auto &file = _chatProcess->slice->list[index].thumb().file;
 	file.relativePath = relativePath;
 	if (relativePath.isEmpty()) {
 		file.skipReason = Data::File::SkipReason::Unavailable;
 	}
+	--_chatProcess->filesLoading;
 	loadNextMessageFile();
 }
 
@@ -1558,7 +1631,11 @@ bool ApiWrap::writePreloadedFile(Data::File &file) {
 		return true;
 	} else if (!file.content.isEmpty()) {
 		const auto process = prepareFileProcess(file);
-		if (const auto result = process->file.writeBlock(file.content)) {
+		const auto result = [&] {
+			const auto result = process->file.writeBlock(file.content);
+			return result ? process->file.flush() : result;
+		}();
+		if (result) {
 			file.relativePath = process->relativePath;
 			_fileCache->save(file.location, file.relativePath);
 		} else {
@@ -1573,34 +1650,45 @@ void ApiWrap::loadFile(
 		const Data::File &file,
 		Fn<bool(FileProgress)> progress,
 		FnMut<void(QString)> done) {
-	Expects(_fileProcess == nullptr);
 	Expects(file.location.dcId != 0
 		|| file.location.data.type() == mtpc_inputTakeoutFileLocation);
 
-	_fileProcess = prepareFileProcess(file);
-	_fileProcess->progress = std::move(progress);
-	_fileProcess->done = std::move(done);
+	const auto id = ++_fileProcessIdLast;
+	auto prepared = prepareFileProcess(file);
+	const auto process = prepared.get();
+	process->id = id;
+	process->progress = std::move(progress);
+	process->done = std::move(done);
+	_fileProcesses.emplace(id, std::move(prepared));
 
-	if (_fileProcess->progress) {
+	if (process->progress) {
 		const auto progress = FileProgress{
-			_fileProcess->file.size(),
-			_fileProcess->size
+			process->file.size(),
+			process->size,
+			process->relativePath
 		};
-		if (!_fileProcess->progress(progress)) {
+		if (!process->progress(progress)) {
 			return;
 		}
 	}
 
-	loadFilePart();
+	loadFilePart(id);
 }
 
 auto ApiWrap::prepareFileProcess(const Data::File &file) const
 -> std::unique_ptr<FileProcess> {
 	Expects(_settings != nullptr);
 
+	// Files that are being loaded right now don't exist on disk yet.
+	auto reserved = base::flat_set<QString>();
+	reserved.reserve(_fileProcesses.size());
+	for (const auto &[id, process] : _fileProcesses) {
+		reserved.emplace(process->relativePath);
+	}
 	const auto relativePath = Output::File::PrepareRelativePath(
 		_settings->path,
-		file.suggestedPath);
+		file.suggestedPath,
+		reserved);
 	auto result = std::make_unique<FileProcess>(
 		_settings->path + relativePath,
 		_stats);
@@ -1610,40 +1698,90 @@ auto ApiWrap::prepareFileProcess(const Data::File &file) const
 	return result;
 }
 
-void ApiWrap::loadFilePart() {
-	if (!_fileProcess
-		|| _fileProcess->requests.size() >= kFileRequestsCount
-		|| (_fileProcess->size > 0
-			&& _fileProcess->offset >= _fileProcess->size)) {
+auto ApiWrap::fileProcess(uint64 processId) const -> FileProcess* {
+	const auto i = _fileProcesses.find(processId);
+	return (i != end(_fileProcesses)) ? i->second.get() : nullptr;
+}
+
+void ApiWrap::loadFilePart(uint64 processId) {
+	const auto process = fileProcess(processId);
+	if (!process
+		|| process->waitingBandwidth
+		|| process->requests.size() >= kFileRequestsCount
+		|| (process->size > 0 && process->offset >= process->size)) {
+		return;
+	}
+	if (const auto delay = takeFileBandwidth()) {
+		loadFilePartDelayed(processId, delay);
 		return;
 	}
 
-	const auto offset = _fileProcess->offset;
-	_fileProcess->requests.push_back({ offset });
+	const auto offset = process->offset;
+	process->requests.push_back({ offset });
 	fileRequest(
-		_fileProcess->location,
-		_fileProcess->offset
+		processId,
+		process->location,
+		offset
 	).done([=](const MTPupload_File &result) {
-		filePartDone(offset, result);
+		filePartDone(processId, offset, result);
 	}).send();
-	_fileProcess->offset += kFileChunkSize;
-
-	if (_fileProcess->size > 0
-		&& _fileProcess->requests.size() < kFileRequestsCount) {
-		//const auto runner = _runner;
-		//crl::on_main([=] {
-		//	QTimer::singleShot(kFileNextRequestDelay, [=] {
-		//		runner([=] {
-		//			loadFilePart();
-		//		});
-		//	});
-		//});
+	process->offset += kFileChunkSize;
+
+	if (process->size > 0) {
+		loadFilePart(processId);
 	}
 }
 
-void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
-	Expects(_fileProcess != nullptr);
-	Expects(!_fileProcess->requests.empty());
+void ApiWrap::loadFilePartDelayed(uint64 processId, crl::time delay) {
+	const auto process = fileProcess(processId);
+	Assert(process != nullptr);
+
+	process->waitingBandwidth = true;
+	const auto runner = _runner;
+	crl::on_main([=] {
+		QTimer::singleShot(delay, [=] {
+			runner([=] {
+				if (const auto process = fileProcess(processId)) {
+					process->waitingBandwidth = false;
+					loadFilePart(processId);
+				}
+			});
+		});
+	});
+}
+
+crl::time ApiWrap::takeFileBandwidth() {
+	const auto limit = _settings->media.bandwidthLimit;
+	if (limit <= 0) {
+		return 0;
+	}
+	const auto now = crl::now();
+	if (!_fileBandwidthStart
+		|| now >= _fileBandwidthStart + kFileBandwidthPeriod) {
+		_fileBandwidthStart = now;
+		_fileBandwidthTaken = 0;
+	}
+
+	// Let at least one part go in each period even for tiny limits.
+	if (_fileBandwidthTaken > 0
+		&& _fileBandwidthTaken + kFileChunkSize > limit) {
+		return std::max(
+			_fileBandwidthStart + kFileBandwidthPeriod - now,
+			crl::time(1));
+	}
+	_fileBandwidthTaken += kFileChunkSize;
+	return 0;
+}
+
+void ApiWrap::filePartDone(
+		uint64 processId,
+		int offset,
+		const MTPupload_File &result) {
+	const auto process = fileProcess(processId);
+	if (!process) {
+		return;
+	}
+	Assert(!process->requests.empty());
 
 	if (result.type() == mtpc_upload_fileCdnRedirect) {
 		error("Cdn redirect is not supported.");
@@ -1651,18 +1789,18 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 	}
 	const auto &data = result.c_upload_file();
 	if (data.vbytes().v.isEmpty()) {
-		if (_fileProcess->size > 0) {
+		if (process->size > 0) {
 			error("Empty bytes received in file part.");
 			return;
 		}
-		const auto result = _fileProcess->file.writeBlock({});
+		const auto result = process->file.writeBlock({});
 		if (!result) {
 			ioError(result);
 			return;
 		}
 	} else {
 		using Request = FileProcess::Request;
-		auto &requests = _fileProcess->requests;
+		auto &requests = process->requests;
 		const auto i = ranges::find(
 			requests,
 			offset,
@@ -1671,7 +1809,7 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 
 		i->bytes = data.vbytes().v;
 
-		auto &file = _fileProcess->file;
+		auto &file = process->file;
 		while (!requests.empty() && !requests.front().bytes.isEmpty()) {
 			const auto &bytes = requests.front().bytes;
 			if (const auto result = file.writeBlock(bytes); !result) {
@@ -1681,33 +1819,42 @@ void ApiWrap::filePartDone(int offset, const MTPupload_File &result) {
 			requests.pop_front();
 		}
 
-		if (_fileProcess->progress) {
-			_fileProcess->progress(FileProgress{
+		if (process->progress) {
+			process->progress(FileProgress{
 				file.size(),
-				_fileProcess->size });
+				process->size,
+				process->relativePath });
 		}
 
 		if (!requests.empty()
-			|| !_fileProcess->size
-			|| _fileProcess->size > _fileProcess->offset) {
-			loadFilePart();
+			|| !process->size
+			|| process->size > process->offset) {
+			loadFilePart(processId);
 			return;
 		}
 	}
 
-	auto process = base::take(_fileProcess);
-	const auto relativePath = process->relativePath;
-	_fileCache->save(process->location, relativePath);
-	process->done(process->relativePath);
+	if (const auto result = process->file.flush(); !result) {
+		ioError(result);
+		return;
+	}
+
+	auto finished = _fileProcesses.take(processId);
+	Assert(finished.has_value());
+	const auto relativePath = (*finished)->relativePath;
+	_fileCache->save((*finished)->location, relativePath);
+	(*finished)->done(relativePath);
 }
 
-void ApiWrap::filePartUnavailable() {
-	Expects(_fileProcess != nullptr);
-	Expects(!_fileProcess->requests.empty());
+void ApiWrap::filePartUnavailable(uint64 processId) {
+	auto process = _fileProcesses.take(processId);
+	if (!process) {
+		return;
+	}
 
 	LOG(("Export Error: File unavailable."));
 
-	base::take(_fileProcess)->done(QString());
+	(*process)->done(QString());
 }
 
 void ApiWrap::error(RPCError &&error) {
@@ -144,6 +144,9 @@ private:
 	void checkFirstMessageDate(int localSplitIndex, int count);
 	void messagesCountLoaded(int localSplitIndex, int count);
 	void requestMessagesSlice();
+	void messagesSliceFetched(Data::MessagesSlice &&slice);
+	void appendMessagesSlice(Data::MessagesSlice &&slice);
+	void loadNextMessagesSlice();
 	void requestChatMessages(
 		int splitIndex,
 		int offsetId,
@@ -152,10 +155,11 @@ private:
 		FnMut<void(MTPmessages_Messages&&)> done);
 	void loadMessagesFiles(Data::MessagesSlice &&slice);
 	void loadNextMessageFile();
-	bool loadMessageFileProgress(FileProgress value);
-	void loadMessageFileDone(const QString &relativePath);
-	bool loadMessageThumbProgress(FileProgress value);
-	void loadMessageThumbDone(const QString &relativePath);
+	bool loadMessageFiles(int index);
+	bool loadMessageFileProgress(int index, FileProgress value);
+	void loadMessageFileDone(int index, const QString &relativePath);
+	bool loadMessageThumbProgress(int index, FileProgress value);
+	void loadMessageThumbDone(int index, const QString &relativePath);
 	void finishMessagesSlice();
 	void finishMessages();
 
@@ -171,9 +175,15 @@ private:
 		const Data::File &file,
 		Fn<bool(FileProgress)> progress,
 		FnMut<void(QString)> done);
-	void loadFilePart();
-	void filePartDone(int offset, const MTPupload_File &result);
-	void filePartUnavailable();
+	[[nodiscard]] FileProcess *fileProcess(uint64 processId) const;
+	void loadFilePart(uint64 processId);
+	void loadFilePartDelayed(uint64 processId, crl::time delay);
+	[[nodiscard]] crl::time takeFileBandwidth();
+	void filePartDone(
+		uint64 processId,
+		int offset,
+		const MTPupload_File &result);
+	void filePartUnavailable(uint64 processId);
 
 	template <typename Request>
 	class RequestBuilder;
@@ -185,6 +195,7 @@ private:
 	[[nodiscard]] auto splitRequest(int index, Request &&request);
 
 	[[nodiscard]] auto fileRequest(
+		uint64 processId,
 		const Data::FileLocation &location,
 		int offset);
 
@@ -193,6 +204,7 @@ private:
 	void ioError(const Output::Result &result);
 
 	MTP::ConcurrentSender _mtp;
+	Fn<void(FnMut<void()>)> _runner;
 	std::optional<uint64> _takeoutId;
 	Output::Stats *_stats = nullptr;
 
@@ -204,7 +216,10 @@ private:
 	std::unique_ptr<ContactsProcess> _contactsProcess;
 	std::unique_ptr<UserpicsProcess> _userpicsProcess;
 	std::unique_ptr<OtherDataProcess> _otherDataProcess;
-	std::unique_ptr<FileProcess> _fileProcess;
+	base::flat_map<uint64, std::unique_ptr<FileProcess>> _fileProcesses;
+	uint64 _fileProcessIdLast = 0;
+	crl::time _fileBandwidthStart = 0;
+	int64 _fileBandwidthTaken = 0;
 	std::unique_ptr<LeftChannelsProcess> _leftChannelsProcess;
 	std::unique_ptr<DialogsProcess> _dialogsProcess;
 	std::unique_ptr<ChatProcess> _chatProcess;
@@ -116,6 +116,7 @@ private:
 	rpl::event_stream<State> _stateChanges;
 
 	Output::Stats _stats;
+	crl::time _startedAt = 0;
 
 	std::vector<int> _substepsInStep;
 	int _substepsTotal = 0;
@@ -236,6 +237,7 @@ void ControllerObject::startExport(
 	}
 	_settings = NormalizeSettings(settings);
 	_environment = environment;
+	_startedAt = crl::now();
 
 	_settings.path = Output::NormalizePath(_settings);
 	_writer = Output::CreateWriter(_settings.format);
@@ -488,6 +490,7 @@ ProcessingState ControllerObject::prepareState(
 	result.substepsPassed = _substepsPassed;
 	result.substepsNow = substepsInStep(_lastProcessingStep);
 	result.substepsTotal = _substepsTotal;
+	result.startedAt = _startedAt;
 	return result;
 }
 
@@ -579,6 +582,13 @@ int ControllerObject::substepsInStep(Step step) const {
 }
 
 void ControllerObject::setFinishedState() {
+	const auto duration = std::max(crl::now() - _startedAt, crl::time(1));
+	LOG(("Export Info: Finished in %1 ms, %2 files, %3 bytes, %4 bytes/s."
+		).arg(duration
+		).arg(_stats.filesCount()
+		).arg(_stats.bytesCount()
+		).arg(_stats.bytesCount() * 1000 / duration));
+
 	setState(FinishedState{
 		_writer->mainFilePath(),
 		_stats.filesCount(),
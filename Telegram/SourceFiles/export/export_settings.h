@@ -36,6 +36,11 @@ struct MediaSettings {
 	Types types = DefaultTypes();
 	int sizeLimit = 8 * 1024 * 1024;
 
+	// How many message files are downloaded at the same time and
+	// the total download speed in bytes per second, zero for no limit.
+	int parallelLoads = 4;
+	int bandwidthLimit = 0;
+
 	static inline Types DefaultTypes() {
 		return Type::Photo;
 	}
@@ -17,19 +17,42 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Export {
 namespace Output {
+namespace {
 
-File::File(const QString &path, Stats *stats) : _path(path), _stats(stats) {
+constexpr auto kBufferSize = 1024 * 1024;
+
+} // namespace
+
+File::File(const QString &path, Stats *stats, bool buffered)
+: _path(path)
+, _stats(stats)
+, _buffered(buffered) {
+}
+
+File::~File() {
+	(void)flush();
 }
 
 int File::size() const {
-	return _offset;
+	return _offset + _buffer.size();
 }
 
 bool File::empty() const {
-	return !_offset;
+	return !size();
 }
 
 Result File::writeBlock(const QByteArray &block) {
+	if (_buffered
+		&& !block.isEmpty()
+		&& _buffer.size() + block.size() <= kBufferSize) {
+		if (!_buffer.capacity()) {
+			_buffer.reserve(kBufferSize);
+		}
+		_buffer.append(block);
+		return Result::Success();
+	} else if (const auto result = flush(); !result) {
+		return result;
+	}
 	const auto result = writeBlockAttempt(block);
 	if (!result) {
 		_file.reset();
@@ -37,6 +60,21 @@ Result File::writeBlock(const QByteArray &block) {
 	return result;
 }
 
+Result File::flush() {
+	if (_buffer.isEmpty()) {
+		return Result::Success();
+	}
+	const auto result = writeBlockAttempt(_buffer);
+	if (!result) {
+		_file.reset();
+		return result;
+	}
+
+	// Reserved capacity is kept for the next blocks.
+	_buffer.resize(0);
+	return result;
+}
+
 Result File::writeBlockAttempt(const QByteArray &block) {
 	if (_stats && !_inStats) {
 		_inStats = true;
@@ -95,8 +133,13 @@ Result File::fatalError() const {
 
 QString File::PrepareRelativePath(
 		const QString &folder,
-		const QString &suggested) {
-	if (!QFile::exists(folder + suggested)) {
+		const QString &suggested,
+		const base::flat_set<QString> &reserved) {
+	const auto taken = [&](const QString &relativePath) {
+		return reserved.contains(relativePath)
+			|| QFile::exists(folder + relativePath);
+	};
+	if (!taken(suggested)) {
 		return suggested;
 	}
 
@@ -114,7 +157,7 @@ QString File::PrepareRelativePath(
 	auto attempt = 0;
 	while (true) {
 		const auto relativePath = relativePart(++attempt);
-		if (!QFile::exists(folder + relativePath)) {
+		if (!taken(relativePath)) {
 			return relativePath;
 		}
 	}
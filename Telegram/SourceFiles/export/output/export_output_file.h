@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "base/optional.h"
+#include "base/flat_set.h"
 
 #include <QtCore/QFile>
 #include <QtCore/QString>
@@ -21,16 +22,21 @@ class Stats;
 
 class File {
 public:
-	File(const QString &path, Stats *stats);
+	// Buffered file collects small blocks in memory and writes them
+	// by large chunks, flush() must be called when the file is done.
+	File(const QString &path, Stats *stats, bool buffered = false);
+	~File();
 
 	[[nodiscard]] int size() const;
 	[[nodiscard]] bool empty() const;
 
 	[[nodiscard]] Result writeBlock(const QByteArray &block);
+	[[nodiscard]] Result flush();
 
 	[[nodiscard]] static QString PrepareRelativePath(
 		const QString &folder,
-		const QString &suggested);
+		const QString &suggested,
+		const base::flat_set<QString> &reserved = {});
 
 	[[nodiscard]] static Result Copy(
 		const QString &source,
@@ -47,6 +53,8 @@ private:
 	QString _path;
 	int _offset = 0;
 	std::optional<QFile> _file;
+	QByteArray _buffer;
+	bool _buffered = false;
 
 	Stats *_stats = nullptr;
 	bool _inStats = false;
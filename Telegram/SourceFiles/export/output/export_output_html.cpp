@@ -691,7 +691,7 @@ HtmlWriter::Wrap::Wrap(
 	const QString &path,
 	const QString &base,
 	Stats *stats)
-: _file(path, stats) {
+: _file(path, stats, true) {
 	Expects(base.endsWith('/'));
 	Expects(path.startsWith(base));
 
@@ -1778,9 +1778,11 @@ Result HtmlWriter::Wrap::close() {
 		while (!_context.empty()) {
 			block.append(_context.popTag());
 		}
-		return _file.writeBlock(block);
+		if (const auto result = _file.writeBlock(block); !result) {
+			return result;
+		}
 	}
-	return Result::Success();
+	return _file.flush();
 }
 
 QString HtmlWriter::Wrap::relativePath(const QString &path) const {
@@ -23,13 +23,28 @@ namespace {
 
 using Context = details::JsonContext;
 
+bool NeedsEscaping(char ch) {
+	return (ch >= 0 && ch < 32)
+		|| (ch == '"')
+		|| (ch == '\\')
+		|| (ch == char(0xE2));
+}
+
 QByteArray SerializeString(const QByteArray &value) {
 	const auto size = value.size();
 	const auto begin = value.data();
 	const auto end = begin + size;
 
+	// Most of the strings don't need escaping at all,
+	// escaped characters take at most six bytes each.
+	const auto escaped = std::count_if(begin, end, NeedsEscaping);
 	auto result = QByteArray();
-	result.reserve(2 + size * 4);
+	if (!escaped) {
+		result.reserve(2 + size);
+		result.append('"').append(value).append('"');
+		return result;
+	}
+	result.reserve(2 + size + escaped * 5);
 	result.append('"');
 	for (auto p = begin; p != end; ++p) {
 		const auto ch = *p;
@@ -99,8 +114,16 @@ QByteArray SerializeObject(
 	const auto guard = gsl::finally([&] { context.nesting.pop_back(); });
 	const auto next = '\n' + Indentation(context);
 
+	auto size = 3 + indent.size();
+	for (const auto &[key, value] : values) {
+		if (!value.isEmpty()) {
+			size += next.size() + key.size() + value.size() + 5;
+		}
+	}
+
 	auto first = true;
 	auto result = QByteArray();
+	result.reserve(size);
 	result.append('{');
 	for (const auto &[key, value] : values) {
 		if (value.isEmpty()) {
@@ -124,8 +147,14 @@ QByteArray SerializeArray(
 	const auto indent = Indentation(context.nesting.size());
 	const auto next = '\n' + Indentation(context.nesting.size() + 1);
 
+	auto size = 3 + indent.size();
+	for (const auto &value : values) {
+		size += next.size() + value.size() + 1;
+	}
+
 	auto first = true;
 	auto result = QByteArray();
+	result.reserve(size);
 	result.append('[');
 	for (const auto &value : values) {
 		if (first) {
@@ -1100,7 +1129,10 @@ Result JsonWriter::finish() {
 
 	auto block = popNesting();
 	Assert(_context.nesting.empty());
-	return _output->writeBlock(block);
+	if (const auto result = _output->writeBlock(block); !result) {
+		return result;
+	}
+	return _output->flush();
 }
 
 QString JsonWriter::mainFilePath() {
@@ -1117,7 +1149,10 @@ QString JsonWriter::pathWithRelativePath(const QString &path) const {
 
 std::unique_ptr<File> JsonWriter::fileWithRelativePath(
 		const QString &path) const {
-	return std::make_unique<File>(pathWithRelativePath(path), _stats);
+	return std::make_unique<File>(
+		pathWithRelativePath(path),
+		_stats,
+		true);
 }
 
 } // namespace Output
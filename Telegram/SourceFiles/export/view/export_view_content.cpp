@@ -12,6 +12,30 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Export {
 namespace View {
+namespace {
+
+// Early progress is too uneven to extrapolate the remaining time.
+constexpr auto kMinTimeLeftProgress = 0.02;
+constexpr auto kMinTimeLeftElapsed = 10 * crl::time(1000);
+
+QString TimeLeftText(const ProcessingState &state, float64 progress) {
+	if (!state.startedAt
+		|| progress < kMinTimeLeftProgress
+		|| progress >= 1.) {
+		return QString();
+	}
+	const auto elapsed = crl::now() - state.startedAt;
+	if (elapsed < kMinTimeLeftElapsed) {
+		return QString();
+	}
+	const auto left = elapsed * (1. - progress) / progress;
+	return tr::lng_export_state_time_left(
+		tr::now,
+		lt_time,
+		formatDurationWords(int64(left / 1000)));
+}
+
+} // namespace
 
 const QString Content::kDoneId = "done";
 
@@ -27,7 +51,7 @@ Content ContentFromState(const ProcessingState &state) {
 		result.rows.push_back({ id, label, info, progress });
 	};
 	const auto pushMain = [&](const QString &label) {
-		const auto info = (state.entityCount > 0)
+		auto info = (state.entityCount > 0)
 			? (QString::number(state.entityIndex + 1)
 				+ " / "
 				+ QString::number(state.entityCount))
@@ -51,7 +75,12 @@ Content ContentFromState(const ProcessingState &state) {
 			&& !state.entityIndex)
 			? addPart(state.itemIndex, state.itemCount)
 			: addPart(state.entityIndex, state.entityCount);
-		push("main", label, info, doneProgress + addProgress);
+		const auto progress = doneProgress + addProgress;
+		const auto left = TimeLeftText(state, progress);
+		if (!left.isEmpty()) {
+			info = info.isEmpty() ? left : (info + ", " + left);
+		}
+		push("main", label, info, progress);
 	};
 	const auto pushBytes = [&](const QString &id, const QString &label) {
 		if (!state.bytesCount) {
@@ -18,8 +18,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 extern "C" {
 #include <libavutil/opt.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/pixdesc.h>
 } // extern "C"
 
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(58, 0, 0)
+#define TDESKTOP_FFMPEG_HW_DECODING
+#endif // LIBAVCODEC_VERSION_INT >= 58.0.0
+
 namespace FFmpeg {
 namespace {
 
@@ -99,6 +105,110 @@ void PremultiplyLine(uchar *dst, const uchar *src, int intsCount) {
 		nullptr);
 }
 
+#ifdef TDESKTOP_FFMPEG_HW_DECODING
+[[nodiscard]] auto HwDeviceTypes() {
+	return std::array{
+#ifdef Q_OS_WIN
+		AV_HWDEVICE_TYPE_D3D11VA,
+		AV_HWDEVICE_TYPE_DXVA2,
+#elif defined Q_OS_MAC // Q_OS_WIN
+		AV_HWDEVICE_TYPE_VIDEOTOOLBOX,
+#else // Q_OS_WIN || Q_OS_MAC
+		AV_HWDEVICE_TYPE_VAAPI,
+#endif // Q_OS_WIN || Q_OS_MAC
+	};
+}
+
+AVPixelFormat GetHwFormat(
+		AVCodecContext *context,
+		const AVPixelFormat *formats) {
+	const auto wanted = static_cast<AVPixelFormat>(
+		reinterpret_cast<intptr_t>(context->opaque));
+	for (auto i = formats; *i != AV_PIX_FMT_NONE; ++i) {
+		if (*i == wanted) {
+			return *i;
+		}
+	}
+
+	// Fall back to software decoding if the hardware format is not offered.
+	for (auto i = formats; *i != AV_PIX_FMT_NONE; ++i) {
+		const auto descriptor = av_pix_fmt_desc_get(*i);
+		if (descriptor && !(descriptor->flags & AV_PIX_FMT_FLAG_HWACCEL)) {
+			return *i;
+		}
+	}
+	return AV_PIX_FMT_NONE;
+}
+
+[[nodiscard]] bool InitHwDevice(
+		not_null<AVCodecContext*> context,
+		not_null<const AVCodec*> codec) {
+	for (const auto type : HwDeviceTypes()) {
+		for (auto i = 0; const auto config = avcodec_get_hw_config(codec, i); ++i) {
+			if (!(config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX)
+				|| config->device_type != type) {
+				continue;
+			}
+			auto device = (AVBufferRef*)nullptr;
+			const auto error = AvErrorWrap(av_hwdevice_ctx_create(
+				&device,
+				type,
+				nullptr,
+				nullptr,
+				0));
+			if (error) {
+				LogError(qstr("av_hwdevice_ctx_create"), error);
+				break;
+			}
+			context->hw_device_ctx = device;
+			context->opaque = reinterpret_cast<void*>(
+				static_cast<intptr_t>(config->pix_fmt));
+			context->get_format = GetHwFormat;
+			return true;
+		}
+	}
+	return false;
+}
+#endif // TDESKTOP_FFMPEG_HW_DECODING
+
+[[nodiscard]] CodecPointer OpenCodec(not_null<AVStream*> stream, bool hw) {
+	auto error = AvErrorWrap();
+
+	auto result = CodecPointer(avcodec_alloc_context3(nullptr));
+	const auto context = result.get();
+	if (!context) {
+		LogError(qstr("avcodec_alloc_context3"));
+		return {};
+	}
+	error = avcodec_parameters_to_context(context, stream->codecpar);
+	if (error) {
+		LogError(qstr("avcodec_parameters_to_context"), error);
+		return {};
+	}
+	av_codec_set_pkt_timebase(context, stream->time_base);
+	av_opt_set_int(context, "refcounted_frames", 1, 0);
+
+	const auto codec = avcodec_find_decoder(context->codec_id);
+	if (!codec) {
+		LogError(qstr("avcodec_find_decoder"), context->codec_id);
+		return {};
+	}
+#ifdef TDESKTOP_FFMPEG_HW_DECODING
+	if (hw && !InitHwDevice(context, codec)) {
+		return {};
+	}
+#else // TDESKTOP_FFMPEG_HW_DECODING
+	if (hw) {
+		return {};
+	}
+#endif // TDESKTOP_FFMPEG_HW_DECODING
+	if ((error = avcodec_open2(context, codec, nullptr))) {
+		LogError(qstr("avcodec_open2"), error);
+		return {};
+	}
+	return result;
+}
+
 } // namespace
 
 IOPointer MakeIOPointer(
@@ -177,32 +287,13 @@ void FormatDeleter::operator()(AVFormatContext *value) {
 	}
 }
 
-CodecPointer MakeCodecPointer(not_null<AVStream*> stream) {
-	auto error = AvErrorWrap();
-
-	auto result = CodecPointer(avcodec_alloc_context3(nullptr));
-	const auto context = result.get();
-	if (!context) {
-		LogError(qstr("avcodec_alloc_context3"));
-		return {};
-	}
-	error = avcodec_parameters_to_context(context, stream->codecpar);
-	if (error) {
-		LogError(qstr("avcodec_parameters_to_context"), error);
-		return {};
-	}
-	av_codec_set_pkt_timebase(context, stream->time_base);
-	av_opt_set_int(context, "refcounted_frames", 1, 0);
-
-	const auto codec = avcodec_find_decoder(context->codec_id);
-	if (!codec) {
-		LogError(qstr("avcodec_find_decoder"), context->codec_id);
-		return {};
-	} else if ((error = avcodec_open2(context, codec, nullptr))) {
-		LogError(qstr("avcodec_open2"), error);
-		return {};
+CodecPointer MakeCodecPointer(CodecDescriptor descriptor) {
+	if (descriptor.hwAllowed) {
+		if (auto result = OpenCodec(descriptor.stream, true)) {
+			return result;
+		}
 	}
-	return result;
+	return OpenCodec(descriptor.stream, false);
 }
 
 void CodecDeleter::operator()(AVCodecContext *value) {
@@ -216,7 +307,8 @@ FramePointer MakeFramePointer() {
 }
 
 bool FrameHasData(AVFrame *frame) {
-	return (frame && frame->data[0] != nullptr);
+	// Hardware frames may hold the surface not in the first data pointer.
+	return frame && (frame->data[0] != nullptr || frame->hw_frames_ctx);
 }
 
 void ClearFrameMemory(AVFrame *frame) {
@@ -225,6 +317,34 @@ void ClearFrameMemory(AVFrame *frame) {
 	}
 }
 
+AvErrorWrap TransferHwFrame(
+		not_null<AVFrame*> to,
+		not_null<AVFrame*> frame) {
+	// Transfer to the buffers of the previous frame if they fit,
+	// av_hwframe_transfer_data allocates new ones only for an empty frame.
+	const auto context = frame->hw_frames_ctx
+		? reinterpret_cast<AVHWFramesContext*>(frame->hw_frames_ctx->data)
+		: nullptr;
+	const auto reuse = context
+		&& FrameHasData(to)
+		&& (to->format == context->sw_format)
+		&& (to->width == frame->width)
+		&& (to->height == frame->height)
+		&& av_frame_is_writable(to);
+	if (!reuse) {
+		ClearFrameMemory(to);
+	}
+	const auto error = AvErrorWrap(av_hwframe_transfer_data(to, frame, 0));
+	if (error) {
+		LogError(qstr("av_hwframe_transfer_data"), error);
+		return error;
+	}
+	to->best_effort_timestamp = frame->best_effort_timestamp;
+	to->pts = frame->pts;
+	to->pkt_dts = frame->pkt_dts;
+	return error;
+}
+
 void FrameDeleter::operator()(AVFrame *value) {
 	av_frame_free(&value);
 }
@@ -136,7 +136,11 @@ struct CodecDeleter {
 	void operator()(AVCodecContext *value);
 };
 using CodecPointer = std::unique_ptr<AVCodecContext, CodecDeleter>;
-[[nodiscard]] CodecPointer MakeCodecPointer(not_null<AVStream*> stream);
+struct CodecDescriptor {
+	not_null<AVStream*> stream;
+	bool hwAllowed = false;
+};
+[[nodiscard]] CodecPointer MakeCodecPointer(CodecDescriptor descriptor);
 
 struct FrameDeleter {
 	void operator()(AVFrame *value);
@@ -146,6 +150,13 @@ using FramePointer = std::unique_ptr<AVFrame, FrameDeleter>;
 [[nodiscard]] bool FrameHasData(AVFrame *frame);
 void ClearFrameMemory(AVFrame *frame);
 
+// Downloads a hardware decoded frame to the system memory as is,
+// in its software pixel format (NV12 for most of the decoders).
+// Buffers already held by 'to' are reused when the frame fits them.
+[[nodiscard]] AvErrorWrap TransferHwFrame(
+	not_null<AVFrame*> to,
+	not_null<AVFrame*> frame);
+
 struct SwscaleDeleter {
 	QSize srcSize;
 	int srcFormat = int(AV_PIX_FMT_NONE);
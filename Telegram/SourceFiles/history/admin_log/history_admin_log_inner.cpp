@@ -54,6 +54,7 @@ constexpr auto kMaxChannelAdmins = 200;
 constexpr auto kScrollDateHideTimeout = 1000;
 constexpr auto kEventsFirstPage = 20;
 constexpr auto kEventsPerPage = 50;
+constexpr auto kUnloadHeavyPartsPages = 3;
 
 } // namespace
 
@@ -312,6 +313,14 @@ void InnerWidget::visibleTopBottomUpdated(
 	} else {
 		scrollDateHideByTimer();
 	}
+
+	// Unload lottie animations.
+	const auto visibleHeight = (_visibleBottom - _visibleTop);
+	const auto pages = kUnloadHeavyPartsPages;
+	const auto from = _visibleTop - pages * visibleHeight;
+	const auto till = _visibleBottom + pages * visibleHeight;
+	session().data().unloadHeavyViewParts(this, from, till);
+
 	_controller->floatPlayerAreaUpdated().notify(true);
 }
 
@@ -608,6 +608,7 @@ std::vector<not_null<HistoryItem*>> History::createItems(
 		const QVector<MTPMessage> &data) {
 	auto result = std::vector<not_null<HistoryItem*>>();
 	result.reserve(data.size());
+	owner().prepareMessageTexts(data);
 	const auto clientFlags = MTPDmessage_ClientFlags();
 	for (auto i = data.cend(), e = data.cbegin(); i != e;) {
 		const auto detachExistingItem = true;
@@ -616,6 +617,7 @@ std::vector<not_null<HistoryItem*>> History::createItems(
 			result.emplace_back(item);
 		}
 	}
+	owner().clearPreparedMessageTexts();
 	return result;
 }
 
@@ -1597,6 +1599,11 @@ void History::calculateFirstUnreadMessage() {
 }
 
 void History::readClientSideMessages() {
+	// Only local service notifications are unread on the client side,
+	// other histories don't need all their loaded messages walked.
+	if (peer->id != PeerData::kServiceNotificationsId) {
+		return;
+	}
 	for (const auto &block : blocks) {
 		for (const auto &view : block->messages) {
 			const auto item = view->data();
@@ -2776,6 +2783,17 @@ void History::resizeToWidth(int newWidth) {
 	_flags &= ~(Flag::f_has_pending_resized_items);
 
 	_width = newWidth;
+	if (resizeAllItems) {
+		auto tasks = std::vector<HistoryView::TextLayoutTask>();
+		for (const auto &block : blocks) {
+			for (const auto &message : block->messages) {
+				if (const auto task = message->textLayoutTask(newWidth)) {
+					tasks.push_back(*task);
+				}
+			}
+		}
+		HistoryView::CountTextLayouts(tasks);
+	}
 	int y = 0;
 	for (const auto &block : blocks) {
 		block->setY(y);
@@ -40,6 +40,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "layout.h"
 #include "main/main_session.h"
 #include "core/application.h"
+#include "core/core_trace.h"
 #include "apiwrap.h"
 #include "platform/platform_info.h"
 #include "lang/lang_keys.h"
@@ -49,6 +50,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "data/data_poll.h"
 #include "data/data_photo.h"
 #include "data/data_user.h"
+#include "window/themes/window_theme.h"
 
 #include <QtGui/QClipboard>
 #include <QtWidgets/QApplication>
@@ -182,6 +184,24 @@ HistoryInner::HistoryInner(
 		repaintItem(view);
 	}, lifetime());
 	session().data().viewLayoutChanged(
+	) | rpl::start_with_next([this](not_null<const Element*> view) {
+		invalidateViewCache(view);
+	}, lifetime());
+	subscribe(session().downloaderTaskFinished(), [=] {
+		// Reply previews may have got their thumbnails loaded.
+		for (auto i = _viewCache.begin(); i != _viewCache.end();) {
+			if (i->first->data()->Has<HistoryMessageReply>()) {
+				i = _viewCache.erase(i);
+			} else {
+				++i;
+			}
+		}
+	});
+	subscribe(Window::Theme::Background(), [=](
+			const Window::Theme::BackgroundUpdate &update) {
+		_viewCache.clear();
+	});
+	session().data().viewLayoutChanged(
 	) | rpl::filter([](not_null<const Element*> view) {
 		return (view == view->data()->mainView()) && view->isUnderCursor();
 	}) | rpl::start_with_next([this](not_null<const Element*> view) {
@@ -231,12 +251,23 @@ void HistoryInner::repaintItem(const HistoryItem *item) {
 }
 
 void HistoryInner::repaintItem(const Element *view) {
+	if (!view) {
+		return;
+	}
+	invalidateViewCache(view);
 	if (_widget->skipItemRepaint()) {
 		return;
 	}
 	const auto top = itemTop(view);
-	if (top >= 0) {
-		update(0, top, width(), view->height());
+	if (top < 0) {
+		return;
+	}
+
+	// Repaint only the visible part, the rest is painted when scrolled to.
+	const auto from = std::max(top, _visibleAreaTop);
+	const auto till = std::min(top + view->height(), _visibleAreaBottom);
+	if (from < till) {
+		update(0, from, width(), till - from);
 	}
 }
 
@@ -547,10 +578,86 @@ void HistoryInner::paintEmpty(Painter &p, int width, int height) {
 	_emptyPainter->paint(p, width, height);
 }
 
+bool HistoryInner::canCacheView(
+		not_null<const Element*> view,
+		TextSelection selection) const {
+	const auto item = view->data();
+	return (selection == TextSelection())
+		&& !view->media()
+		&& !view->isUnderCursor()
+		&& !item->isSending()
+		&& !item->inlineReplyKeyboard()
+		&& !App::main()->highlightStartTime(item)
+		&& !inSelectionMode();
+}
+
+void HistoryInner::paintView(
+		Painter &p,
+		not_null<Element*> view,
+		QRect clip,
+		TextSelection selection,
+		crl::time ms) {
+	if (!canCacheView(view, selection)) {
+		_viewCache.remove(view);
+		view->draw(p, clip, selection, ms);
+		return;
+	}
+	const auto width = view->width();
+	const auto height = view->height();
+	const auto unread = view->data()->unread();
+	auto &cached = _viewCache[view];
+	if (cached.frame.isNull()
+		|| cached.width != width
+		|| cached.height != height
+		|| cached.unread != unread) {
+		const auto ratio = cIntRetinaFactor();
+		auto image = QImage(
+			QSize(width, height) * ratio,
+			QImage::Format_ARGB32_Premultiplied);
+		image.setDevicePixelRatio(ratio);
+		image.fill(Qt::transparent);
+		{
+			Painter q(&image);
+			view->draw(q, QRect(0, 0, width, height), selection, ms);
+		}
+		cached.frame = App::pixmapFromImageInPlace(std::move(image));
+		cached.width = width;
+		cached.height = height;
+		cached.unread = unread;
+	}
+	const auto part = clip.intersected(QRect(0, 0, width, height));
+	if (!part.isEmpty()) {
+		const auto ratio = cIntRetinaFactor();
+		p.drawPixmap(
+			part,
+			cached.frame,
+			QRect(part.topLeft() * ratio, part.size() * ratio));
+	}
+}
+
+void HistoryInner::invalidateViewCache(not_null<const Element*> view) {
+	_viewCache.remove(view);
+}
+
+void HistoryInner::clearViewCacheOutsideVisibleArea() {
+	const auto visibleAreaHeight = _visibleAreaBottom - _visibleAreaTop;
+	const auto from = _visibleAreaTop - visibleAreaHeight;
+	const auto till = _visibleAreaBottom + visibleAreaHeight;
+	for (auto i = _viewCache.begin(); i != _viewCache.end();) {
+		const auto top = itemTop(i->first);
+		if (top < 0 || top + i->first->height() <= from || top >= till) {
+			i = _viewCache.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
 void HistoryInner::paintEvent(QPaintEvent *e) {
 	if (Ui::skipPaintEvent(this, e)) {
 		return;
 	}
+	const auto trace = Core::Trace::Scope("HistoryInner::paintEvent");
 	if (hasPendingResizedItems()) {
 		return;
 	}
@@ -614,7 +721,7 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 					view,
 					selfromy - mtop,
 					seltoy - mtop);
-				view->draw(p, clip.translated(0, -y), selection, ms);
+				paintView(p, view, clip.translated(0, -y), selection, ms);
 
 				if (item->hasViews()) {
 					App::main()->scheduleViewIncrement(item);
@@ -660,7 +767,7 @@ void HistoryInner::paintEvent(QPaintEvent *e) {
 						view,
 						selfromy - htop,
 						seltoy - htop);
-					view->draw(p, hclip.translated(0, -y), selection, ms);
+					paintView(p, view, hclip.translated(0, -y), selection, ms);
 
 					if (item->hasViews()) {
 						App::main()->scheduleViewIncrement(item);
@@ -1287,6 +1394,7 @@ void HistoryInner::viewRemoved(not_null<const Element*> view) {
 	if (_scrollDateLastItem == view) {
 		_scrollDateLastItem = nullptr;
 	}
+	_viewCache.remove(view);
 }
 
 void HistoryInner::refreshView(not_null<HistoryItem*> item) {
@@ -2122,6 +2230,7 @@ void HistoryInner::visibleAreaUpdated(int top, int bottom) {
 	_visibleAreaTop = top;
 	_visibleAreaBottom = bottom;
 	const auto visibleAreaHeight = bottom - top;
+	clearViewCacheOutsideVisibleArea();
 
 	// if history has pending resize events we should not update scrollTopItem
 	if (hasPendingResizedItems()) {
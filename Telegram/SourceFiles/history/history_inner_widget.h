@@ -139,6 +139,12 @@ public slots:
 
 private:
 	class BotAbout;
+	struct CachedView {
+		QPixmap frame;
+		int width = 0;
+		int height = 0;
+		bool unread = false;
+	};
 	using SelectedItems = std::map<HistoryItem*, TextSelection, std::less<>>;
 	enum class MouseAction {
 		None,
@@ -211,6 +217,17 @@ private:
 	void performDrag();
 
 	void paintEmpty(Painter &p, int width, int height);
+	void paintView(
+		Painter &p,
+		not_null<Element*> view,
+		QRect clip,
+		TextSelection selection,
+		crl::time ms);
+	[[nodiscard]] bool canCacheView(
+		not_null<const Element*> view,
+		TextSelection selection) const;
+	void invalidateViewCache(not_null<const Element*> view);
+	void clearViewCacheOutsideVisibleArea();
 
 	QPoint mapPointToItem(QPoint p, const Element *view) const;
 	QPoint mapPointToItem(QPoint p, const HistoryItem *item) const;
@@ -333,6 +350,9 @@ private:
 
 	base::flat_set<not_null<const HistoryItem*>> _animatedStickersPlayed;
 
+	// Static views are painted once to a pixmap and blitted afterwards.
+	base::flat_map<not_null<const Element*>, CachedView> _viewCache;
+
 	MouseAction _mouseAction = MouseAction::None;
 	TextSelectType _mouseSelectType = TextSelectType::Letters;
 	QPoint _dragStartPosition;
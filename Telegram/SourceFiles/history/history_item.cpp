@@ -47,6 +47,119 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace {
 
 constexpr auto kNotificationTextLimit = 255;
+constexpr auto kItemsInSlab = 64;
+
+// History slices are loaded and unloaded as a whole, so the items of all
+// histories are allocated in slabs of same sized slots instead of making
+// a separate heap allocation for each of them. Each slot starts with a
+// pointer to its slab, empty slabs are returned to the heap right away,
+// except for the last one with free slots in the pool.
+class ItemsAllocator final {
+public:
+	[[nodiscard]] void *allocate(std::size_t size);
+	void deallocate(void *pointer);
+
+private:
+	struct Pool;
+	struct alignas(std::max_align_t) Slab {
+		not_null<Pool*> pool;
+		Slab *previous = nullptr;
+		Slab *next = nullptr;
+		void *free = nullptr;
+		int used = 0;
+		int initialized = 0;
+
+		[[nodiscard]] char *slot(int index) {
+			return reinterpret_cast<char*>(this + 1)
+				+ index * pool->slotSize;
+		}
+	};
+	struct Pool {
+		std::size_t slotSize = 0;
+		Slab *available = nullptr;
+	};
+	static constexpr auto kHeaderSize = sizeof(std::max_align_t);
+	static_assert(sizeof(Slab*) <= kHeaderSize);
+	static_assert(sizeof(void*) <= kHeaderSize);
+
+	void link(not_null<Slab*> slab);
+	void unlink(not_null<Slab*> slab);
+
+	std::map<std::size_t, Pool> _pools;
+
+};
+
+void *ItemsAllocator::allocate(std::size_t size) {
+	auto &pool = _pools[size];
+	if (!pool.slotSize) {
+		const auto align = alignof(std::max_align_t);
+		pool.slotSize = kHeaderSize + ((size + align - 1) / align) * align;
+	}
+	auto slab = pool.available;
+	if (!slab) {
+		const auto memory = ::operator new(
+			sizeof(Slab) + kItemsInSlab * pool.slotSize);
+		slab = new (memory) Slab{ &pool };
+		link(slab);
+	}
+	auto slot = static_cast<char*>(slab->free);
+	if (slot) {
+		slab->free = *reinterpret_cast<void**>(slot);
+	} else {
+		slot = slab->slot(slab->initialized++);
+	}
+	if (++slab->used == kItemsInSlab) {
+		unlink(slab);
+	}
+	*reinterpret_cast<Slab**>(slot) = slab;
+	return slot + kHeaderSize;
+}
+
+void ItemsAllocator::deallocate(void *pointer) {
+	const auto slot = static_cast<char*>(pointer) - kHeaderSize;
+	const auto slab = *reinterpret_cast<Slab**>(slot);
+	Assert(slab->used > 0);
+
+	if (slab->used == kItemsInSlab) {
+		link(slab);
+	}
+	*reinterpret_cast<void**>(slot) = base::take(slab->free);
+	slab->free = slot;
+	if (!--slab->used && (slab->previous || slab->next)) {
+		unlink(slab);
+		slab->~Slab();
+		::operator delete(slab);
+	}
+}
+
+void ItemsAllocator::link(not_null<Slab*> slab) {
+	const auto pool = slab->pool;
+	slab->previous = nullptr;
+	slab->next = pool->available;
+	if (pool->available) {
+		pool->available->previous = slab;
+	}
+	pool->available = slab;
+}
+
+void ItemsAllocator::unlink(not_null<Slab*> slab) {
+	const auto pool = slab->pool;
+	if (slab->previous) {
+		slab->previous->next = slab->next;
+	} else {
+		pool->available = slab->next;
+	}
+	if (slab->next) {
+		slab->next->previous = slab->previous;
+	}
+	slab->previous = slab->next = nullptr;
+}
+
+[[nodiscard]] ItemsAllocator &Allocator() {
+	// Never destroyed, items may outlive the static objects on quit.
+	static const auto result = new ItemsAllocator();
+	return *result;
+}
 
 enum class MediaCheckResult {
 	Good,
@@ -65,12 +178,21 @@ not_null<HistoryItem*> CreateUnsupportedMessage(
 		TimeId date,
 		UserId from) {
 	const auto siteLink = qsl("https://desktop.telegram.org");
-	auto text = TextWithEntities{
-		tr::lng_message_unsupported(tr::now, lt_link, siteLink)
-	};
-	TextUtilities::ParseEntities(text, Ui::ItemTextNoMonoOptions().flags);
-	text.entities.push_front(
-		EntityInText(EntityType::Italic, 0, text.text.size()));
+
+	// The text is the same for all such messages, parse it only once.
+	static auto Parsed = TextWithEntities();
+	static auto ParsedFrom = QString();
+	auto phrase = tr::lng_message_unsupported(tr::now, lt_link, siteLink);
+	if (ParsedFrom != phrase) {
+		ParsedFrom = phrase;
+		Parsed = TextWithEntities{ std::move(phrase) };
+		TextUtilities::ParseEntities(
+			Parsed,
+			Ui::ItemTextNoMonoOptions().flags);
+		Parsed.entities.push_front(
+			EntityInText(EntityType::Italic, 0, Parsed.text.size()));
+	}
+	const auto &text = Parsed;
 	flags &= ~MTPDmessage::Flag::f_post_author;
 	flags |= MTPDmessage::Flag::f_legacy;
 	return history->owner().makeMessage(
@@ -159,6 +281,16 @@ MediaCheckResult CheckMessageMedia(const MTPMessageMedia &media) {
 
 } // namespace
 
+void *HistoryItem::operator new(std::size_t size) {
+	return Allocator().allocate(size);
+}
+
+void HistoryItem::operator delete(void *pointer) {
+	if (pointer) {
+		Allocator().deallocate(pointer);
+	}
+}
+
 void HistoryItem::HistoryItem::Destroyer::operator()(HistoryItem *value) {
 	if (value) {
 		value->destroy();
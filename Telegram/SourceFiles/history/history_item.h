@@ -63,6 +63,10 @@ public:
 		const MTPMessage &message,
 		MTPDmessage_ClientFlags clientFlags);
 
+	// Items are allocated in slabs, they're created and destroyed in bulk.
+	static void *operator new(std::size_t size);
+	static void operator delete(void *pointer);
+
 	struct Destroyer {
 		void operator()(HistoryItem *value);
 	};
@@ -438,8 +438,11 @@ HistoryMessage::HistoryMessage(
 	if (const auto media = data.vmedia()) {
 		setMedia(*media);
 	}
+	auto prepared = history->owner().takePreparedMessageText(&data);
 	setText({
-		TextUtilities::Clean(qs(data.vmessage())),
+		(prepared
+			? std::move(*prepared)
+			: TextUtilities::Clean(qs(data.vmessage()))),
 		TextUtilities::EntitiesFromMTP(data.ventities().value_or_empty())
 	});
 	if (const auto groupedId = data.vgrouped_id()) {
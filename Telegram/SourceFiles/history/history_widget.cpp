@@ -106,6 +106,9 @@ namespace {
 constexpr auto kMessagesPerPageFirst = 30;
 constexpr auto kMessagesPerPage = 50;
 constexpr auto kPreloadHeightsCount = 3; // when 3 screens to scroll left make a preload request
+constexpr auto kPreloadTimeToReach = crl::time(1000); // slice request time
+constexpr auto kPreloadPredictedHeightsMax = 20;
+constexpr auto kScrollVelocityTimeout = crl::time(200);
 constexpr auto kTabbedSelectorToggleTooltipTimeoutMs = 3000;
 constexpr auto kTabbedSelectorToggleTooltipCount = 3;
 constexpr auto kScrollToVoiceAfterScrolledMs = 1000;
@@ -1733,7 +1736,6 @@ void HistoryWidget::showHistory(
 	_replyEditMsg = nullptr;
 	_editMsgId = _replyToId = 0;
 	_previewData = nullptr;
-	_previewCache.clear();
 	_fieldBarCancel->hide();
 
 	_membersDropdownShowTimer.stop();
@@ -1787,6 +1789,7 @@ void HistoryWidget::showHistory(
 
 		_history = _peer->owner().history(_peer);
 		_migrated = _history->migrateFrom();
+		_history->owner().registerHistoryShown(_history);
 		if (_migrated
 			&& !_migrated->isEmpty()
 			&& (!_history->loadedAtTop() || !_migrated->loadedAtBottom())) {
@@ -2725,16 +2728,31 @@ void HistoryWidget::preloadHistoryIfNeeded() {
 	}
 
 	updateHistoryDownVisibility();
+
+	const auto now = crl::now();
+	const auto scrollTop = _scroll->scrollTop();
+	if (scrollTop != _lastScrollTop) {
+		const auto elapsed = now - _lastScrolled;
+		_scrollVelocity = (elapsed > 0 && elapsed < kScrollVelocityTimeout)
+			? (float64(scrollTop - _lastScrollTop) / elapsed)
+			: 0.;
+		_lastScrolled = now;
+		_lastScrollTop = scrollTop;
+	}
+
 	if (!_scrollToAnimation.animating()) {
 		preloadHistoryByScroll();
 		checkReplyReturns();
 	}
+}
 
-	auto scrollTop = _scroll->scrollTop();
-	if (scrollTop != _lastScrollTop) {
-		_lastScrolled = crl::now();
-		_lastScrollTop = scrollTop;
+int HistoryWidget::predictedScrollDistance() const {
+	if (_lastScrolled + kScrollVelocityTimeout <= crl::now()) {
+		return 0;
 	}
+	const auto limit = kPreloadPredictedHeightsMax * _scroll->height();
+	const auto distance = int(std::round(_scrollVelocity * kPreloadTimeToReach));
+	return std::clamp(distance, -limit, limit);
 }
 
 void HistoryWidget::preloadHistoryByScroll() {
@@ -2745,10 +2763,17 @@ void HistoryWidget::preloadHistoryByScroll() {
 	auto scrollTop = _scroll->scrollTop();
 	auto scrollTopMax = _scroll->scrollTopMax();
 	auto scrollHeight = _scroll->height();
-	if (scrollTop + kPreloadHeightsCount * scrollHeight >= scrollTopMax) {
+
+	// Request the next slice while a fast scroll would still need
+	// more time to reach the end of the loaded messages than it takes.
+	const auto predicted = predictedScrollDistance();
+	const auto aheadDown = std::max(predicted, 0);
+	const auto aheadUp = std::max(-predicted, 0);
+	if (scrollTop + kPreloadHeightsCount * scrollHeight + aheadDown
+		>= scrollTopMax) {
 		loadMessagesDown();
 	}
-	if (scrollTop <= kPreloadHeightsCount * scrollHeight) {
+	if (scrollTop <= kPreloadHeightsCount * scrollHeight + aheadUp) {
 		loadMessages();
 	}
 }
@@ -4445,6 +4470,18 @@ void HistoryWidget::sendFileConfirmed(
 		const std::shared_ptr<FileLoadResult> &file,
 		const std::optional<FullMsgId> &oldId) {
 	const auto isEditing = oldId.has_value();
+	if (!isEditing && !file->contentKey.isEmpty()) {
+		auto message = Api::MessageToSend(
+			session().data().history(file->to.peer));
+		message.textWithTags = file->caption;
+		message.action.options = file->to.options;
+		message.action.replyTo = file->to.replyTo;
+		if (session().api().sendAsSentDocument(
+				file->contentKey,
+				std::move(message))) {
+			return;
+		}
+	}
 	const auto channelId = peerToChannel(file->to.peer);
 	const auto lastKeyboardUsed = lastForceReplyReplied(FullMsgId(
 		channelId,
@@ -4603,6 +4640,12 @@ void HistoryWidget::sendFileConfirmed(
 				mtpMessage,
 				clientFlags,
 				NewMessageType::Unread);
+			if (!file->contentKey.isEmpty()) {
+				session().api().rememberSentDocument(
+					file->contentKey,
+					session().data().document(file->id),
+					newId);
+			}
 		}
 	} else if (file->type == SendMediaType::Audio) {
 		if (!peer->isChannel() || peer->isMegagroup()) {
@@ -6098,16 +6141,17 @@ void HistoryWidget::checkPreview() {
 				previewCancel();
 			}
 		} else {
-			const auto i = _previewCache.constFind(_previewLinks);
-			if (i == _previewCache.cend()) {
+			const auto cached = session().data().webpageByLinks(
+				_previewLinks);
+			if (!cached) {
 				_previewRequest = MTP::send(
 					MTPmessages_GetWebPagePreview(
 						MTP_flags(0),
 						MTP_string(_previewLinks),
 						MTPVector<MTPMessageEntity>()),
 					rpcDone(&HistoryWidget::gotPreview, _previewLinks));
-			} else if (i.value()) {
-				_previewData = session().data().webpage(i.value());
+			} else if (*cached) {
+				_previewData = session().data().webpage(*cached);
 				updatePreview();
 			} else {
 				if (_previewData && _previewData->pendingTill >= 0) previewCancel();
@@ -6137,7 +6181,7 @@ void HistoryWidget::gotPreview(QString links, const MTPMessageMedia &result, mtp
 	if (result.type() == mtpc_messageMediaWebPage) {
 		const auto &data = result.c_messageMediaWebPage().vwebpage();
 		const auto page = session().data().processWebpage(data);
-		_previewCache.insert(links, page->id);
+		session().data().rememberWebpageByLinks(links, page->id);
 		if (page->pendingTill > 0 && page->pendingTill <= base::unixtime::now()) {
 			page->pendingTill = -1;
 		}
@@ -6149,7 +6193,7 @@ void HistoryWidget::gotPreview(QString links, const MTPMessageMedia &result, mtp
 		}
 		session().data().sendWebPageGamePollNotifications();
 	} else if (result.type() == mtpc_messageMediaEmpty) {
-		_previewCache.insert(links, 0);
+		session().data().rememberWebpageByLinks(links, 0);
 		if (links == _previewLinks && !_previewCancelled) {
 			_previewData = nullptr;
 			updatePreview();
@@ -612,6 +612,7 @@ private:
 	int countInitialScrollTop();
 	int countAutomaticScrollTop();
 	void preloadHistoryByScroll();
+	[[nodiscard]] int predictedScrollDistance() const;
 	void checkReplyReturns();
 	void scrollToAnimationCallback(FullMsgId attachToId, int relativeTo);
 
@@ -659,8 +660,6 @@ private:
 	QStringList _parsedLinks;
 	QString _previewLinks;
 	WebPageData *_previewData = nullptr;
-	typedef QMap<QString, WebPageId> PreviewCache;
-	PreviewCache _previewCache;
 	mtpRequestId _previewRequest = 0;
 	Ui::Text::String _previewTitle;
 	Ui::Text::String _previewDescription;
@@ -698,6 +697,7 @@ private:
 
 	int _lastScrollTop = 0; // gifs optimization
 	crl::time _lastScrolled = 0;
+	float64 _scrollVelocity = 0.; // px per ms, negative when scrolling up
 	QTimer _updateHistoryItems;
 
 	crl::time _lastUserScrolled = 0;
@@ -31,6 +31,9 @@ namespace {
 // A new message from the same sender is attached to previous within 15 minutes.
 constexpr int kAttachMessageToPreviousSecondsDelta = 900;
 
+// Less layouts are counted faster than the worker threads are woken up.
+constexpr auto kMinTextLayoutsInChunk = 32;
+
 bool IsAttachedToPreviousInSavedMessages(
 		not_null<HistoryItem*> previous,
 		not_null<HistoryItem*> item) {
@@ -52,6 +55,33 @@ bool IsAttachedToPreviousInSavedMessages(
 
 } // namespace
 
+void CountTextLayouts(const std::vector<TextLayoutTask> &tasks) {
+	const auto count = int(tasks.size());
+	const auto threads = std::max(QThread::idealThreadCount(), 1);
+	const auto chunks = std::clamp(
+		count / kMinTextLayoutsInChunk,
+		1,
+		threads);
+	const auto perChunk = (count + chunks - 1) / chunks;
+	const auto countChunk = [&](int index) {
+		const auto from = std::min(index * perChunk, count);
+		const auto till = std::min(from + perChunk, count);
+		for (auto i = from; i != till; ++i) {
+			tasks[i].text->countHeight(tasks[i].width);
+		}
+	};
+	crl::semaphore semaphore;
+	for (auto i = 1; i != chunks; ++i) {
+		crl::async([=, &semaphore] {
+			countChunk(i);
+			semaphore.release();
+		});
+	}
+	countChunk(0);
+	for (auto i = 1; i != chunks; ++i) {
+		semaphore.acquire();
+	}
+}
 
 std::unique_ptr<HistoryView::Element> SimpleElementDelegate::elementCreate(
 		not_null<HistoryMessage*> message) {
@@ -593,6 +623,11 @@ bool Element::hasVisibleText() const {
 	return false;
 }
 
+auto Element::textLayoutTask(int newWidth) const
+-> std::optional<TextLayoutTask> {
+	return std::nullopt;
+}
+
 void Element::unloadHeavyPart() {
 	if (_media) {
 		_media->unloadHeavyPart();
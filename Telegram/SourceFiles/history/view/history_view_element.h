@@ -16,6 +16,12 @@ class HistoryItem;
 class HistoryMessage;
 class HistoryService;
 
+namespace Ui {
+namespace Text {
+class String;
+} // namespace Text
+} // namespace Ui
+
 namespace HistoryView {
 
 enum class PointState : char;
@@ -31,6 +37,17 @@ enum class Context : char {
 	ContactPreview
 };
 
+// Line breaking of a message text for some width, it doesn't depend
+// on anything but the text itself, so it may be counted on any thread.
+struct TextLayoutTask {
+	not_null<const Ui::Text::String*> text;
+	int width = 0;
+};
+
+// Counts the layouts in the worker threads, returns when all are ready.
+// Afterwards the resize on the main thread finds them in the text cache.
+void CountTextLayouts(const std::vector<TextLayoutTask> &tasks);
+
 class Element;
 class ElementDelegate {
 public:
@@ -256,6 +273,10 @@ public:
 	virtual TimeId displayedEditDate() const;
 	virtual bool hasVisibleText() const;
 
+	// The text layout resizeGetHeight(newWidth) is going to count.
+	[[nodiscard]] virtual std::optional<TextLayoutTask> textLayoutTask(
+		int newWidth) const;
+
 	virtual void unloadHeavyPart();
 
 	// Legacy blocks structure.
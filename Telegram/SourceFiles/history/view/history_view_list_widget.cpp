@@ -1198,6 +1198,15 @@ int ListWidget::resizeGetHeight(int newWidth) {
 	update();
 
 	const auto resizeAllItems = (_itemsWidth != newWidth);
+	if (resizeAllItems) {
+		auto tasks = std::vector<TextLayoutTask>();
+		for (const auto &view : _items) {
+			if (const auto task = view->textLayoutTask(newWidth)) {
+				tasks.push_back(*task);
+			}
+		}
+		CountTextLayouts(tasks);
+	}
 	auto newHeight = 0;
 	for (auto &view : _items) {
 		view->setY(newHeight);
@@ -2385,7 +2394,14 @@ void ListWidget::repaintItem(const Element *view) {
 	if (!view) {
 		return;
 	}
-	update(0, itemTop(view), width(), view->height());
+
+	// Repaint only the visible part, the rest is painted when scrolled to.
+	const auto top = itemTop(view);
+	const auto from = std::max(top, _visibleTop);
+	const auto till = std::min(top + view->height(), _visibleBottom);
+	if (from < till) {
+		update(0, from, width(), till - from);
+	}
 }
 
 void ListWidget::repaintItem(FullMsgId itemId) {
@@ -1759,6 +1759,39 @@ bool Message::hasVisibleText() const {
 	return !media || !media->hideMessageText();
 }
 
+auto Message::textLayoutTask(int newWidth) const
+-> std::optional<TextLayoutTask> {
+	if (pendingResize()
+		|| isHidden()
+		|| newWidth < st::msgMinWidth
+		|| !drawBubble()
+		|| !hasVisibleText()) {
+		return std::nullopt;
+	}
+	const auto media = this->media();
+	if (media && media->isDisplayed()) {
+		// The text width depends on the media, it is resized serially.
+		return std::nullopt;
+	}
+
+	// This code duplicates resizeContentGetHeight() for text-only messages.
+	auto contentWidth = newWidth - (st::msgMargin.left() + st::msgMargin.right());
+	if (hasFromPhoto() && displayRightAction()) {
+		contentWidth -= st::msgPhotoSkip;
+	}
+	accumulate_min(contentWidth, maxWidth());
+	accumulate_min(contentWidth, st::msgMaxWidth);
+	if (contentWidth == maxWidth()) {
+		return std::nullopt;
+	}
+	const auto item = message();
+	const auto textWidth = qMax(contentWidth - st::msgPadding.left() - st::msgPadding.right(), 1);
+	if (textWidth == item->_textWidth) {
+		return std::nullopt;
+	}
+	return TextLayoutTask{ &item->_text, textWidth };
+}
+
 QSize Message::performCountCurrentSize(int newWidth) {
 	const auto item = message();
 	const auto newHeight = resizeContentGetHeight(newWidth);
@@ -138,6 +138,8 @@ private:
 	QSize performCountOptimalSize() override;
 	QSize performCountCurrentSize(int newWidth) override;
 	bool hasVisibleText() const override;
+	std::optional<TextLayoutTask> textLayoutTask(
+		int newWidth) const override;
 
 	bool displayFastShare() const;
 	bool displayGoToOriginal() const;
@@ -225,6 +225,10 @@ public:
 	}
 	virtual void parentTextUpdated() {
 	}
+	// Returns false if the changed data requires a resize.
+	[[nodiscard]] virtual bool applyDataChangesInPlace() {
+		return false;
+	}
 
 	virtual ~Media() = default;
 
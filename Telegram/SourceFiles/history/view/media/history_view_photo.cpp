@@ -165,7 +165,7 @@ void Photo::draw(Painter &p, const QRect &r, TextSelection selection, crl::time
 	auto rthumb = rtlrect(paintx, painty, paintw, painth, width());
 	if (_serviceWidth > 0) {
 		const auto pix = [&] {
-			if (loaded) {
+			if (loaded || _data->large()->loadedProgressive()) {
 				return _data->large()->pixCircled(_realParent->fullId(), _pixw, _pixh);
 			} else if (_data->thumbnail()->loaded()) {
 				return _data->thumbnail()->pixBlurredCircled(_realParent->fullId(), _pixw, _pixh);
@@ -195,7 +195,7 @@ void Photo::draw(Painter &p, const QRect &r, TextSelection selection, crl::time
 		auto roundCorners = inWebPage ? RectPart::AllCorners : ((isBubbleTop() ? (RectPart::TopLeft | RectPart::TopRight) : RectPart::None)
 			| ((isBubbleBottom() && _caption.isEmpty()) ? (RectPart::BottomLeft | RectPart::BottomRight) : RectPart::None));
 		const auto pix = [&] {
-			if (loaded) {
+			if (loaded || _data->large()->loadedProgressive()) {
 				return _data->large()->pixSingle(_realParent->fullId(), _pixw, _pixh, paintw, painth, roundRadius, roundCorners);
 			} else if (_data->thumbnail()->loaded()) {
 				return _data->thumbnail()->pixBlurredSingle(_realParent->fullId(), _pixw, _pixh, paintw, painth, roundRadius, roundCorners);
@@ -294,6 +294,7 @@ void Poll::updateTexts() {
 		return;
 	}
 	_pollVersion = _poll->version;
+	_pollLayoutVersion = _poll->layoutVersion;
 
 	const auto willStartAnimation = checkAnimationStart();
 
@@ -318,6 +319,16 @@ void Poll::updateTexts() {
 	}
 }
 
+bool Poll::applyDataChangesInPlace() {
+	if (_pollLayoutVersion != _poll->layoutVersion) {
+		return false;
+	}
+
+	// Only the results changed, the bars animate without a relayout.
+	updateTexts();
+	return true;
+}
+
 void Poll::updateAnswers() {
 	const auto changed = !ranges::equal(
 		_answers,
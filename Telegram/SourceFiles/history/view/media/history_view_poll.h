@@ -40,6 +40,8 @@ public:
 		const ClickHandlerPtr &handler,
 		bool pressed) override;
 
+	bool applyDataChangesInPlace() override;
+
 	~Poll();
 
 private:
@@ -117,6 +119,7 @@ private:
 
 	not_null<PollData*> _poll;
 	int _pollVersion = 0;
+	int _pollLayoutVersion = 0;
 	int _totalVotes = 0;
 	bool _voted = false;
 	bool _closed = false;
@@ -16,6 +16,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/view/history_view_cursor_state.h"
 #include "history/view/media/history_view_media_common.h"
 #include "ui/image/image.h"
+#include "ui/image/image_prepare.h"
 #include "ui/emoji_config.h"
 #include "main/main_session.h"
 #include "main/main_app_config.h"
@@ -29,10 +30,68 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace HistoryView {
 namespace {
 
+// Lottie::FrameRenderer frames together with the one being shown.
+constexpr auto kLottieFramesInMemory = 5;
+
 double GetEmojiStickerZoom(not_null<Main::Session*> session) {
 	return session->appConfig().get<double>("emojies_animated_zoom", 0.625);
 }
 
+// Big emoji of the same document and size share one player.
+using SharedEmojiKey = std::tuple<
+	not_null<DocumentData*>,
+	const Lottie::ColorReplacements*,
+	QSize>;
+
+struct SharedEmojiKeyCompare {
+	bool operator()(const SharedEmojiKey &a, const SharedEmojiKey &b) const {
+		const auto &[aDocument, aReplacements, aSize] = a;
+		const auto &[bDocument, bReplacements, bSize] = b;
+		return std::make_tuple(
+			aDocument.get(),
+			aReplacements,
+			aSize.width(),
+			aSize.height()
+		) < std::make_tuple(
+			bDocument.get(),
+			bReplacements,
+			bSize.width(),
+			bSize.height());
+	}
+};
+
+std::map<
+	SharedEmojiKey,
+	std::weak_ptr<Lottie::SinglePlayer>,
+	SharedEmojiKeyCompare> SharedEmojiPlayers;
+
+std::shared_ptr<Lottie::SinglePlayer> SharedEmojiPlayer(
+		not_null<DocumentData*> document,
+		const Lottie::ColorReplacements *replacements,
+		QSize box) {
+	const auto key = SharedEmojiKey(document, replacements, box);
+	auto &weak = SharedEmojiPlayers[key];
+	if (auto result = weak.lock()) {
+		return result;
+	}
+	for (auto i = begin(SharedEmojiPlayers); i != end(SharedEmojiPlayers);) {
+		if (i->second.expired() && i->first != key) {
+			i = SharedEmojiPlayers.erase(i);
+		} else {
+			++i;
+		}
+	}
+	auto result = std::shared_ptr<Lottie::SinglePlayer>(
+		Stickers::LottiePlayerFromDocument(
+			document,
+			replacements,
+			Stickers::LottieSize::MessageHistory,
+			box,
+			Lottie::Quality::High));
+	weak = result;
+	return result;
+}
+
 } // namespace
 
 Sticker::Sticker(
@@ -43,6 +102,13 @@ Sticker::Sticker(
 , _document(document)
 , _replacements(replacements) {
 	_document->loadThumbnail(parent->data()->fullId());
+	if (const auto sticker = _document->sticker(); sticker && sticker->animated) {
+		// Read the first frame from cache as soon as the message is
+		// created, so it is there until the lottie player is ready.
+		if (const auto good = _document->goodThumbnail()) {
+			good->load({});
+		}
+	}
 }
 
 Sticker::~Sticker() {
@@ -90,20 +156,27 @@ void Sticker::draw(Painter &p, const QRect &r, bool selected) {
 }
 
 void Sticker::paintLottie(Painter &p, const QRect &r, bool selected) {
+	const auto shared = isEmojiSticker();
 	auto request = Lottie::FrameRequest();
 	request.box = _size * cIntRetinaFactor();
-	if (selected) {
+	if (selected && !shared) {
 		request.colored = st::msgStickerOverlay->c;
 	}
 	const auto frame = _lottie->frameInfo(request);
+	_parent->data()->history()->owner().heavyViewPartShown(_parent);
 	const auto size = frame.image.size() / cIntRetinaFactor();
+
+	// A shared player keeps one request for all views,
+	// so the selected one is colored only for this paint.
 	p.drawImage(
 		QRect(
 			QPoint(
 				r.x() + (r.width() - size.width()) / 2,
 				r.y() + (r.height() - size.height()) / 2),
 			size),
-		frame.image);
+		(selected && shared)
+			? Images::prepareColored(st::msgStickerOverlay, frame.image)
+			: frame.image);
 
 	const auto paused = App::wnd()->sessionController()->isGifPausedAtLeastFor(Window::GifPauseReason::Any);
 	const auto playOnce = isEmojiSticker()
@@ -185,13 +258,24 @@ void Sticker::refreshLink() {
 }
 
 void Sticker::setupLottie() {
-	_lottie = Stickers::LottiePlayerFromDocument(
-		_document,
-		_replacements,
-		Stickers::LottieSize::MessageHistory,
-		_size * cIntRetinaFactor(),
-		Lottie::Quality::High);
-	_parent->data()->history()->owner().registerHeavyViewPart(_parent);
+	_lottie = isEmojiSticker()
+		? SharedEmojiPlayer(
+			_document,
+			_replacements,
+			_size * cIntRetinaFactor())
+		: std::shared_ptr<Lottie::SinglePlayer>(
+			Stickers::LottiePlayerFromDocument(
+				_document,
+				_replacements,
+				Stickers::LottieSize::MessageHistory,
+				_size * cIntRetinaFactor(),
+				Lottie::Quality::High));
+
+	// The player keeps a few frames of this size at once.
+	const auto size = _size * cIntRetinaFactor();
+	_parent->data()->history()->owner().registerHeavyViewPart(
+		_parent,
+		int64(size.width()) * size.height() * 4 * kLottieFramesInMemory);
 
 	_lottie->updates(
 	) | rpl::start_with_next([=](Lottie::Update update) {
@@ -208,6 +292,7 @@ void Sticker::unloadLottie() {
 		return;
 	}
 	_lottie = nullptr;
+	_lifetime.destroy();
 	_parent->data()->history()->owner().unregisterHeavyViewPart(_parent);
 }
 
@@ -60,7 +60,7 @@ private:
 	const not_null<Element*> _parent;
 	const not_null<DocumentData*> _document;
 	const Lottie::ColorReplacements *_replacements = nullptr;
-	std::unique_ptr<Lottie::SinglePlayer> _lottie;
+	std::shared_ptr<Lottie::SinglePlayer> _lottie;
 	ClickHandlerPtr _link;
 	QSize _size;
 	mutable bool _lottieOncePlayed = false;
@@ -47,6 +47,7 @@ constexpr auto kPreloadIfLessThanScreens = 2;
 constexpr auto kPreloadedScreensCountFull
 	= kPreloadedScreensCount + 1 + kPreloadedScreensCount;
 constexpr auto kMediaCountForSearch = 10;
+constexpr auto kPrefetchScreensCount = 2;
 
 UniversalMsgId GetUniversalId(FullMsgId itemId) {
 	return (itemId.channel != 0)
@@ -116,6 +117,7 @@ public:
 		const Context &context,
 		QRect clip,
 		int outerWidth) const;
+	void preload(int fromTop, int tillBottom) const;
 
 	static int MinItemHeight(Type type, int width);
 
@@ -357,6 +359,14 @@ auto ListWidget::Section::findItemAfterBottom(
 		});
 }
 
+void ListWidget::Section::preload(int fromTop, int tillBottom) const {
+	const auto fromIt = findItemAfterTop(fromTop);
+	const auto tillIt = findItemAfterBottom(fromIt, tillBottom);
+	for (auto it = fromIt; it != tillIt; ++it) {
+		it->second->preload();
+	}
+}
+
 void ListWidget::Section::paint(
 		Painter &p,
 		const Context &context,
@@ -1021,10 +1031,28 @@ auto ListWidget::foundItemInSection(
 void ListWidget::visibleTopBottomUpdated(
 		int visibleTop,
 		int visibleBottom) {
+	const auto scrolledUp = (visibleTop < _visibleTop);
 	_visibleTop = visibleTop;
 	_visibleBottom = visibleBottom;
 
 	checkMoveToOtherViewer();
+	preloadInScrollDirection(scrolledUp);
+}
+
+void ListWidget::preloadInScrollDirection(bool up) {
+	const auto visibleHeight = (_visibleBottom - _visibleTop);
+	if (visibleHeight <= 0 || _sections.empty()) {
+		return;
+	}
+	const auto distance = kPrefetchScreensCount * visibleHeight;
+	const auto from = up ? (_visibleTop - distance) : _visibleBottom;
+	const auto till = up ? _visibleTop : (_visibleBottom + distance);
+	const auto fromSectionIt = findSectionAfterTop(from);
+	const auto tillSectionIt = findSectionAfterBottom(fromSectionIt, till);
+	for (auto it = fromSectionIt; it != tillSectionIt; ++it) {
+		const auto top = it->top();
+		it->preload(from - top, till - top);
+	}
 }
 
 void ListWidget::checkMoveToOtherViewer() {
@@ -229,6 +229,7 @@ private:
 	void clearStaleLayouts();
 	std::vector<Section>::iterator findSectionByItem(
 		UniversalMsgId universalId);
+	void preloadInScrollDirection(bool up);
 	std::vector<Section>::iterator findSectionAfterTop(int top);
 	std::vector<Section>::const_iterator findSectionAfterTop(
 		int top) const;
@@ -41,6 +41,7 @@ namespace internal {
 namespace {
 
 constexpr auto kInlineBotRequestDelay = 400;
+constexpr auto kInlineCacheMaxEntries = 64;
 
 } // namespace
 
@@ -1054,6 +1055,9 @@ void Widget::inlineResultsDone(const MTPmessages_BotResults &result) {
 
 		if (it == _inlineCache.cend()) {
 			it = _inlineCache.emplace(_inlineQuery, std::make_unique<internal::CacheEntry>()).first;
+			it->second->validTill = crl::now()
+				+ d.vcache_time().v * crl::time(1000);
+			clearInlineCacheOverflow();
 		}
 		auto entry = it->second.get();
 		entry->nextOffset = qs(d.vnext_offset().value_or_empty());
@@ -1103,6 +1107,14 @@ void Widget::queryInlineBot(UserData *bot, PeerData *peer, QString query) {
 			_inlineRequestId = 0;
 			Notify::inlineBotRequesting(false);
 		}
+		const auto i = _inlineCache.find(query);
+		if (i != _inlineCache.cend()
+			&& i->second->validTill <= crl::now()
+			&& i->first != _inlineQuery) {
+			// Results of the shown query are used by the rows till the
+			// next ones are received, only other entries are removed.
+			_inlineCache.erase(i);
+		}
 		if (_inlineCache.find(query) != _inlineCache.cend()) {
 			_inlineRequestTimer.stop();
 			_inlineQuery = _inlineNextQuery = query;
@@ -1136,6 +1148,23 @@ void Widget::onInlineRequest() {
 	}).handleAllErrors().send();
 }
 
+void Widget::clearInlineCacheOverflow() {
+	while (_inlineCache.size() > internal::kInlineCacheMaxEntries) {
+		auto oldest = _inlineCache.end();
+		for (auto i = _inlineCache.begin(); i != _inlineCache.end(); ++i) {
+			if (i->first != _inlineQuery
+				&& (oldest == _inlineCache.end()
+					|| i->second->lastUsed < oldest->second->lastUsed)) {
+				oldest = i;
+			}
+		}
+		if (oldest == _inlineCache.end()) {
+			return;
+		}
+		_inlineCache.erase(oldest);
+	}
+}
+
 void Widget::onEmptyInlineRows() {
 	hideAnimated();
 	_inner->clearInlineRowsPanel();
@@ -1145,6 +1174,7 @@ bool Widget::refreshInlineRows(int *added) {
 	auto it = _inlineCache.find(_inlineQuery);
 	const internal::CacheEntry *entry = nullptr;
 	if (it != _inlineCache.cend()) {
+		it->second->lastUsed = crl::now();
 		if (!it->second->results.empty() || !it->second->switchPmText.isEmpty()) {
 			entry = it->second.get();
 		}
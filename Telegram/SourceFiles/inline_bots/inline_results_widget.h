@@ -47,6 +47,8 @@ struct CacheEntry {
 	QString nextOffset;
 	QString switchPmText, switchPmStartToken;
 	Results results;
+	crl::time validTill = 0;
+	crl::time lastUsed = 0;
 };
 
 class Inner
@@ -241,6 +243,7 @@ private:
 	void recountContentMaxHeight();
 	bool refreshInlineRows(int *added = nullptr);
 	void inlineResultsDone(const MTPmessages_BotResults &result);
+	void clearInlineCacheOverflow();
 
 	not_null<Window::SessionController*> _controller;
 
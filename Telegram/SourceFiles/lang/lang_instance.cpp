@@ -243,6 +243,7 @@ struct Instance::PrivateTag {
 
 Instance::Instance()
 : _values(PrepareDefaultValues())
+, _pendingValues(kKeysCount)
 , _nonDefaultSet(kKeysCount, 0) {
 }
 
@@ -302,6 +303,7 @@ void Instance::reset(const Language &data) {
 	for (auto i = 0, count = int(_values.size()); i != count; ++i) {
 		_values[i] = GetOriginalValue(ushort(i));
 	}
+	ranges::fill(_pendingValues, PendingValue());
 	ranges::fill(_nonDefaultSet, 0);
 
 	_idChanges.fire_copy(_id);
@@ -702,14 +704,43 @@ QString Instance::getNonDefaultValue(const QByteArray &key) const {
 
 void Instance::applyValue(const QByteArray &key, const QByteArray &value) {
 	_nonDefaultValues[key] = value;
-	ParseKeyValue(key, value, [&](ushort key, QString &&value) {
-		_nonDefaultSet[key] = 1;
+	const auto index = GetKeyIndex(QLatin1String(key));
+	if (index != kKeysCount) {
+		_nonDefaultSet[index] = 1;
 		if (!_derived) {
-			_values[key] = std::move(value);
-		} else if (!_derived->_nonDefaultSet[key]) {
-			_derived->_values[key] = std::move(value);
+			setPendingValue(index, { key, value });
+		} else if (!_derived->_nonDefaultSet[index]) {
+			_derived->setPendingValue(index, { key, value });
 		}
-	});
+	} else if (!key.startsWith("cloud_")) {
+		DEBUG_LOG(("Lang Warning: Unknown key '%1'"
+			).arg(QString::fromLatin1(key)));
+	}
+}
+
+void Instance::setPendingValue(ushort key, PendingValue &&value) {
+	Expects(!_derived);
+	Expects(!value.key.isEmpty());
+
+	_pendingValues[key] = std::move(value);
+}
+
+void Instance::materializeValue(ushort key) const {
+	const auto pending = base::take(_pendingValues[key]);
+	ValueParser parser(pending.key, key, pending.value);
+	if (parser.parse()) {
+		_values[key] = parser.takeResult();
+		return;
+	} else if (!_base) {
+		return;
+	}
+	const auto i = _base->_nonDefaultValues.find(pending.key);
+	if (i != end(_base->_nonDefaultValues)) {
+		ValueParser parser(pending.key, key, i->second);
+		if (parser.parse()) {
+			_values[key] = parser.takeResult();
+		}
+	}
 }
 
 void Instance::updatePluralRules() {
@@ -736,8 +767,10 @@ void Instance::resetValue(const QByteArray &key) {
 			_values[keyIndex] = !base.isEmpty()
 				? base
 				: GetOriginalValue(keyIndex);
+			_pendingValues[keyIndex] = PendingValue();
 		} else if (!_derived->_nonDefaultSet[keyIndex]) {
 			_derived->_values[keyIndex] = GetOriginalValue(keyIndex);
+			_derived->_pendingValues[keyIndex] = PendingValue();
 		}
 	}
 }
@@ -86,6 +86,9 @@ public:
 	QString getValue(ushort key) const {
 		Expects(key < _values.size());
 
+		if (!_pendingValues[key].key.isEmpty()) {
+			materializeValue(key);
+		}
 		return _values[key];
 	}
 	QString getNonDefaultValue(const QByteArray &key) const;
@@ -102,6 +105,15 @@ public:
 	}
 
 private:
+	// Values read from the cache or the server are parsed on first use.
+	struct PendingValue {
+		QByteArray key;
+		QByteArray value;
+	};
+
+	void materializeValue(ushort key) const;
+	void setPendingValue(ushort key, PendingValue &&value);
+
 	void setBaseId(const QString &baseId, const QString &pluralId);
 
 	void applyDifferenceToMe(const MTPDlangPackDifference &difference);
@@ -133,7 +145,8 @@ private:
 
 	mutable QString _systemLanguage;
 
-	std::vector<QString> _values;
+	mutable std::vector<QString> _values;
+	mutable std::vector<PendingValue> _pendingValues;
 	std::vector<uchar> _nonDefaultSet;
 	std::map<QByteArray, QByteArray> _nonDefaultValues;
 
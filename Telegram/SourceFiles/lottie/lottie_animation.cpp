@@ -15,6 +15,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "logs.h"
 
 #include <QFile>
+#include <QMutex>
 #include <rlottie.h>
 #include <crl/crl_async.h>
 #include <crl/crl_on_main.h>
@@ -24,6 +25,32 @@ namespace {
 
 const auto kIdealSize = QSize(512, 512);
 
+// Same stickers are often shown in several places at once.
+constexpr auto kParsedCacheLimit = 16;
+
+struct ParsedAnimation {
+	QByteArray content;
+	const ColorReplacements *replacements = nullptr;
+	std::unique_ptr<rlottie::Animation> animation;
+};
+
+QMutex ParsedMutex;
+std::deque<ParsedAnimation> Parsed; // Most recently used are at the end.
+
+std::unique_ptr<rlottie::Animation> TakeParsed(
+		const QByteArray &content,
+		const ColorReplacements *replacements) {
+	QMutexLocker lock(&ParsedMutex);
+	for (auto i = Parsed.rbegin(); i != Parsed.rend(); ++i) {
+		if (i->replacements == replacements && i->content == content) {
+			auto result = std::move(i->animation);
+			Parsed.erase(std::next(i).base());
+			return result;
+		}
+	}
+	return nullptr;
+}
+
 std::string UnpackGzip(const QByteArray &bytes) {
 	const auto original = [&] {
 		return std::string(bytes.constData(), bytes.size());
@@ -89,6 +116,8 @@ details::InitData Init(
 	auto animation = details::CreateFromContent(content, replacements);
 	return animation
 		? CheckSharedState(std::make_unique<SharedState>(
+			content,
+			replacements,
 			std::move(animation),
 			request.empty() ? FrameRequest{ kIdealSize } : request,
 			quality))
@@ -109,7 +138,7 @@ details::InitData Init(
 	}
 	auto cache = std::make_unique<Cache>(cached, request, std::move(put));
 	const auto prepare = !cache->framesCount()
-		|| (cache->framesReady() < cache->framesCount());
+		|| !cache->canRenderAllFrames();
 	auto animation = prepare
 		? details::CreateFromContent(content, replacements)
 		: nullptr;
@@ -131,6 +160,9 @@ namespace details {
 std::unique_ptr<rlottie::Animation> CreateFromContent(
 		const QByteArray &content,
 		const ColorReplacements *replacements) {
+	if (auto parsed = TakeParsed(content, replacements)) {
+		return parsed;
+	}
 	const auto string = UnpackGzip(content);
 	Assert(string.size() <= kMaxFileSize);
 
@@ -148,6 +180,22 @@ std::unique_ptr<rlottie::Animation> CreateFromContent(
 	return result;
 }
 
+void CacheParsed(
+		const QByteArray &content,
+		const ColorReplacements *replacements,
+		std::unique_ptr<rlottie::Animation> animation) {
+	Expects(animation != nullptr);
+
+	// Destroy the evicted animation after the mutex is unlocked.
+	auto evicted = ParsedAnimation();
+	QMutexLocker lock(&ParsedMutex);
+	Parsed.push_back({ content, replacements, std::move(animation) });
+	if (Parsed.size() > kParsedCacheLimit) {
+		evicted = std::move(Parsed.front());
+		Parsed.pop_front();
+	}
+}
+
 } // namespace details
 
 std::shared_ptr<FrameRenderer> MakeFrameRenderer() {
@@ -37,6 +37,12 @@ std::unique_ptr<rlottie::Animation> CreateFromContent(
 	const QByteArray &content,
 	const ColorReplacements *replacements);
 
+// Keeps a parsed animation for reuse by the next CreateFromContent().
+void CacheParsed(
+	const QByteArray &content,
+	const ColorReplacements *replacements,
+	std::unique_ptr<rlottie::Animation> animation);
+
 } // namespace details
 
 class Animation final : public base::has_weak_ptr {
@@ -0,0 +1,273 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "lottie/lottie_animation.h"
+#include "lottie/lottie_cache.h"
+#include "lottie/lottie_common.h"
+#include "logs.h"
+#include <crl/crl.h>
+#include <rlottie.h>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtGui/QColor>
+#include <QtGui/QImage>
+#include <iostream>
+#include <iomanip>
+
+// lib_lottie logs through the application, the benchmark just drops it.
+namespace Logs {
+
+bool DebugEnabled() {
+	return false;
+}
+
+bool started() {
+	return false;
+}
+
+void writeMain(const QString &v) {
+}
+
+void writeDebug(const char *file, int32 line, const QString &v) {
+}
+
+} // namespace Logs
+
+// Colored frames are not requested here.
+namespace Images {
+
+QImage prepareColored(QColor add, QImage image) {
+	return image;
+}
+
+} // namespace Images
+
+using namespace Lottie;
+
+namespace {
+
+// Run with LOTTIE_BENCHMARK_CORPUS=<folder with .tgs files>.
+constexpr auto kCorpusVariable = "LOTTIE_BENCHMARK_CORPUS";
+
+// Cached frames of 64 KB and more are compressed with LZ4HC,
+// YUV420A4 takes two bytes per pixel, so 128x128 stays with LZ4.
+constexpr auto kLowCompressionBox = 128;
+constexpr auto kHighCompressionBox = 256;
+
+constexpr auto kImageFormat = QImage::Format_ARGB32_Premultiplied;
+
+struct Sample {
+	QString name;
+	QByteArray content;
+};
+
+struct Totals {
+	int files = 0;
+	int frames = 0;
+	int64 bytes = 0;
+	crl::profile_time parse = 0;
+	crl::profile_time render = 0;
+	crl::profile_time firstRender = 0;
+	crl::profile_time encode = 0;
+	crl::profile_time firstDecode = 0;
+	crl::profile_time decode = 0;
+};
+
+std::vector<Sample> LoadCorpus() {
+	const auto path = qEnvironmentVariable(kCorpusVariable);
+	const auto files = QDir(path).entryInfoList(
+		{ "*.tgs" },
+		QDir::Files,
+		QDir::Name);
+	auto result = std::vector<Sample>();
+	for (const auto &info : files) {
+		auto content = ReadContent(QByteArray(), info.filePath());
+		if (!content.isEmpty()) {
+			result.push_back({ info.fileName(), std::move(content) });
+		}
+	}
+	return result;
+}
+
+const std::vector<Sample> &Corpus() {
+	static const auto result = LoadCorpus();
+	return result;
+}
+
+int FrameRate(not_null<rlottie::Animation*> animation, Quality quality) {
+	const auto rate = int(qRound(animation->frameRate()));
+	return (quality == Quality::Default && rate == 60) ? (rate / 2) : rate;
+}
+
+int FramesCount(not_null<rlottie::Animation*> animation, Quality quality) {
+	const auto rate = int(qRound(animation->frameRate()));
+	const auto count = int(animation->totalFrame());
+	return (quality == Quality::Default && rate == 60) ? (count / 2) : count;
+}
+
+int FrameIndex(
+		not_null<rlottie::Animation*> animation,
+		Quality quality,
+		int index) {
+	const auto rate = int(qRound(animation->frameRate()));
+	return (quality == Quality::Default && rate == 60) ? (index * 2) : index;
+}
+
+void Render(
+		QImage &image,
+		not_null<rlottie::Animation*> animation,
+		Quality quality,
+		int index) {
+	image.fill(Qt::transparent);
+	auto surface = rlottie::Surface(
+		reinterpret_cast<uint32_t*>(image.bits()),
+		image.width(),
+		image.height(),
+		image.bytesPerLine());
+	animation->renderSync(FrameIndex(animation, quality, index), surface);
+}
+
+void Measure(Totals &totals, const Sample &sample, Quality quality, int box) {
+	const auto parseStart = crl::profile();
+	const auto animation = details::CreateFromContent(
+		sample.content,
+		nullptr);
+	const auto parse = crl::profile() - parseStart;
+	if (!animation) {
+		std::cout << "skipped " << sample.name.toStdString() << std::endl;
+		return;
+	}
+	auto width = size_t(0);
+	auto height = size_t(0);
+	animation->size(width, height);
+	const auto original = QSize(int(width), int(height));
+	const auto rate = FrameRate(animation.get(), quality);
+	const auto count = FramesCount(animation.get(), quality);
+	if (original.isEmpty() || rate <= 0 || count <= 0) {
+		std::cout << "skipped " << sample.name.toStdString() << std::endl;
+		return;
+	}
+
+	auto request = FrameRequest();
+	request.box = QSize(box, box);
+	const auto size = request.size(original);
+
+	auto cached = QByteArray();
+	auto cache = Cache(QByteArray(), request, [&](QByteArray &&data) {
+		cached = std::move(data);
+	});
+	cache.init(original, rate, count, request);
+
+	auto image = QImage(size, kImageFormat);
+	auto render = crl::profile_time(0);
+	auto firstRender = crl::profile_time(0);
+	auto encode = crl::profile_time(0);
+	for (auto i = 0; i != count; ++i) {
+		const auto renderStart = crl::profile();
+		Render(image, animation.get(), quality, i);
+		const auto encodeStart = crl::profile();
+		cache.appendFrame(image, request, i);
+		const auto encodeFinish = crl::profile();
+		render += encodeStart - renderStart;
+		encode += encodeFinish - encodeStart;
+		if (!i) {
+			firstRender = encodeStart - renderStart;
+		}
+	}
+	REQUIRE(!cached.isEmpty());
+
+	const auto decodeStart = crl::profile();
+	auto decoder = Cache(cached, request, [](QByteArray&&) {});
+	REQUIRE(decoder.renderFrame(image, request, 0));
+	const auto firstDecode = crl::profile() - decodeStart;
+	for (auto i = 1; i != count; ++i) {
+		REQUIRE(decoder.renderFrame(image, request, i));
+	}
+	const auto decode = crl::profile() - decodeStart;
+
+	++totals.files;
+	totals.frames += count;
+	totals.bytes += cached.size();
+	totals.parse += parse;
+	totals.render += render;
+	totals.firstRender += firstRender;
+	totals.encode += encode;
+	totals.firstDecode += firstDecode;
+	totals.decode += decode;
+}
+
+void ReportRate(const char *name, crl::profile_time time, int frames) {
+	const auto perSecond = time ? (int64(frames) * 1000000 / time) : 0;
+	std::cout
+		<< std::left << std::setw(40) << name
+		<< std::right << std::setw(12) << perSecond << " frames/s"
+		<< std::endl;
+}
+
+void ReportLatency(const char *name, crl::profile_time time, int files) {
+	std::cout
+		<< std::left << std::setw(40) << name
+		<< std::right << std::setw(12) << (time / files) << " us"
+		<< std::endl;
+}
+
+void ReportSize(const char *name, int64 bytes, int frames) {
+	std::cout
+		<< std::left << std::setw(40) << name
+		<< std::right << std::setw(12) << (bytes / frames) << " bytes/frame"
+		<< std::endl;
+}
+
+void Run(const char *label, Quality quality, int box) {
+	auto totals = Totals();
+	for (const auto &sample : Corpus()) {
+		Measure(totals, sample, quality, box);
+	}
+	if (!totals.frames) {
+		return;
+	}
+	std::cout
+		<< label << ", "
+		<< totals.files << " files, "
+		<< totals.frames << " frames" << std::endl;
+	ReportRate("  rlottie render", totals.render, totals.frames);
+	ReportRate("  cache encode", totals.encode, totals.frames);
+	ReportRate("  cache decode", totals.decode, totals.frames);
+	ReportSize("  cache size", totals.bytes, totals.frames);
+	ReportLatency(
+		"  first frame, parse and render",
+		totals.parse + totals.firstRender,
+		totals.files);
+	ReportLatency(
+		"  first frame, from cache",
+		totals.firstDecode,
+		totals.files);
+}
+
+} // namespace
+
+TEST_CASE("lottie corpus", "[lottie_benchmark]") {
+	if (Corpus().empty()) {
+		std::cout
+			<< "No .tgs files found, set "
+			<< kCorpusVariable
+			<< " to a folder with them."
+			<< std::endl;
+	}
+}
+
+TEST_CASE("lottie render and cache, default quality", "[lottie_benchmark]") {
+	Run("LZ4, default quality", Quality::Default, kLowCompressionBox);
+	Run("LZ4HC, default quality", Quality::Default, kHighCompressionBox);
+}
+
+TEST_CASE("lottie render and cache, high quality", "[lottie_benchmark]") {
+	Run("LZ4, high quality", Quality::High, kLowCompressionBox);
+	Run("LZ4HC, high quality", Quality::High, kHighCompressionBox);
+}
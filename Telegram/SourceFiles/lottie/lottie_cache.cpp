@@ -16,6 +16,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <lz4hc.h>
 #include <range/v3/numeric/accumulate.hpp>
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define LOTTIE_CACHE_USE_SSE2
+#include <emmintrin.h>
+#elif defined __ARM_NEON
+#define LOTTIE_CACHE_USE_NEON
+#include <arm_neon.h>
+#endif // __SSE2__ || _M_X64 || _M_IX86_FP >= 2 || __ARM_NEON
+
 namespace Lottie {
 namespace {
 
@@ -24,17 +32,22 @@ constexpr auto kAlignStorage = 16;
 // Must not exceed max database allowed entry size.
 constexpr auto kMaxCacheSize = 10 * 1024 * 1024;
 
-void Xor(EncodedStorage &to, const EncodedStorage &from) {
-	Expects(to.size() == from.size());
+// Don't downscale from variants much larger than the requested size.
+constexpr auto kMaxVariantScale = 4;
+
+// Large frames are compressed slower, but take much less cache space.
+constexpr auto kHighCompressionMinSize = 64 * 1024;
+constexpr auto kHighCompressionLevel = 6;
 
+// Each pixel pair takes one byte: high nibble for the first pixel.
+constexpr auto kAlphaPixelsPerVector = 16;
+
+void XorBlocks(uchar *toBytes, const uchar *fromBytes, int amount) {
 	using Block = std::conditional_t<
 		sizeof(void*) == sizeof(uint64),
 		uint64,
 		uint32>;
-	constexpr auto kBlockSize = sizeof(Block);
-	const auto amount = from.size();
-	const auto fromBytes = reinterpret_cast<const uchar*>(from.data());
-	const auto toBytes = reinterpret_cast<uchar*>(to.data());
+	constexpr auto kBlockSize = int(sizeof(Block));
 	const auto blocks = amount / kBlockSize;
 	const auto fromBlocks = reinterpret_cast<const Block*>(fromBytes);
 	const auto toBlocks = reinterpret_cast<Block*>(toBytes);
@@ -47,6 +60,38 @@ void Xor(EncodedStorage &to, const EncodedStorage &from) {
 	}
 }
 
+void Xor(EncodedStorage &to, const EncodedStorage &from) {
+	Expects(to.size() == from.size());
+
+	const auto amount = from.size();
+	const auto fromBytes = reinterpret_cast<const uchar*>(from.data());
+	const auto toBytes = reinterpret_cast<uchar*>(to.data());
+	auto done = 0;
+#if defined LOTTIE_CACHE_USE_SSE2
+	constexpr auto kVectorSize = int(sizeof(__m128i));
+	for (; done + kVectorSize <= amount; done += kVectorSize) {
+		const auto destination = reinterpret_cast<__m128i*>(toBytes + done);
+		const auto source = reinterpret_cast<const __m128i*>(
+			fromBytes + done);
+		_mm_storeu_si128(
+			destination,
+			_mm_xor_si128(
+				_mm_loadu_si128(destination),
+				_mm_loadu_si128(source)));
+	}
+#elif defined LOTTIE_CACHE_USE_NEON
+	constexpr auto kVectorSize = int(sizeof(uint8x16_t));
+	for (; done + kVectorSize <= amount; done += kVectorSize) {
+		vst1q_u8(
+			toBytes + done,
+			veorq_u8(
+				vld1q_u8(toBytes + done),
+				vld1q_u8(fromBytes + done)));
+	}
+#endif // LOTTIE_CACHE_USE_SSE2 || LOTTIE_CACHE_USE_NEON
+	XorBlocks(toBytes + done, fromBytes + done, amount - done);
+}
+
 bool UncompressToRaw(EncodedStorage &to, bytes::const_span from) {
 	if (from.empty() || from.size() > to.size()) {
 		return false;
@@ -62,16 +107,41 @@ bool UncompressToRaw(EncodedStorage &to, bytes::const_span from) {
 	return (result == to.size());
 }
 
-void CompressFromRaw(QByteArray &to, const EncodedStorage &from) {
+bool GoodVariantSize(QSize variant, QSize size) {
+	return (variant != size)
+		&& (variant.width() >= size.width())
+		&& (variant.height() >= size.height())
+		&& (variant.width() <= size.width() * kMaxVariantScale)
+		&& (variant.height() <= size.height() * kMaxVariantScale);
+}
+
+Cache::Encoder ChooseEncoder(QSize size) {
+	// 12 bit per pixel in YUV420P and 4 bit per pixel for alpha.
+	return (size.width() * size.height() * 2 >= kHighCompressionMinSize)
+		? Cache::Encoder::YUV420A4_LZ4HC
+		: Cache::Encoder::YUV420A4_LZ4;
+}
+
+void CompressFromRaw(
+		QByteArray &to,
+		const EncodedStorage &from,
+		Cache::Encoder encoder) {
 	const auto size = from.size();
 	const auto max = sizeof(qint32) + LZ4_compressBound(size);
 	to.reserve(max);
 	to.resize(max);
-	const auto compressed = LZ4_compress_default(
-		from.data(),
-		to.data() + sizeof(qint32),
-		size,
-		to.size() - sizeof(qint32));
+	const auto compressed = (encoder == Cache::Encoder::YUV420A4_LZ4HC)
+		? LZ4_compress_HC(
+			from.data(),
+			to.data() + sizeof(qint32),
+			size,
+			to.size() - sizeof(qint32),
+			kHighCompressionLevel)
+		: LZ4_compress_default(
+			from.data(),
+			to.data() + sizeof(qint32),
+			size,
+			to.size() - sizeof(qint32));
 	Assert(compressed > 0);
 	if (compressed >= size + sizeof(qint32)) {
 		to.resize(size + sizeof(qint32));
@@ -89,8 +159,9 @@ void CompressAndSwapFrame(
 		QByteArray &to,
 		QByteArray *additional,
 		EncodedStorage &frame,
-		EncodedStorage &previous) {
-	CompressFromRaw(to, frame);
+		EncodedStorage &previous,
+		Cache::Encoder encoder) {
+	CompressFromRaw(to, frame, encoder);
 	std::swap(frame, previous);
 	if (!additional) {
 		return;
@@ -98,7 +169,7 @@ void CompressAndSwapFrame(
 
 	// Check if XOR-d delta compresses better.
 	Xor(frame, previous);
-	CompressFromRaw(*additional, frame);
+	CompressFromRaw(*additional, frame, encoder);
 	if (additional->size() >= to.size()) {
 		return;
 	}
@@ -160,6 +231,60 @@ void DecodeAlpha(QImage &to, const EncodedStorage &from) {
 	for (auto i = 0; i != height; ++i) {
 		auto ints = reinterpret_cast<uint32*>(bytes);
 		const auto till = ints + width;
+#if defined LOTTIE_CACHE_USE_SSE2
+		const auto vectors = ints
+			+ (width / kAlphaPixelsPerVector) * kAlphaPixelsPerVector;
+		const auto zero = _mm_setzero_si128();
+		const auto nibble = _mm_set1_epi8(0x0F);
+		const auto color = _mm_set1_epi32(0x00FFFFFF);
+		for (; ints != vectors; ints += kAlphaPixelsPerVector) {
+			const auto packed = _mm_loadl_epi64(
+				reinterpret_cast<const __m128i*>(alpha));
+			alpha += kAlphaPixelsPerVector / 2;
+
+			// Sixteen nibbles in pixel order, each expanded to n * 0x11.
+			const auto nibbles = _mm_unpacklo_epi8(
+				_mm_and_si128(_mm_srli_epi16(packed, 4), nibble),
+				_mm_and_si128(packed, nibble));
+			const auto values = _mm_or_si128(
+				nibbles,
+				_mm_slli_epi16(nibbles, 4));
+			const auto low = _mm_unpacklo_epi8(zero, values);
+			const auto high = _mm_unpackhi_epi8(zero, values);
+			const __m128i alphas[] = {
+				_mm_unpacklo_epi16(zero, low),
+				_mm_unpackhi_epi16(zero, low),
+				_mm_unpacklo_epi16(zero, high),
+				_mm_unpackhi_epi16(zero, high),
+			};
+			const auto pixels = reinterpret_cast<__m128i*>(ints);
+			for (auto j = 0; j != 4; ++j) {
+				_mm_storeu_si128(
+					pixels + j,
+					_mm_or_si128(
+						_mm_and_si128(_mm_loadu_si128(pixels + j), color),
+						alphas[j]));
+			}
+		}
+#elif defined LOTTIE_CACHE_USE_NEON
+		const auto vectors = ints
+			+ (width / kAlphaPixelsPerVector) * kAlphaPixelsPerVector;
+		const auto nibble = vdup_n_u8(0x0F);
+		for (; ints != vectors; ints += kAlphaPixelsPerVector) {
+			const auto packed = vld1_u8(alpha);
+			alpha += kAlphaPixelsPerVector / 2;
+
+			// Sixteen nibbles in pixel order, each expanded to n * 0x11.
+			const auto zipped = vzip_u8(
+				vshr_n_u8(packed, 4),
+				vand_u8(packed, nibble));
+			const auto nibbles = vcombine_u8(zipped.val[0], zipped.val[1]);
+			const auto pixels = reinterpret_cast<uint8_t*>(ints);
+			auto channels = vld4q_u8(pixels);
+			channels.val[3] = vorrq_u8(nibbles, vshlq_n_u8(nibbles, 4));
+			vst4q_u8(pixels, channels);
+		}
+#endif // LOTTIE_CACHE_USE_SSE2 || LOTTIE_CACHE_USE_NEON
 		while (ints != till) {
 			const auto value = uint32(*alpha++);
 			*ints = (*ints & 0x00FFFFFFU)
@@ -237,6 +362,46 @@ void EncodeAlpha(EncodedStorage &to, const QImage &from) {
 	for (auto i = 0; i != height; ++i) {
 		auto ints = reinterpret_cast<const uint32*>(bytes);
 		const auto till = ints + width;
+#if defined LOTTIE_CACHE_USE_SSE2
+		const auto vectors = ints
+			+ (width / kAlphaPixelsPerVector) * kAlphaPixelsPerVector;
+		const auto mask = _mm_set1_epi16(0xFF);
+		for (; ints != vectors; ints += kAlphaPixelsPerVector) {
+			const auto pixels = reinterpret_cast<const __m128i*>(ints);
+			const auto nibbles = _mm_packus_epi16(
+				_mm_packs_epi32(
+					_mm_srli_epi32(_mm_loadu_si128(pixels + 0), 28),
+					_mm_srli_epi32(_mm_loadu_si128(pixels + 1), 28)),
+				_mm_packs_epi32(
+					_mm_srli_epi32(_mm_loadu_si128(pixels + 2), 28),
+					_mm_srli_epi32(_mm_loadu_si128(pixels + 3), 28)));
+
+			// Each 16 bit lane holds a pixel pair: first in the low byte.
+			const auto pairs = _mm_or_si128(
+				_mm_slli_epi16(_mm_and_si128(nibbles, mask), 4),
+				_mm_srli_epi16(nibbles, 8));
+			_mm_storel_epi64(
+				reinterpret_cast<__m128i*>(alpha),
+				_mm_packus_epi16(pairs, pairs));
+			alpha += kAlphaPixelsPerVector / 2;
+		}
+#elif defined LOTTIE_CACHE_USE_NEON
+		const auto vectors = ints
+			+ (width / kAlphaPixelsPerVector) * kAlphaPixelsPerVector;
+		for (; ints != vectors; ints += kAlphaPixelsPerVector) {
+			const auto channels = vld4q_u8(
+				reinterpret_cast<const uint8_t*>(ints));
+			const auto pairs = vuzp_u8(
+				vget_low_u8(channels.val[3]),
+				vget_high_u8(channels.val[3]));
+			vst1_u8(
+				alpha,
+				vorr_u8(
+					vand_u8(pairs.val[0], vdup_n_u8(0xF0)),
+					vshr_n_u8(pairs.val[1], 4)));
+			alpha += kAlphaPixelsPerVector / 2;
+		}
+#endif // LOTTIE_CACHE_USE_SSE2 || LOTTIE_CACHE_USE_NEON
 		for (; ints != till; ints += 2) {
 			*alpha++ = (((*ints) >> 24) & 0xF0U) | ((*(ints + 1)) >> 28);
 		}
@@ -419,7 +584,8 @@ bool Cache::readHeader(const FrameRequest &request) {
 
 	auto encoder = qint32(0);
 	stream >> encoder;
-	if (static_cast<Encoder>(encoder) != Encoder::YUV420A4_LZ4) {
+	if (static_cast<Encoder>(encoder) != Encoder::YUV420A4_LZ4
+		&& static_cast<Encoder>(encoder) != Encoder::YUV420A4_LZ4HC) {
 		return false;
 	}
 	auto size = QSize();
@@ -442,8 +608,27 @@ bool Cache::readHeader(const FrameRequest &request) {
 		|| (framesCount <= 0)
 		|| (framesCount > kMaxFramesCount)
 		|| (framesReady <= 0)
-		|| (framesReady > framesCount)
-		|| request.size(original) != size) {
+		|| (framesReady > framesCount)) {
+		return false;
+	} else if (request.size(original) != size) {
+		if (framesReady != framesCount
+			|| !GoodVariantSize(size, request.size(original))) {
+			return false;
+		}
+		_variant = std::unique_ptr<Cache>(new Cache());
+		_variant->_data = base::take(_data);
+		_variant->_encoder = static_cast<Encoder>(encoder);
+		_variant->_size = size;
+		_variant->_original = original;
+		_variant->_frameRate = frameRate;
+		_variant->_framesCount = framesCount;
+		_variant->_framesReady = framesReady;
+		_variant->prepareBuffers();
+
+		// Frames will be added from the variant by appendFrame().
+		_original = original;
+		_frameRate = frameRate;
+		_framesCount = framesCount;
 		return false;
 	}
 	_encoder = static_cast<Encoder>(encoder);
@@ -460,22 +645,43 @@ QImage Cache::takeFirstFrame() {
 	return std::move(_firstFrame);
 }
 
+bool Cache::canRenderAllFrames() const {
+	return (_framesReady == _framesCount) || (_variant != nullptr);
+}
+
 bool Cache::renderFrame(
 		QImage &to,
 		const FrameRequest &request,
 		int index) {
-	Expects(index >= _framesReady
-		|| index == _offsetFrameIndex
-		|| index == 0);
-
 	if (index >= _framesReady) {
-		return false;
+		return renderFromVariant(to, request, index);
 	} else if (request.size(_original) != _size) {
 		return false;
-	} else if (index == 0) {
+	}
+	return readFrame(to, index);
+}
+
+bool Cache::readFrame(QImage &to, int index) {
+	if (index == 0 || index < _offsetFrameIndex) {
 		_offset = headerSize();
 		_offsetFrameIndex = 0;
 	}
+
+	// Skipped frames are still needed to restore the XOR-d ones.
+	while (_offsetFrameIndex < index) {
+		if (!readNextFrame()) {
+			return false;
+		}
+	}
+	if (!readNextFrame()) {
+		return false;
+	}
+	Decode(to, _previous, _size, _decodeContext);
+	return true;
+}
+
+bool Cache::readNextFrame() {
+	const auto index = _offsetFrameIndex;
 	const auto [ok, xored] = readCompressedFrame();
 	if (!ok || (xored && index == 0)) {
 		_framesReady = 0;
@@ -489,7 +695,30 @@ bool Cache::renderFrame(
 	} else {
 		std::swap(_uncompressed, _previous);
 	}
-	Decode(to, _previous, _size, _decodeContext);
+	return true;
+}
+
+bool Cache::renderFromVariant(
+		QImage &to,
+		const FrameRequest &request,
+		int index) {
+	if (!_variant) {
+		return false;
+	} else if (index != _framesReady
+		|| !_variant->readFrame(_variantFrame, index)) {
+		_variant = nullptr;
+		_variantFrame = QImage();
+		return false;
+	}
+	to = _variantFrame.scaled(
+		request.size(_original),
+		Qt::IgnoreAspectRatio,
+		Qt::SmoothTransformation);
+	appendFrame(to, request, index);
+	if (_framesReady == _framesCount) {
+		_variant = nullptr;
+		_variantFrame = QImage();
+	}
 	return true;
 }
 
@@ -506,6 +735,7 @@ void Cache::appendFrame(
 	}
 	if (index == 0) {
 		_size = request.size(_original);
+		_encoder = ChooseEncoder(_size);
 		_encode = EncodeFields();
 		_encode.compressedFrames.reserve(_framesCount);
 		prepareBuffers();
@@ -516,7 +746,8 @@ void Cache::appendFrame(
 		_encode.compressBuffer,
 		(index != 0) ? &_encode.xorCompressBuffer : nullptr,
 		_uncompressed,
-		_previous);
+		_previous,
+		_encoder);
 	const auto compressed = _encode.compressBuffer;
 	const auto nowSize = (_data.isEmpty() ? headerSize() : _data.size())
 		+ _encode.totalSize;
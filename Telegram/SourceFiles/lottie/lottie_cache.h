@@ -54,6 +54,7 @@ class Cache {
 public:
 	enum class Encoder : qint8 {
 		YUV420A4_LZ4,
+		YUV420A4_LZ4HC,
 	};
 
 	Cache(
@@ -72,6 +73,9 @@ public:
 	[[nodiscard]] QSize originalSize() const;
 	[[nodiscard]] QImage takeFirstFrame();
 
+	// All frames are cached or can be downscaled from a larger variant.
+	[[nodiscard]] bool canRenderAllFrames() const;
+
 	[[nodiscard]] bool renderFrame(
 		QImage &to,
 		const FrameRequest &request,
@@ -96,10 +100,19 @@ private:
 		FFmpeg::SwscalePointer context;
 		int totalSize = 0;
 	};
+	Cache() = default;
+
 	int headerSize() const;
 	void prepareBuffers();
 	void finalizeEncoding();
 
+	[[nodiscard]] bool readFrame(QImage &to, int index);
+	[[nodiscard]] bool readNextFrame();
+	[[nodiscard]] bool renderFromVariant(
+		QImage &to,
+		const FrameRequest &request,
+		int index);
+
 	void writeHeader();
 	void updateFramesReadyCount();
 	[[nodiscard]] bool readHeader(const FrameRequest &request);
@@ -121,6 +134,10 @@ private:
 	Encoder _encoder = Encoder::YUV420A4_LZ4;
 	FnMut<void(QByteArray &&cached)> _put;
 
+	// Complete cache of a larger size, used to build this one.
+	std::unique_ptr<Cache> _variant;
+	QImage _variantFrame;
+
 };
 
 } // namespace Lottie
@@ -11,12 +11,15 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "lottie/lottie_animation.h"
 #include "lottie/lottie_cache.h"
 #include "base/flat_map.h"
+#include "base/memory_usage.h"
 #include "logs.h"
 
 #include <QPainter>
+#include <QThread>
 #include <rlottie.h>
+#include <crl/crl_async.h>
 #include <range/v3/algorithm/find.hpp>
-#include <range/v3/algorithm/count_if.hpp>
+#include <range/v3/algorithm/stable_partition.hpp>
 
 namespace Images {
 QImage prepareColored(QColor add, QImage image);
@@ -74,8 +77,12 @@ public:
 
 private:
 	struct Entry {
-		std::unique_ptr<SharedState> state;
+		// Shared with the crl::async task that may be rendering it.
+		std::shared_ptr<SharedState> state;
 		FrameRequest request;
+		bool rendering = false;
+		bool idle = false;
+		bool shownWhileRendering = false;
 	};
 
 	static not_null<SharedState*> StateFromEntry(const Entry &entry) {
@@ -84,9 +91,17 @@ private:
 
 	void queueGenerateFrames();
 	void generateFrames();
+	void startRendering(Entry &entry);
+	void renderingFinished(
+		not_null<SharedState*> state,
+		SharedState::RenderResult result);
+	void notifyPlayers();
 
 	crl::weak_on_queue<FrameRendererObject> _weak;
 	std::vector<Entry> _entries;
+	base::flat_map<Player*, base::weak_ptr<Player>> _players;
+	int _renderingLimit = 1;
+	int _rendering = 0;
 	bool _queued = false;
 
 };
@@ -147,7 +162,8 @@ QImage PrepareFrameByRequest(
 
 FrameRendererObject::FrameRendererObject(
 	crl::weak_on_queue<FrameRendererObject> weak)
-: _weak(std::move(weak)) {
+: _weak(std::move(weak))
+, _renderingLimit(std::max(QThread::idealThreadCount() - 1, 1)) {
 }
 
 void FrameRendererObject::append(
@@ -158,6 +174,10 @@ void FrameRendererObject::append(
 }
 
 void FrameRendererObject::frameShown() {
+	for (auto &entry : _entries) {
+		entry.idle = false;
+		entry.shownWhileRendering = entry.rendering;
+	}
 	queueGenerateFrames();
 }
 
@@ -176,27 +196,81 @@ void FrameRendererObject::remove(not_null<SharedState*> entry) {
 }
 
 void FrameRendererObject::generateFrames() {
-	auto players = base::flat_map<Player*, base::weak_ptr<Player>>();
-	const auto renderOne = [&](const Entry &entry) {
-		const auto result = entry.state->renderNextFrame(entry.request);
-		if (const auto player = result.notify.get()) {
-			players.emplace(player, result.notify);
+	if (_rendering >= _renderingLimit) {
+		return;
+	}
+	auto waiting = std::vector<not_null<Entry*>>();
+	waiting.reserve(_entries.size());
+	for (auto &entry : _entries) {
+		if (!entry.rendering && !entry.idle) {
+			waiting.push_back(&entry);
 		}
-		return result.rendered;
-	};
-	const auto rendered = ranges::count_if(_entries, renderOne);
-	if (rendered) {
-		if (!players.empty()) {
-			crl::on_main([players = std::move(players)] {
-				for (const auto &[player, weak] : players) {
-					if (weak) {
-						weak->checkStep();
-					}
-				}
-			});
+	}
+
+	// Frames that the main thread waits for go first.
+	ranges::stable_partition(waiting, [](not_null<Entry*> entry) {
+		return entry->state->hasFrameToPresent();
+	});
+	for (const auto entry : waiting) {
+		if (_rendering >= _renderingLimit) {
+			break;
 		}
+		startRendering(*entry);
+	}
+}
+
+void FrameRendererObject::startRendering(Entry &entry) {
+	Expects(!entry.rendering);
+
+	entry.rendering = true;
+	++_rendering;
+	crl::async([
+		weak = _weak,
+		state = entry.state,
+		request = entry.request
+	] {
+		const auto result = state->renderNextFrame(request);
+		weak.with([=](FrameRendererObject &that) {
+			that.renderingFinished(state.get(), result);
+		});
+	});
+}
+
+void FrameRendererObject::renderingFinished(
+		not_null<SharedState*> state,
+		SharedState::RenderResult result) {
+	--_rendering;
+	const auto i = ranges::find(_entries, state, &StateFromEntry);
+	if (i == end(_entries)) {
+		// Removed while rendering, ignore the result.
 		queueGenerateFrames();
+		return;
+	}
+	i->rendering = false;
+	i->idle = !result.rendered && !base::take(i->shownWhileRendering);
+	if (const auto player = result.notify.get()) {
+		if (_players.empty()) {
+			// Notify once for all the results that are already queued.
+			_weak.with([](FrameRendererObject &that) {
+				that.notifyPlayers();
+			});
+		}
+		_players.emplace(player, result.notify);
+	}
+	queueGenerateFrames();
+}
+
+void FrameRendererObject::notifyPlayers() {
+	if (_players.empty()) {
+		return;
 	}
+	crl::on_main([players = base::take(_players)] {
+		for (const auto &[player, weak] : players) {
+			if (weak) {
+				weak->checkStep();
+			}
+		}
+	});
 }
 
 void FrameRendererObject::queueGenerateFrames() {
@@ -244,12 +318,16 @@ Information SharedState::CalculateInformation(
 }
 
 SharedState::SharedState(
+	const QByteArray &content,
+	const ColorReplacements *replacements,
 	std::unique_ptr<rlottie::Animation> animation,
 	const FrameRequest &request,
 	Quality quality)
 : _info(CalculateInformation(quality, animation.get(), nullptr))
 , _quality(quality)
-, _animation(std::move(animation)) {
+, _animation(std::move(animation))
+, _content(content)
+, _replacements(replacements) {
 	construct(request);
 }
 
@@ -327,7 +405,10 @@ void SharedState::renderFrame(
 	if (_cache) {
 		_cache->appendFrame(image, request, index);
 		if (_cache->framesReady() == _cache->framesCount()) {
-			_animation = nullptr;
+			details::CacheParsed(
+				_content,
+				_replacements,
+				base::take(_animation));
 		}
 	}
 }
@@ -337,6 +418,14 @@ void SharedState::init(QImage cover, const FrameRequest &request) {
 
 	_frames[0].request = request;
 	_frames[0].original = std::move(cover);
+
+	const auto &original = _frames[0].original;
+	_framesMemory = int64(original.bytesPerLine())
+		* original.height()
+		* kFramesCount;
+	base::memory_usage::Add(
+		base::memory_usage::Category::LottieFrames,
+		_framesMemory);
 }
 
 void SharedState::start(
@@ -360,10 +449,16 @@ void SharedState::renderNextFrame(
 		const FrameRequest &request) {
 	Expects(_info.framesCount > 0);
 
+	// Frames can be skipped only if they don't need to be cached.
+	const auto step = (!_cache
+		|| _cache->framesReady() == _cache->framesCount())
+		? _frameStep.load(std::memory_order_relaxed)
+		: 1;
+	_frameIndex += step;
 	renderFrame(
 		frame->original,
 		request,
-		(++_frameIndex) % _info.framesCount);
+		_frameIndex % _info.framesCount);
 	frame->request = request;
 	PrepareFrameByRequest(frame);
 	frame->index = _frameIndex;
@@ -411,6 +506,16 @@ auto SharedState::renderNextFrame(const FrameRequest &request)
 	Unexpected("Counter value in Lottie::SharedState::renderNextFrame.");
 }
 
+void SharedState::setFrameStep(int step) {
+	Expects(step > 0);
+
+	_frameStep.store(step, std::memory_order_relaxed);
+}
+
+bool SharedState::hasFrameToPresent() const {
+	return (counter() % 2) == 0;
+}
+
 crl::time SharedState::countFrameDisplayTime(int index) const {
 	return _started
 		+ _delay
@@ -565,7 +670,17 @@ bool SharedState::markFrameShown() {
 	Unexpected("Counter value in Lottie::SharedState::markFrameShown.");
 }
 
-SharedState::~SharedState() = default;
+SharedState::~SharedState() {
+	base::memory_usage::Add(
+		base::memory_usage::Category::LottieFrames,
+		-_framesMemory);
+	if (_animation) {
+		details::CacheParsed(
+			_content,
+			_replacements,
+			std::move(_animation));
+	}
+}
 
 std::shared_ptr<FrameRenderer> FrameRenderer::CreateIndependent() {
 	return std::make_shared<FrameRenderer>();
@@ -52,6 +52,8 @@ QImage PrepareFrameByRequest(
 class SharedState {
 public:
 	SharedState(
+		const QByteArray &content,
+		const ColorReplacements *replacements,
 		std::unique_ptr<rlottie::Animation> animation,
 		const FrameRequest &request,
 		Quality quality);
@@ -79,6 +81,9 @@ public:
 	void markFrameDisplayed(crl::time now);
 	bool markFrameShown();
 
+	// Render only each step-th frame, keeping the timeline. Main thread.
+	void setFrameStep(int step);
+
 	void renderFrame(QImage &image, const FrameRequest &request, int index);
 
 	struct RenderResult {
@@ -87,6 +92,9 @@ public:
 	};
 	[[nodiscard]] RenderResult renderNextFrame(const FrameRequest &request);
 
+	// Rendered frame waits to be released to the main thread.
+	[[nodiscard]] bool hasFrameToPresent() const;
+
 	~SharedState();
 
 private:
@@ -114,6 +122,9 @@ private:
 	static constexpr auto kFramesCount = 4;
 	std::array<Frame, kFramesCount> _frames;
 
+	// Estimated by the cover size, reported to base::memory_usage.
+	int64 _framesMemory = 0;
+
 	base::weak_ptr<Player> _owner;
 	crl::time _started = kTimeUnknown;
 
@@ -123,6 +134,7 @@ private:
 
 	int _frameIndex = 0;
 	int _skippedFrames = 0;
+	std::atomic<int> _frameStep = 1;
 	const Information _info;
 	const Quality _quality = Quality::Default;
 
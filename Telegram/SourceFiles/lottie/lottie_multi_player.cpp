@@ -14,6 +14,16 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <range/v3/algorithm/remove.hpp>
 
 namespace Lottie {
+namespace {
+
+// When frames can't be rendered in time the frame rate is halved,
+// so that the animations stay smooth instead of stuttering.
+constexpr auto kFrameBudget = crl::time(1000) / kNormalFrameRate;
+constexpr auto kMaxFrameStep = 4;
+constexpr auto kLateFramesToDegrade = 3;
+constexpr auto kOnTimeFramesToRestore = 2 * kNormalFrameRate;
+
+} // namespace
 
 MultiPlayer::MultiPlayer(
 	Quality quality,
@@ -76,6 +86,7 @@ void MultiPlayer::startAtRightTime(std::unique_ptr<SharedState> state) {
 		lastSyncTime,
 		_delay);
 	state->start(this, _started, _delay, frameIndex);
+	state->setFrameStep(_frameStep);
 	const auto request = state->frameForPaint()->request;
 	_renderer->append(std::move(state), request);
 }
@@ -178,6 +189,8 @@ void MultiPlayer::removeNow(not_null<Animation*> animation) {
 			_started = kTimeUnknown;
 			_lastSyncTime = kTimeUnknown;
 			_delay = 0;
+			_frameStep = 1;
+			_lateFrames = _onTimeFrames = 0;
 		}
 	}
 }
@@ -318,6 +331,7 @@ void MultiPlayer::checkNextFrameRender() {
 
 		markFrameDisplayed(now);
 		addTimelineDelay(now - _nextFrameTime);
+		updateFrameStep(now - _nextFrameTime);
 		_lastSyncTime = now;
 		_nextFrameTime = kFrameDisplayTimeAlreadyDone;
 		processPending();
@@ -325,6 +339,35 @@ void MultiPlayer::checkNextFrameRender() {
 	}
 }
 
+void MultiPlayer::updateFrameStep(crl::time late) {
+	if (late > kFrameBudget) {
+		_onTimeFrames = 0;
+		if (_frameStep == kMaxFrameStep
+			|| ++_lateFrames < kLateFramesToDegrade) {
+			return;
+		}
+		_lateFrames = 0;
+		_frameStep *= 2;
+	} else {
+		_lateFrames = 0;
+		if (_frameStep == 1 || ++_onTimeFrames < kOnTimeFramesToRestore) {
+			return;
+		}
+		_onTimeFrames = 0;
+		_frameStep /= 2;
+	}
+	applyFrameStep();
+}
+
+void MultiPlayer::applyFrameStep() {
+	for (const auto &[animation, state] : _active) {
+		state->setFrameStep(_frameStep);
+	}
+	for (const auto &[animation, info] : _paused) {
+		info.state->setFrameStep(_frameStep);
+	}
+}
+
 void MultiPlayer::updateFrameRequest(
 		not_null<const Animation*> animation,
 		const FrameRequest &request) {
@@ -90,6 +90,8 @@ private:
 	void pauseAndSaveState(not_null<Animation*> animation);
 	void unpauseAndKeepUp(not_null<Animation*> animation);
 	void removeNow(not_null<Animation*> animation);
+	void updateFrameStep(crl::time late);
+	void applyFrameStep();
 
 	Quality _quality = Quality::Default;
 	base::Timer _timer;
@@ -106,6 +108,9 @@ private:
 	crl::time _lastSyncTime = kTimeUnknown;
 	crl::time _delay = 0;
 	crl::time _nextFrameTime = kTimeUnknown;
+	int _frameStep = 1;
+	int _lateFrames = 0;
+	int _onTimeFrames = 0;
 	rpl::event_stream<MultiUpdate> _updates;
 	rpl::lifetime _lifetime;
 
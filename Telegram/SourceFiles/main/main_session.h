@@ -42,6 +42,7 @@ class Instance;
 
 namespace Stickers {
 class EmojiPack;
+class ThumbnailAtlas;
 } // namespace Stickers;
 
 namespace Core {
@@ -86,6 +87,9 @@ public:
 	[[nodiscard]] Stickers::EmojiPack &emojiStickersPack() {
 		return *_emojiStickersPack;
 	}
+	[[nodiscard]] Stickers::ThumbnailAtlas &stickerThumbnails() {
+		return *_stickerThumbnails;
+	}
 	[[nodiscard]] AppConfig &appConfig() {
 		return *_appConfig;
 	}
@@ -155,6 +159,7 @@ private:
 
 	// _emojiStickersPack depends on _data.
 	const std::unique_ptr<Stickers::EmojiPack> _emojiStickersPack;
+	const std::unique_ptr<Stickers::ThumbnailAtlas> _stickerThumbnails;
 
 	// _changelogs depends on _data, subscribes on chats loading event.
 	const std::unique_ptr<Core::Changelogs> _changelogs;
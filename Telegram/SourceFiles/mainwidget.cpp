@@ -110,6 +110,11 @@ constexpr auto kChannelGetDifferenceLimit = 100;
 // 1s wait after show channel history before sending getChannelDifference.
 constexpr auto kWaitForChannelGetDifference = crl::time(1000);
 
+// Channels with gaps found at once, like after a long sleep, are asked
+// for their differences in portions, with the more important ones first.
+constexpr auto kChannelGetDifferencesPortion = 8;
+constexpr auto kChannelGetDifferencesPortionDelay = crl::time(300);
+
 // If nothing is received in 1 min we ping.
 constexpr auto kNoUpdatesTimeout = 60 * 1000;
 
@@ -119,8 +124,8 @@ constexpr auto kNoUpdatesAfterSleepTimeout = 60 * crl::time(1000);
 // Send channel views each second.
 constexpr auto kSendViewsTimeout = crl::time(1000);
 
-// Cache background scaled image after 3s.
-constexpr auto kCacheBackgroundTimeout = 3000;
+// Cache background scaled image after 1s.
+constexpr auto kCacheBackgroundTimeout = 1000;
 
 enum class DataIsLoadedResult {
 	NotLoaded = 0,
@@ -1332,7 +1337,9 @@ void MainWidget::clearCachedBackground() {
 }
 
 QPixmap MainWidget::cachedBackground(const QRect &forRect, int &x, int &y) {
-	if (!_cachedBackground.isNull() && forRect == _cachedFor) {
+	if (!_cachedBackground.isNull()
+		&& forRect == _cachedFor
+		&& _cachedBackground.devicePixelRatio() == cRetinaFactor()) {
 		x = _cachedX;
 		y = _cachedY;
 		return _cachedBackground;
@@ -1344,6 +1351,10 @@ QPixmap MainWidget::cachedBackground(const QRect &forRect, int &x, int &y) {
 	return QPixmap();
 }
 
+const QPixmap &MainWidget::lastCachedBackground() const {
+	return _cachedBackground;
+}
+
 void MainWidget::updateScrollColors() {
 	_history->updateScrollColors();
 }
@@ -3093,13 +3104,36 @@ void MainWidget::getDifferenceByPts() {
 			getDifference();
 		}
 	}
-	for (ChannelGetDifferenceTime::iterator i = _channelGetDifferenceTimeByPts.begin(); i != _channelGetDifferenceTimeByPts.cend();) {
+	auto due = std::vector<not_null<ChannelData*>>();
+	for (auto i = _channelGetDifferenceTimeByPts.begin(); i != _channelGetDifferenceTimeByPts.cend(); ++i) {
 		if (i.value() > now) {
 			wait = wait ? qMin(wait, i.value() - now) : (i.value() - now);
-			++i;
 		} else {
-			getChannelDifference(i.key(), ChannelDifferenceRequest::PtsGapOrShortPoll);
-			i = _channelGetDifferenceTimeByPts.erase(i);
+			due.push_back(i.key());
+		}
+	}
+	if (!due.empty()) {
+		const auto current = _history->peer();
+		const auto rank = [&](not_null<ChannelData*> channel) {
+			if (current == channel.get()) {
+				return 0;
+			}
+			const auto history = session().data().historyLoaded(channel);
+			if (history && history->isPinnedDialog()) {
+				return 1;
+			}
+			return session().data().notifyIsMuted(channel) ? 3 : 2;
+		};
+		ranges::stable_sort(due, ranges::less(), rank);
+		if (int(due.size()) > kChannelGetDifferencesPortion) {
+			due.resize(kChannelGetDifferencesPortion);
+			wait = wait
+				? qMin(wait, kChannelGetDifferencesPortionDelay)
+				: kChannelGetDifferencesPortionDelay;
+		}
+		for (const auto channel : due) {
+			getChannelDifference(channel, ChannelDifferenceRequest::PtsGapOrShortPoll);
+			_channelGetDifferenceTimeByPts.remove(channel);
 		}
 	}
 	if (wait) {
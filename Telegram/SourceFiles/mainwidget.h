@@ -218,6 +218,8 @@ public:
 	bool isIdle() const;
 
 	QPixmap cachedBackground(const QRect &forRect, int &x, int &y);
+	// Is kept until the new one is ready, while the window is resized.
+	const QPixmap &lastCachedBackground() const;
 	void updateScrollColors();
 
 	void setChatBackground(
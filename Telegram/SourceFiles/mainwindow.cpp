@@ -50,6 +50,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace {
 
+constexpr auto kIconsWithCounterLimit = 64;
+
 // Code for testing languages is F7-F6-F7-F8
 void FeedLangTestingKey(int key) {
 	static auto codeState = 0;
@@ -857,6 +859,35 @@ void MainWindow::placeSmallCounter(QImage &img, int size, int count, style::colo
 }
 
 QImage MainWindow::iconWithCounter(int size, int count, style::color bg, style::color fg, bool smallIcon) {
+	// Counters that show the same text give the same icon, see below.
+	const auto layer = (size < 0) || !smallIcon;
+	const auto displayed = (count < (layer ? 1000 : 100))
+		? count
+		: layer
+		? (1000 + count % 100)
+		: (100 + count % 10);
+	const auto support = account().sessionExists()
+		&& account().session().supportMode();
+	const auto key = IconWithCounterKey(
+		size,
+		displayed,
+		bg->c.rgba(),
+		fg->c.rgba(),
+		smallIcon,
+		support);
+	if (const auto i = _iconsWithCounter.find(key)
+		; i != end(_iconsWithCounter)) {
+		return i->second;
+	}
+	if (_iconsWithCounter.size() >= kIconsWithCounterLimit) {
+		_iconsWithCounter.clear();
+	}
+	auto result = renderIconWithCounter(size, count, bg, fg, smallIcon);
+	_iconsWithCounter.emplace(key, result);
+	return result;
+}
+
+QImage MainWindow::renderIconWithCounter(int size, int count, style::color bg, style::color fg, bool smallIcon) {
 	bool layer = false;
 	if (size < 0) {
 		size = -size;
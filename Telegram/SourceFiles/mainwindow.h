@@ -161,8 +161,13 @@ private:
 	QPixmap grabInner();
 
 	void placeSmallCounter(QImage &img, int size, int count, style::color bg, const QPoint &shift, style::color color) override;
+	QImage renderIconWithCounter(int size, int count, style::color bg, style::color fg, bool smallIcon);
 	QImage icon16, icon32, icon64, iconbig16, iconbig32, iconbig64;
 
+	// size, displayed count, bg, fg, small icon, support mode
+	using IconWithCounterKey = std::tuple<int, int, QRgb, QRgb, bool, bool>;
+	base::flat_map<IconWithCounterKey, QImage> _iconsWithCounter;
+
 	crl::time _lastTrayClickTime = 0;
 
 	object_ptr<Window::PasscodeLockWidget> _passcodeLock = { nullptr };
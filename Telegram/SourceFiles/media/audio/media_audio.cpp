@@ -278,7 +278,6 @@ namespace Player {
 namespace {
 
 constexpr auto kVolumeRound = 10000;
-constexpr auto kPreloadSamples = 2LL * kDefaultFrequency; // preload next part if less than 2 seconds remains
 constexpr auto kFadeDuration = crl::time(500);
 constexpr auto kCheckPlaybackPositionTimeout = crl::time(100); // 100ms per check audio position
 constexpr auto kCheckPlaybackPositionDelta = 2400LL; // update position called each 2400 samples
@@ -512,6 +511,15 @@ int Mixer::Track::getNotQueuedBufferIndex() {
 	return -1;
 }
 
+bool Mixer::Track::hasFreeBuffer() const {
+	if (!samplesCount[kBuffersCount - 1]) {
+		return true;
+	}
+	ALint processed = 0;
+	alGetSourcei(stream.source, AL_BUFFERS_PROCESSED, &processed);
+	return (processed > 0);
+}
+
 void Mixer::Track::setExternalData(
 		std::unique_ptr<ExternalSoundData> data) {
 #ifndef TDESKTOP_DISABLE_OPENAL_EFFECTS
@@ -1420,8 +1428,10 @@ int32 Fader::updateOnePlayback(Mixer::Track *track, bool &hasPlaying, bool &hasF
 	}
 	if (playing || track->state.state == State::Starting || track->state.state == State::Resuming) {
 		if (!track->loaded && !track->loading) {
-			auto needPreload = (track->state.position + kPreloadSamples > track->bufferedPosition + track->bufferedLength);
-			if (needPreload) {
+			// Refill as soon as any buffer is played through, so that
+			// the whole ring stays queued and a loader delay doesn't
+			// turn into an audible gap.
+			if (track->hasFreeBuffer()) {
 				track->loading = true;
 				emitSignals |= EmitNeedToPreload;
 			}
@@ -1664,7 +1674,6 @@ public:
 		buffer.reserve(kWaveformCounterBufferSize);
 		int64 countbytes = sampleSize() * samplesCount();
 		int64 processed = 0;
-		int64 sumbytes = 0;
 		if (samplesCount() < Media::Player::kWaveformSamplesCount) {
 			return false;
 		}
@@ -1673,15 +1682,11 @@ public:
 		peaks.reserve(Media::Player::kWaveformSamplesCount);
 
 		auto fmt = format();
-		auto peak = uint16(0);
-		auto callback = [&](uint16 sample) {
-			accumulate_max(peak, sample);
-			sumbytes += Media::Player::kWaveformSamplesCount;
-			if (sumbytes >= countbytes) {
-				sumbytes -= countbytes;
-				peaks.push_back(peak);
-				peak = 0;
-			}
+		auto reducer = Media::Audio::PeaksReducer(
+			Media::Player::kWaveformSamplesCount,
+			countbytes);
+		auto callback = [&](uint16 peak) {
+			peaks.push_back(peak);
 		};
 		while (processed < countbytes) {
 			buffer.resize(0);
@@ -1697,14 +1702,15 @@ public:
 
 			auto sampleBytes = bytes::make_span(buffer);
 			if (fmt == AL_FORMAT_MONO8 || fmt == AL_FORMAT_STEREO8) {
-				Media::Audio::IterateSamples<uchar>(sampleBytes, callback);
+				reducer.feed<uchar>(sampleBytes, callback);
 			} else if (fmt == AL_FORMAT_MONO16 || fmt == AL_FORMAT_STEREO16) {
-				Media::Audio::IterateSamples<int16>(sampleBytes, callback);
+				reducer.feed<int16>(sampleBytes, callback);
 			}
 			processed += sampleSize() * samples;
 		}
-		if (sumbytes > 0 && peaks.size() < Media::Player::kWaveformSamplesCount) {
-			peaks.push_back(peak);
+		if (reducer.hasPartial()
+			&& peaks.size() < Media::Player::kWaveformSamplesCount) {
+			peaks.push_back(reducer.partialPeak());
 		}
 
 		if (peaks.isEmpty()) {
@@ -1712,7 +1718,8 @@ public:
 		}
 
 		auto sum = std::accumulate(peaks.cbegin(), peaks.cend(), 0LL);
-		peak = qMax(int32(sum * 1.8 / peaks.size()), 2500);
+		const auto peak = uint16(
+			qMax(int32(sum * 1.8 / peaks.size()), 2500));
 
 		result.resize(peaks.size());
 		for (int32 i = 0, l = peaks.size(); i != l; ++i) {
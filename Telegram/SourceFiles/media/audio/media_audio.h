@@ -197,7 +197,7 @@ private:
 
 	class Track {
 	public:
-		static constexpr int kBuffersCount = 3;
+		static constexpr int kBuffersCount = 6;
 
 		// Thread: Any. Must be locked: AudioMutex.
 		void reattach(AudioMsgId::Type type);
@@ -210,6 +210,7 @@ private:
 		void ensureStreamCreated(AudioMsgId::Type type);
 
 		int getNotQueuedBufferIndex();
+		bool hasFreeBuffer() const;
 
 		void setExternalData(std::unique_ptr<ExternalSoundData> data);
 #ifndef TDESKTOP_DISABLE_OPENAL_EFFECTS
@@ -380,6 +381,68 @@ TG_FORCE_INLINE uint16 ReadOneSample(int16 data) {
 	return qAbs(data);
 }
 
+// The loop has neither branches nor calls, so compilers vectorize it.
+template <typename SampleType>
+[[nodiscard]] uint16 SamplesPeak(const SampleType *samples, int64 count) {
+	auto result = uint16(0);
+	for (const auto till = samples + count; samples != till; ++samples) {
+		result = std::max(result, ReadOneSample(*samples));
+	}
+	return result;
+}
+
+// Splits the sample values to runs while they are decoded and reports
+// the peak of each run: it ends when the values count multiplied by
+// 'step' reaches 'total', the remainder goes to the next run.
+class PeaksReducer final {
+public:
+	PeaksReducer(int64 step, int64 total) : _step(step), _total(total) {
+		Expects(step > 0 && total > 0);
+	}
+
+	template <typename SampleType, typename Callback>
+	void feed(const SampleType *samples, int64 count, Callback &&callback) {
+		while (count > 0) {
+			const auto left = (_total - _sum + _step - 1) / _step;
+			const auto part = std::min(count, left);
+			_peak = std::max(_peak, SamplesPeak(samples, part));
+			_sum += part * _step;
+			samples += part;
+			count -= part;
+			if (_sum >= _total) {
+				_sum -= _total;
+				callback(base::take(_peak));
+			}
+		}
+	}
+
+	template <typename SampleType, typename Callback>
+	void feed(bytes::const_span bytes, Callback &&callback) {
+		feed(
+			reinterpret_cast<const SampleType*>(bytes.data()),
+			int64(bytes.size() / sizeof(SampleType)),
+			std::forward<Callback>(callback));
+	}
+
+	[[nodiscard]] bool hasPartial() const {
+		return _sum > 0;
+	}
+	[[nodiscard]] uint16 partialPeak() const {
+		return _peak;
+	}
+	void reset() {
+		_sum = 0;
+		_peak = 0;
+	}
+
+private:
+	int64 _step = 0;
+	int64 _total = 0;
+	int64 _sum = 0;
+	uint16 _peak = 0;
+
+};
+
 template <typename SampleType, typename Callback>
 void IterateSamples(bytes::const_span bytes, Callback &&callback) {
 	auto samplesPointer = reinterpret_cast<const SampleType*>(bytes.data());
@@ -24,6 +24,13 @@ constexpr auto kCaptureSkipDuration = crl::time(400);
 constexpr auto kCaptureFadeInDuration = crl::time(300);
 constexpr auto kCaptureBufferSlice = 256 * 1024;
 constexpr auto kCaptureUpdateDelta = crl::time(100);
+constexpr auto kCaptureReadDelay = crl::time(50);
+
+// Samples are read on the same thread that encodes them, so the device
+// buffer must outlive an encoding stall, otherwise the samples are lost.
+constexpr auto kCaptureDeviceBufferDuration = crl::time(2000);
+constexpr auto kCaptureDeviceBufferSamples = int(
+	kCaptureDeviceBufferDuration * kCaptureFrequency / 1000);
 
 Instance *CaptureInstance = nullptr;
 
@@ -57,13 +64,13 @@ Instance::Instance() : _inner(new Inner(&_thread)) {
 	connect(_inner, SIGNAL(error()), this, SIGNAL(error()));
 	connect(&_thread, SIGNAL(started()), _inner, SLOT(onInit()));
 	connect(&_thread, SIGNAL(finished()), _inner, SLOT(deleteLater()));
-	_thread.start();
+	_thread.start(QThread::HighPriority);
 }
 
 void Instance::check() {
 	_available = false;
 	if (auto defaultDevice = alcGetString(0, ALC_CAPTURE_DEFAULT_DEVICE_SPECIFIER)) {
-		if (auto device = alcCaptureOpenDevice(defaultDevice, kCaptureFrequency, AL_FORMAT_MONO16, kCaptureFrequency / 5)) {
+		if (auto device = alcCaptureOpenDevice(defaultDevice, kCaptureFrequency, AL_FORMAT_MONO16, kCaptureDeviceBufferSamples)) {
 			auto error = ErrorHappened(device);
 			alcCaptureCloseDevice(device);
 			_available = !error;
@@ -111,9 +118,9 @@ struct Instance::Inner::Private {
 	QByteArray data;
 	int32 dataPos = 0;
 
-	int64 waveformMod = 0;
 	int64 waveformEach = (kCaptureFrequency / 100);
-	uint16 waveformPeak = 0;
+	Media::Audio::PeaksReducer waveformReducer
+		= Media::Audio::PeaksReducer(1, waveformEach);
 	QVector<uchar> waveform;
 
 	static int _read_data(void *opaque, uint8_t *buf, int buf_size) {
@@ -162,6 +169,7 @@ struct Instance::Inner::Private {
 
 Instance::Inner::Inner(QThread *thread) : d(new Private()) {
 	moveToThread(thread);
+	_timer.setTimerType(Qt::PreciseTimer);
 	_timer.moveToThread(thread);
 	connect(&_timer, SIGNAL(timeout()), this, SLOT(onTimeout()));
 }
@@ -179,7 +187,7 @@ void Instance::Inner::onStart() {
 	// Start OpenAL Capture
 	const ALCchar *dName = alcGetString(0, ALC_CAPTURE_DEFAULT_DEVICE_SPECIFIER);
 	DEBUG_LOG(("Audio Info: Capture device name '%1'").arg(dName));
-	d->device = alcCaptureOpenDevice(dName, kCaptureFrequency, AL_FORMAT_MONO16, kCaptureFrequency / 5);
+	d->device = alcCaptureOpenDevice(dName, kCaptureFrequency, AL_FORMAT_MONO16, kCaptureDeviceBufferSamples);
 	if (!d->device) {
 		LOG(("Audio Error: capture device not present!"));
 		emit error();
@@ -323,7 +331,7 @@ void Instance::Inner::onStart() {
 		return;
 	}
 
-	_timer.start(50);
+	_timer.start(kCaptureReadDelay);
 	_captured.clear();
 	_captured.reserve(kCaptureBufferSlice);
 	DEBUG_LOG(("Audio Capture: started!"));
@@ -346,8 +354,7 @@ void Instance::Inner::onStop(bool needResult) {
 			d->fullSamples = 0;
 			d->dataPos = 0;
 			d->data.clear();
-			d->waveformMod = 0;
-			d->waveformPeak = 0;
+			d->waveformReducer.reset();
 			d->waveform.clear();
 		} else {
 			float64 coef = 1. / fadeSamples, fadedFrom = 0;
@@ -371,8 +378,7 @@ void Instance::Inner::onStop(bool needResult) {
 				d->fullSamples = 0;
 				d->dataPos = 0;
 				d->data.clear();
-				d->waveformMod = 0;
-				d->waveformPeak = 0;
+				d->waveformReducer.reset();
 				d->waveform.clear();
 			}
 		}
@@ -468,8 +474,7 @@ void Instance::Inner::onStop(bool needResult) {
 		d->dataPos = 0;
 		d->data.clear();
 
-		d->waveformMod = 0;
-		d->waveformPeak = 0;
+		d->waveformReducer.reset();
 		d->waveform.clear();
 	}
 	if (needResult) emit done(result, waveform, samples);
@@ -574,17 +579,12 @@ void Instance::Inner::processFrame(int32 offset, int32 framesize) {
 	}
 
 	d->waveform.reserve(d->waveform.size() + (samplesCnt / d->waveformEach) + 1);
-	for (short *ptr = srcSamplesDataChannel, *end = ptr + samplesCnt; ptr != end; ++ptr) {
-		uint16 value = qAbs(*ptr);
-		if (d->waveformPeak < value) {
-			d->waveformPeak = value;
-		}
-		if (++d->waveformMod == d->waveformEach) {
-			d->waveformMod -= d->waveformEach;
-			d->waveform.push_back(uchar(d->waveformPeak / 256));
-			d->waveformPeak = 0;
-		}
-	}
+	d->waveformReducer.feed(
+		static_cast<const int16*>(srcSamplesDataChannel),
+		samplesCnt,
+		[&](uint16 peak) {
+			d->waveform.push_back(uchar(peak / 256));
+		});
 
 	// Convert to final format
 
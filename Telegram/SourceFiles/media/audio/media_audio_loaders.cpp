@@ -17,6 +17,9 @@ namespace {
 
 constexpr auto kPlaybackBufferSize = 256 * 1024;
 
+// The first buffer is small to start playing as soon as possible.
+constexpr auto kPlaybackStartBufferSize = 32 * 1024;
+
 } // namespace
 
 Loaders::Loaders(QThread *thread)
@@ -167,7 +170,10 @@ void Loaders::loadData(AudioMsgId audio, crl::time positionMs) {
 	if (l->holdsSavedDecodedSamples()) {
 		l->takeSavedDecodedSamples(&samples, &samplesCount);
 	}
-	while (samples.size() < kPlaybackBufferSize) {
+	const auto bufferSize = started
+		? kPlaybackStartBufferSize
+		: kPlaybackBufferSize;
+	while (samples.size() < bufferSize) {
 		auto res = l->readMore(samples, samplesCount);
 		using Result = AudioPlayerLoader::ReadResult;
 		if (res == Result::Error) {
@@ -189,7 +195,7 @@ void Loaders::loadData(AudioMsgId audio, crl::time positionMs) {
 		} else if (res == Result::Ok) {
 			errAtStart = false;
 		} else if (res == Result::Wait) {
-			waiting = (samples.size() < kPlaybackBufferSize)
+			waiting = (samples.size() < bufferSize)
 				&& !l->forceToBuffer();
 			if (waiting) {
 				l->saveDecodedSamples(&samples, &samplesCount);
@@ -243,6 +249,9 @@ void Loaders::loadData(AudioMsgId audio, crl::time positionMs) {
 
 		if (bufferIndex < 0) { // No free buffers, wait.
 			l->saveDecodedSamples(&samples, &samplesCount);
+
+			// Fader will request us again when some buffer is processed.
+			track->loading = false;
 			return;
 		} else if (l->forceToBuffer()) {
 			l->setForceToBuffer(false);
@@ -288,6 +297,10 @@ void Loaders::loadData(AudioMsgId audio, crl::time positionMs) {
 	}
 
 	if (state == AL_PLAYING) {
+		if (!finished && track->hasFreeBuffer()) {
+			// Keep filling the ring without waiting for the Fader timer.
+			emit needToCheck();
+		}
 		return;
 	} else if (state == AL_STOPPED && !internal::CheckAudioDeviceConnected()) {
 		return;
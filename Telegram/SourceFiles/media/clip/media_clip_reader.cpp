@@ -11,6 +11,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/file_download.h"
 #include "media/clip/media_clip_ffmpeg.h"
 #include "media/clip/media_clip_check_streaming.h"
+#include "media/streaming/media_streaming_decode_scheduler.h"
 #include "mainwidget.h"
 #include "mainwindow.h"
 
@@ -29,9 +30,21 @@ namespace Media {
 namespace Clip {
 namespace {
 
+// Clips decode only in free slots of the streaming decode scheduler.
+constexpr auto kDecodeSlotRetryTimeout = crl::time(10);
+
 QVector<QThread*> threads;
 QVector<Manager*> managers;
 
+// Leave one core for the main thread, the readers share the rest.
+int ThreadsLimit() {
+	static const auto result = std::clamp(
+		QThread::idealThreadCount() - 1,
+		1,
+		int(ClipThreadsCount));
+	return result;
+}
+
 QImage PrepareFrameImage(const FrameRequest &request, const QImage &original, bool hasAlpha, QImage &cache) {
 	auto needResize = (original.width() != request.framew) || (original.height() != request.frameh);
 	auto needOuterFill = (request.outerw != request.framew) || (request.outerh != request.frameh);
@@ -110,7 +123,7 @@ Reader::Reader(const QByteArray &data, Callback &&callback, Mode mode, crl::time
 }
 
 void Reader::init(const FileLocation &location, const QByteArray &data) {
-	if (threads.size() < ClipThreadsCount) {
+	if (threads.size() < ThreadsLimit()) {
 		_threadIndex = threads.size();
 		threads.push_back(new QThread());
 		managers.push_back(new Manager(threads.back()));
@@ -810,6 +823,15 @@ void Manager::process() {
 	for (auto i = _readers.begin(), e = _readers.end(); i != e;) {
 		ReaderPrivate *reader = i.key();
 		if (i.value() <= ms) {
+			const auto slot = Streaming::DecodeScheduler::Instance()->tryAcquire();
+			if (!slot) {
+				i.value() = ms + kDecodeSlotRetryTimeout;
+				if (!reader->_autoPausedGif && i.value() < minms) {
+					minms = i.value();
+				}
+				++i;
+				continue;
+			}
 			ResultHandleState state = handleResult(reader, reader->process(ms), ms);
 			if (state == ResultHandleRemove) {
 				i = _readers.erase(i);
@@ -41,6 +41,7 @@ struct PlaybackOptions {
 	bool syncVideoByAudio = true;
 	bool dropStaleFrames = true;
 	bool loop = false;
+	bool hwAllowed = false; // Falls back to software decoding if fails.
 };
 
 struct TrackState {
@@ -60,6 +61,26 @@ struct AudioInformation {
 	TrackState state;
 };
 
+struct DecodingStatistics {
+	int framesDecoded = 0;
+	int framesDropped = 0;
+	crl::profile_time decodeTime = 0;
+};
+
+struct PlaybackStatistics {
+	DecodingStatistics video;
+	int underrunsCount = 0;
+	crl::time underrunsDuration = 0;
+	int64 bytesFetched = 0;
+	int64 bytesPlayed = 0;
+
+	[[nodiscard]] float64 decodeMsPerFrame() const {
+		return video.framesDecoded
+			? (video.decodeTime / (1000. * video.framesDecoded))
+			: 0.;
+	}
+};
+
 struct Information {
 	VideoInformation video;
 	AudioInformation audio;
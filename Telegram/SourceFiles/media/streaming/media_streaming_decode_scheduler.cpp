@@ -0,0 +1,75 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "media/streaming/media_streaming_decode_scheduler.h"
+
+#include <thread>
+
+namespace Media {
+namespace Streaming {
+
+DecodeScheduler::Slot::Slot(not_null<DecodeScheduler*> owner)
+: _owner(owner) {
+}
+
+DecodeScheduler::Slot::~Slot() {
+	_owner->release();
+}
+
+DecodeScheduler::DecodeScheduler()
+: _slots(std::max(int(std::thread::hardware_concurrency()), 1)) {
+}
+
+not_null<DecodeScheduler*> DecodeScheduler::Instance() {
+	static DecodeScheduler result;
+	return &result;
+}
+
+void DecodeScheduler::request(crl::time deadline, Task task) {
+	Expects(task != nullptr);
+
+	QMutexLocker lock(&_mutex);
+	if (_busy < _slots) {
+		++_busy;
+		lock.unlock();
+
+		task(std::make_shared<Slot>(this));
+		return;
+	}
+	_waiting.push_back({ deadline, ++_order, std::move(task) });
+	ranges::push_heap(_waiting, std::greater<>());
+}
+
+auto DecodeScheduler::tryAcquire() -> SlotPointer {
+	QMutexLocker lock(&_mutex);
+	if (_busy >= _slots) {
+		return nullptr;
+	}
+	++_busy;
+	lock.unlock();
+
+	return std::make_shared<Slot>(this);
+}
+
+void DecodeScheduler::release() {
+	QMutexLocker lock(&_mutex);
+	if (_waiting.empty()) {
+		Assert(_busy > 0);
+		--_busy;
+		return;
+	}
+	ranges::pop_heap(_waiting, std::greater<>());
+	auto task = std::move(_waiting.back().task);
+	_waiting.pop_back();
+	lock.unlock();
+
+	// The busy slot is passed to the next task as is.
+	task(std::make_shared<Slot>(this));
+}
+
+} // namespace Streaming
+} // namespace Media
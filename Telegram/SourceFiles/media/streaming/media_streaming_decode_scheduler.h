@@ -0,0 +1,71 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+namespace Media {
+namespace Streaming {
+
+// Limits the count of video tracks decoding at the same time
+// by the count of cores, so that many simultaneous players
+// don't fight for the CPU with the ones that are needed most.
+class DecodeScheduler final {
+public:
+	class Slot final {
+	public:
+		explicit Slot(not_null<DecodeScheduler*> owner);
+		Slot(const Slot &other) = delete;
+		Slot &operator=(const Slot &other) = delete;
+		~Slot();
+
+	private:
+		const not_null<DecodeScheduler*> _owner;
+
+	};
+	using SlotPointer = std::shared_ptr<Slot>;
+	using Task = Fn<void(SlotPointer)>;
+
+	[[nodiscard]] static not_null<DecodeScheduler*> Instance();
+
+	// Thread-safe.
+	// The task is invoked right away if there is a free slot, otherwise
+	// it is invoked, earliest deadline first, from the thread that frees
+	// some slot. The slot stays busy while the pointer copies are alive,
+	// so the task should move it to the decoding queue with the work.
+	void request(crl::time deadline, Task task);
+
+	// Thread-safe.
+	// Low priority requests take only a slot that is free right now,
+	// they never wait, so they don't delay the players in the queue.
+	[[nodiscard]] SlotPointer tryAcquire();
+
+private:
+	struct Waiting {
+		crl::time deadline = 0;
+		uint64 order = 0;
+		Task task;
+	};
+	friend inline bool operator>(const Waiting &a, const Waiting &b) {
+		return (a.deadline > b.deadline)
+			|| (a.deadline == b.deadline && a.order > b.order);
+	}
+
+	DecodeScheduler();
+
+	void release();
+
+	const int _slots = 0;
+
+	QMutex _mutex;
+	std::vector<Waiting> _waiting;
+	int _busy = 0;
+	uint64 _order = 0;
+
+};
+
+} // namespace Streaming
+} // namespace Media
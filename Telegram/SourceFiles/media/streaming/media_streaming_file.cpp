@@ -16,6 +16,79 @@ namespace Streaming {
 namespace {
 
 constexpr auto kMaxSingleReadAmount = 8 * 1024 * 1024;
+constexpr auto kSeekIndexVersion = 1;
+constexpr auto kSeekIndexMaxEntries = 16 * 1024;
+
+[[nodiscard]] int CountKeyframes(not_null<AVStream*> stream) {
+	const auto entries = stream->index_entries;
+	const auto till = entries + stream->nb_index_entries;
+	return std::count_if(entries, till, [](const AVIndexEntry &entry) {
+		return (entry.flags & AVINDEX_KEYFRAME) != 0;
+	});
+}
+
+[[nodiscard]] QByteArray SerializeSeekIndex(not_null<AVStream*> stream) {
+	const auto keyframes = CountKeyframes(stream);
+	const auto step = (keyframes + kSeekIndexMaxEntries - 1)
+		/ kSeekIndexMaxEntries;
+	const auto count = step ? ((keyframes + step - 1) / step) : 0;
+
+	auto result = QByteArray();
+	QDataStream output(&result, QIODevice::WriteOnly);
+	output.setVersion(QDataStream::Qt_5_1);
+	output
+		<< qint32(kSeekIndexVersion)
+		<< qint32(stream->index)
+		<< qint32(count);
+	auto index = 0;
+	const auto entries = stream->index_entries;
+	for (auto i = 0; i != stream->nb_index_entries; ++i) {
+		const auto &entry = entries[i];
+		if ((entry.flags & AVINDEX_KEYFRAME) && !(index++ % step)) {
+			output << qint64(entry.timestamp) << qint64(entry.pos);
+		}
+	}
+	return result;
+}
+
+// Returns the count of entries in the stored index.
+int ApplySeekIndex(not_null<AVStream*> stream, const QByteArray &data) {
+	if (data.isEmpty()) {
+		return 0;
+	}
+	auto version = qint32();
+	auto index = qint32();
+	auto count = qint32();
+	QDataStream input(data);
+	input.setVersion(QDataStream::Qt_5_1);
+	input >> version >> index >> count;
+	if (input.status() != QDataStream::Ok
+		|| version != kSeekIndexVersion
+		|| index != stream->index
+		|| count <= 0
+		|| count > kSeekIndexMaxEntries) {
+		return 0;
+	} else if (CountKeyframes(stream) >= count) {
+		// The container index is already as good as the stored one.
+		return count;
+	}
+	for (auto i = 0; i != count; ++i) {
+		auto timestamp = qint64();
+		auto position = qint64();
+		input >> timestamp >> position;
+		if (input.status() != QDataStream::Ok) {
+			return 0;
+		}
+		av_add_index_entry(
+			stream,
+			position,
+			timestamp,
+			0, // size
+			0, // distance
+			AVINDEX_KEYFRAME);
+	}
+	return count;
+}
 
 } // namespace
 
@@ -116,7 +189,8 @@ void File::Context::logFatal(
 
 Stream File::Context::initStream(
 		not_null<AVFormatContext*> format,
-		AVMediaType type) {
+		AVMediaType type,
+		bool hwAllowed) {
 	auto result = Stream();
 	const auto index = result.index = av_find_best_stream(
 		format,
@@ -140,7 +214,10 @@ Stream File::Context::initStream(
 		}
 	}
 
-	result.codec = FFmpeg::MakeCodecPointer(info);
+	result.codec = FFmpeg::MakeCodecPointer({
+		info,
+		(hwAllowed && type == AVMEDIA_TYPE_VIDEO)
+	});
 	if (!result.codec) {
 		return result;
 	}
@@ -207,6 +284,30 @@ void File::Context::seekToPosition(
 	return logFatal(qstr("av_seek_frame"), error);
 }
 
+void File::Context::applySeekIndex(
+		not_null<AVFormatContext*> format,
+		const Stream &stream) {
+	Expects(stream.index >= 0 && stream.index < int(format->nb_streams));
+
+	const auto info = format->streams[stream.index];
+	_seekStreamIndex = stream.index;
+
+	// Containers with a full index don't need the stored one.
+	const auto known = CountKeyframes(info);
+	const auto stored = ApplySeekIndex(info, _reader->seekIndex());
+	_seekIndexSize = std::max(known, stored);
+}
+
+void File::Context::storeSeekIndex() {
+	if (!_format || _seekStreamIndex < 0) {
+		return;
+	}
+	const auto stream = _format->streams[_seekStreamIndex];
+	if (CountKeyframes(stream) > _seekIndexSize) {
+		_reader->putSeekIndex(SerializeSeekIndex(stream));
+	}
+}
+
 base::variant<FFmpeg::Packet, FFmpeg::AvErrorWrap> File::Context::readPacket() {
 	auto error = FFmpeg::AvErrorWrap();
 
@@ -222,7 +323,7 @@ base::variant<FFmpeg::Packet, FFmpeg::AvErrorWrap> File::Context::readPacket() {
 	return error;
 }
 
-void File::Context::start(crl::time position) {
+void File::Context::start(crl::time position, bool hwAllowed) {
 	auto error = FFmpeg::AvErrorWrap();
 
 	if (unroll()) {
@@ -241,12 +342,12 @@ void File::Context::start(crl::time position) {
 		return logFatal(qstr("avformat_find_stream_info"), error);
 	}
 
-	auto video = initStream(format.get(), AVMEDIA_TYPE_VIDEO);
+	auto video = initStream(format.get(), AVMEDIA_TYPE_VIDEO, hwAllowed);
 	if (unroll()) {
 		return;
 	}
 
-	auto audio = initStream(format.get(), AVMEDIA_TYPE_AUDIO);
+	auto audio = initStream(format.get(), AVMEDIA_TYPE_AUDIO, false);
 	if (unroll()) {
 		return;
 	}
@@ -256,7 +357,9 @@ void File::Context::start(crl::time position) {
 		sendFullInCache(true);
 	}
 	if (video.codec || audio.codec) {
-		seekToPosition(format.get(), video.codec ? video : audio, position);
+		const auto &stream = video.codec ? video : audio;
+		applySeekIndex(format.get(), stream);
+		seekToPosition(format.get(), stream, position);
 	}
 	if (unroll()) {
 		return;
@@ -301,6 +404,11 @@ void File::Context::readNextPacket() {
 	}
 }
 
+void File::Context::finish() {
+	// Remember the keyframes found while reading for the next time.
+	storeSeekIndex();
+}
+
 void File::Context::handleEndOfFile() {
 	const auto more = _delegate->fileProcessPacket(FFmpeg::Packet());
 	if (_delegate->fileReadMore()) {
@@ -356,16 +464,20 @@ File::File(
 : _reader(std::move(reader)) {
 }
 
-void File::start(not_null<FileDelegate*> delegate, crl::time position) {
+void File::start(
+		not_null<FileDelegate*> delegate,
+		crl::time position,
+		bool hwAllowed) {
 	stop(true);
 
 	_reader->startStreaming();
 	_context.emplace(delegate, _reader.get());
 	_thread = std::thread([=, context = &*_context] {
-		context->start(position);
+		context->start(position, hwAllowed);
 		while (!context->finished()) {
 			context->readNextPacket();
 		}
+		context->finish();
 	});
 }
 
@@ -388,6 +500,14 @@ bool File::isRemoteLoader() const {
 	return _reader->isRemoteLoader();
 }
 
+int64 File::bytesLoaded() const {
+	return _reader->bytesLoaded();
+}
+
+int64 File::bytesRead() const {
+	return _reader->bytesRead();
+}
+
 File::~File() {
 	stop();
 }
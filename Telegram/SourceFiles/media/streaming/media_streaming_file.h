@@ -32,11 +32,16 @@ public:
 	File(const File &other) = delete;
 	File &operator=(const File &other) = delete;
 
-	void start(not_null<FileDelegate*> delegate, crl::time position);
+	void start(
+		not_null<FileDelegate*> delegate,
+		crl::time position,
+		bool hwAllowed = false);
 	void wake();
 	void stop(bool stillActive = false);
 
 	[[nodiscard]] bool isRemoteLoader() const;
+	[[nodiscard]] int64 bytesLoaded() const;
+	[[nodiscard]] int64 bytesRead() const;
 
 	~File();
 
@@ -45,8 +50,9 @@ private:
 	public:
 		Context(not_null<FileDelegate*> delegate, not_null<Reader*> reader);
 
-		void start(crl::time position);
+		void start(crl::time position, bool hwAllowed);
 		void readNextPacket();
+		void finish();
 
 		void interrupt();
 		void wake();
@@ -72,11 +78,16 @@ private:
 
 		Stream initStream(
 			not_null<AVFormatContext *> format,
-			AVMediaType type);
+			AVMediaType type,
+			bool hwAllowed);
 		void seekToPosition(
 			not_null<AVFormatContext *> format,
 			const Stream &stream,
 			crl::time position);
+		void applySeekIndex(
+			not_null<AVFormatContext *> format,
+			const Stream &stream);
+		void storeSeekIndex();
 
 		// TODO base::expected.
 		[[nodiscard]] auto readPacket()
@@ -93,6 +104,8 @@ private:
 		bool _failed = false;
 		bool _readTillEnd = false;
 		std::optional<bool> _fullInCache;
+		int _seekStreamIndex = -1;
+		int _seekIndexSize = 0;
 		crl::semaphore _semaphore;
 		std::atomic<bool> _interrupted = false;
 
@@ -14,11 +14,6 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Media {
 namespace Streaming {
-namespace {
-
-constexpr auto kMaxConcurrentRequests = 4;
-
-} // namespace
 
 LoaderMtproto::LoaderMtproto(
 	not_null<Storage::Downloader*> owner,
@@ -110,7 +105,7 @@ void LoaderMtproto::changeRequestedAmount(int index, int amount) {
 }
 
 void LoaderMtproto::sendNext() {
-	if (_requests.size() >= kMaxConcurrentRequests) {
+	if (int(_requests.size()) >= _owner->partsInFlightForDc(_dcId)) {
 		return;
 	}
 	const auto offset = _requested.take().value_or(-1);
@@ -122,6 +117,7 @@ void LoaderMtproto::sendNext() {
 	changeRequestedAmount(index, kPartSize);
 
 	const auto usedFileReference = _location.fileReference();
+	const auto sent = crl::now();
 	const auto id = _sender.request(MTPupload_GetFile(
 		MTP_flags(0),
 		_location.tl(Auth().userId()),
@@ -129,6 +125,7 @@ void LoaderMtproto::sendNext() {
 		MTP_int(kPartSize)
 	)).done([=](const MTPupload_File &result) {
 		changeRequestedAmount(index, -kPartSize);
+		_owner->requestFinished(_dcId, kPartSize, crl::now() - sent);
 		requestDone(offset, result);
 	}).fail([=](const RPCError &error) {
 		changeRequestedAmount(index, -kPartSize);
@@ -27,6 +27,8 @@ constexpr auto kMsFrequency = 1000; // 1000 ms per second.
 // slower than we're playing, so load full file in that case.
 constexpr auto kLoadFullIfStuckAfterPlayback = 3 * crl::time(1000);
 
+constexpr auto kStatisticsUpdateTimeout = crl::time(1000);
+
 [[nodiscard]] bool FullTrackReceived(const TrackState &state) {
 	return (state.duration != kTimeUnknown)
 		&& (state.receivedTill == state.duration);
@@ -84,7 +86,8 @@ Player::Player(
 	std::shared_ptr<Reader> reader)
 : _file(std::make_unique<File>(owner, std::move(reader)))
 , _remoteLoader(_file->isRemoteLoader())
-, _renderFrameTimer([=] { checkNextFrameRender(); }) {
+, _renderFrameTimer([=] { checkNextFrameRender(); })
+, _statisticsTimer([=] { _statisticsUpdates.fire(statistics()); }) {
 }
 
 not_null<FileDelegate*> Player::delegate() {
@@ -486,7 +489,7 @@ void Player::play(const PlaybackOptions &options) {
 		_options.speed = 1.;
 	}
 	_stage = Stage::Initializing;
-	_file->start(delegate(), _options.position);
+	_file->start(delegate(), _options.position, _options.hwAllowed);
 }
 
 void Player::savePreviousReceivedTill(
@@ -625,6 +628,7 @@ bool Player::receivedTillEnd() const {
 void Player::checkResumeFromWaitingForData() {
 	if (_pausedByWaitingForData && bothReceivedEnough(kBufferFor)) {
 		_pausedByWaitingForData = false;
+		underrunFinished();
 		updatePausedState();
 		_updates.fire({ WaitingForData{ false } });
 	}
@@ -636,12 +640,19 @@ void Player::start() {
 	_stage = Stage::Started;
 	const auto guard = base::make_weak(&_sessionGuard);
 
+	_bytesLoadedBefore = _file->bytesLoaded();
+	_bytesReadBefore = _file->bytesRead();
+	_statisticsTimer.callEach(kStatisticsUpdateTimeout);
+
 	rpl::merge(
 		_audio ? _audio->waitingForData() : nullptr,
 		_video ? _video->waitingForData() : nullptr
 	) | rpl::filter([=] {
 		return !bothReceivedEnough(kBufferFor);
 	}) | rpl::start_with_next([=] {
+		if (!_pausedByWaitingForData) {
+			underrunStarted();
+		}
 		_pausedByWaitingForData = true;
 		updatePausedState();
 		_updates.fire({ WaitingForData{ true } });
@@ -680,6 +691,10 @@ void Player::start() {
 		}) | rpl::start_with_next([=] {
 			checkVideoStep();
 		}, _sessionLifetime);
+
+		if (!_visible) {
+			_video->setVisible(false);
+		}
 	}
 	if (guard && _audio) {
 		trackSendReceivedTill(*_audio, _information.audio.state);
@@ -698,6 +713,19 @@ void Player::checkVideoStep() {
 }
 
 void Player::stop(bool stillActive) {
+	if (_stage == Stage::Started) {
+		const auto statistics = this->statistics();
+		DEBUG_LOG(("Streaming Info: Played %1 of %2 fetched bytes, "
+			"%3 frames decoded (%4 ms per frame), %5 dropped, "
+			"%6 underruns (%7 ms)."
+			).arg(statistics.bytesPlayed
+			).arg(statistics.bytesFetched
+			).arg(statistics.video.framesDecoded
+			).arg(statistics.decodeMsPerFrame()
+			).arg(statistics.video.framesDropped
+			).arg(statistics.underrunsCount
+			).arg(statistics.underrunsDuration));
+	}
 	_file->stop(stillActive);
 	_sessionLifetime = rpl::lifetime();
 	_stage = Stage::Uninitialized;
@@ -707,6 +735,9 @@ void Player::stop(bool stillActive) {
 	_pausedByUser = _pausedByWaitingForData = _paused = false;
 	_renderFrameTimer.cancel();
 	_nextFrameTime = kTimeUnknown;
+	_statisticsTimer.cancel();
+	_statistics = PlaybackStatistics();
+	_underrunStartedAt = kTimeUnknown;
 	_audioFinished = false;
 	_videoFinished = false;
 	_pauseReading = false;
@@ -767,6 +798,16 @@ void Player::setSpeed(float64 speed) {
 	}
 }
 
+void Player::setVisible(bool visible) {
+	if (_visible == visible) {
+		return;
+	}
+	_visible = visible;
+	if (_video && _stage == Stage::Started) {
+		_video->setVisible(visible);
+	}
+}
+
 bool Player::active() const {
 	return (_stage != Stage::Uninitialized) && !finished() && !failed();
 }
@@ -784,6 +825,37 @@ rpl::producer<bool> Player::fullInCache() const {
 	return _fullInCache.events();
 }
 
+void Player::underrunStarted() {
+	++_statistics.underrunsCount;
+	_underrunStartedAt = crl::now();
+}
+
+void Player::underrunFinished() {
+	if (_underrunStartedAt != kTimeUnknown) {
+		_statistics.underrunsDuration += crl::now() - _underrunStartedAt;
+		_underrunStartedAt = kTimeUnknown;
+	}
+}
+
+PlaybackStatistics Player::statistics() const {
+	auto result = _statistics;
+	if (_underrunStartedAt != kTimeUnknown) {
+		result.underrunsDuration += crl::now() - _underrunStartedAt;
+	}
+	if (_stage == Stage::Started) {
+		result.bytesFetched = _file->bytesLoaded() - _bytesLoadedBefore;
+		result.bytesPlayed = _file->bytesRead() - _bytesReadBefore;
+		if (_video) {
+			result.video = _video->decodingStatistics();
+		}
+	}
+	return result;
+}
+
+rpl::producer<PlaybackStatistics> Player::statisticsValue() const {
+	return _statisticsUpdates.events_starting_with(statistics());
+}
+
 QSize Player::videoSize() const {
 	return _information.video.size;
 }
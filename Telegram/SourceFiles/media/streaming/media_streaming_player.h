@@ -50,6 +50,9 @@ public:
 	[[nodiscard]] float64 speed() const;
 	void setSpeed(float64 speed); // 0.5 <= speed <= 2.
 
+	// Offscreen players pause video decoding, audio keeps playing.
+	void setVisible(bool visible);
+
 	[[nodiscard]] bool playing() const;
 	[[nodiscard]] bool buffering() const;
 	[[nodiscard]] bool paused() const;
@@ -59,6 +62,10 @@ public:
 	[[nodiscard]] rpl::producer<Update, Error> updates() const;
 	[[nodiscard]] rpl::producer<bool> fullInCache() const;
 
+	// Counted from the last play() call.
+	[[nodiscard]] PlaybackStatistics statistics() const;
+	[[nodiscard]] rpl::producer<PlaybackStatistics> statisticsValue() const;
+
 	[[nodiscard]] QSize videoSize() const;
 	[[nodiscard]] QImage frame(const FrameRequest &request) const;
 
@@ -104,6 +111,8 @@ private:
 	void videoPlayedTill(crl::time position);
 
 	void updatePausedState();
+	void underrunStarted();
+	void underrunFinished();
 	[[nodiscard]] bool trackReceivedEnough(
 		const TrackState &state,
 		crl::time amount) const;
@@ -172,6 +181,7 @@ private:
 	bool _audioFinished = false;
 	bool _videoFinished = false;
 	bool _remoteLoader = false;
+	bool _visible = true;
 
 	crl::time _startedTime = kTimeUnknown;
 	crl::time _pausedTime = kTimeUnknown;
@@ -181,6 +191,13 @@ private:
 	rpl::event_stream<bool> _fullInCache;
 	std::optional<bool> _fullInCacheSinceStart;
 
+	PlaybackStatistics _statistics;
+	crl::time _underrunStartedAt = kTimeUnknown;
+	int64 _bytesLoadedBefore = 0;
+	int64 _bytesReadBefore = 0;
+	base::Timer _statisticsTimer;
+	rpl::event_stream<PlaybackStatistics> _statisticsUpdates;
+
 	crl::time _totalDuration = kTimeUnknown;
 	crl::time _loopingShift = 0;
 	crl::time _previousReceivedTill = kTimeUnknown;
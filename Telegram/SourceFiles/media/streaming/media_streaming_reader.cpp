@@ -10,6 +10,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/streaming/media_streaming_common.h"
 #include "media/streaming/media_streaming_loader.h"
 #include "storage/cache/storage_cache_database.h"
+#include "base/memory_usage.h"
 
 namespace Media {
 namespace Streaming {
@@ -23,10 +24,26 @@ constexpr auto kMaxOnlyInHeader = 80 * kPartSize;
 constexpr auto kPartsOutsideFirstSliceGood = 8;
 constexpr auto kSlicesInMemory = 2;
 
+// All streaming Readers together try to fit in 6 slices (48 MB),
+// but each one keeps at least kSlicesInMemory slices anyway.
+constexpr auto kSlicesInMemoryBudget = 6;
+
 // 1 MB of parts are requested from cloud ahead of reading demand.
 constexpr auto kPreloadPartsAhead = 8;
+
+// On fast links up to 4 MB of parts, enough for ~20 seconds of playback.
+constexpr auto kPreloadPartsAheadMax = 32;
+constexpr auto kPreloadDuration = crl::time(20000);
+constexpr auto kRateMeasureDuration = crl::time(2000);
 constexpr auto kDownloaderRequestsLimit = 4;
 
+// Slices fully in cache are read for the downloader before it asks.
+constexpr auto kDownloaderCachedSlicesAhead = 1;
+
+// Seek index is stored in the cache next to the file slices.
+// Slice numbers never get this far, a 2 GB file has only 256 slices.
+constexpr auto kSeekIndexSliceNumber = 0xFFFF;
+
 using PartsMap = base::flat_map<int, QByteArray>;
 
 struct ParsedCacheEntry {
@@ -34,6 +51,26 @@ struct ParsedCacheEntry {
 	std::optional<PartsMap> included;
 };
 
+std::atomic<int> ActiveStreamingReaders = 0;
+
+[[nodiscard]] int SlicesInMemory() {
+	const auto active = ActiveStreamingReaders.load(
+		std::memory_order_relaxed);
+	return std::max(
+		kSlicesInMemory,
+		kSlicesInMemoryBudget / std::max(active, 1));
+}
+
+[[nodiscard]] int ComputePreloadParts(int64 loadedRate, int64 readRate) {
+	if (loadedRate <= readRate) {
+		// Network doesn't keep up with playback, a deeper window
+		// would only delay the parts we need right now.
+		return kPreloadPartsAhead;
+	}
+	const auto wanted = (readRate * kPreloadDuration / 1000) / kPartSize;
+	return std::clamp(int(wanted), kPreloadPartsAhead, kPreloadPartsAheadMax);
+}
+
 bool IsContiguousSerialization(int serializedSize, int maxSliceSize) {
 	return !(serializedSize % kPartSize) || (serializedSize == maxSliceSize);
 }
@@ -190,6 +227,12 @@ void CopyLoaded(bytes::span buffer, Range &&parts, int offset, int till) {
 	}
 }
 
+void AccountParts(int64 bytes) {
+	base::memory_usage::Add(
+		base::memory_usage::Category::StreamingParts,
+		bytes);
+}
+
 } // namespace
 
 template <int Size>
@@ -223,6 +266,7 @@ struct Reader::CacheHelper {
 	const Storage::Cache::Key baseKey;
 
 	QMutex mutex;
+	QByteArray seekIndex;
 	base::flat_map<int, PartsMap> results;
 	std::vector<int> sizes;
 	std::atomic<crl::semaphore*> waiting = nullptr;
@@ -246,9 +290,13 @@ void Reader::Slice::processCacheData(PartsMap &&data) {
 	});
 	if (parts.empty()) {
 		parts = std::move(data);
+		AccountParts(memoryUsage());
 	} else {
 		for (auto &[offset, bytes] : data) {
-			parts.emplace(offset, std::move(bytes));
+			const auto size = bytes.size();
+			if (parts.emplace(offset, std::move(bytes)).second) {
+				AccountParts(size);
+			}
 		}
 	}
 }
@@ -256,19 +304,31 @@ void Reader::Slice::processCacheData(PartsMap &&data) {
 void Reader::Slice::addPart(int offset, QByteArray bytes) {
 	Expects(!parts.contains(offset));
 
+	AccountParts(bytes.size());
 	parts.emplace(offset, std::move(bytes));
 	if (flags & Flag::LoadedFromCache) {
 		flags |= Flag::ChangedSinceCache;
 	}
 }
 
-auto Reader::Slice::prepareFill(int from, int till) -> PrepareFillResult {
+int64 Reader::Slice::memoryUsage() const {
+	auto result = int64(0);
+	for (const auto &[offset, bytes] : parts) {
+		result += bytes.size();
+	}
+	return result;
+}
+
+auto Reader::Slice::prepareFill(
+		int from,
+		int till,
+		int preloadParts) -> PrepareFillResult {
 	auto result = PrepareFillResult();
 
 	result.ready = false;
 	const auto fromOffset = (from / kPartSize) * kPartSize;
 	const auto tillPart = (till + kPartSize - 1) / kPartSize;
-	const auto preloadTillOffset = (tillPart + kPreloadPartsAhead)
+	const auto preloadTillOffset = (tillPart + preloadParts)
 		* kPartSize;
 
 	const auto after = ranges::upper_bound(
@@ -346,6 +406,14 @@ Reader::Slices::Slices(int size, bool useCache)
 	}
 }
 
+Reader::Slices::~Slices() {
+	auto usage = _header.memoryUsage();
+	for (const auto &slice : _data) {
+		usage += slice.memoryUsage();
+	}
+	AccountParts(-usage);
+}
+
 bool Reader::Slices::headerModeUnknown() const {
 	return (_headerMode == HeaderMode::Unknown);
 }
@@ -541,7 +609,11 @@ void Reader::Slices::processPart(
 	checkSliceFullLoaded(index + 1);
 }
 
-auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
+auto Reader::Slices::fill(
+		int offset,
+		bytes::span buffer,
+		int preloadParts,
+		int slicesInMemory) -> FillResult {
 	Expects(!buffer.empty());
 	Expects(offset >= 0 && offset < _size);
 	Expects(offset + buffer.size() <= _size);
@@ -555,7 +627,7 @@ auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 		Assert(waitingForHeaderCache());
 		return {};
 	} else if (isFullInHeader()) {
-		return fillFromHeader(offset, buffer);
+		return fillFromHeader(offset, buffer, preloadParts);
 	}
 
 	auto result = FillResult();
@@ -595,9 +667,15 @@ auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 	const auto firstTill = std::min(kInSlice, till - fromSlice * kInSlice);
 	const auto secondFrom = 0;
 	const auto secondTill = till - (fromSlice + 1) * kInSlice;
-	const auto first = _data[fromSlice].prepareFill(firstFrom, firstTill);
+	const auto first = _data[fromSlice].prepareFill(
+		firstFrom,
+		firstTill,
+		preloadParts);
 	const auto second = (fromSlice + 1 < tillSlice)
-		? _data[fromSlice + 1].prepareFill(secondFrom, secondTill)
+		? _data[fromSlice + 1].prepareFill(
+			secondFrom,
+			secondTill,
+			preloadParts)
 		: Slice::PrepareFillResult();
 	handlePrepareResult(fromSlice, first);
 	if (fromSlice + 1 < tillSlice) {
@@ -618,7 +696,7 @@ auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 				secondFrom,
 				secondTill);
 		}
-		result.toCache = serializeAndUnloadUnused();
+		result.toCache = serializeAndUnloadUnused(slicesInMemory);
 		result.filled = true;
 	} else {
 		handleReadFromCache(fromSlice);
@@ -629,13 +707,15 @@ auto Reader::Slices::fill(int offset, bytes::span buffer) -> FillResult {
 	return result;
 }
 
-auto Reader::Slices::fillFromHeader(int offset, bytes::span buffer)
--> FillResult {
+auto Reader::Slices::fillFromHeader(
+		int offset,
+		bytes::span buffer,
+		int preloadParts) -> FillResult {
 	auto result = FillResult();
 	const auto from = offset;
 	const auto till = int(offset + buffer.size());
 
-	const auto prepared = _header.prepareFill(from, till);
+	const auto prepared = _header.prepareFill(from, till, preloadParts);
 	for (const auto full : prepared.offsetsFromLoader.values()) {
 		if (full < _size) {
 			result.offsetsFromLoader.add(full);
@@ -682,6 +762,14 @@ bool Reader::Slices::readCacheForDownloaderRequired(int offset) {
 	return !(slice.flags & Slice::Flag::LoadedFromCache);
 }
 
+bool Reader::Slices::sliceFullInCache(int sliceNumber) const {
+	Expects(sliceNumber > 0);
+
+	return !isFullInHeader()
+		&& (sliceNumber <= int(_data.size()))
+		&& (_data[sliceNumber - 1].flags & Slice::Flag::FullInCache);
+}
+
 void Reader::Slices::markSliceUsed(int sliceIndex) {
 	const auto i = ranges::find(_usedSlices, sliceIndex);
 	const auto end = _usedSlices.end();
@@ -699,11 +787,12 @@ int Reader::Slices::maxSliceSize(int sliceNumber) const {
 	return MaxSliceSize(sliceNumber, _size);
 }
 
-Reader::SerializedSlice Reader::Slices::serializeAndUnloadUnused() {
+Reader::SerializedSlice Reader::Slices::serializeAndUnloadUnused(
+		int slicesInMemory) {
 	using Flag = Slice::Flag;
 
 	if (_headerMode == HeaderMode::Unknown
-		|| _usedSlices.size() <= kSlicesInMemory) {
+		|| _usedSlices.size() <= slicesInMemory) {
 		return {};
 	}
 	const auto purgeSlice = _usedSlices.front();
@@ -790,6 +879,7 @@ Reader::SerializedSlice Reader::Slices::serializeAndUnloadSlice(
 
 void Reader::Slices::unloadSlice(Slice &slice) const {
 	const auto full = (slice.flags & Slice::Flag::FullInCache);
+	AccountParts(-slice.memoryUsage());
 	slice = Slice();
 	if (full) {
 		slice.flags |= Slice::Flag::FullInCache;
@@ -821,7 +911,10 @@ QByteArray Reader::Slices::serializeAndUnloadFirstSliceNoHeader() {
 
 	auto &slice = _data[0];
 	for (const auto &[offset, part] : _header.parts) {
-		slice.parts.erase(offset);
+		if (const auto i = slice.parts.find(offset); i != end(slice.parts)) {
+			AccountParts(-i->second.size());
+			slice.parts.erase(i);
+		}
 	}
 	auto result = serializeComplexSlice(slice);
 	unloadSlice(slice);
@@ -850,13 +943,15 @@ Reader::Reader(
 : _cache(cache)
 , _loader(std::move(loader))
 , _cacheHelper(InitCacheHelper(_loader->baseCacheKey()))
-, _slices(_loader->size(), _cacheHelper != nullptr) {
+, _slices(_loader->size(), _cacheHelper != nullptr)
+, _preloadPartsAhead(kPreloadPartsAhead) {
 	_loader->parts(
 	) | rpl::start_with_next([=](LoadedPart &&part) {
 		if (_attachedDownloader) {
 			_partsForDownloader.fire_copy(part);
 		}
 		if (_streamingActive) {
+			_bytesLoaded += part.bytes.size();
 			_loadedParts.emplace(std::move(part));
 		}
 		if (const auto waiting = _waiting.load(std::memory_order_acquire)) {
@@ -866,6 +961,9 @@ Reader::Reader(
 	}, _lifetime);
 
 	if (_cacheHelper) {
+		// Database handles requests in order, so the seek index
+		// is ready by the time we're done with the header.
+		readSeekIndexFromCache();
 		readFromCache(0);
 	}
 }
@@ -887,7 +985,19 @@ void Reader::stopSleep() {
 }
 
 void Reader::startStreaming() {
-	_streamingActive = true;
+	activateStreaming(true);
+}
+
+void Reader::activateStreaming(bool active) {
+	if (_streamingActive == active) {
+		return;
+	}
+	_streamingActive = active;
+	if (active) {
+		++ActiveStreamingReaders;
+	} else {
+		--ActiveStreamingReaders;
+	}
 }
 
 void Reader::stopStreaming(bool stillActive) {
@@ -895,7 +1005,7 @@ void Reader::stopStreaming(bool stillActive) {
 
 	_waiting.store(nullptr, std::memory_order_release);
 	if (!stillActive) {
-		_streamingActive = false;
+		activateStreaming(false);
 		_loadingOffsets.clear();
 		processDownloaderRequests();
 	}
@@ -970,6 +1080,7 @@ void Reader::checkForDownloaderChange(int checkItemsCount) {
 			begin(_offsetsForDownloader),
 			changed + 1);
 		_downloaderReadCache.clear();
+		_downloaderSentSlices.clear();
 		_downloaderOffsetAcks.take();
 	}
 }
@@ -1008,9 +1119,49 @@ void Reader::checkForDownloaderReadyOffsets() {
 		ranges::find_if(_offsetsForDownloader, unavailable));
 }
 
+void Reader::sendCachedSlicesToDownloader() {
+	// Send all the parts of a slice read from cache at once, so that
+	// the downloader has to request only the parts missing in cache.
+	auto nextSliceNumber = 0;
+	for (const auto &[sliceNumber, cachedParts] : _downloaderReadCache) {
+		if (!cachedParts
+			|| cachedParts->empty()
+			|| !_downloaderSentSlices.emplace(sliceNumber).second) {
+			continue;
+		}
+		const auto shift = (sliceNumber - 1) * kInSlice;
+		auto parts = std::vector<LoadedPart>();
+		parts.reserve(cachedParts->size());
+		for (const auto &[offset, bytes] : *cachedParts) {
+			parts.push_back({ shift + offset, bytes });
+		}
+		crl::on_main(this, [=, parts = std::move(parts)]() mutable {
+			if (!_attachedDownloader) {
+				return;
+			}
+			for (auto &part : parts) {
+				_partsForDownloader.fire(std::move(part));
+			}
+		});
+		nextSliceNumber = sliceNumber + 1;
+	}
+	if (!nextSliceNumber) {
+		return;
+	}
+	const auto frontSliceNumber = empty(_offsetsForDownloader)
+		? (nextSliceNumber - 1)
+		: (_offsetsForDownloader.front() / kInSlice) + 1;
+	const auto readTill = frontSliceNumber + kDownloaderCachedSlicesAhead;
+	if (nextSliceNumber <= readTill
+		&& _slices.sliceFullInCache(nextSliceNumber)) {
+		downloaderWaitForCachedSlice((nextSliceNumber - 1) * kInSlice);
+	}
+}
+
 void Reader::processDownloaderRequests() {
 	processCacheResults();
 	enqueueDownloaderOffsets();
+	sendCachedSlicesToDownloader();
 	checkForDownloaderReadyOffsets();
 	pruneDoneDownloaderRequests();
 	if (!empty(_offsetsForDownloader)) {
@@ -1142,6 +1293,43 @@ void Reader::readFromCache(int sliceNumber) {
 	_cache->getWithSizes(key, std::move(keys), ready);
 }
 
+void Reader::readSeekIndexFromCache() {
+	Expects(_cacheHelper != nullptr);
+
+	const auto key = _cacheHelper->key(kSeekIndexSliceNumber);
+	const auto cache = std::weak_ptr<CacheHelper>(_cacheHelper);
+	_cache->get(key, [=](QByteArray &&result) {
+		if (const auto strong = cache.lock()) {
+			QMutexLocker lock(&strong->mutex);
+			strong->seekIndex = std::move(result);
+		}
+	});
+}
+
+QByteArray Reader::seekIndex() const {
+	if (!_cacheHelper) {
+		return QByteArray();
+	}
+	QMutexLocker lock(&_cacheHelper->mutex);
+	return _cacheHelper->seekIndex;
+}
+
+void Reader::putSeekIndex(QByteArray data) {
+	if (!_cacheHelper || data.isEmpty()) {
+		return;
+	}
+	QMutexLocker lock(&_cacheHelper->mutex);
+	if (_cacheHelper->seekIndex == data) {
+		return;
+	}
+	_cacheHelper->seekIndex = data;
+	lock.unlock();
+
+	_cache->put(
+		_cacheHelper->key(kSeekIndexSliceNumber),
+		std::move(data));
+}
+
 bool Reader::readFromCacheForDownloader(int sliceNumber) {
 	Expects(_cacheHelper != nullptr);
 	Expects(sliceNumber > 0);
@@ -1164,6 +1352,14 @@ int Reader::size() const {
 	return _loader->size();
 }
 
+int64 Reader::bytesLoaded() const {
+	return _bytesLoaded.load(std::memory_order_relaxed);
+}
+
+int64 Reader::bytesRead() const {
+	return _bytesRead.load(std::memory_order_relaxed);
+}
+
 std::optional<Error> Reader::streamingError() const {
 	return _streamingError;
 }
@@ -1216,6 +1412,8 @@ bool Reader::fill(
 	do {
 		if (fillFromSlices(offset, buffer)) {
 			clearWaiting();
+			updatePreloadWindow(offset, buffer.size());
+			_bytesRead += buffer.size();
 			return true;
 		}
 		startWaiting();
@@ -1227,7 +1425,11 @@ bool Reader::fill(
 bool Reader::fillFromSlices(int offset, bytes::span buffer) {
 	using namespace rpl::mappers;
 
-	auto result = _slices.fill(offset, buffer);
+	auto result = _slices.fill(
+		offset,
+		buffer,
+		_preloadPartsAhead,
+		SlicesInMemory());
 	if (!result.filled && _slices.headerWontBeFilled()) {
 		_streamingError = Error::NotStreamable;
 		return false;
@@ -1257,6 +1459,29 @@ bool Reader::fillFromSlices(int offset, bytes::span buffer) {
 	return result.filled;
 }
 
+void Reader::updatePreloadWindow(int offset, int size) {
+	// Only sequential reading tells us the playback bitrate,
+	// after a seek we start measuring from scratch.
+	const auto now = crl::now();
+	if (offset != _lastFillTill) {
+		_rateMeasureStarted = now;
+		_rateMeasureLoaded = _rateMeasureRead = 0;
+	} else {
+		_rateMeasureRead += size;
+	}
+	_lastFillTill = offset + size;
+
+	const auto passed = now - _rateMeasureStarted;
+	if (passed < kRateMeasureDuration) {
+		return;
+	}
+	_preloadPartsAhead = ComputePreloadParts(
+		_rateMeasureLoaded * 1000 / passed,
+		_rateMeasureRead * 1000 / passed);
+	_rateMeasureStarted = now;
+	_rateMeasureLoaded = _rateMeasureRead = 0;
+}
+
 void Reader::cancelLoadInRange(int from, int till) {
 	Expects(from < till);
 
@@ -1324,6 +1549,7 @@ bool Reader::processLoadedParts() {
 		} else if (!_loadingOffsets.remove(part.offset)) {
 			continue;
 		}
+		_rateMeasureLoaded += part.bytes.size();
 		_slices.processPart(
 			part.offset,
 			std::move(part.bytes));
@@ -1360,6 +1586,7 @@ void Reader::finalizeCache() {
 }
 
 Reader::~Reader() {
+	activateStreaming(false);
 	finalizeCache();
 }
 
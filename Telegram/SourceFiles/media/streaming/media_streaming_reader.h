@@ -40,6 +40,8 @@ public:
 	// Any thread.
 	[[nodiscard]] int size() const;
 	[[nodiscard]] bool isRemoteLoader() const;
+	[[nodiscard]] int64 bytesLoaded() const;
+	[[nodiscard]] int64 bytesRead() const;
 
 	// Single thread.
 	[[nodiscard]] bool fill(
@@ -50,6 +52,8 @@ public:
 	void headerDone();
 	[[nodiscard]] int headerSize() const;
 	[[nodiscard]] bool fullInCache() const;
+	[[nodiscard]] QByteArray seekIndex() const;
+	void putSeekIndex(QByteArray data);
 
 	// Thread safe.
 	void startSleep(not_null<crl::semaphore*> wake);
@@ -69,7 +73,7 @@ public:
 	~Reader();
 
 private:
-	static constexpr auto kLoadFromRemoteMax = 8;
+	static constexpr auto kLoadFromRemoteMax = 32;
 
 	struct CacheHelper;
 
@@ -118,7 +122,8 @@ private:
 
 		void processCacheData(PartsMap &&data);
 		void addPart(int offset, QByteArray bytes);
-		PrepareFillResult prepareFill(int from, int till);
+		PrepareFillResult prepareFill(int from, int till, int preloadParts);
+		[[nodiscard]] int64 memoryUsage() const;
 
 		// Get up to kLoadFromRemoteMax not loaded parts in from-till range.
 		StackIntVector<kLoadFromRemoteMax> offsetsFromLoader(
@@ -133,6 +138,7 @@ private:
 	class Slices {
 	public:
 		Slices(int size, bool useCache);
+		~Slices();
 
 		void headerDone(bool fromCache);
 		[[nodiscard]] int headerSize() const;
@@ -149,11 +155,16 @@ private:
 		void processCachedSizes(const std::vector<int> &sizes);
 		void processPart(int offset, QByteArray &&bytes);
 
-		[[nodiscard]] FillResult fill(int offset, bytes::span buffer);
+		[[nodiscard]] FillResult fill(
+			int offset,
+			bytes::span buffer,
+			int preloadParts,
+			int slicesInMemory);
 		[[nodiscard]] SerializedSlice unloadToCache();
 
 		[[nodiscard]] QByteArray partForDownloader(int offset) const;
 		[[nodiscard]] bool readCacheForDownloaderRequired(int offset);
+		[[nodiscard]] bool sliceFullInCache(int sliceNumber) const;
 
 	private:
 		enum class HeaderMode {
@@ -168,7 +179,8 @@ private:
 		[[nodiscard]] int maxSliceSize(int sliceNumber) const;
 		[[nodiscard]] SerializedSlice serializeAndUnloadSlice(
 			int sliceNumber);
-		[[nodiscard]] SerializedSlice serializeAndUnloadUnused();
+		[[nodiscard]] SerializedSlice serializeAndUnloadUnused(
+			int slicesInMemory);
 		[[nodiscard]] QByteArray serializeComplexSlice(
 			const Slice &slice) const;
 		[[nodiscard]] QByteArray serializeAndUnloadFirstSliceNoHeader();
@@ -176,7 +188,8 @@ private:
 		[[nodiscard]] bool computeIsGoodHeader() const;
 		[[nodiscard]] FillResult fillFromHeader(
 			int offset,
-			bytes::span buffer);
+			bytes::span buffer,
+			int preloadParts);
 		void unloadSlice(Slice &slice) const;
 		void checkSliceFullLoaded(int sliceNumber);
 		[[nodiscard]] bool checkFullInCache() const;
@@ -193,6 +206,7 @@ private:
 	// 0 is for headerData, slice index = sliceNumber - 1.
 	// returns false if asked for a known-empty downloader slice cache.
 	void readFromCache(int sliceNumber);
+	void readSeekIndexFromCache();
 	[[nodiscard]] bool readFromCacheForDownloader(int sliceNumber);
 	bool processCacheResults();
 	void putToCache(SerializedSlice &&data);
@@ -205,6 +219,8 @@ private:
 	bool checkForSomethingMoreReceived();
 
 	bool fillFromSlices(int offset, bytes::span buffer);
+	void updatePreloadWindow(int offset, int size);
+	void activateStreaming(bool active);
 
 	void finalizeCache();
 
@@ -217,6 +233,7 @@ private:
 	void enqueueDownloaderOffsets();
 	void checkForDownloaderChange(int checkItemsCount);
 	void checkForDownloaderReadyOffsets();
+	void sendCachedSlicesToDownloader();
 
 	static std::shared_ptr<CacheHelper> InitCacheHelper(
 		std::optional<Storage::Cache::Key> baseKey);
@@ -225,9 +242,11 @@ private:
 	const std::unique_ptr<Loader> _loader;
 	const std::shared_ptr<CacheHelper> _cacheHelper;
 
-	base::thread_safe_queue<LoadedPart, std::vector> _loadedParts;
+	base::lock_free_queue<LoadedPart, std::vector> _loadedParts;
 	std::atomic<crl::semaphore*> _waiting = nullptr;
 	std::atomic<crl::semaphore*> _sleeping = nullptr;
+	std::atomic<int64> _bytesLoaded = 0;
+	std::atomic<int64> _bytesRead = 0;
 	PriorityQueue _loadingOffsets;
 
 	Slices _slices;
@@ -244,14 +263,20 @@ private:
 	bool _streamingActive = false;
 
 	// Streaming thread.
+	int _preloadPartsAhead = 0;
+	crl::time _rateMeasureStarted = 0;
+	int64 _rateMeasureLoaded = 0;
+	int64 _rateMeasureRead = 0;
+	int _lastFillTill = -1;
 	std::deque<int> _offsetsForDownloader;
 	base::flat_set<int> _downloaderOffsetsRequested;
 	base::flat_map<int, std::optional<PartsMap>> _downloaderReadCache;
+	base::flat_set<int> _downloaderSentSlices;
 
 	// Communication from main thread to streaming thread.
 	// Streaming thread to main thread communicates using crl::on_main.
-	base::thread_safe_queue<int> _downloaderOffsetRequests;
-	base::thread_safe_queue<int> _downloaderOffsetAcks;
+	base::lock_free_queue<int> _downloaderOffsetRequests;
+	base::lock_free_queue<int> _downloaderOffsetAcks;
 
 	rpl::lifetime _lifetime;
 
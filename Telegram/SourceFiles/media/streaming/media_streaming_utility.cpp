@@ -103,6 +103,19 @@ QImage ConvertFrame(
 		QImage storage) {
 	Expects(frame != nullptr);
 
+	const auto decoded = frame;
+	if (frame->hw_frames_ctx) {
+		if (!stream.transferred) {
+			stream.transferred = FFmpeg::MakeFramePointer();
+		}
+		const auto software = stream.transferred.get();
+		if (FFmpeg::TransferHwFrame(software, frame)) {
+			return QImage();
+		}
+		av_frame_unref(frame);
+		frame = software;
+	}
+
 	const auto frameSize = QSize(frame->width, frame->height);
 	if (frameSize.isEmpty()) {
 		LOG(("Streaming Error: Bad frame size %1,%2"
@@ -170,7 +183,8 @@ QImage ConvertFrame(
 		}
 	}
 
-	FFmpeg::ClearFrameMemory(frame);
+	// Transferred frame buffers are kept for the next transfer.
+	FFmpeg::ClearFrameMemory(decoded);
 	return storage;
 }
 
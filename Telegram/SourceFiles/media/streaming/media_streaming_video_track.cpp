@@ -7,6 +7,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "media/streaming/media_streaming_video_track.h"
 
+#include "media/streaming/media_streaming_decode_scheduler.h"
 #include "media/audio/media_audio.h"
 #include "base/concurrent_timer.h"
 
@@ -42,6 +43,7 @@ public:
 	void pause(crl::time time);
 	void resume(crl::time time);
 	void setSpeed(float64 speed);
+	void setVisible(bool visible);
 	void interrupt();
 	void frameDisplayed();
 	void updateFrameRequest(const FrameRequest &request);
@@ -100,6 +102,7 @@ private:
 	FrameRequest _request = FrameRequest::NonStrict();
 
 	bool _queued = false;
+	bool _hidden = false;
 	base::ConcurrentTimer _readFramesTimer;
 
 	// For initial frame skipping for an exact seek.
@@ -122,7 +125,7 @@ VideoTrackObject::VideoTrackObject(
 , _audioId(audioId)
 , _ready(std::move(ready))
 , _error(std::move(error))
-, _readFramesTimer(_weak, [=] { readFrames(); }) {
+, _readFramesTimer(_weak, [=] { queueReadFrames(); }) {
 	Expects(_stream.duration > 1);
 	Expects(_ready != nullptr);
 	Expects(_error != nullptr);
@@ -182,17 +185,22 @@ int VideoTrackObject::durationByPacket(const FFmpeg::Packet &packet) {
 void VideoTrackObject::queueReadFrames(crl::time delay) {
 	if (delay > 0) {
 		_readFramesTimer.callOnce(delay);
-	} else if (!_queued) {
+	} else if (!_queued && !_hidden) {
+		// Decoding waits for a free slot shared by all the video tracks.
 		_queued = true;
-		_weak.with([](VideoTrackObject &that) {
-			that._queued = false;
-			that.readFrames();
+		const auto weak = _weak;
+		DecodeScheduler::Instance()->request(crl::now(), [=](
+				DecodeScheduler::SlotPointer slot) {
+			weak.with([slot = std::move(slot)](VideoTrackObject &that) {
+				that._queued = false;
+				that.readFrames();
+			});
 		});
 	}
 }
 
 void VideoTrackObject::readFrames() {
-	if (interrupted()) {
+	if (interrupted() || _hidden) {
 		return;
 	}
 	auto time = trackTime().trackTime;
@@ -233,6 +241,7 @@ auto VideoTrackObject::readEnoughFrames(crl::time trackTime)
 				|| !VideoTrack::IsStale(frame, trackTime)) {
 				return std::nullopt;
 			}
+			_shared->countDropped();
 		}
 	}, [&](Shared::PrepareNextCheck delay) -> ReadEnoughState {
 		return delay;
@@ -265,6 +274,7 @@ crl::time VideoTrackObject::computeDuration() const {
 }
 
 auto VideoTrackObject::readFrame(not_null<Frame*> frame) -> FrameResult {
+	const auto started = crl::profile();
 	if (const auto error = ReadNextFrame(_stream)) {
 		if (error.code() == AVERROR_EOF) {
 			if (!_options.loop) {
@@ -293,6 +303,7 @@ auto VideoTrackObject::readFrame(not_null<Frame*> frame) -> FrameResult {
 	std::swap(frame->decoded, _stream.frame);
 	frame->position = position;
 	frame->displayed = kTimeUnknown;
+	_shared->countDecoded(crl::profile() - started);
 	return FrameResult::Done;
 }
 
@@ -304,6 +315,10 @@ void VideoTrackObject::presentFrameIfNeeded() {
 	const auto rasterize = [&](not_null<Frame*> frame) {
 		Expects(frame->position != kFinishedPosition);
 
+		const auto started = crl::profile();
+		const auto guard = gsl::finally([&] {
+			_shared->countRasterized(crl::profile() - started);
+		});
 		frame->request = _request;
 		frame->original = ConvertFrame(
 			_stream,
@@ -380,6 +395,16 @@ void VideoTrackObject::setSpeed(float64 speed) {
 	_options.speed = speed;
 }
 
+void VideoTrackObject::setVisible(bool visible) {
+	if (interrupted() || _hidden != visible) {
+		return;
+	}
+	_hidden = !visible;
+	if (visible) {
+		queueReadFrames();
+	}
+}
+
 bool VideoTrackObject::interrupted() const {
 	return (_shared == nullptr);
 }
@@ -476,7 +501,9 @@ void VideoTrackObject::callReady() {
 	if (FFmpeg::RotationSwapWidthHeight(_stream.rotation)) {
 		data.size.transpose();
 	}
-	data.cover = frame->original;
+	// Frames storage is reused only while not shared with anyone,
+	// so we don't give out the first frame storage as a long living cover.
+	data.cover = frame->original.copy();
 	data.rotation = _stream.rotation;
 	data.state.duration = _stream.duration;
 	data.state.position = _syncTimePoint.trackTime;
@@ -572,6 +599,7 @@ auto VideoTrack::Shared::prepareState(
 		} else if (IsStale(frame, trackTime)) {
 			std::swap(*frame, *next);
 			next->displayed = kDisplaySkipped;
+			countDropped();
 			return next;
 		} else {
 			return PrepareNextCheck(frame->position - trackTime + 1);
@@ -664,6 +692,27 @@ auto VideoTrack::Shared::presentFrame(
 	Unexpected("Counter value in VideoTrack::Shared::prepareState.");
 }
 
+void VideoTrack::Shared::countDecoded(crl::profile_time duration) {
+	_framesDecoded.fetch_add(1, std::memory_order_relaxed);
+	_decodeTime.fetch_add(duration, std::memory_order_relaxed);
+}
+
+void VideoTrack::Shared::countRasterized(crl::profile_time duration) {
+	_decodeTime.fetch_add(duration, std::memory_order_relaxed);
+}
+
+void VideoTrack::Shared::countDropped() {
+	_framesDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+DecodingStatistics VideoTrack::Shared::statistics() const {
+	auto result = DecodingStatistics();
+	result.framesDecoded = _framesDecoded.load(std::memory_order_relaxed);
+	result.framesDropped = _framesDropped.load(std::memory_order_relaxed);
+	result.decodeTime = _decodeTime.load(std::memory_order_relaxed);
+	return result;
+}
+
 crl::time VideoTrack::Shared::nextFrameDisplayTime() const {
 	const auto frameDisplayTime = [&](int counter) {
 		const auto next = (counter + 1) % (2 * kFramesCount);
@@ -787,6 +836,12 @@ void VideoTrack::setSpeed(float64 speed) {
 	});
 }
 
+void VideoTrack::setVisible(bool visible) {
+	_wrapped.with([=](Implementation &unwrapped) {
+		unwrapped.setVisible(visible);
+	});
+}
+
 crl::time VideoTrack::nextFrameDisplayTime() const {
 	return _shared->nextFrameDisplayTime();
 }
@@ -801,6 +856,10 @@ crl::time VideoTrack::markFrameDisplayed(crl::time now) {
 	return result;
 }
 
+DecodingStatistics VideoTrack::decodingStatistics() const {
+	return _shared->statistics();
+}
+
 QImage VideoTrack::frame(const FrameRequest &request) {
 	const auto frame = _shared->frameForPaint();
 	const auto changed = (frame->request != request)
@@ -44,6 +44,10 @@ public:
 	// Called from the main thread.
 	void setSpeed(float64 speed);
 
+	// Called from the main thread.
+	// Hidden tracks don't decode frames until they're shown again.
+	void setVisible(bool visible);
+
 	// Called from the main thread.
 	// Returns the position of the displayed frame.
 	[[nodiscard]] crl::time markFrameDisplayed(crl::time now);
@@ -52,6 +56,9 @@ public:
 	[[nodiscard]] rpl::producer<> checkNextFrame() const;
 	[[nodiscard]] rpl::producer<> waitingForData() const;
 
+	// Thread-safe.
+	[[nodiscard]] DecodingStatistics decodingStatistics() const;
+
 	// Called from the main thread.
 	~VideoTrack();
 
@@ -104,6 +111,14 @@ private:
 		[[nodiscard]] crl::time nextFrameDisplayTime() const;
 		[[nodiscard]] not_null<Frame*> frameForPaint();
 
+		// Called from the wrapped object queue.
+		void countDecoded(crl::profile_time duration);
+		void countRasterized(crl::profile_time duration);
+		void countDropped();
+
+		// Thread-safe.
+		[[nodiscard]] DecodingStatistics statistics() const;
+
 	private:
 		[[nodiscard]] not_null<Frame*> getFrame(int index);
 		[[nodiscard]] not_null<const Frame*> getFrame(int index) const;
@@ -115,6 +130,10 @@ private:
 		static constexpr auto kFramesCount = 4;
 		std::array<Frame, kFramesCount> _frames;
 
+		std::atomic<int> _framesDecoded = 0;
+		std::atomic<int> _framesDropped = 0;
+		std::atomic<crl::profile_time> _decodeTime = 0;
+
 	};
 
 	static QImage PrepareFrameByRequest(
@@ -75,6 +75,10 @@ constexpr auto kPreloadCount = 4;
 // even though it reports that max texture size is 16384.
 constexpr auto kMaxDisplayImageSize = 4096;
 
+// Prepare display images of X next photos in the moving direction.
+constexpr auto kPreparePhotosCount = 2;
+constexpr auto kPreparePhotosBytesLimit = 64 * 1024 * 1024;
+
 // Preload X message ids before and after current.
 constexpr auto kIdsLimit = 48;
 
@@ -381,9 +385,13 @@ bool OverlayWidget::videoIsGifv() const {
 }
 
 QImage OverlayWidget::videoFrame() const {
+	return videoFrame(Streaming::FrameRequest());
+}
+
+QImage OverlayWidget::videoFrame(
+		const Streaming::FrameRequest &request) const {
 	Expects(videoShown());
 
-	auto request = Streaming::FrameRequest();
 	//request.radius = (_doc && _doc->isVideoMessage())
 	//	? ImageRoundRadius::Ellipse
 	//	: ImageRoundRadius::None;
@@ -395,7 +403,17 @@ QImage OverlayWidget::videoFrame() const {
 QImage OverlayWidget::videoFrameForDirectPaint() const {
 	Expects(_streamed != nullptr);
 
-	const auto result = videoFrame();
+	// Ask the decoder thread to scale the frame to the painted size in
+	// the same swscale pass that converts it from YUV, so that painting
+	// doesn't scale it once again. Zoomed in frames are scaled by painter.
+	auto request = Streaming::FrameRequest();
+	const auto size = contentRect().size() * cIntRetinaFactor();
+	const auto fits = (size.width() <= width() * cIntRetinaFactor())
+		&& (size.height() <= height() * cIntRetinaFactor());
+	if (fits && !size.isEmpty() && !(_streamed->info.video.rotation % 180)) {
+		request.resize = request.outer = size;
+	}
+	const auto result = videoFrame(request);
 
 #ifdef USE_OPENGL_OVERLAY_WIDGET
 	const auto bytesPerLine = result.bytesPerLine();
@@ -983,6 +1001,7 @@ void OverlayWidget::clearData() {
 	_from = nullptr;
 	_fromName = QString();
 	_photo = nullptr;
+	_preparedPhotos.clear();
 	_doc = nullptr;
 	_fullScreenVideo = false;
 	_caption.clear();
@@ -2391,6 +2410,7 @@ void OverlayWidget::restartAtSeekPosition(crl::time position) {
 	auto options = Streaming::PlaybackOptions();
 	options.position = position;
 	options.audioId = AudioMsgId(_doc, _msgid);
+	options.hwAllowed = true;
 	if (!_streamed->withSound) {
 		options.mode = Streaming::Mode::Video;
 		options.loop = true;
@@ -2513,6 +2533,18 @@ void OverlayWidget::validatePhotoImage(Image *image, bool blurred) {
 	}
 	const auto w = _width * cIntRetinaFactor();
 	const auto h = _height * cIntRetinaFactor();
+	if (!blurred && image == _photo->large()) {
+		const auto i = _preparedPhotos.find(_photo);
+		if (i != end(_preparedPhotos)
+			&& i->second.width() == w
+			&& i->second.height() == h) {
+			_current = App::pixmapFromImageInPlace(std::move(i->second));
+			_preparedPhotos.erase(i);
+			_current.setDevicePixelRatio(cRetinaFactor());
+			_blurred = false;
+			return;
+		}
+	}
 	_current = image->pixNoCache(
 		fileOrigin(),
 		w,
@@ -2577,7 +2609,7 @@ void OverlayWidget::paintEvent(QPaintEvent *e) {
 				}
 				if (!_current.isNull()) {
 					PainterHighQualityEnabler hq(p);
-					p.drawPixmap(rect, _current);
+					p.drawPixmap(rect, currentForSize(rect.size()));
 				}
 			}
 
@@ -3269,6 +3301,8 @@ void OverlayWidget::preloadData(int delta) {
 		}
 	}
 
+	preparePhotosAhead(delta);
+
 	for (auto index = from; index != till; ++index) {
 		auto entity = entityByIndex(index);
 		if (auto photo = base::get_if<not_null<PhotoData*>>(&entity.data)) {
@@ -3284,6 +3318,107 @@ void OverlayWidget::preloadData(int delta) {
 	}
 }
 
+const QPixmap &OverlayWidget::currentForSize(QSize size) {
+	const auto wanted = size * cIntRetinaFactor();
+	if (wanted.isEmpty()) {
+		return _current;
+	}
+	auto level = _current.size();
+	while (level.width() >= 2 * wanted.width()
+		&& level.height() >= 2 * wanted.height()) {
+		level /= 2;
+	}
+	if (level == _current.size() || level.isEmpty()) {
+		return _current;
+	}
+	const auto key = _current.cacheKey();
+	if (_currentLevelKey != key) {
+		_currentLevelKey = key;
+		_currentLevel = QPixmap();
+		_currentLevelRequested = QSize();
+	}
+	if (_currentLevel.size() == level) {
+		return _currentLevel;
+	} else if (_currentLevelRequested != level) {
+		// Smooth scaling of a large image takes a while, until it is
+		// ready the full image is scaled while painting, as before.
+		_currentLevelRequested = level;
+		crl::async([=, image = _current.toImage()] {
+			auto scaled = image.scaled(
+				level,
+				Qt::IgnoreAspectRatio,
+				Qt::SmoothTransformation);
+			crl::on_main(this, [=, scaled = std::move(scaled)]() mutable {
+				if (_currentLevelKey != key
+					|| _currentLevelRequested != level) {
+					return;
+				}
+				_currentLevel = App::pixmapFromImageInPlace(std::move(scaled));
+				update();
+			});
+		});
+	}
+	return (_currentLevel.width() >= wanted.width()
+		&& _currentLevel.height() >= wanted.height())
+		? _currentLevel
+		: _current;
+}
+
+void OverlayWidget::preparePhotosAhead(int delta) {
+	Expects(_index.has_value());
+
+	// Only the photos ahead are kept, turning back drops the others.
+	const auto direction = (delta < 0) ? -1 : 1;
+	auto wanted = std::vector<not_null<PhotoData*>>();
+	for (auto i = 1; i <= kPreparePhotosCount; ++i) {
+		const auto entity = entityByIndex(*_index + direction * i);
+		if (const auto photo = base::get_if<not_null<PhotoData*>>(
+				&entity.data)) {
+			wanted.push_back(*photo);
+		}
+	}
+	for (auto i = begin(_preparedPhotos); i != end(_preparedPhotos);) {
+		if (ranges::find(wanted, i->first) == end(wanted)) {
+			i = _preparedPhotos.erase(i);
+		} else {
+			++i;
+		}
+	}
+
+	auto bytes = int64(0);
+	for (const auto photo : wanted) {
+		const auto w = style::ConvertScale(photo->width())
+			* cIntRetinaFactor();
+		const auto h = style::ConvertScale(photo->height())
+			* cIntRetinaFactor();
+		bytes += int64(w) * h * 4;
+		if (bytes > kPreparePhotosBytesLimit) {
+			break;
+		} else if (w <= 0
+			|| h <= 0
+			|| _preparedPhotos.contains(photo)
+			|| !photo->large()->loaded()) {
+			continue;
+		}
+		_preparedPhotos.emplace(photo, QImage());
+		crl::async([=, original = photo->large()->original()]() mutable {
+			auto image = Images::prepare(
+				std::move(original),
+				w,
+				h,
+				Images::Option::Smooth,
+				-1,
+				-1);
+			crl::on_main(this, [=, image = std::move(image)]() mutable {
+				const auto i = _preparedPhotos.find(photo);
+				if (i != end(_preparedPhotos) && i->second.isNull()) {
+					i->second = std::move(image);
+				}
+			});
+		});
+	}
+}
+
 void OverlayWidget::mousePressEvent(QMouseEvent *e) {
 	updateOver(e->pos());
 	if (_menu || !_receiveMouse) return;
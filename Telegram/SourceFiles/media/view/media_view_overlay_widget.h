@@ -40,6 +40,7 @@ struct TrackState;
 namespace Streaming {
 struct Information;
 struct Update;
+struct FrameRequest;
 enum class Error;
 } // namespace Streaming
 } // namespace Media
@@ -182,6 +183,8 @@ private:
 	void moveToScreen(bool force = false);
 	bool moveToNext(int delta);
 	void preloadData(int delta);
+	void preparePhotosAhead(int delta);
+	[[nodiscard]] const QPixmap &currentForSize(QSize size);
 
 	Entity entityForUserPhotos(int index) const;
 	Entity entityForSharedMedia(int index) const;
@@ -318,6 +321,8 @@ private:
 	[[nodiscard]] QSize videoSize() const;
 	[[nodiscard]] bool videoIsGifv() const;
 	[[nodiscard]] QImage videoFrame() const;
+	[[nodiscard]] QImage videoFrame(
+		const Streaming::FrameRequest &request) const;
 	[[nodiscard]] QImage videoFrameForDirectPaint() const;
 	[[nodiscard]] QImage transformVideoFrame(QImage frame) const;
 	[[nodiscard]] bool documentContentShown() const;
@@ -372,6 +377,14 @@ private:
 	QPixmap _current;
 	bool _blurred = true;
 
+	// Downscaled _current for zoomed out painting, by halves.
+	QPixmap _currentLevel;
+	qint64 _currentLevelKey = 0;
+	QSize _currentLevelRequested;
+
+	// Display-ready images of the next photos, null while preparing.
+	base::flat_map<not_null<PhotoData*>, QImage> _preparedPhotos;
+
 	std::unique_ptr<Streamed> _streamed;
 
 	const style::icon *_docIcon = nullptr;
@@ -17,6 +17,7 @@ namespace {
 
 constexpr auto kEnumerateDcTimeout = 8000; // 8 seconds timeout for help_getConfig to work (then move to other dc)
 constexpr auto kSpecialRequestTimeoutMs = 6000; // 4 seconds timeout for it to work in a specially requested dc.
+constexpr auto kSpecialStartTimeout = 2000; // 2 seconds without config from main dc to start looking for special endpoints.
 
 } // namespace
 
@@ -37,6 +38,10 @@ void ConfigLoader::load() {
 	if (!_instance->isKeysDestroyer()) {
 		sendRequest(_instance->mainDcId());
 		_enumDCTimer.callOnce(kEnumerateDcTimeout);
+
+		// Race special endpoints with the main dc instead of starting
+		// them only after the whole enumerate timeout has passed.
+		_specialEnumTimer.callOnce(kSpecialStartTimeout);
 	} else {
 		auto ids = _instance->dcOptions()->configEnumDcIds();
 		Assert(!ids.empty());
@@ -51,12 +51,105 @@ constexpr auto kPingSendAfter = crl::time(30000);
 constexpr auto kPingSendAfterForce = crl::time(45000);
 constexpr auto kTestModeDcIdShift = 10000;
 
+// The endpoint that won the last time doesn't wait for any better one.
+constexpr auto kPreferredEndpointPriority = 4;
+
 // If we can't connect for this time we will ask _instance to update config.
 constexpr auto kRequestConfigTimeout = crl::time(8000);
 
 // Don't try to handle messages larger than this size.
 constexpr auto kMaxMessageLength = 16 * 1024 * 1024;
 
+// Requests that don't fit in one container are sent in the next one.
+constexpr auto kMaxContainerRequests = 1000;
+constexpr auto kMaxContainerInts = uint32(256 * 1024);
+
+std::vector<PreRequestMap::iterator> ChoosePackedRequests(
+		PreRequestMap &toSend) {
+	auto result = std::vector<PreRequestMap::iterator>();
+	result.reserve(toSend.size());
+	for (auto i = toSend.begin(), e = toSend.end(); i != e; ++i) {
+		result.push_back(i);
+	}
+	ranges::stable_sort(result, ranges::greater(), [](const auto &i) {
+		return i.value()->priority;
+	});
+
+	// Leave the rest for the next container if this one is full.
+	auto ints = uint32(0);
+	auto till = begin(result);
+	for (const auto e = end(result); till != e; ++till) {
+		const auto size = (*till).value().messageSize();
+		if (till != begin(result)
+			&& ((till - begin(result)) >= kMaxContainerRequests
+				|| ints + size > kMaxContainerInts)) {
+			break;
+		}
+		ints += size;
+	}
+	result.erase(till, end(result));
+	return result;
+}
+
+// Returns true if some requests are left to be sent.
+bool ErasePackedRequests(
+		PreRequestMap &toSend,
+		const std::vector<PreRequestMap::iterator> &packed) {
+	for (const auto &i : packed) {
+		toSend.erase(i);
+	}
+	return !toSend.isEmpty();
+}
+
+// Acks collected from a burst of received messages are sent together.
+// The more of them are waiting the sooner they are sent.
+constexpr auto kMaxIdsInRequest = 8192;
+constexpr auto kAckWaitingHalveCount = 256;
+
+crl::time AckSendWaiting(int count) {
+	const auto halvings = count / kAckWaitingHalveCount;
+	return (count < kMaxIdsInRequest && halvings < 16)
+		? (kAckSendWaiting >> halvings)
+		: crl::time(0);
+}
+
+QVector<MTPlong> TakeIdsForRequest(QVector<MTPlong> &ids) {
+	if (ids.size() <= kMaxIdsInRequest) {
+		return base::take(ids);
+	}
+	auto result = ids.mid(0, kMaxIdsInRequest);
+	ids.erase(ids.begin(), ids.begin() + kMaxIdsInRequest);
+	return result;
+}
+
+constexpr auto kExternalHeaderIntsCount = 6U; // 2 auth_key_id, 4 msg_key
+constexpr auto kEncryptedHeaderIntsCount = 8U; // 2 salt, 2 session, 2 msg_id, 1 seq_no, 1 length
+constexpr auto kMinimalEncryptedIntsCount = kEncryptedHeaderIntsCount + 4U; // + 1 data + 3 padding
+constexpr auto kMinimalIntsCount = kExternalHeaderIntsCount + kMinimalEncryptedIntsCount;
+
+// Packets larger than that are decrypted in a worker thread,
+// so that a big download doesn't stall other sessions on this thread.
+constexpr auto kAsyncDecryptSize = 64U * 1024U;
+
+#ifndef TDESKTOP_MTPROTO_OLD
+bool CheckMsgKey(
+		const AuthKeyPtr &key,
+		const MTPint128 &msgKey,
+		const void *decrypted,
+		uint32 size) {
+	std::array<uchar, 32> sha256Buffer = { { 0 } };
+
+	SHA256_CTX msgKeyLargeContext;
+	SHA256_Init(&msgKeyLargeContext);
+	SHA256_Update(&msgKeyLargeContext, key->partForMsgKey(false), 32);
+	SHA256_Update(&msgKeyLargeContext, decrypted, size);
+	SHA256_Final(sha256Buffer.data(), &msgKeyLargeContext);
+
+	constexpr auto kMsgKeyShift = 8U;
+	return !memcmp(&msgKey, sha256Buffer.data() + kMsgKeyShift, sizeof(msgKey));
+}
+#endif // TDESKTOP_MTPROTO_OLD
+
 QString LogIdsVector(const QVector<MTPlong> &ids) {
 	if (!ids.size()) return "[]";
 	auto idsStr = QString("[%1").arg(ids.cbegin()->v);
@@ -245,6 +338,80 @@ void wrapInvokeAfter(SecureRequest &to, const SecureRequest &from, const Request
 	}
 }
 
+uint64 AddMod(uint64 a, uint64 b, uint64 m) {
+	return (a >= m - b) ? (a - (m - b)) : (a + b);
+}
+
+uint64 MulMod(uint64 a, uint64 b, uint64 m) {
+	auto result = uint64(0);
+	for (a %= m; b; b >>= 1) {
+		if (b & 1) {
+			result = AddMod(result, a, m);
+		}
+		a = AddMod(a, a, m);
+	}
+	return result;
+}
+
+uint64 Gcd(uint64 a, uint64 b) {
+	while (b) {
+		a %= b;
+		std::swap(a, b);
+	}
+	return a;
+}
+
+// Pollard's rho with Brent's cycle detection, it takes about the fourth
+// root of pq steps, while Fermat's method is slow for distant factors.
+uint64 FindFactor(uint64 pq) {
+	constexpr auto kBatch = uint64(128);
+	constexpr auto kMaxCycle = uint64(1) << 24;
+	constexpr auto kMaxAttempts = uint64(16);
+
+	if (pq < 4) {
+		return 0;
+	} else if (!(pq & 1)) {
+		return 2;
+	}
+	const auto distance = [](uint64 a, uint64 b) {
+		return (a > b) ? (a - b) : (b - a);
+	};
+	for (auto c = uint64(1); c <= kMaxAttempts; ++c) {
+		const auto next = [&](uint64 value) {
+			return AddMod(MulMod(value, value, pq), c, pq);
+		};
+		auto x = uint64(2), y = x, ys = y, product = uint64(1);
+		auto divisor = uint64(1);
+		for (auto cycle = uint64(1); divisor == 1; cycle <<= 1) {
+			if (cycle > kMaxCycle) {
+				return 0;
+			}
+			x = y;
+			for (auto i = uint64(0); i != cycle; ++i) {
+				y = next(y);
+			}
+			for (auto k = uint64(0); k < cycle && divisor == 1; k += kBatch) {
+				ys = y;
+				for (auto i = std::min(kBatch, cycle - k); i; --i) {
+					y = next(y);
+					product = MulMod(product, distance(x, y), pq);
+				}
+				divisor = Gcd(product, pq);
+			}
+		}
+		if (divisor == pq) {
+			do {
+				ys = next(ys);
+				divisor = Gcd(distance(x, ys), pq);
+			} while (divisor == 1);
+		}
+		if (divisor != pq) {
+			return divisor;
+		}
+	}
+	return 0;
+}
+
 bool parsePQ(const QByteArray &pqStr, QByteArray &pStr, QByteArray &qStr) {
 	if (pqStr.length() > 8) return false; // more than 64 bit pq
 
@@ -254,20 +421,11 @@ bool parsePQ(const QByteArray &pqStr, QByteArray &pStr, QByteArray &qStr) {
 		pq <<= 8;
 		pq |= (uint64)pqChars[i];
 	}
-	uint64 pqSqrt = (uint64)sqrtl((long double)pq), ySqr, y;
-	while (pqSqrt * pqSqrt > pq) --pqSqrt;
-	while (pqSqrt * pqSqrt < pq) ++pqSqrt;
-	for (ySqr = pqSqrt * pqSqrt - pq; ; ++pqSqrt, ySqr = pqSqrt * pqSqrt - pq) {
-		y = (uint64)sqrtl((long double)ySqr);
-		while (y * y > ySqr) --y;
-		while (y * y < ySqr) ++y;
-		if (!ySqr || y + pqSqrt >= pq) return false;
-		if (y * y == ySqr) {
-			p = pqSqrt + y;
-			q = (pqSqrt > y) ? (pqSqrt - y) : (y - pqSqrt);
-			break;
-		}
+	p = FindFactor(pq);
+	if (!p) {
+		return false;
 	}
+	q = pq / p;
 	if (p > q) std::swap(p, q);
 
 	pStr.resize(4);
@@ -351,9 +509,20 @@ void ConnectionPrivate::appendTestConnection(
 		const bytes::vector &protocolSecret) {
 	QWriteLocker lock(&stateConnMutex);
 
-	const auto priority = (qthelp::is_ipv6(ip) ? 0 : 1)
-		+ (protocol == DcOptions::Variants::Tcp ? 1 : 0)
-		+ (protocolSecret.empty() ? 0 : 1);
+	auto endpoint = DcOptions::PreferredEndpoint{
+		protocol,
+		ip.toStdString(),
+		port
+	};
+	const auto preferred = _preferredEndpoint
+		&& (_preferredEndpoint->protocol == endpoint.protocol)
+		&& (_preferredEndpoint->ip == endpoint.ip)
+		&& (_preferredEndpoint->port == endpoint.port);
+	const auto priority = preferred
+		? kPreferredEndpointPriority
+		: ((qthelp::is_ipv6(ip) ? 0 : 1)
+			+ (protocol == DcOptions::Variants::Tcp ? 1 : 0)
+			+ (protocolSecret.empty() ? 0 : 1));
 	_testConnections.push_back({
 		AbstractConnection::Create(
 			_instance,
@@ -361,7 +530,8 @@ void ConnectionPrivate::appendTestConnection(
 			thread(),
 			protocolSecret,
 			_connectionOptions->proxy),
-		priority
+		priority,
+		std::move(endpoint)
 	});
 	const auto weak = _testConnections.back().data.get();
 	connect(weak, &AbstractConnection::error, [=](int errorCode) {
@@ -406,7 +576,70 @@ int16 ConnectionPrivate::getProtocolDcId() const {
 		: testedDcId;
 }
 
+struct ConnectionPrivate::AsyncDecryption {
+	bool ready() {
+		QMutexLocker lock(&mutex);
+		return finished;
+	}
+
+	mtpBuffer packet;
+	QByteArray decrypted;
+	bool msgKeyGood = false;
+	crl::profile_time time = 0;
+
+	QMutex mutex;
+	ConnectionPrivate *owner = nullptr;
+	bool finished = false;
+};
+
+void ConnectionPrivate::startAsyncDecryption(
+		mtpBuffer &&packet,
+		const AuthKeyPtr &key) {
+	Expects(_asyncDecryption == nullptr);
+
+#ifndef TDESKTOP_MTPROTO_OLD
+	const auto decryption = std::make_shared<AsyncDecryption>();
+	decryption->packet = std::move(packet);
+	decryption->owner = this;
+	_asyncDecryption = decryption;
+
+	crl::async([=] {
+		const auto started = crl::profile();
+		const auto ints = decryption->packet.constData();
+		const auto intsCount = uint32(decryption->packet.size());
+		const auto encryptedIntsCount = (intsCount - kExternalHeaderIntsCount) & ~0x03U;
+		const auto encryptedBytesCount = encryptedIntsCount * kIntSize;
+		const auto msgKey = *(MTPint128*)(ints + 2);
+		auto &decrypted = decryption->decrypted;
+		decrypted = QByteArray(encryptedBytesCount, Qt::Uninitialized);
+		aesIgeDecrypt(ints + kExternalHeaderIntsCount, decrypted.data(), encryptedBytesCount, key, msgKey);
+		decryption->msgKeyGood = CheckMsgKey(key, msgKey, decrypted.constData(), encryptedBytesCount);
+		decryption->time = crl::profile() - started;
+
+		QMutexLocker lock(&decryption->mutex);
+		decryption->finished = true;
+		if (const auto owner = decryption->owner) {
+			emit owner->decryptedAsync();
+		}
+	});
+#endif // TDESKTOP_MTPROTO_OLD
+}
+
+void ConnectionPrivate::cancelAsyncDecryption() {
+	if (const auto decryption = base::take(_asyncDecryption)) {
+		QMutexLocker lock(&decryption->mutex);
+		decryption->owner = nullptr;
+	}
+}
+
+void ConnectionPrivate::handleDecrypted() {
+	if (_asyncDecryption) {
+		handleReceived();
+	}
+}
+
 void ConnectionPrivate::destroyAllConnections() {
+	cancelAsyncDecryption();
 	_waitForBetterTimer.cancel();
 	_waitForReceivedTimer.cancel();
 	_waitForConnectedTimer.cancel();
@@ -449,6 +682,7 @@ ConnectionPrivate::ConnectionPrivate(
 	connect(sessionData->owner(), SIGNAL(needToSend()), this, SLOT(tryToSend()), Qt::QueuedConnection);
 	connect(sessionData->owner(), SIGNAL(needToPing()), this, SLOT(onPingSendForce()), Qt::QueuedConnection);
 	connect(this, SIGNAL(sessionResetDone()), sessionData->owner(), SLOT(onResetDone()), Qt::QueuedConnection);
+	connect(this, SIGNAL(decryptedAsync()), this, SLOT(handleDecrypted()), Qt::QueuedConnection);
 
 	static bool _registered = false;
 	if (!_registered) {
@@ -642,6 +876,7 @@ void ConnectionPrivate::resetSession() { // recreate all msg_id and msg_seqno
 	}
 
 	ackRequestData.clear();
+	_ackSendAt = 0;
 	resendRequestData.clear();
 	{
 		QWriteLocker locker5(sessionData->stateRequestMutex());
@@ -788,6 +1023,7 @@ void ConnectionPrivate::tryToSend() {
 
 		_pingId = _pingIdToSend;
 		_pingIdToSend = 0;
+		_pingSentAt = pingRequest->msDate;
 	} else {
 		if (prependOnly) {
 			DEBUG_LOG(("MTP Info: dc %1 not sending, waiting for Connected state, state: %2").arg(_shiftedDcId).arg(state));
@@ -798,13 +1034,16 @@ void ConnectionPrivate::tryToSend() {
 	}
 
 	SecureRequest ackRequest, resendRequest, stateRequest, httpWaitRequest;
+	auto idsLeft = false;
 	if (!prependOnly && !ackRequestData.isEmpty()) {
 		ackRequest = SecureRequest::Serialize(MTPMsgsAck(
-			MTP_msgs_ack(MTP_vector<MTPlong>(ackRequestData))));
+			MTP_msgs_ack(MTP_vector<MTPlong>(
+				TakeIdsForRequest(ackRequestData)))));
 		ackRequest->msDate = crl::now(); // > 0 - can send without container
 		ackRequest->requestId = 0; // dont add to haveSent / wereAcked maps
 
-		ackRequestData.clear();
+		_ackSendAt = 0;
+		idsLeft = !ackRequestData.isEmpty();
 	}
 	if (!prependOnly && !resendRequestData.isEmpty()) {
 		resendRequest = SecureRequest::Serialize(MTPMsgResendReq(
@@ -820,12 +1059,17 @@ void ConnectionPrivate::tryToSend() {
 			QWriteLocker locker(sessionData->stateRequestMutex());
 			auto &ids = sessionData->stateRequestMap();
 			if (!ids.isEmpty()) {
-				stateReq.reserve(ids.size());
-				for (auto i = ids.cbegin(), e = ids.cend(); i != e; ++i) {
+				stateReq.reserve(std::min(ids.size(), kMaxIdsInRequest));
+				auto i = ids.begin();
+				for (const auto e = ids.end(); i != e; ++i) {
+					if (stateReq.size() == kMaxIdsInRequest) {
+						idsLeft = true;
+						break;
+					}
 					stateReq.push_back(MTP_long(i.key()));
 				}
+				ids.erase(ids.begin(), i);
 			}
-			ids.clear();
 		}
 		if (!stateReq.isEmpty()) {
 			stateRequest = SecureRequest::Serialize(MTPMsgsStateReq(
@@ -840,6 +1084,9 @@ void ConnectionPrivate::tryToSend() {
 			httpWaitRequest->requestId = 0; // dont add to haveSent / wereAcked maps
 		}
 	}
+	if (idsLeft) {
+		emit sendAnythingAsync(0);
+	}
 
 	MTPInitConnection<SecureRequest> initWrapper;
 	int32 initSize = 0, initSizeInInts = 0;
@@ -895,7 +1142,9 @@ void ConnectionPrivate::tryToSend() {
 		auto &toSend = prependOnly ? toSendDummy : sessionData->toSendMap();
 		if (prependOnly) locker1.unlock();
 
-		uint32 toSendCount = toSend.size();
+		const auto packing = ChoosePackedRequests(toSend);
+
+		uint32 toSendCount = packing.size();
 		if (pingRequest) ++toSendCount;
 		if (ackRequest) ++toSendCount;
 		if (resendRequest) ++toSendCount;
@@ -904,11 +1153,13 @@ void ConnectionPrivate::tryToSend() {
 
 		if (!toSendCount) return; // nothing to send
 
-		auto first = pingRequest ? pingRequest : (ackRequest ? ackRequest : (resendRequest ? resendRequest : (stateRequest ? stateRequest : (httpWaitRequest ? httpWaitRequest : toSend.cbegin().value()))));
+		auto first = pingRequest ? pingRequest : (ackRequest ? ackRequest : (resendRequest ? resendRequest : (stateRequest ? stateRequest : (httpWaitRequest ? httpWaitRequest : packing.front().value()))));
 		if (toSendCount == 1 && first->msDate > 0) { // if can send without container
 			toSendRequest = first;
 			if (!prependOnly) {
-				toSend.clear();
+				if (ErasePackedRequests(toSend, packing)) {
+					emit sendAnythingAsync(0);
+				}
 				locker1.unlock();
 			}
 
@@ -968,7 +1219,7 @@ void ConnectionPrivate::tryToSend() {
 			if (resendRequest) containerSize += resendRequest.messageSize();
 			if (stateRequest) containerSize += stateRequest.messageSize();
 			if (httpWaitRequest) containerSize += httpWaitRequest.messageSize();
-			for (auto i = toSend.begin(), e = toSend.end(); i != e; ++i) {
+			for (const auto &i : packing) {
 				containerSize += i.value().messageSize();
 				if (needsLayer && i.value()->needsLayer) {
 					containerSize += initSizeInInts;
@@ -985,7 +1236,7 @@ void ConnectionPrivate::tryToSend() {
 			// prepare container + each in invoke after
 			toSendRequest = SecureRequest::Prepare(
 				containerSize,
-				containerSize + 3 * toSend.size());
+				containerSize + 3 * packing.size());
 			toSendRequest->push_back(mtpc_msg_container);
 			toSendRequest->push_back(toSendCount);
 
@@ -1012,7 +1263,7 @@ void ConnectionPrivate::tryToSend() {
 			} else if (resendRequest || stateRequest) {
 				needAnyResponse = true;
 			}
-			for (auto i = toSend.begin(), e = toSend.end(); i != e; ++i) {
+			for (const auto &i : packing) {
 				auto &req = i.value();
 				auto msgId = prepareToSend(req, bigMsgId);
 				if (msgId > bigMsgId) {
@@ -1068,7 +1319,13 @@ void ConnectionPrivate::tryToSend() {
 			*(mtpMsgId*)(haveSentIdsWrap->data() + 4) = contMsgId;
 			(*haveSentIdsWrap)[6] = 0; // for container, msDate = 0, seqNo = 0
 			haveSent.insert(contMsgId, haveSentIdsWrap);
-			toSend.clear();
+			sessionData->changeMetrics([&](ConnectionMetrics &metrics) {
+				++metrics.containersSent;
+				metrics.containerRequests += toSendCount;
+			});
+			if (ErasePackedRequests(toSend, packing)) {
+				emit sendAnythingAsync(0);
+			}
 		}
 	}
 	sendSecureRequest(
@@ -1142,6 +1399,9 @@ void ConnectionPrivate::connectToServer(bool afterConfig) {
 	}
 
 	destroyAllConnections();
+	_preferredEndpoint = (_connectionOptions->proxy.type == ProxyData::Type::None)
+		? _instance->dcOptions()->preferredEndpoint(bareDc, _dcType)
+		: std::nullopt;
 	if (_connectionOptions->proxy.type == ProxyData::Type::Mtproto) {
 		// host, port, secret for mtproto proxy are taken from proxy.
 		appendTestConnection(DcOptions::Variants::Tcp, {}, 0, {});
@@ -1216,7 +1476,7 @@ void ConnectionPrivate::connectToServer(bool afterConfig) {
 	_waitForConnectedTimer.cancel();
 
 	setState(ConnectingState);
-	_pingId = _pingMsgId = _pingIdToSend = _pingSendAt = 0;
+	_pingId = _pingMsgId = _pingIdToSend = _pingSendAt = _pingSentAt = 0;
 	_pingSender.cancel();
 
 	_waitForConnectedTimer.callOnce(_waitForConnected);
@@ -1443,14 +1703,29 @@ void ConnectionPrivate::handleReceived() {
 		return restartOnError();
 	}
 
-	while (!_connection->received().empty()) {
-		auto intsBuffer = std::move(_connection->received().front());
-		_connection->received().pop_front();
+	while (_asyncDecryption || !_connection->received().empty()) {
+		auto intsBuffer = mtpBuffer();
+		auto decryptedBuffer = QByteArray();
+		auto msgKeyGood = false;
+		auto decryptTime = crl::profile_time(0);
+		if (_asyncDecryption) {
+			if (!_asyncDecryption->ready()) {
+				// Next packets are handled after this one to keep the order.
+				break;
+			}
+			const auto decryption = base::take(_asyncDecryption);
+			intsBuffer = std::move(decryption->packet);
+			decryptedBuffer = std::move(decryption->decrypted);
+			msgKeyGood = decryption->msgKeyGood;
+			decryptTime = decryption->time;
+		} else {
+			intsBuffer = std::move(_connection->received().front());
+			_connection->received().pop_front();
+		}
+		const auto recycle = gsl::finally([&] {
+			ReleasePacketBuffer(std::move(intsBuffer));
+		});
 
-		constexpr auto kExternalHeaderIntsCount = 6U; // 2 auth_key_id, 4 msg_key
-		constexpr auto kEncryptedHeaderIntsCount = 8U; // 2 salt, 2 session, 2 msg_id, 1 seq_no, 1 length
-		constexpr auto kMinimalEncryptedIntsCount = kEncryptedHeaderIntsCount + 4U; // + 1 data + 3 padding
-		constexpr auto kMinimalIntsCount = kExternalHeaderIntsCount + kMinimalEncryptedIntsCount;
 		auto intsCount = uint32(intsBuffer.size());
 		auto ints = intsBuffer.constData();
 		if ((intsCount < kMinimalIntsCount) || (intsCount > kMaxMessageLength / kIntSize)) {
@@ -1469,14 +1744,30 @@ void ConnectionPrivate::handleReceived() {
 		auto encryptedInts = ints + kExternalHeaderIntsCount;
 		auto encryptedIntsCount = (intsCount - kExternalHeaderIntsCount) & ~0x03U;
 		auto encryptedBytesCount = encryptedIntsCount * kIntSize;
-		auto decryptedBuffer = QByteArray(encryptedBytesCount, Qt::Uninitialized);
 		auto msgKey = *(MTPint128*)(ints + 2);
 
+		if (decryptedBuffer.isEmpty()) {
+#ifndef TDESKTOP_MTPROTO_OLD
+			if (encryptedBytesCount >= kAsyncDecryptSize) {
+				startAsyncDecryption(std::move(intsBuffer), key);
+				break;
+			}
+#endif // TDESKTOP_MTPROTO_OLD
+
+			decryptedBuffer = QByteArray(encryptedBytesCount, Qt::Uninitialized);
+			const auto decryptStarted = crl::profile();
 #ifdef TDESKTOP_MTPROTO_OLD
-		aesIgeDecrypt_oldmtp(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, key, msgKey);
+			aesIgeDecrypt_oldmtp(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, key, msgKey);
 #else // TDESKTOP_MTPROTO_OLD
-		aesIgeDecrypt(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, key, msgKey);
+			aesIgeDecrypt(encryptedInts, decryptedBuffer.data(), encryptedBytesCount, key, msgKey);
+			msgKeyGood = CheckMsgKey(key, msgKey, decryptedBuffer.constData(), encryptedBytesCount);
 #endif // TDESKTOP_MTPROTO_OLD
+			decryptTime = crl::profile() - decryptStarted;
+		}
+		sessionData->changeMetrics([&](ConnectionMetrics &metrics) {
+			metrics.bytesReceived += intsCount * kIntSize;
+			metrics.decryptTime += decryptTime;
+		});
 
 		auto decryptedInts = reinterpret_cast<const mtpPrime*>(decryptedBuffer.constData());
 		auto serverSalt = *(uint64*)&decryptedInts[0];
@@ -1518,16 +1809,7 @@ void ConnectionPrivate::handleReceived() {
 		constexpr auto kMaxPaddingSize = 1024U;
 		auto badMessageLength = (paddingSize < kMinPaddingSize || paddingSize > kMaxPaddingSize);
 
-		std::array<uchar, 32> sha256Buffer = { { 0 } };
-
-		SHA256_CTX msgKeyLargeContext;
-		SHA256_Init(&msgKeyLargeContext);
-		SHA256_Update(&msgKeyLargeContext, key->partForMsgKey(false), 32);
-		SHA256_Update(&msgKeyLargeContext, decryptedInts, encryptedBytesCount);
-		SHA256_Final(sha256Buffer.data(), &msgKeyLargeContext);
-
-		constexpr auto kMsgKeyShift = 8U;
-		if (memcmp(&msgKey, sha256Buffer.data() + kMsgKeyShift, sizeof(msgKey)) != 0) {
+		if (!msgKeyGood) {
 			LOG(("TCP Error: bad SHA256 hash after aesDecrypt in message"));
 			TCP_LOG(("TCP Error: bad message %1").arg(Logs::mb(encryptedInts, encryptedBytesCount).str()));
 
@@ -1607,13 +1889,6 @@ void ConnectionPrivate::handleReceived() {
 			sessionData->receivedIdsSet().shrink();
 		}
 
-		// send acks
-		uint32 toAckSize = ackRequestData.size();
-		if (toAckSize) {
-			DEBUG_LOG(("MTP Info: will send %1 acks, ids: %2").arg(toAckSize).arg(LogIdsVector(ackRequestData)));
-			emit sendAnythingAsync(kAckSendWaiting);
-		}
-
 		bool emitSignal = false;
 		{
 			QReadLocker locker(sessionData->haveReceivedMutex());
@@ -1646,11 +1921,29 @@ void ConnectionPrivate::handleReceived() {
 			}
 		}
 	}
+	scheduleAcksSend();
 	if (_connection->needHttpWait()) {
 		emit sendHttpWaitAsync();
 	}
 }
 
+void ConnectionPrivate::scheduleAcksSend() {
+	if (ackRequestData.isEmpty()) {
+		return;
+	}
+	const auto now = crl::now();
+	const auto waiting = AckSendWaiting(ackRequestData.size());
+	if (_ackSendAt && _ackSendAt <= now + waiting) {
+		return;
+	}
+	DEBUG_LOG(("MTP Info: will send %1 acks in %2ms, ids: %3"
+		).arg(ackRequestData.size()
+		).arg(waiting
+		).arg(LogIdsVector(ackRequestData)));
+	_ackSendAt = now + waiting;
+	emit sendAnythingAsync(waiting);
+}
+
 ConnectionPrivate::HandleResult ConnectionPrivate::handleOneReceived(const mtpPrime *from, const mtpPrime *end, uint64 msgId, int32 serverTime, uint64 serverSalt, bool badTime) {
 	const auto cons = mtpTypeId(*from);
 
@@ -2206,6 +2499,15 @@ ConnectionPrivate::HandleResult ConnectionPrivate::handleOneReceived(const mtpPr
 		}
 		if (data.vping_id().v == _pingId) {
 			_pingId = 0;
+			if (_pingSentAt) {
+				const auto rtt = crl::now() - _pingSentAt;
+				sessionData->changeMetrics([&](ConnectionMetrics &metrics) {
+					metrics.smoothedRtt = metrics.smoothedRtt
+						? ((metrics.smoothedRtt * 7 + rtt) / 8)
+						: rtt;
+				});
+				_pingSentAt = 0;
+			}
 		} else {
 			DEBUG_LOG(("Message Info: just pong..."));
 		}
@@ -2514,6 +2816,7 @@ void ConnectionPrivate::onConnected(
 	} else {
 		DEBUG_LOG(("MTP Info: connection through IPv4 succeed."));
 		_waitForBetterTimer.cancel();
+		rememberPreferredEndpoint(*i);
 		_connection = std::move(i->data);
 		_testConnections.clear();
 
@@ -2552,12 +2855,25 @@ void ConnectionPrivate::confirmBestConnection() {
 	DEBUG_LOG(("MTP Info: can't connect through better, using %1."
 		).arg(i->data->tag()));
 
+	rememberPreferredEndpoint(*i);
 	_connection = std::move(i->data);
 	_testConnections.clear();
 
 	updateAuthKey();
 }
 
+void ConnectionPrivate::rememberPreferredEndpoint(
+		const TestConnection &connection) {
+	if (_connectionOptions->proxy.type != ProxyData::Type::None
+		|| _testConnections.size() < 2) {
+		return;
+	}
+	_instance->dcOptions()->setPreferredEndpoint(
+		BareDcId(_shiftedDcId),
+		_dcType,
+		connection.endpoint);
+}
+
 void ConnectionPrivate::removeTestConnection(
 		not_null<AbstractConnection*> connection) {
 	_testConnections.erase(
@@ -3202,6 +3518,7 @@ bool ConnectionPrivate::sendSecureRequest(
 	auto from = request->constData() + 4;
 	MTP_LOG(_shiftedDcId, ("Send: ") + mtpTextSerialize(from, from + messageSize));
 
+	const auto encryptStarted = crl::profile();
 #ifdef TDESKTOP_MTPROTO_OLD
 	uint32 padding = fullSize - 4 - messageSize;
 
@@ -3246,6 +3563,12 @@ bool ConnectionPrivate::sendSecureRequest(
 
 	DEBUG_LOG(("MTP Info: sending request, size: %1, num: %2, time: %3").arg(fullSize + 6).arg((*request)[4]).arg((*request)[5]));
 
+	const auto encryptTime = crl::profile() - encryptStarted;
+	sessionData->changeMetrics([&](ConnectionMetrics &metrics) {
+		metrics.bytesSent += packet.size() * sizeof(mtpPrime);
+		metrics.encryptTime += encryptTime;
+	});
+
 	_connection->setSentEncrypted();
 	_connection->sendData(std::move(packet));
 
@@ -3297,6 +3620,7 @@ void ConnectionPrivate::unlockKey() {
 }
 
 ConnectionPrivate::~ConnectionPrivate() {
+	cancelAsyncDecryption();
 	clearAuthKeyData();
 	Assert(_finished && _connection == nullptr && _testConnections.empty());
 }
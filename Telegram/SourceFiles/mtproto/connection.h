@@ -125,6 +125,7 @@ signals:
 	void resendAsync(quint64 msgId, qint64 msCanWait, bool forceContainer, bool sendMsgStateInfo);
 	void resendManyAsync(QVector<quint64> msgIds, qint64 msCanWait, bool forceContainer, bool sendMsgStateInfo);
 	void resendAllAsync();
+	void decryptedAsync();
 
 	void finished(internal::Connection *connection);
 
@@ -145,6 +146,7 @@ public slots:
 
 	// General packet receive slot, connected to conn->receivedData signal
 	void handleReceived();
+	void handleDecrypted();
 
 	// Sessions signals, when we need to send something
 	void tryToSend();
@@ -158,7 +160,13 @@ private:
 	struct TestConnection {
 		ConnectionPointer data;
 		int priority = 0;
+		DcOptions::PreferredEndpoint endpoint;
 	};
+	struct AsyncDecryption;
+
+	void scheduleAcksSend();
+	void startAsyncDecryption(mtpBuffer &&packet, const AuthKeyPtr &key);
+	void cancelAsyncDecryption();
 	void connectToServer(bool afterConfig = false);
 	void connectingTimedOut();
 	void doDisconnect();
@@ -181,6 +189,7 @@ private:
 
 	void destroyAllConnections();
 	void confirmBestConnection();
+	void rememberPreferredEndpoint(const TestConnection &connection);
 	void removeTestConnection(not_null<AbstractConnection*> connection);
 	int16 getProtocolDcId() const;
 
@@ -238,6 +247,7 @@ private:
 
 	not_null<Instance*> _instance;
 	DcType _dcType = DcType::Regular;
+	std::optional<DcOptions::PreferredEndpoint> _preferredEndpoint;
 
 	mutable QReadWriteLock stateConnMutex;
 	int32 _state = DisconnectedState;
@@ -266,11 +276,14 @@ private:
 	crl::time firstSentAt = -1;
 
 	QVector<MTPlong> ackRequestData, resendRequestData;
+	crl::time _ackSendAt = 0;
+	std::shared_ptr<AsyncDecryption> _asyncDecryption;
 
 	mtpPingId _pingId = 0;
 	mtpPingId _pingIdToSend = 0;
 	crl::time _pingSendAt = 0;
 	mtpMsgId _pingMsgId = 0;
+	crl::time _pingSentAt = 0;
 	base::Timer _pingSender;
 
 	bool restarted = false;
@@ -15,6 +15,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace MTP {
 namespace internal {
+namespace {
+
+constexpr auto kMaxPooledPacketBuffers = 8;
+constexpr auto kMaxPooledPacketBufferInts = 256 * 1024;
+
+thread_local auto PacketBuffers = std::vector<mtpBuffer>();
+
+} // namespace
 
 ConnectionPointer::ConnectionPointer() = default;
 
@@ -187,5 +195,32 @@ ConnectionPointer AbstractConnection::Create(
 	return result;
 }
 
+mtpBuffer AcquirePacketBuffer(int size) {
+	Expects(size >= 0);
+
+	auto &pool = PacketBuffers;
+	const auto i = ranges::find_if(pool, [&](const mtpBuffer &buffer) {
+		return (buffer.capacity() >= size);
+	});
+	if (i == end(pool)) {
+		return mtpBuffer(size);
+	}
+	auto result = std::move(*i);
+	pool.erase(i);
+	result.resize(size);
+	return result;
+}
+
+void ReleasePacketBuffer(mtpBuffer &&buffer) {
+	auto &pool = PacketBuffers;
+	if (pool.size() >= kMaxPooledPacketBuffers
+		|| buffer.capacity() > kMaxPooledPacketBufferInts
+		|| !buffer.isDetached()) {
+		return;
+	}
+	buffer.resize(0);
+	pool.push_back(std::move(buffer));
+}
+
 } // namespace internal
 } // namespace MTP
@@ -141,6 +141,10 @@ protected:
 
 };
 
+// Received packet buffers are recycled by connections of the same thread.
+[[nodiscard]] mtpBuffer AcquirePacketBuffer(int size);
+void ReleasePacketBuffer(mtpBuffer &&buffer);
+
 template <typename Request>
 mtpBuffer AbstractConnection::prepareNotSecurePacket(
 		const Request &request,
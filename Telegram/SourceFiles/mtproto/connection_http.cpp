@@ -16,6 +16,10 @@ namespace {
 constexpr auto kForceHttpPort = 80;
 constexpr auto kFullConnectionTimeout = crl::time(8000);
 
+// Keep more than one http_wait in flight, so the server has a request to
+// answer with new data while the next long poll is still on its way.
+constexpr auto kMaxLongPolls = 2;
+
 } // namespace
 
 HttpConnection::HttpConnection(QThread *thread, const ProxyData &proxy)
@@ -41,6 +45,7 @@ void HttpConnection::sendData(mtpBuffer &&buffer) {
 	QNetworkRequest request(url());
 	request.setHeader(QNetworkRequest::ContentLengthHeader, QVariant(requestSize));
 	request.setHeader(QNetworkRequest::ContentTypeHeader, QVariant(qsl("application/x-www-form-urlencoded")));
+	request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
 
 	TCP_LOG(("HTTP Info: sending %1 len request").arg(requestSize));
 	_requests.insert(_manager.post(request, QByteArray((const char*)(&buffer[2]), requestSize)));
@@ -209,7 +214,7 @@ bool HttpConnection::usingHttpWait() {
 }
 
 bool HttpConnection::needHttpWait() {
-	return _requests.isEmpty();
+	return (_requests.size() < kMaxLongPolls);
 }
 
 int32 HttpConnection::debugState() const {
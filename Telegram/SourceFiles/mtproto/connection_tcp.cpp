@@ -24,6 +24,7 @@ constexpr auto kPacketSizeMax = int(0x01000000 * sizeof(mtpPrime));
 constexpr auto kFullConnectionTimeout = 8 * crl::time(1000);
 constexpr auto kSmallBufferSize = 256 * 1024;
 constexpr auto kMinPacketBuffer = 256;
+constexpr auto kMaxKeptLargeBuffer = 2 * 1024 * 1024;
 constexpr auto kConnectionStartPrefixSize = 64;
 
 } // namespace
@@ -262,14 +263,18 @@ void TcpConnection::ensureAvailableInBuffer(int amount) {
 	if (amount <= _smallBuffer.size()) {
 		if (_usingLargeBuffer) {
 			bytes::copy(_smallBuffer, read);
-			_usingLargeBuffer = false;
-			_largeBuffer.clear();
+			releaseLargeBuffer();
 		} else {
 			bytes::move(_smallBuffer, read);
 		}
 	} else if (amount <= _largeBuffer.size()) {
 		Assert(_usingLargeBuffer);
 		bytes::move(_largeBuffer, read);
+	} else if (!_usingLargeBuffer && amount <= _largeBuffer.capacity()) {
+		// Reuse the memory left from the previous large packet.
+		_largeBuffer.resize(amount);
+		bytes::copy(_largeBuffer, read);
+		_usingLargeBuffer = true;
 	} else {
 		auto enough = bytes::vector(amount);
 		bytes::copy(enough, read);
@@ -279,6 +284,15 @@ void TcpConnection::ensureAvailableInBuffer(int amount) {
 	_offsetBytes = 0;
 }
 
+void TcpConnection::releaseLargeBuffer() {
+	_usingLargeBuffer = false;
+	if (_largeBuffer.capacity() > kMaxKeptLargeBuffer) {
+		_largeBuffer = bytes::vector();
+	} else {
+		_largeBuffer.clear();
+	}
+}
+
 void TcpConnection::socketRead() {
 	Expects(_leftBytes > 0 || !_usingLargeBuffer);
 
@@ -316,8 +330,7 @@ void TcpConnection::socketRead() {
 						return;
 					}
 
-					_usingLargeBuffer = false;
-					_largeBuffer.clear();
+					releaseLargeBuffer();
 					_offsetBytes = _readBytes = 0;
 				} else {
 					TCP_LOG(("TCP Info: not enough %1 for packet! read %2"
@@ -400,7 +413,7 @@ mtpBuffer TcpConnection::parsePacket(bytes::const_span bytes) {
 		}
 		return mtpBuffer(1, ints[0]);
 	}
-	auto result = mtpBuffer(ints.size());
+	auto result = AcquirePacketBuffer(ints.size());
 	memcpy(result.data(), ints.data(), ints.size() * sizeof(mtpPrime));
 	return result;
 }
@@ -52,6 +52,7 @@ private:
 	};
 
 	void socketRead();
+	void releaseLargeBuffer();
 	bytes::const_span prepareConnectionStartPrefix(bytes::span buffer);
 
 	void socketPacket(bytes::const_span bytes);
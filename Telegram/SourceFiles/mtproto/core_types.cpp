@@ -12,6 +12,9 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace MTP {
 namespace {
 
+// See CountPaddingAmountInInts: up to 6 ints plus 15 * 4 extended ones.
+constexpr auto kMaxPaddingInts = uint32(6 + (0x0F << 2));
+
 uint32 CountPaddingAmountInInts(uint32 requestSize, bool extended) {
 #ifdef TDESKTOP_MTPROTO_OLD
 	return ((8 + requestSize) & 0x03)
@@ -45,8 +48,10 @@ SecureRequest::SecureRequest(const details::SecureRequestCreateTag &tag)
 SecureRequest SecureRequest::Prepare(uint32 size, uint32 reserveSize) {
 	const auto finalSize = std::max(size, reserveSize);
 
+	// Reserve space for the padding, so that the request is not
+	// reallocated together with all its data in addPadding().
 	auto result = SecureRequest(details::SecureRequestCreateTag{});
-	result->reserve(kMessageBodyPosition + finalSize);
+	result->reserve(kMessageBodyPosition + finalSize + kMaxPaddingInts);
 	result->resize(kMessageBodyPosition);
 	result->back() = (size << 2);
 	return result;
@@ -145,6 +150,33 @@ bool SecureRequest::needAck() const {
 	return true;
 }
 
+RequestPriority SecureRequest::defaultPriority() const {
+	if (_data->size() <= kMessageBodyPosition) {
+		return RequestPriority::Normal;
+	}
+	switch (mtpTypeId((*_data)[kMessageBodyPosition])) {
+	case mtpc_messages_getHistory:
+	case mtpc_messages_getPeerDialogs:
+	case mtpc_messages_getMessages:
+	case mtpc_channels_getMessages:
+	case mtpc_messages_sendMessage:
+	case mtpc_messages_sendMedia:
+	case mtpc_messages_readHistory:
+	case mtpc_channels_readHistory:
+		return RequestPriority::Interactive;
+	case mtpc_updates_getDifference:
+	case mtpc_updates_getChannelDifference:
+	case mtpc_messages_getStickerSet:
+	case mtpc_messages_getAllStickers:
+	case mtpc_messages_getFeaturedStickers:
+	case mtpc_messages_getRecentStickers:
+	case mtpc_messages_getSavedGifs:
+	case mtpc_messages_getFavedStickers:
+		return RequestPriority::Background;
+	}
+	return RequestPriority::Normal;
+}
+
 } // namespace MTP
 
 uint32 MTPstring::innerLength() const {
@@ -269,6 +269,28 @@ struct is_boxed<MTPBoxed<T>> : std::true_type {
 template <typename T>
 constexpr bool is_boxed_v = is_boxed<T>::value;
 
+// Requests with higher priority are packed into containers first.
+enum class RequestPriority : uchar {
+	Background,
+	Normal,
+	Interactive,
+};
+
+struct ConnectionMetrics {
+	crl::time smoothedRtt = 0;
+	int resentCount = 0;
+	int containersSent = 0;
+	int containerRequests = 0;
+	int64 bytesSent = 0;
+	int64 bytesReceived = 0;
+	crl::profile_time encryptTime = 0;
+	crl::profile_time decryptTime = 0;
+
+	int averageContainerFill() const {
+		return containersSent ? (containerRequests / containersSent) : 0;
+	}
+};
+
 class SecureRequestData;
 class SecureRequest {
 public:
@@ -309,6 +331,7 @@ public:
 	bool isSentContainer() const;
 	bool isStateRequest() const;
 	bool needAck() const;
+	RequestPriority defaultPriority() const;
 
 	using ResponseType = void; // don't know real response type =(
 
@@ -331,6 +354,7 @@ public:
 	mtpRequestId requestId = 0;
 	SecureRequest after;
 	bool needsLayer = false;
+	RequestPriority priority = RequestPriority::Normal;
 
 };
 
@@ -783,6 +807,11 @@ public:
 		}
 		auto count = static_cast<uint32>(*(from++));
 
+		// Each item takes at least one prime, so a broken count is
+		// rejected before allocating the items it claims.
+		if (count > uint32(end - from)) {
+			return false;
+		}
 		auto vector = QVector<T>(count, T());
 		for (auto &item : vector) {
 			if (!item.read(from, end)) {
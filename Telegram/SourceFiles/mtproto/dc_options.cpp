@@ -382,6 +382,16 @@ QByteArray DcOptions::serialize() const {
 		}
 	}
 
+	// Preferred endpoints.
+	auto preferred = 0;
+	size += sizeof(qint32);
+	for (const auto &[key, endpoint] : _preferredEndpoints) {
+		++preferred;
+		// id + type + protocol + port
+		size += 4 * sizeof(qint32);
+		size += sizeof(qint32) + endpoint.ip.size();
+	}
+
 	constexpr auto kVersion = 1;
 
 	auto result = QByteArray();
@@ -417,6 +427,17 @@ QByteArray DcOptions::serialize() const {
 				<< Serialize::bytes(key.n)
 				<< Serialize::bytes(key.e);
 		}
+
+		// Preferred endpoints.
+		stream << qint32(preferred);
+		for (const auto &[key, endpoint] : _preferredEndpoints) {
+			stream << qint32(key.first)
+				<< qint32(key.second)
+				<< qint32(endpoint.protocol)
+				<< qint32(endpoint.port)
+				<< qint32(endpoint.ip.size());
+			stream.writeRawData(endpoint.ip.data(), endpoint.ip.size());
+		}
 	}
 	return result;
 }
@@ -511,6 +532,45 @@ void DcOptions::constructFromSerialized(const QByteArray &serialized) {
 			}
 		}
 	}
+
+	// Read preferred endpoints
+	if (!stream.atEnd()) {
+		auto count = qint32(0);
+		stream >> count;
+		if (stream.status() != QDataStream::Ok) {
+			LOG(("MTP Error: Bad data for preferred endpoints in DcOptions::constructFromSerialized()"));
+			return;
+		}
+
+		_preferredEndpoints.clear();
+		for (auto i = 0; i != count; ++i) {
+			qint32 dcId = 0, type = 0, protocol = 0, port = 0, ipSize = 0;
+			stream >> dcId >> type >> protocol >> port >> ipSize;
+
+			constexpr auto kMaxIpSize = 45;
+			if (ipSize <= 0
+				|| ipSize > kMaxIpSize
+				|| (type != qint32(DcType::Regular)
+					&& type != qint32(DcType::MediaDownload))
+				|| protocol < 0
+				|| protocol >= Variants::ProtocolCount) {
+				LOG(("MTP Error: Bad data for preferred endpoints inside DcOptions::constructFromSerialized()"));
+				return;
+			}
+			auto ip = std::string(ipSize, ' ');
+			stream.readRawData(ip.data(), ipSize);
+			if (stream.status() != QDataStream::Ok) {
+				LOG(("MTP Error: Bad data for preferred endpoints inside DcOptions::constructFromSerialized()"));
+				return;
+			}
+			const auto key = std::make_pair(DcId(dcId), DcType(type));
+			_preferredEndpoints.emplace(key, PreferredEndpoint{
+				static_cast<Variants::Protocol>(protocol),
+				std::move(ip),
+				port
+			});
+		}
+	}
 }
 
 DcOptions::Ids DcOptions::configEnumDcIds() const {
@@ -545,6 +605,28 @@ DcType DcOptions::dcType(ShiftedDcId shiftedDcId) const {
 	return DcType::Regular;
 }
 
+auto DcOptions::preferredEndpoint(DcId dcId, DcType type) const
+-> std::optional<PreferredEndpoint> {
+	ReadLocker lock(this);
+	const auto i = _preferredEndpoints.find(std::make_pair(dcId, type));
+	if (i == end(_preferredEndpoints)) {
+		return std::nullopt;
+	}
+	return i->second;
+}
+
+void DcOptions::setPreferredEndpoint(
+		DcId dcId,
+		DcType type,
+		const PreferredEndpoint &endpoint) {
+	// Only regular and media connections use the persistent endpoints.
+	if (type != DcType::Regular && type != DcType::MediaDownload) {
+		return;
+	}
+	QWriteLocker lock(&_useThroughLockers);
+	_preferredEndpoints[std::make_pair(dcId, type)] = endpoint;
+}
+
 void DcOptions::setCDNConfig(const MTPDcdnConfig &config) {
 	WriteLocker lock(this);
 	_cdnPublicKeys.clear();
@@ -89,6 +89,21 @@ public:
 	Variants lookup(DcId dcId, DcType type, bool throughProxy) const;
 	DcType dcType(ShiftedDcId shiftedDcId) const;
 
+	// The endpoint that won the last connection race to this dc,
+	// it is tried with the highest priority next time.
+	struct PreferredEndpoint {
+		Variants::Protocol protocol = Variants::Tcp;
+		std::string ip;
+		int port = 0;
+	};
+	std::optional<PreferredEndpoint> preferredEndpoint(
+		DcId dcId,
+		DcType type) const;
+	void setPreferredEndpoint(
+		DcId dcId,
+		DcType type,
+		const PreferredEndpoint &endpoint);
+
 	void setCDNConfig(const MTPDcdnConfig &config);
 	bool hasCDNKeysForDc(DcId dcId) const;
 	bool getDcRSAKey(DcId dcId, const QVector<MTPlong> &fingerprints, internal::RSAPublicKey *result) const;
@@ -131,6 +146,7 @@ private:
 	std::set<DcId> _cdnDcIds;
 	std::map<uint64, internal::RSAPublicKey> _publicKeys;
 	std::map<DcId, std::map<uint64, internal::RSAPublicKey>> _cdnPublicKeys;
+	std::map<std::pair<DcId, DcType>, PreferredEndpoint> _preferredEndpoints;
 	mutable QReadWriteLock _useThroughLockers;
 
 	mutable base::Observable<Ids> _changed;
@@ -303,7 +303,7 @@ void DedicatedLoader::startLoading() {
 }
 
 void DedicatedLoader::sendRequest() {
-	if (_requests.size() >= kRequestsCount || _offset >= _size) {
+	if (_requests.size() >= _requestsCount || _offset >= _size) {
 		return;
 	}
 	const auto offset = _offset;
@@ -319,7 +319,7 @@ void DedicatedLoader::sendRequest() {
 		MTP::updaterDcId(_dcId));
 	_offset += kChunkSize;
 
-	if (_requests.size() < kRequestsCount) {
+	if (_requests.size() < _requestsCount) {
 		App::CallDelayed(kNextRequestDelay, this, [=] { sendRequest(); });
 	}
 }
@@ -346,6 +346,7 @@ void DedicatedLoader::gotPart(int offset, const MTPupload_File &result) {
 	Assert(i != end(_requests));
 
 	i->bytes = data.vbytes().v;
+	_requestsCount = std::min(_requestsCount + 1, kRequestsCountMax);
 	while (!_requests.empty() && !_requests.front().bytes.isEmpty()) {
 		writeChunk(bytes::make_span(_requests.front().bytes), _size);
 		_requests.pop_front();
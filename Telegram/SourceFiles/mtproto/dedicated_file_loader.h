@@ -129,10 +129,14 @@ private:
 	void gotPart(int offset, const MTPupload_File &result);
 	Fn<void(const RPCError &)> failHandler();
 
+	// The window of parts in flight starts small and grows with each
+	// received part, so high latency links get enough parallel requests.
 	static constexpr auto kRequestsCount = 2;
+	static constexpr auto kRequestsCountMax = 8;
 	static constexpr auto kNextRequestDelay = crl::time(20);
 
 	std::deque<Request> _requests;
+	int _requestsCount = kRequestsCount;
 	int32 _size = 0;
 	int _offset = 0;
 	DcId _dcId = 0;
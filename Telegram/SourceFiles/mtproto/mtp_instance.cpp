@@ -31,6 +31,7 @@ namespace {
 
 constexpr auto kConfigBecomesOldIn = 2 * 60 * crl::time(1000);
 constexpr auto kConfigBecomesOldForBlockedIn = 8 * crl::time(1000);
+constexpr auto kConnectionMetricsUpdateTimeout = crl::time(1000);
 
 } // namespace
 
@@ -68,6 +69,8 @@ public:
 	void restart(ShiftedDcId shiftedDcId);
 	[[nodiscard]] int32 dcstate(ShiftedDcId shiftedDcId = 0);
 	[[nodiscard]] QString dctransport(ShiftedDcId shiftedDcId = 0);
+	[[nodiscard]] ConnectionMetrics connectionMetrics(
+		ShiftedDcId shiftedDcId = 0);
 	void ping();
 	void cancel(mtpRequestId requestId);
 	[[nodiscard]] int32 state(mtpRequestId requestId); // < 0 means waiting for such count of ms
@@ -528,6 +531,25 @@ QString Instance::Private::dctransport(ShiftedDcId shiftedDcId) {
 	return QString();
 }
 
+ConnectionMetrics Instance::Private::connectionMetrics(
+		ShiftedDcId shiftedDcId) {
+	if (!shiftedDcId) {
+		Assert(_mainSession != nullptr);
+		return _mainSession->metrics();
+	}
+	if (!BareDcId(shiftedDcId)) {
+		Assert(_mainSession != nullptr);
+		shiftedDcId += BareDcId(_mainSession->getDcWithShift());
+	}
+
+	auto it = _sessions.find(shiftedDcId);
+	if (it != _sessions.cend()) {
+		return it->second->metrics();
+	}
+
+	return ConnectionMetrics();
+}
+
 void Instance::Private::ping() {
 	getSession(0)->ping();
 }
@@ -913,6 +935,7 @@ void Instance::Private::sendRequest(
 	}
 	request->msDate = crl::now(); // > 0 - can send without container
 	request->needsLayer = needsLayer;
+	request->priority = request.defaultPriority();
 
 	session->sendPrepared(request, msCanWait);
 }
@@ -1626,6 +1649,23 @@ QString Instance::dctransport(ShiftedDcId shiftedDcId) {
 	return _private->dctransport(shiftedDcId);
 }
 
+ConnectionMetrics Instance::connectionMetrics(ShiftedDcId shiftedDcId) {
+	return _private->connectionMetrics(shiftedDcId);
+}
+
+rpl::producer<ConnectionMetrics> Instance::connectionMetricsValue(
+		ShiftedDcId shiftedDcId) {
+	return rpl::make_producer<ConnectionMetrics>([=](auto consumer) {
+		auto lifetime = rpl::lifetime();
+		const auto timer = lifetime.make_state<base::Timer>([=] {
+			consumer.put_next(connectionMetrics(shiftedDcId));
+		});
+		consumer.put_next(connectionMetrics(shiftedDcId));
+		timer->callEach(kConnectionMetricsUpdateTimeout);
+		return lifetime;
+	});
+}
+
 void Instance::ping() {
 	_private->ping();
 }
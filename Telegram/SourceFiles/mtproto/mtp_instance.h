@@ -140,6 +140,9 @@ public:
 	void restart(ShiftedDcId shiftedDcId);
 	int32 dcstate(ShiftedDcId shiftedDcId = 0);
 	QString dctransport(ShiftedDcId shiftedDcId = 0);
+	ConnectionMetrics connectionMetrics(ShiftedDcId shiftedDcId = 0);
+	rpl::producer<ConnectionMetrics> connectionMetricsValue(
+		ShiftedDcId shiftedDcId = 0);
 	void ping();
 	void cancel(mtpRequestId requestId);
 	int32 state(mtpRequestId requestId); // < 0 means waiting for such count of ms
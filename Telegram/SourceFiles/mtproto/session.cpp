@@ -31,6 +31,11 @@ constexpr auto kResendThreshold = 1;
 // Container lives 10 minutes in haveSent map.
 constexpr auto kContainerLives = 600;
 
+// Should be a power of two greater than kIdsBufferSize.
+constexpr auto kReceivedIdsInitialCapacity = 512;
+static_assert(kReceivedIdsInitialCapacity > kIdsBufferSize);
+static_assert(!(kReceivedIdsInitialCapacity & (kReceivedIdsInitialCapacity - 1)));
+
 QString LogIds(const QVector<uint64> &ids) {
 	if (!ids.size()) return "[]";
 	auto idsStr = QString("[%1").arg(*ids.cbegin());
@@ -42,6 +47,81 @@ QString LogIds(const QVector<uint64> &ids) {
 
 } // namespace
 
+ReceivedMsgIds::ReceivedMsgIds()
+: _entries(kReceivedIdsInitialCapacity) {
+}
+
+bool ReceivedMsgIds::registerMsgId(mtpMsgId msgId, bool needAck) {
+	const auto index = lowerBound(msgId);
+	if (index < _count && at(index).msgId == msgId) {
+		MTP_LOG(-1, ("No need to handle - %1 already is in map").arg(msgId));
+		return false;
+	} else if (_count >= kIdsBufferSize && !index) {
+		MTP_LOG(-1, ("No need to handle - %1 < min = %2").arg(msgId).arg(min()));
+		return false;
+	}
+	insert(index, { msgId, needAck });
+	return true;
+}
+
+void ReceivedMsgIds::shrink() {
+	if (_count > kIdsBufferSize) {
+		const auto remove = _count - kIdsBufferSize;
+		_first = (_first + remove) & (_entries.size() - 1);
+		_count = kIdsBufferSize;
+	}
+}
+
+auto ReceivedMsgIds::lookup(mtpMsgId msgId) const -> State {
+	const auto index = lowerBound(msgId);
+	if (index == _count || at(index).msgId != msgId) {
+		return State::NotFound;
+	}
+	return at(index).needAck ? State::NeedsAck : State::NoAckNeeded;
+}
+
+void ReceivedMsgIds::clear() {
+	_first = _count = 0;
+}
+
+int ReceivedMsgIds::lowerBound(mtpMsgId msgId) const {
+	// Most of the time we look for a new msgId, greater than all others.
+	if (!_count || at(_count - 1).msgId < msgId) {
+		return _count;
+	}
+	auto from = 0;
+	auto till = _count;
+	while (from < till) {
+		const auto middle = from + (till - from) / 2;
+		if (at(middle).msgId < msgId) {
+			from = middle + 1;
+		} else {
+			till = middle;
+		}
+	}
+	return from;
+}
+
+void ReceivedMsgIds::insert(int index, Entry entry) {
+	if (_count == int(_entries.size())) {
+		grow();
+	}
+	for (auto i = _count; i != index; --i) {
+		at(i) = at(i - 1);
+	}
+	at(index) = entry;
+	++_count;
+}
+
+void ReceivedMsgIds::grow() {
+	auto entries = std::vector<Entry>(_entries.size() * 2);
+	for (auto i = 0; i != _count; ++i) {
+		entries[i] = at(i);
+	}
+	_entries = std::move(entries);
+	_first = 0;
+}
+
 ConnectionOptions::ConnectionOptions(
 	const QString &systemLangCode,
 	const QString &cloudLangCode,
@@ -457,6 +537,10 @@ QString Session::transport() const {
 	return _connection ? _connection->transport() : QString();
 }
 
+ConnectionMetrics Session::metrics() const {
+	return data.metrics();
+}
+
 mtpRequestId Session::resend(quint64 msgId, qint64 msCanWait, bool forceContainer, bool sendMsgStateInfo) {
 	SecureRequest request;
 	{
@@ -493,6 +577,9 @@ mtpRequestId Session::resend(quint64 msgId, qint64 msCanWait, bool forceContaine
 	} else if (!request.isStateRequest()) {
 		request->msDate = forceContainer ? 0 : crl::now();
 		sendPrepared(request, msCanWait, false);
+		data.changeMetrics([](ConnectionMetrics &metrics) {
+			++metrics.resentCount;
+		});
 		{
 			QWriteLocker locker(data.toResendMutex());
 			data.toResendMap().insert(msgId, request->requestId);
@@ -599,35 +686,26 @@ void Session::tryToReceive() {
 		return;
 	}
 	while (true) {
-		auto requestId = mtpRequestId(0);
-		auto isUpdate = false;
-		auto message = SerializedMessage();
+		// Take all the received messages at once,
+		// so that the lock is not acquired for each of them.
+		auto responses = QMap<mtpRequestId, SerializedMessage>();
+		auto updates = QList<SerializedMessage>();
 		{
 			QWriteLocker locker(data.haveReceivedMutex());
-			auto &responses = data.haveReceivedResponses();
-			auto response = responses.begin();
-			if (response == responses.cend()) {
-				auto &updates = data.haveReceivedUpdates();
-				auto update = updates.begin();
-				if (update == updates.cend()) {
-					return;
-				} else {
-					message = std::move(*update);
-					isUpdate = true;
-					updates.pop_front();
-				}
-			} else {
-				requestId = response.key();
-				message = std::move(response.value());
-				responses.erase(response);
-			}
+			responses = base::take(data.haveReceivedResponses());
+			updates = base::take(data.haveReceivedUpdates());
+		}
+		if (responses.isEmpty() && updates.isEmpty()) {
+			return;
 		}
-		if (isUpdate) {
-			if (dcWithShift == BareDcId(dcWithShift)) { // call globalCallback only in main session
+		for (auto i = responses.cbegin(), e = responses.cend(); i != e; ++i) {
+			const auto &message = i.value();
+			_instance->execCallback(i.key(), message.constData(), message.constData() + message.size());
+		}
+		if (dcWithShift == BareDcId(dcWithShift)) { // call globalCallback only in main session
+			for (const auto &message : std::as_const(updates)) {
 				_instance->globalCallback(message.constData(), message.constData() + message.size());
 			}
-		} else {
-			_instance->execCallback(requestId, message.constData(), message.constData() + message.size());
 		}
 	}
 }
@@ -42,57 +42,52 @@ public:
 
 };
 
+// Received msgIds are almost monotonic, so they are kept sorted
+// in a ring buffer where new ids are usually appended to the end.
 class ReceivedMsgIds {
 public:
-	bool registerMsgId(mtpMsgId msgId, bool needAck) {
-		auto i = _idsNeedAck.constFind(msgId);
-		if (i == _idsNeedAck.cend()) {
-			if (_idsNeedAck.size() < kIdsBufferSize || msgId > min()) {
-				_idsNeedAck.insert(msgId, needAck);
-				return true;
-			}
-			MTP_LOG(-1, ("No need to handle - %1 < min = %2").arg(msgId).arg(min()));
-		} else {
-			MTP_LOG(-1, ("No need to handle - %1 already is in map").arg(msgId));
-		}
-		return false;
-	}
+	ReceivedMsgIds();
+
+	bool registerMsgId(mtpMsgId msgId, bool needAck);
 
 	mtpMsgId min() const {
-		return _idsNeedAck.isEmpty() ? 0 : _idsNeedAck.cbegin().key();
+		return _count ? at(0).msgId : 0;
 	}
 
 	mtpMsgId max() const {
-		auto end = _idsNeedAck.cend();
-		return _idsNeedAck.isEmpty() ? 0 : (--end).key();
+		return _count ? at(_count - 1).msgId : 0;
 	}
 
-	void shrink() {
-		auto size = _idsNeedAck.size();
-		while (size-- > kIdsBufferSize) {
-			_idsNeedAck.erase(_idsNeedAck.begin());
-		}
-	}
+	void shrink();
 
 	enum class State {
 		NotFound,
 		NeedsAck,
 		NoAckNeeded,
 	};
-	State lookup(mtpMsgId msgId) const {
-		auto i = _idsNeedAck.constFind(msgId);
-		if (i == _idsNeedAck.cend()) {
-			return State::NotFound;
-		}
-		return i.value() ? State::NeedsAck : State::NoAckNeeded;
-	}
+	State lookup(mtpMsgId msgId) const;
 
-	void clear() {
-		_idsNeedAck.clear();
-	}
+	void clear();
 
 private:
-	QMap<mtpMsgId, bool> _idsNeedAck;
+	struct Entry {
+		mtpMsgId msgId = 0;
+		bool needAck = false;
+	};
+
+	Entry &at(int index) {
+		return _entries[(_first + index) & (_entries.size() - 1)];
+	}
+	const Entry &at(int index) const {
+		return _entries[(_first + index) & (_entries.size() - 1)];
+	}
+	int lowerBound(mtpMsgId msgId) const;
+	void insert(int index, Entry entry);
+	void grow();
+
+	std::vector<Entry> _entries; // size is always a power of two
+	int _first = 0;
+	int _count = 0;
 
 };
 
@@ -277,6 +272,16 @@ public:
 		return result * 2 + (needAck ? 1 : 0);
 	}
 
+	ConnectionMetrics metrics() const {
+		QReadLocker locker(&_metricsLock);
+		return _metrics;
+	}
+	template <typename Method>
+	void changeMetrics(Method method) {
+		QWriteLocker locker(&_metricsLock);
+		method(_metrics);
+	}
+
 	void clear(Instance *instance);
 
 private:
@@ -302,6 +307,8 @@ private:
 	QMap<mtpRequestId, SerializedMessage> _receivedResponses; // map of request_id -> response that should be processed in the main thread
 	QList<SerializedMessage> _receivedUpdates; // list of updates that should be processed in the main thread
 
+	ConnectionMetrics _metrics;
+
 	// mutexes
 	mutable QReadWriteLock _lock;
 	mutable QReadWriteLock _toSendLock;
@@ -311,6 +318,7 @@ private:
 	mutable QReadWriteLock _wereAckedLock;
 	mutable QReadWriteLock _haveReceivedLock;
 	mutable QReadWriteLock _stateRequestLock;
+	mutable QReadWriteLock _metricsLock;
 
 };
 
@@ -341,6 +349,7 @@ public:
 	int32 requestState(mtpRequestId requestId) const;
 	int32 getState() const;
 	QString transport() const;
+	ConnectionMetrics metrics() const;
 
 	// Nulls msgId and seqNo in request, if newRequest = true.
 	void sendPrepared(
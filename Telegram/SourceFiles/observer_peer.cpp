@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "observer_peer.h"
 
 #include "base/observer.h"
+#include <rpl/event_stream.h>
 
 namespace Notify {
 namespace {
@@ -28,6 +29,9 @@ void FinishCallback() {
 
 base::Observable<PeerUpdate, PeerUpdatedHandler> PeerUpdatedObservable;
 
+// rpl viewers are served without a base::Subscription for each of them.
+rpl::event_stream<PeerUpdate> PeerUpdatedStream;
+
 } // namespace
 
 void mergePeerUpdate(PeerUpdate &mergeTo, const PeerUpdate &mergeFrom) {
@@ -75,11 +79,11 @@ void peerUpdatedSendDelayed() {
 
 	auto smallList = base::take(*SmallUpdates);
 	auto allList = base::take(*AllUpdates);
-	for (auto &update : smallList) {
-		PeerUpdated().notify(std::move(update), true);
+	for (const auto &update : smallList) {
+		peerUpdatedNow(update);
 	}
-	for (auto &update : allList) {
-		PeerUpdated().notify(std::move(update), true);
+	for (const auto &update : allList) {
+		peerUpdatedNow(update);
 	}
 
 	if (SmallUpdates->isEmpty()) {
@@ -88,21 +92,21 @@ void peerUpdatedSendDelayed() {
 	}
 }
 
+void peerUpdatedNow(const PeerUpdate &update) {
+	PeerUpdated().notify(update, true);
+	PeerUpdatedStream.fire_copy(update);
+}
+
 base::Observable<PeerUpdate, PeerUpdatedHandler> &PeerUpdated() {
 	return PeerUpdatedObservable;
 }
 
 rpl::producer<PeerUpdate> PeerUpdateViewer(
 		PeerUpdate::Flags flags) {
-	return [=](const auto &consumer) {
-		auto lifetime = rpl::lifetime();
-		lifetime.make_state<base::Subscription>(
-			PeerUpdated().add_subscription({ flags, [=](
-					const PeerUpdate &update) {
-				consumer.put_next_copy(update);
-			}}));
-		return lifetime;
-	};
+	return PeerUpdatedStream.events(
+	) | rpl::filter([=](const PeerUpdate &update) {
+		return (update.flags & flags);
+	});
 }
 
 rpl::producer<PeerUpdate> PeerUpdateViewer(
@@ -88,6 +88,9 @@ inline void peerUpdatedDelayed(PeerData *peer, PeerUpdate::Flags events) {
 }
 void peerUpdatedSendDelayed();
 
+// Notifies both the legacy subscribers and the rpl viewers right away.
+void peerUpdatedNow(const PeerUpdate &update);
+
 class PeerUpdatedHandler {
 public:
 	template <typename Lambda>
@@ -316,6 +316,12 @@ int32 Photo::resizeGetHeight(int32 width) {
 	return _height;
 }
 
+void Photo::preload() {
+	if (!_data->loaded()) {
+		_data->thumbnail()->automaticLoad(parent()->fullId(), parent());
+	}
+}
+
 void Photo::paint(Painter &p, const QRect &clip, TextSelection selection, const PaintContext *context) {
 	bool good = _data->loaded(), selected = (selection == FullSelection);
 	if (!good) {
@@ -419,6 +425,14 @@ int32 Video::resizeGetHeight(int32 width) {
 	return _height;
 }
 
+void Video::preload() {
+	if (const auto good = _data->goodThumbnail()) {
+		good->load({});
+	} else if (_data->hasThumbnail()) {
+		_data->thumbnail()->load(parent()->fullId());
+	}
+}
+
 void Video::paint(Painter &p, const QRect &clip, TextSelection selection, const PaintContext *context) {
 	const auto selected = (selection == FullSelection);
 	const auto blurred = _data->thumbnailInline();
@@ -1467,6 +1481,11 @@ void Link::initDimensions() {
 }
 
 int32 Link::resizeGetHeight(int32 width) {
+	// Sections are laid out again on each slice update, mostly
+	// with the same width, and counting the text height is not cheap.
+	if (qMin(width, _maxw) == _width && _height > 0) {
+		return _height;
+	}
 	_width = qMin(width, _maxw);
 	int32 w = _width - st::linksPhotoSize - st::linksPhotoPadding;
 	for (const auto &link : _links) {
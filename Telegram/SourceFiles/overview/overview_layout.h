@@ -57,6 +57,10 @@ public:
 	virtual void invalidateCache() {
 	}
 
+	// Starts loading what paint() will need, before it becomes visible.
+	virtual void preload() {
+	}
+
 };
 
 class ItemBase : public AbstractItem {
@@ -208,6 +212,7 @@ public:
 	TextState getState(
 		QPoint point,
 		StateRequest request) const override;
+	void preload() override;
 
 private:
 	void setPixFrom(not_null<Image*> image);
@@ -232,6 +237,7 @@ public:
 	TextState getState(
 		QPoint point,
 		StateRequest request) const override;
+	void preload() override;
 
 protected:
 	float64 dataProgress() const override;
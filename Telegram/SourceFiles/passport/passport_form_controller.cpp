@@ -1378,10 +1378,13 @@ void FormController::uploadScan(
 		return std::nullopt;
 	}();
 	auto &scan = nonconst->fileInEdit(type, fileIndex);
-	encryptFile(scan, std::move(content), [=](UploadScanData &&result) {
-		uploadEncryptedFile(
-			nonconst->fileInEdit(type, fileIndex),
-			std::move(result));
+	encryptFile(scan, std::move(content), [=](
+			UploadScanData &&result,
+			QImage &&image) {
+		auto &file = nonconst->fileInEdit(type, fileIndex);
+		file.fields.image = std::move(image);
+		uploadEncryptedFile(file, std::move(result));
+		_scanUpdated.fire(&file);
 	});
 }
 
@@ -1408,7 +1411,6 @@ void FormController::prepareFile(
 	file.fields.dcId = MTP::maindc();
 	file.fields.secret = GenerateSecretBytes();
 	file.fields.date = base::unixtime::now();
-	file.fields.image = ReadImage(bytes::make_span(content));
 	file.fields.downloadOffset = file.fields.size;
 
 	_scanUpdated.fire(&file);
@@ -1417,9 +1419,11 @@ void FormController::prepareFile(
 void FormController::encryptFile(
 		EditFile &file,
 		QByteArray &&content,
-		Fn<void(UploadScanData &&result)> callback) {
+		Fn<void(UploadScanData &&result, QImage &&image)> callback) {
 	prepareFile(file, content);
 
+	// The preview is decoded together with the encryption,
+	// so a few scans chosen at once don't block the panel.
 	const auto weak = std::weak_ptr<bool>(file.guard);
 	crl::async([
 		=,
@@ -1439,9 +1443,14 @@ void FormController::encryptFile(
 			result.bytes.data(),
 			result.bytes.size(),
 			result.md5checksum.data());
-		crl::on_main([=, encrypted = std::move(result)]() mutable {
+		auto image = ReadImage(bytes::make_span(bytes));
+		crl::on_main([
+			=,
+			encrypted = std::move(result),
+			image = std::move(image)
+		]() mutable {
 			if (weak.lock()) {
-				callback(std::move(encrypted));
+				callback(std::move(encrypted), std::move(image));
 			}
 		});
 	});
@@ -13,6 +13,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "history/history.h"
 #include "lang/lang_keys.h"
 
+#include <crl/crl_queue.h>
+
 namespace Platform {
 namespace Notifications {
 #ifndef TDESKTOP_DISABLE_GTK_INTEGRATION
@@ -328,6 +330,12 @@ public:
 private:
 	QString escapeNotificationText(const QString &text) const;
 	void showNextNotification();
+	void showInQueue(
+		const Notification &notification,
+		const QString &imagePath,
+		PeerId peerId,
+		MsgId msgId);
+	void closeInQueue(const Notification &notification);
 
 	struct QueuedNotification {
 		PeerData *peer = nullptr;
@@ -353,6 +361,10 @@ private:
 
 	std::shared_ptr<Manager*> _guarded;
 
+	// Image loading and D-Bus calls of libnotify are blocking,
+	// they are done in order here instead of the main thread.
+	crl::queue _queue;
+
 };
 #endif // !TDESKTOP_DISABLE_GTK_INTEGRATION
 
@@ -413,7 +425,17 @@ void Manager::Private::showNotification(
 	notification.title = titleText;
 	notification.body = bodyText;
 	notification.hideNameAndPhoto = hideNameAndPhoto;
-	_queuedNotifications.push_back(notification);
+
+	// A chat flooding the queue keeps only its latest message waiting.
+	const auto i = ranges::find(
+		_queuedNotifications,
+		notification.peer,
+		&QueuedNotification::peer);
+	if (i != _queuedNotifications.end()) {
+		*i = notification;
+	} else {
+		_queuedNotifications.push_back(notification);
+	}
 
 	showNextNotification();
 }
@@ -457,7 +479,7 @@ void Manager::Private::showNextNotification() {
 	const auto key = data.hideNameAndPhoto
 		? InMemoryKey()
 		: data.peer->userpicUniqueKey();
-	notification->setImage(_cachedUserpics.get(key, data.peer));
+	const auto imagePath = _cachedUserpics.get(key, data.peer);
 
 	auto i = _notifications.find(peerId);
 	if (i != _notifications.cend()) {
@@ -465,7 +487,7 @@ void Manager::Private::showNextNotification() {
 		if (j != i->cend()) {
 			auto oldNotification = j.value();
 			i->erase(j);
-			oldNotification->close();
+			closeInQueue(oldNotification);
 			i = _notifications.find(peerId);
 		}
 	}
@@ -473,14 +495,30 @@ void Manager::Private::showNextNotification() {
 		i = _notifications.insert(peerId, QMap<MsgId, Notification>());
 	}
 	_notifications[peerId].insert(msgId, notification);
-	if (!notification->show()) {
-		i = _notifications.find(peerId);
-		if (i != _notifications.cend()) {
-			i->remove(msgId);
-			if (i->isEmpty()) _notifications.erase(i);
+	showInQueue(notification, imagePath, peerId, msgId);
+}
+
+void Manager::Private::showInQueue(
+		const Notification &notification,
+		const QString &imagePath,
+		PeerId peerId,
+		MsgId msgId) {
+	const auto weak = std::weak_ptr<Manager*>(_guarded);
+	_queue.async([=] {
+		notification->setImage(imagePath);
+		if (notification->show()) {
+			return;
 		}
-		showNextNotification();
-	}
+		crl::on_main(weak, [=] {
+			(*weak.lock())->clearNotification(peerId, msgId);
+		});
+	});
+}
+
+void Manager::Private::closeInQueue(const Notification &notification) {
+	_queue.async([=] {
+		notification->close();
+	});
 }
 
 void Manager::Private::clearAll() {
@@ -489,7 +527,7 @@ void Manager::Private::clearAll() {
 	auto temp = base::take(_notifications);
 	for_const (auto &notifications, temp) {
 		for_const (auto notification, notifications) {
-			notification->close();
+			closeInQueue(notification);
 		}
 	}
 }
@@ -509,7 +547,7 @@ void Manager::Private::clearFromHistory(not_null<History*> history) {
 		_notifications.erase(i);
 
 		for_const (auto notification, temp) {
-			notification->close();
+			closeInQueue(notification);
 		}
 	}
 
@@ -529,7 +567,13 @@ void Manager::Private::clearNotification(PeerId peerId, MsgId msgId) {
 }
 
 Manager::Private::~Private() {
-	clearAll();
+	// The queue may not get to the pending tasks any more.
+	_queuedNotifications.clear();
+	for_const (auto &notifications, base::take(_notifications)) {
+		for_const (auto notification, notifications) {
+			notification->close();
+		}
+	}
 }
 
 Manager::Manager(Window::Notifications::System *system) : NativeManager(system)
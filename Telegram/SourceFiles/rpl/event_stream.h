@@ -88,7 +88,12 @@ private:
 	struct Data {
 		std::vector<consumer<Value, Error>> consumers;
 		int depth = 0;
+
+		// Firing doesn't copy the shared pointer, so if the stream is
+		// finished from one of the handlers it is kept alive here.
+		std::shared_ptr<Data> firing_owner;
 	};
+	static void keep_while_firing(std::shared_ptr<Data> &&data);
 	std::weak_ptr<Data> make_weak() const;
 
 	mutable std::shared_ptr<Data> _data;
@@ -121,7 +126,7 @@ inline void event_stream<Value, Error>::fire_forward(
 	if (!_data) {
 		return;
 	}
-	const auto copy = _data;
+	const auto copy = _data.get();
 	auto &consumers = copy->consumers;
 	if (consumers.empty()) {
 		return;
@@ -161,7 +166,9 @@ inline void event_stream<Value, Error>::fire_forward(
 			consumers.erase(staleFrom.base(), consumers.end());
 		}
 	}
-	--copy->depth;
+	if (!--copy->depth && copy->firing_owner) {
+		details::take(copy->firing_owner);
+	}
 }
 
 template <typename Value, typename Error>
@@ -171,9 +178,10 @@ inline void event_stream<Value, Error>::fire_error_forward(
 	if (!_data) {
 		return;
 	}
-	const auto data = std::move(_data);
+	auto data = std::move(_data);
 	const auto &consumers = data->consumers;
 	if (consumers.empty()) {
+		keep_while_firing(std::move(data));
 		return;
 	}
 	const auto begin = base::index_based_begin(consumers);
@@ -189,14 +197,25 @@ inline void event_stream<Value, Error>::fire_error_forward(
 	prev->put_error_forward(std::forward<OtherError>(error));
 
 	// Just drop any new consumers.
+	keep_while_firing(std::move(data));
 }
 
 template <typename Value, typename Error>
 void event_stream<Value, Error>::fire_done() const {
-	if (const auto data = details::take(_data)) {
+	if (auto data = details::take(_data)) {
 		for (const auto &consumer : data->consumers) {
 			consumer.put_done();
 		}
+		keep_while_firing(std::move(data));
+	}
+}
+
+template <typename Value, typename Error>
+void event_stream<Value, Error>::keep_while_firing(
+		std::shared_ptr<Data> &&data) {
+	if (data->depth > 0) {
+		auto &owner = data->firing_owner;
+		owner = std::move(data);
 	}
 }
 
@@ -15,6 +15,77 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace rpl {
 namespace details {
 
+template <
+	typename Value,
+	typename Error,
+	typename Generator,
+	typename Predicate>
+class filter_generator {
+public:
+	filter_generator(
+		producer<Value, Error, Generator> &&initial,
+		Predicate &&predicate)
+		: _initial(std::move(initial))
+		, _predicate(std::move(predicate)) {
+	}
+
+	template <typename Handlers>
+	lifetime operator()(const consumer<Value, Error, Handlers> &consumer) {
+		return std::move(_initial).start(
+			[
+				consumer,
+				predicate = std::move(_predicate)
+			](auto &&value) {
+				const auto &immutable = value;
+				if (details::callable_invoke(
+					predicate,
+					immutable)
+				) {
+					consumer.put_next_forward(
+						std::forward<decltype(value)>(value));
+				}
+			}, [consumer](auto &&error) {
+				consumer.put_error_forward(
+					std::forward<decltype(error)>(error));
+			}, [consumer] {
+				consumer.put_done();
+			});
+	}
+
+	producer<Value, Error, Generator> take_initial() {
+		return std::move(_initial);
+	}
+	Predicate take_predicate() {
+		return std::move(_predicate);
+	}
+
+private:
+	producer<Value, Error, Generator> _initial;
+	Predicate _predicate;
+
+};
+
+// Two adjacent filter() predicates checked in a single consumer.
+template <typename First, typename Second>
+class filter_composed {
+public:
+	filter_composed(First &&first, Second &&second)
+		: _first(std::move(first))
+		, _second(std::move(second)) {
+	}
+
+	template <typename Value>
+	bool operator()(const Value &value) const {
+		return details::callable_invoke(_first, value)
+			&& details::callable_invoke(_second, value);
+	}
+
+private:
+	First _first;
+	Second _second;
+
+};
+
 template <typename Predicate>
 class filter_helper {
 public:
@@ -30,30 +101,33 @@ public:
 		typename = std::enable_if_t<
 			details::is_callable_v<Predicate, Value>>>
 	auto operator()(producer<Value, Error, Generator> &&initial) {
-		return make_producer<Value, Error>([
-			initial = std::move(initial),
-			predicate = std::move(_predicate)
-		](const auto &consumer) mutable {
-			return std::move(initial).start(
-				[
-					consumer,
-					predicate = std::move(predicate)
-				](auto &&value) {
-					const auto &immutable = value;
-					if (details::callable_invoke(
-						predicate,
-						immutable)
-					) {
-						consumer.put_next_forward(
-							std::forward<decltype(value)>(value));
-					}
-				}, [consumer](auto &&error) {
-					consumer.put_error_forward(
-						std::forward<decltype(error)>(error));
-				}, [consumer] {
-					consumer.put_done();
-				});
-		});
+		using Generated = filter_generator<
+			Value,
+			Error,
+			Generator,
+			Predicate>;
+		return make_producer<Value, Error>(Generated(
+			std::move(initial),
+			std::move(_predicate)));
+	}
+
+	template <
+		typename Value,
+		typename Error,
+		typename InitialGenerator,
+		typename InitialPredicate,
+		typename = std::enable_if_t<
+			details::is_callable_v<Predicate, Value>>>
+	auto operator()(producer<Value, Error, filter_generator<
+			Value,
+			Error,
+			InitialGenerator,
+			InitialPredicate>> &&initial) {
+		using Composed = filter_composed<InitialPredicate, Predicate>;
+		auto generator = std::move(initial).take_generator();
+		return filter_helper<Composed>(Composed(
+			generator.take_predicate(),
+			std::move(_predicate)))(generator.take_initial());
 	}
 
 private:
@@ -62,6 +62,90 @@ map_transform(
 	return { std::move(transform), consumer };
 }
 
+template <
+	typename Value,
+	typename NewValue,
+	typename Error,
+	typename Generator,
+	typename Transform>
+class map_generator {
+public:
+	map_generator(
+		producer<Value, Error, Generator> &&initial,
+		Transform &&transform)
+		: _initial(std::move(initial))
+		, _transform(std::move(transform)) {
+	}
+
+	template <typename Handlers>
+	lifetime operator()(const consumer<NewValue, Error, Handlers> &consumer) {
+		return std::move(_initial).start(
+		map_transform(
+			std::move(_transform),
+			consumer
+		), [consumer](auto &&error) {
+			consumer.put_error_forward(
+				std::forward<decltype(error)>(error));
+		}, [consumer] {
+			consumer.put_done();
+		});
+	}
+
+	producer<Value, Error, Generator> take_initial() {
+		return std::move(_initial);
+	}
+	Transform take_transform() {
+		return std::move(_transform);
+	}
+
+private:
+	producer<Value, Error, Generator> _initial;
+	Transform _transform;
+
+};
+
+template <
+	typename First,
+	typename Second,
+	typename Arg,
+	bool = is_callable_v<const First&, Arg>>
+struct is_composed_callable : std::false_type {
+};
+
+template <typename First, typename Second, typename Arg>
+struct is_composed_callable<First, Second, Arg, true>
+	: std::bool_constant<is_callable_v<
+		const Second&,
+		callable_result<const First&, Arg>>> {
+};
+
+// Two adjacent map() transforms applied in a single consumer.
+template <typename First, typename Second>
+class map_composed {
+public:
+	map_composed(First &&first, Second &&second)
+		: _first(std::move(first))
+		, _second(std::move(second)) {
+	}
+
+	template <
+		typename OtherValue,
+		typename = std::enable_if_t<
+			is_composed_callable<First, Second, OtherValue&&>::value>>
+	auto operator()(OtherValue &&value) const {
+		return details::callable_invoke(
+			_second,
+			details::callable_invoke(
+				_first,
+				std::forward<OtherValue>(value)));
+	}
+
+private:
+	First _first;
+	Second _second;
+
+};
+
 template <typename Transform>
 class map_helper {
 public:
@@ -78,21 +162,34 @@ public:
 			Transform,
 			Value>>
 	auto operator()(producer<Value, Error, Generator> &&initial) {
-		return make_producer<NewValue, Error>([
-			initial = std::move(initial),
-			transform = std::move(_transform)
-		](const auto &consumer) mutable {
-			return std::move(initial).start(
-			map_transform(
-				std::move(transform),
-				consumer
-			), [consumer](auto &&error) {
-				consumer.put_error_forward(
-					std::forward<decltype(error)>(error));
-			}, [consumer] {
-				consumer.put_done();
-			});
-		});
+		using Generated = map_generator<
+			Value,
+			NewValue,
+			Error,
+			Generator,
+			Transform>;
+		return make_producer<NewValue, Error>(Generated(
+			std::move(initial),
+			std::move(_transform)));
+	}
+
+	template <
+		typename Value,
+		typename Error,
+		typename InitialValue,
+		typename InitialGenerator,
+		typename InitialTransform>
+	auto operator()(producer<Value, Error, map_generator<
+			InitialValue,
+			Value,
+			Error,
+			InitialGenerator,
+			InitialTransform>> &&initial) {
+		using Composed = map_composed<InitialTransform, Transform>;
+		auto generator = std::move(initial).take_generator();
+		return map_helper<Composed>(Composed(
+			generator.take_transform(),
+			std::move(_transform)))(generator.take_initial());
 	}
 
 private:
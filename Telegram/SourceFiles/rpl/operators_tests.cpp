@@ -220,6 +220,29 @@ TEST_CASE("basic operators tests", "[rpl::operators]") {
 		REQUIRE(*sum == "2 2 4 ");
 	}
 
+	SECTION("adjacent map and filter test") {
+		auto sum = std::make_shared<std::string>("");
+		{
+			auto lifetime = single(std::make_tuple(1, 2))
+				| then(single(std::make_tuple(2, 3)))
+				| then(single(std::make_tuple(3, 4)))
+				| then(single(std::make_tuple(4, 5)))
+				| filter([](auto first, auto second) { return first != 2; })
+				| filter([](const auto &value) {
+					return std::get<1>(value) != 5;
+				})
+				| map([](auto first, auto second) { return first * second; })
+				| map([](int value) { return std::to_string(value); })
+				| map([](std::string &&value) {
+					return std::move(value) + ' ';
+				})
+				| start_with_next([=](std::string &&value) {
+					*sum += std::move(value);
+				});
+		}
+		REQUIRE(*sum == "2 12 ");
+	}
+
 	SECTION("distinct_until_changed test") {
 		auto sum = std::make_shared<std::string>("");
 		{
@@ -246,6 +246,11 @@ public:
 	[[nodiscard]] lifetime start_existing(
 		const consumer_type<Handlers> &consumer) &&;
 
+	// Operators use it to fuse with the stage that made this producer.
+	[[nodiscard]] Generator take_generator() && {
+		return std::move(_generator);
+	}
+
 private:
 	Generator _generator;
 
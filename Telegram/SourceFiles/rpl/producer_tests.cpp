@@ -327,6 +327,26 @@ TEST_CASE("basic event_streams tests", "[rpl::event_stream]") {
 		}
 		REQUIRE(*sum == 1 + 2 + 3 + 4);
 	}
+
+	SECTION("event_stream destroyed in handler test") {
+		auto sum = std::make_shared<int>(0);
+		auto doneGenerated = std::make_shared<int>(0);
+		lifetime extended;
+		auto stream = std::make_unique<event_stream<int>>();
+		for (auto i = 0; i != 2; ++i) {
+			stream->events().start([=, &stream](int value) {
+				*sum += value;
+				stream = nullptr;
+			}, [=](no_error) {
+			}, [=] {
+				++*doneGenerated;
+			}, extended);
+		}
+		stream->fire(1);
+		REQUIRE(stream == nullptr);
+		REQUIRE(*sum == 1);
+		REQUIRE(*doneGenerated == 2);
+	}
 }
 
 TEST_CASE("basic piping tests", "[rpl::producer]") {
@@ -0,0 +1,110 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include <rpl/event_stream.h>
+#include <rpl/variable.h>
+#include "base/observer.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+using namespace rpl;
+
+namespace {
+
+constexpr auto kFiresCount = 1 << 20;
+constexpr int kConsumersCounts[] = { 0, 1, 4, 16 };
+
+using Clock = std::chrono::steady_clock;
+
+void Report(const std::string &name, Clock::duration time, int count) {
+	const auto nanoseconds = std::chrono::duration_cast<
+		std::chrono::nanoseconds>(time).count();
+	std::cout
+		<< std::left << std::setw(48) << name
+		<< std::right << std::setw(12) << (nanoseconds / count) << " ns/op"
+		<< std::endl;
+}
+
+std::string Label(const char *name, int consumers) {
+	return std::string(name)
+		+ ", "
+		+ std::to_string(consumers)
+		+ " consumers";
+}
+
+} // namespace
+
+TEST_CASE("event_stream fire", "[rpl_benchmark]") {
+	for (const auto consumers : kConsumersCounts) {
+		auto sum = 0;
+		auto stream = event_stream<int>();
+		auto lifetime = rpl::lifetime();
+		for (auto i = 0; i != consumers; ++i) {
+			stream.events(
+			) | start_with_next([&](int value) {
+				sum += value;
+			}, lifetime);
+		}
+
+		const auto start = Clock::now();
+		for (auto i = 0; i != kFiresCount; ++i) {
+			stream.fire_copy(i & 1);
+		}
+		Report(Label("fire", consumers), Clock::now() - start, kFiresCount);
+
+		REQUIRE(sum == (kFiresCount / 2) * consumers);
+	}
+}
+
+TEST_CASE("variable assign", "[rpl_benchmark]") {
+	for (const auto consumers : kConsumersCounts) {
+		auto sum = 0;
+		auto value = variable<int>(0);
+		auto lifetime = rpl::lifetime();
+		for (auto i = 0; i != consumers; ++i) {
+			value.changes(
+			) | start_with_next([&](int value) {
+				sum += value;
+			}, lifetime);
+		}
+
+		// Every assignment changes the value, so every one is fired.
+		const auto start = Clock::now();
+		for (auto i = 0; i != kFiresCount; ++i) {
+			value = (i & 1);
+		}
+		Report(Label("assign", consumers), Clock::now() - start, kFiresCount);
+
+		REQUIRE(sum == (kFiresCount / 2) * consumers);
+	}
+}
+
+TEST_CASE("base::Observable notify", "[rpl_benchmark]") {
+	for (const auto consumers : kConsumersCounts) {
+		auto sum = 0;
+		auto observable = base::Observable<int>();
+		auto subscriptions = std::vector<base::Subscription>();
+		for (auto i = 0; i != consumers; ++i) {
+			subscriptions.push_back(observable.add_subscription([&](int value) {
+				sum += value;
+			}));
+		}
+
+		// Only sync notifications are measured, delayed ones need a loop.
+		const auto start = Clock::now();
+		for (auto i = 0; i != kFiresCount; ++i) {
+			observable.notify(i & 1, true);
+		}
+		Report(Label("notify", consumers), Clock::now() - start, kFiresCount);
+
+		REQUIRE(sum == (kFiresCount / 2) * consumers);
+	}
+}
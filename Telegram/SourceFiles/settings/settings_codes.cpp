@@ -20,6 +20,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "mtproto/dc_options.h"
 #include "core/file_utilities.h"
 #include "core/update_checker.h"
+#include "core/core_trace.h"
+#include "base/memory_usage.h"
 #include "window/themes/window_theme.h"
 #include "window/themes/window_theme_editor.h"
 #include "media/audio/media_audio_track.h"
@@ -65,6 +67,39 @@ auto GenerateCodes() {
 		}
 		Ui::show(Box<InformBox>(DebugLogging::FileLoader() ? qsl("Enabled file download logging") : qsl("Disabled file download logging")));
 	});
+	codes.emplace(qsl("tracing"), [](::Main::Session *session) {
+		const auto text = Core::Trace::Enabled()
+			? qsl("Do you want to disable tracing?")
+			: qsl("Do you want to enable tracing?\n\n"
+				"Durations of hot paths will be recorded in memory.");
+		Ui::show(Box<ConfirmBox>(text, [] {
+			Core::Trace::SetEnabled(!Core::Trace::Enabled());
+			Ui::hideLayer();
+		}));
+	});
+	codes.emplace(qsl("exporttrace"), [](::Main::Session *session) {
+		if (!Core::Trace::Enabled()) {
+			return;
+		}
+		const auto trace = Core::Trace::ExportChromeTrace();
+		FileDialog::GetWritePath(
+			Core::App().getFileDialogParent(),
+			"Export trace",
+			"Chrome trace (*.json)",
+			cWorkingDir() + "trace.json",
+			[=](const QString &result) {
+				QFile f(result);
+				if (!f.open(QIODevice::WriteOnly)
+					|| f.write(trace) != trace.size()) {
+					Ui::show(Box<InformBox>("Could not write the trace."));
+				}
+			});
+	});
+	codes.emplace(qsl("memoryusage"), [](::Main::Session *session) {
+		const auto summary = base::memory_usage::Summary();
+		LOG(("Memory usage:\n%1").arg(summary));
+		Ui::show(Box<InformBox>(summary));
+	});
 	codes.emplace(qsl("crashplease"), [](::Main::Session *session) {
 		Unexpected("Crashed in Settings!");
 	});
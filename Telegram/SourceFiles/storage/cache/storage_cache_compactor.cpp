@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "storage/cache/storage_cache_database_object.h"
 #include "storage/cache/storage_cache_binlog_reader.h"
+#include "base/concurrent_timer.h"
 #include <unordered_set>
 
 namespace Storage {
@@ -41,6 +42,7 @@ private:
 	bool readHeader();
 	bool openCompact();
 	void parseChunk();
+	void parseChunkThrottled();
 	void fail();
 	void done(int64 till);
 	void finish();
@@ -75,6 +77,9 @@ private:
 	File _compact;
 	BinlogWrapper _wrapper;
 	size_type _partSize = 0;
+	crl::time _started = 0;
+	int64 _processedBytes = 0;
+	base::ConcurrentTimer _throttleTimer;
 	std::unordered_set<Key> _written;
 	base::variant<
 		std::vector<MultiStore::Part>,
@@ -98,8 +103,11 @@ CompactorObject::CompactorObject(
 , _key(std::move(key))
 , _info(info)
 , _wrapper(_binlog, _settings, _info.till)
-, _partSize(_settings.maxBundledRecords) { // Perhaps a better estimate?
+, _partSize(_settings.maxBundledRecords) // Perhaps a better estimate?
+, _started(crl::now())
+, _throttleTimer(_weak, [=] { parseChunk(); }) {
 	Expects(_settings.compactChunkSize > 0);
+	Expects(_settings.compactBytesPerSecond >= 0);
 
 	_written.reserve(_info.keysCount);
 	start();
@@ -239,6 +247,8 @@ bool CompactorObject::writeMultiStore() {
 	if (_compact.write(bytes::object_as_span(&header))
 		&& _compact.write(bytes::make_span(list))) {
 		_compact.flush();
+		_processedBytes += bytes::object_as_span(&header).size()
+			+ bytes::make_span(list).size();
 		return true;
 	}
 	return false;
@@ -297,7 +307,9 @@ bool CompactorObject::readBlock(std::vector<Key> &result) {
 }
 
 void CompactorObject::parseChunk() {
+	const auto offset = _binlog.offset();
 	auto keys = readChunk();
+	_processedBytes += _binlog.offset() - offset;
 	if (_wrapper.failed()) {
 		fail();
 		return;
@@ -328,7 +340,24 @@ void CompactorObject::processValues(
 			return;
 		}
 	}
-	parseChunk();
+	parseChunkThrottled();
+}
+
+void CompactorObject::parseChunkThrottled() {
+	const auto limit = _settings.compactBytesPerSecond;
+	if (!limit) {
+		parseChunk();
+		return;
+	}
+
+	// Wait until the average speed since start drops below the limit.
+	const auto spent = crl::now() - _started;
+	const auto required = crl::time(_processedBytes * 1000 / limit);
+	if (required > spent) {
+		_throttleTimer.callOnce(required - spent);
+	} else {
+		parseChunk();
+	}
 }
 
 auto CompactorObject::fillList(RawSpan values) -> RawSpan {
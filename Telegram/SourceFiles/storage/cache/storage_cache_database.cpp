@@ -153,6 +153,33 @@ void Database::getWithTag(
 	});
 }
 
+void Database::getMany(
+		std::vector<Key> &&keys,
+		FnMut<void(std::vector<QByteArray>&&)> &&done) {
+	if (done) {
+		auto untag = [done = std::move(done)](
+				std::vector<TaggedValue> &&values) mutable {
+			done(values | ranges::view::transform([](TaggedValue &value) {
+				return std::move(value.bytes);
+			}) | ranges::to_vector);
+		};
+		getManyWithTag(std::move(keys), std::move(untag));
+	} else {
+		getManyWithTag(std::move(keys), nullptr);
+	}
+}
+
+void Database::getManyWithTag(
+		std::vector<Key> &&keys,
+		FnMut<void(std::vector<TaggedValue>&&)> &&done) {
+	_wrapped.with([
+		keys = std::move(keys),
+		done = std::move(done)
+	](Implementation &unwrapped) mutable {
+		unwrapped.getMany(keys, std::move(done));
+	});
+}
+
 void Database::getWithSizes(
 		const Key &key,
 		std::vector<Key> &&keys,
@@ -64,6 +64,14 @@ public:
 		FnMut<void(Error)> &&done = nullptr);
 	void getWithTag(const Key &key, FnMut<void(TaggedValue&&)> &&done);
 
+	// Results are in the same order as keys, missing ones are empty.
+	void getMany(
+		std::vector<Key> &&keys,
+		FnMut<void(std::vector<QByteArray>&&)> &&done);
+	void getManyWithTag(
+		std::vector<Key> &&keys,
+		FnMut<void(std::vector<TaggedValue>&&)> &&done);
+
 	void getWithSizes(
 		const Key &key,
 		std::vector<Key> &&keys,
@@ -71,6 +79,8 @@ public:
 
 	using Stats = details::Stats;
 	using TaggedSummary = details::TaggedSummary;
+	using UsageStats = details::UsageStats;
+	using OperationStats = details::OperationStats;
 	rpl::producer<Stats> statsOnMain() const;
 
 	void clear(FnMut<void(Error)> &&done = nullptr);
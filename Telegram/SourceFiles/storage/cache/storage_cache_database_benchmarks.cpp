@@ -0,0 +1,262 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#include "catch.hpp"
+
+#include "storage/cache/storage_cache_database.h"
+#include "storage/storage_encryption.h"
+#include "base/concurrent_timer.h"
+#include <crl/crl.h>
+#include <QtCore/QFile>
+#include <QtCore/QCoreApplication>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <thread>
+
+using namespace Storage::Cache;
+
+namespace {
+
+// The synthetic profile is generated from a fixed seed,
+// so that every run works with exactly the same keys and values.
+constexpr auto kSeed = 20180901U;
+constexpr auto kSmallValueSize = 512;
+constexpr auto kLargeValueSize = 512 * 1024;
+constexpr auto kLargeValuesCount = 64;
+constexpr auto kGetsCount = 2000;
+
+const auto key = Storage::EncryptionKey(bytes::make_vector(
+	bytes::make_span("\
+abcdefgh01234567abcdefgh01234567abcdefgh01234567abcdefgh01234567\
+abcdefgh01234567abcdefgh01234567abcdefgh01234567abcdefgh01234567\
+abcdefgh01234567abcdefgh01234567abcdefgh01234567abcdefgh01234567\
+abcdefgh01234567abcdefgh01234567abcdefgh01234567abcdefgh01234567\
+").subspan(0, Storage::EncryptionKey::kSize)));
+
+const auto name = QString("benchmark.db");
+
+crl::semaphore Semaphore;
+
+auto Result = Error();
+const auto GetResult = [](Error error) {
+	Result = error;
+	Semaphore.release();
+};
+
+Error Open(Database &db) {
+	db.open(base::duplicate(key), GetResult);
+	Semaphore.acquire();
+	return Result;
+}
+
+void Close(Database &db) {
+	db.close([&] { Semaphore.release(); });
+	Semaphore.acquire();
+}
+
+Error Clear(Database &db) {
+	db.clear(GetResult);
+	Semaphore.acquire();
+	return Result;
+}
+
+void Get(Database &db, const Key &key) {
+	db.get(key, [](QByteArray&&) { Semaphore.release(); });
+	Semaphore.acquire();
+}
+
+Error Put(Database &db, const Key &key, QByteArray value) {
+	db.put(key, std::move(value), GetResult);
+	Semaphore.acquire();
+	return Result;
+}
+
+void Remove(Database &db, const Key &key) {
+	db.remove(key, [](Error) { Semaphore.release(); });
+	Semaphore.acquire();
+}
+
+void WaitForCleaner(Database &db) {
+	db.waitForCleaner([] { Semaphore.release(); });
+	Semaphore.acquire();
+}
+
+QString GetBinlogPath() {
+	QFile versionFile(name + "/version");
+	if (!versionFile.open(QIODevice::ReadOnly)) {
+		return QString();
+	}
+	const auto bytes = versionFile.readAll();
+	if (bytes.size() != 4) {
+		return QString();
+	}
+	const auto version = *reinterpret_cast<const int32*>(bytes.data());
+	return name + '/' + QString::number(version) + "/binlog";
+}
+
+Key KeyByIndex(uint64 index) {
+	return Key{ index * 0x9E3779B97F4A7C15ULL, index };
+}
+
+QByteArray GenerateValue(std::mt19937 &generator, int size) {
+	auto result = QByteArray(size, Qt::Uninitialized);
+	for (auto &ch : result) {
+		ch = char(generator() & 0xFF);
+	}
+	return result;
+}
+
+void Fill(Database &db, int count, int size) {
+	auto generator = std::mt19937(kSeed);
+	for (auto i = 0; i != count; ++i) {
+		const auto result = Put(
+			db,
+			KeyByIndex(i),
+			GenerateValue(generator, size));
+		REQUIRE(result.type == Error::Type::None);
+	}
+}
+
+void Report(const char *name, crl::profile_time time, int count = 1) {
+	std::cout
+		<< std::left << std::setw(40) << name
+		<< std::right << std::setw(12) << time << " us";
+	if (count > 1) {
+		std::cout
+			<< std::setw(12) << (time / count) << " us/op";
+	}
+	std::cout << std::endl;
+}
+
+void ReportThroughput(const char *name, crl::profile_time time, int64 bytes) {
+	const auto perSecond = time ? (bytes * 1000000 / time) : 0;
+	std::cout
+		<< std::left << std::setw(40) << name
+		<< std::right << std::setw(12) << (perSecond / 1024) << " KB/s"
+		<< std::endl;
+}
+
+const auto Settings = [] {
+	auto result = Database::Settings();
+	result.trackEstimatedTime = true;
+	result.writeBundleDelay = crl::time(100);
+	result.compactAfterExcess = std::numeric_limits<int64>::max();
+	result.compactAfterFullSize = 0;
+	return result;
+}();
+
+} // namespace
+
+TEST_CASE("init benchmark timers", "[storage_cache_database_benchmark]") {
+	static auto init = [] {
+		int argc = 0;
+		char **argv = nullptr;
+		static QCoreApplication application(argc, argv);
+		static base::ConcurrentTimerEnvironment environment;
+		return true;
+	}();
+}
+
+TEST_CASE("cache db open time", "[storage_cache_database_benchmark]") {
+	for (const auto count : { 1000, 10000, 50000 }) {
+		Database db(name, Settings);
+		REQUIRE(Clear(db).type == Error::Type::None);
+		REQUIRE(Open(db).type == Error::Type::None);
+		Fill(db, count, 16);
+		Close(db);
+
+		const auto binlog = QFile(GetBinlogPath()).size();
+		const auto start = crl::profile();
+		REQUIRE(Open(db).type == Error::Type::None);
+		const auto time = crl::profile() - start;
+		Close(db);
+
+		const auto label = "open, binlog " + std::to_string(binlog) + " bytes";
+		Report(label.c_str(), time);
+	}
+}
+
+TEST_CASE("cache db random get latency", "[storage_cache_database_benchmark]") {
+	constexpr auto kCount = 10000;
+
+	Database db(name, Settings);
+	REQUIRE(Clear(db).type == Error::Type::None);
+	REQUIRE(Open(db).type == Error::Type::None);
+	Fill(db, kCount, kSmallValueSize);
+
+	auto generator = std::mt19937(kSeed);
+	auto distribution = std::uniform_int_distribution<int>(0, kCount - 1);
+	const auto start = crl::profile();
+	for (auto i = 0; i != kGetsCount; ++i) {
+		Get(db, KeyByIndex(distribution(generator)));
+	}
+	Report("random get", crl::profile() - start, kGetsCount);
+	Close(db);
+}
+
+TEST_CASE("cache db put throughput", "[storage_cache_database_benchmark]") {
+	const auto measure = [](const char *label, int count, int size) {
+		Database db(name, Settings);
+		REQUIRE(Clear(db).type == Error::Type::None);
+		REQUIRE(Open(db).type == Error::Type::None);
+
+		const auto start = crl::profile();
+		Fill(db, count, size);
+		const auto time = crl::profile() - start;
+		Close(db);
+
+		Report(label, time, count);
+		ReportThroughput(label, time, int64(count) * size);
+	};
+	measure("put small values", 5000, kSmallValueSize);
+	measure("put large values", kLargeValuesCount, kLargeValueSize);
+}
+
+TEST_CASE("cache db compaction duration", "[storage_cache_database_benchmark]") {
+	constexpr auto kCount = 20000;
+
+	auto settings = Settings;
+	Database db(name, settings);
+	REQUIRE(Clear(db).type == Error::Type::None);
+	REQUIRE(Open(db).type == Error::Type::None);
+	Fill(db, kCount, 16);
+	for (auto i = 0; i < kCount; i += 2) {
+		Remove(db, KeyByIndex(i));
+	}
+	Close(db);
+
+	// Reopen with low limits, so that the next write starts compactor.
+	settings.compactAfterExcess = 1;
+	Database compacting(name, settings);
+	REQUIRE(Open(compacting).type == Error::Type::None);
+	const auto path = GetBinlogPath();
+	const auto size = QFile(path).size();
+	const auto start = crl::profile();
+	Remove(compacting, KeyByIndex(1));
+	while (QFile(path).size() >= size) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	Report("compaction", crl::profile() - start);
+	Close(compacting);
+}
+
+TEST_CASE("cache db cleaner cost", "[storage_cache_database_benchmark]") {
+	constexpr auto kCount = 5000;
+
+	Database db(name, Settings);
+	REQUIRE(Clear(db).type == Error::Type::None);
+	REQUIRE(Open(db).type == Error::Type::None);
+	Fill(db, kCount, kSmallValueSize);
+
+	// Clear creates a new version, the cleaner removes the old one.
+	const auto start = crl::profile();
+	REQUIRE(Clear(db).type == Error::Type::None);
+	WaitForCleaner(db);
+	Report("cleaner", crl::profile() - start, kCount);
+	Close(db);
+}
@@ -17,7 +17,6 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include <crl/crl.h>
 #include <xxhash.h>
 #include <QtCore/QDir>
-#include <unordered_map>
 #include <set>
 
 namespace Storage {
@@ -26,6 +25,7 @@ namespace details {
 namespace {
 
 constexpr auto kMaxDelayAfterFailure = 24 * 60 * 60 * crl::time(1000);
+constexpr auto kIndexBinlogCheckSize = int64(4096);
 
 uint32 CountChecksum(bytes::const_span data) {
 	const auto seed = uint32(0);
@@ -81,7 +81,8 @@ DatabaseObject::DatabaseObject(
 , _base(ComputeBasePath(path))
 , _settings(settings)
 , _writeBundlesTimer(_weak, [=] { writeBundles(); checkCompactor(); })
-, _pruneTimer(_weak, [=] { prune(); }) {
+, _pruneTimer(_weak, [=] { prune(); })
+, _writeCombinedTimer(_weak, [=] { writeCombined(); }) {
 	checkSettings();
 }
 
@@ -102,6 +103,8 @@ void DatabaseObject::updateSettings(const SettingsUpdate &update) {
 
 void DatabaseObject::checkSettings() {
 	Expects(_settings.staleRemoveChunk > 0);
+	Expects(_settings.writeCombinedSizeLimit >= 0
+		&& _settings.writeCombinedSizeLimit <= _settings.maxDataSize);
 	Expects(_settings.maxDataSize > 0
 		&& _settings.maxDataSize < kDataSizeLimit);
 	Expects(_settings.maxBundledRecords > 0
@@ -175,6 +178,10 @@ QString DatabaseObject::CompactReadyFilename() {
 	return QStringLiteral("binlog-ready");
 }
 
+QString DatabaseObject::IndexFilename() {
+	return QStringLiteral("index");
+}
+
 QString DatabaseObject::binlogPath(Version version) const {
 	return computePath(version) + BinlogFilename();
 }
@@ -191,14 +198,25 @@ QString DatabaseObject::compactReadyPath() const {
 	return _path + CompactReadyFilename();
 }
 
+QString DatabaseObject::indexPath(Version version) const {
+	return computePath(version) + IndexFilename();
+}
+
+QString DatabaseObject::indexPath() const {
+	return _path + IndexFilename();
+}
+
 File::Result DatabaseObject::openBinlog(
 		Version version,
 		File::Mode mode,
 		EncryptionKey &key) {
 	const auto ready = compactReadyPath(version);
 	const auto path = binlogPath(version);
-	if (QFile(ready).exists() && !File::Move(ready, path)) {
-		return File::Result::Failed;
+	if (QFile(ready).exists()) {
+		QFile(indexPath(version)).remove();
+		if (!File::Move(ready, path)) {
+			return File::Result::Failed;
+		}
 	}
 	const auto result = _binlog.open(path, mode, key);
 	if (result != File::Result::Success) {
@@ -232,7 +250,11 @@ bool DatabaseObject::writeHeader() {
 	if (_settings.trackEstimatedTime) {
 		header.flags |= header.kTrackEstimatedTime;
 	}
-	return _binlog.write(bytes::object_as_span(&header));
+	if (!_binlog.write(bytes::object_as_span(&header))) {
+		return false;
+	}
+	_usage.binlogBytesWritten += sizeof(header);
+	return true;
 }
 
 template <typename Reader, typename ...Handlers>
@@ -250,6 +272,16 @@ void DatabaseObject::readBinlogHelper(
 
 void DatabaseObject::readBinlog() {
 	BinlogWrapper wrapper(_binlog, _settings);
+
+	// Each entry takes at least one store record in the binlog.
+	const auto recordSize = int64(_settings.trackEstimatedTime
+		? sizeof(StoreWithTime)
+		: sizeof(Store));
+	_map.reserve(_binlog.size() / recordSize);
+
+	if (_settings.useIndexSnapshot) {
+		readIndexSnapshot();
+	}
 	if (_settings.trackEstimatedTime) {
 		BinlogReader<
 			StoreWithTime,
@@ -284,6 +316,159 @@ void DatabaseObject::readBinlog() {
 	optimize();
 }
 
+bool DatabaseObject::readIndexSnapshot() {
+	const auto start = _binlog.offset();
+	const auto time = _time;
+	const auto fail = [&] {
+		clearIndexState();
+		_time = time;
+		_binlog.seek(start);
+		return false;
+	};
+
+	File index;
+	const auto result = index.open(indexPath(), File::Mode::Read, _key);
+	if (result != File::Result::Success) {
+		return false;
+	}
+	auto header = IndexHeader();
+	const auto headerBytes = bytes::object_as_span(&header);
+	if (index.read(headerBytes) != headerBytes.size()) {
+		return fail();
+	} else if (header.getFormat() != Format::Format_0) {
+		return fail();
+	} else if (_settings.trackEstimatedTime
+		!= !!(header.flags & header.kTrackEstimatedTime)) {
+		return fail();
+	} else if (header.binlogOffset < start
+		|| header.binlogOffset > _binlog.size()
+		|| header.excessLength < 0) {
+		return fail();
+	} else if (countBinlogChecksum(header.binlogOffset)
+		!= header.binlogChecksum) {
+		return fail();
+	}
+	const auto read = _settings.trackEstimatedTime
+		? readIndexSnapshotRecords<StoreWithTime>(index, header)
+		: readIndexSnapshotRecords<Store>(index, header);
+	if (!read || !_binlog.seek(header.binlogOffset)) {
+		return fail();
+	}
+	applyTimePoint(header.time);
+	_binlogExcessLength = header.excessLength;
+	return true;
+}
+
+template <typename Record>
+bool DatabaseObject::readIndexSnapshotRecords(
+		File &index,
+		const IndexHeader &header) {
+	static_assert(GoodForEncryption<Record>);
+
+	const auto count = size_type(header.count);
+	if (count * int64(sizeof(Record)) > index.size()) {
+		return false;
+	}
+	auto records = std::vector<Record>(count);
+	const auto bytes = bytes::make_span(records);
+	if (index.read(bytes) != bytes.size()
+		|| CountChecksum(bytes) != header.recordsChecksum) {
+		return false;
+	}
+	for (const auto &record : records) {
+		if (!processRecordStore(&record, std::is_class<Record>{})) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void DatabaseObject::writeIndexSnapshot() {
+	if (!_settings.useIndexSnapshot || !_binlog.isOpen()) {
+		return;
+	}
+	const auto path = indexPath();
+	const auto written = [&] {
+		if (_map.empty()) {
+			return false;
+		}
+		File index;
+		const auto result = index.open(path, File::Mode::Write, _key);
+		if (result != File::Result::Success) {
+			return false;
+		}
+		return _settings.trackEstimatedTime
+			? writeIndexSnapshotRecords<StoreWithTime>(index)
+			: writeIndexSnapshotRecords<Store>(index);
+	}();
+	if (!written) {
+		QFile(path).remove();
+	}
+}
+
+template <typename Record>
+bool DatabaseObject::writeIndexSnapshotRecords(File &index) {
+	static_assert(GoodForEncryption<IndexHeader>);
+	static_assert(GoodForEncryption<Record>);
+
+	auto header = IndexHeader();
+	header.binlogOffset = _binlog.size();
+	if (const auto checksum = countBinlogChecksum(header.binlogOffset)) {
+		header.binlogChecksum = *checksum;
+	} else {
+		return false;
+	}
+	auto records = std::vector<Record>();
+	records.reserve(_map.size());
+	for (const auto &[key, entry] : _map) {
+		auto record = Record();
+		record.key = key;
+		record.tag = entry.tag;
+		record.setSize(entry.size);
+		record.checksum = entry.checksum;
+		record.place = entry.place;
+		if constexpr (std::is_same_v<Record, StoreWithTime>) {
+			record.time.setRelative(entry.useTime);
+			record.time.system = _time.system;
+		}
+		records.push_back(record);
+	}
+	if (_settings.trackEstimatedTime) {
+		header.flags |= header.kTrackEstimatedTime;
+	}
+	header.count = uint32(records.size());
+	header.excessLength = _binlogExcessLength;
+	header.time = _time;
+	header.recordsChecksum = CountChecksum(bytes::make_span(records));
+	return index.write(bytes::object_as_span(&header))
+		&& index.write(bytes::make_span(records))
+		&& index.flush();
+}
+
+// Checksum part of the binlog right before the index snapshot offset,
+// so that a snapshot can't be applied to a binlog compacted elsewhere.
+std::optional<uint32> DatabaseObject::countBinlogChecksum(int64 till) {
+	const auto from = std::max(till - kIndexBinlogCheckSize, int64(0));
+	const auto position = _binlog.offset();
+	auto buffer = bytes::vector(till - from);
+	const auto bytes = bytes::make_span(buffer);
+	const auto good = _binlog.seek(from)
+		&& (_binlog.read(bytes) == bytes.size());
+	if (!_binlog.seek(position) || !good) {
+		return std::nullopt;
+	}
+	return CountChecksum(bytes);
+}
+
+void DatabaseObject::clearIndexState() {
+	_map = {};
+	_binlogExcessLength = 0;
+	_totalSize = 0;
+	_minimalEntryTime = 0;
+	_entriesWithMinimalTimeCount = 0;
+	_taggedStats = {};
+}
+
 uint64 DatabaseObject::countRelativeTime() const {
 	const auto now = GetUnixtime();
 	const auto delta = std::max(int64(now) - int64(_time.system), 0LL);
@@ -443,7 +628,7 @@ void DatabaseObject::collectSizeStale(
 		return;
 	}
 
-	using Bucket = std::pair<const Key, Entry>;
+	using Bucket = Map::value_type;
 	auto oldest = base::flat_multi_map<
 		int64,
 		const Bucket*,
@@ -629,6 +814,33 @@ void DatabaseObject::updateStats(const Entry &was, const Entry &now) {
 	pushStatsDelayed();
 }
 
+void DatabaseObject::recordOperation(
+		OperationStats &stats,
+		crl::profile_time started) {
+	stats.add(crl::profile() - started);
+	if (_stats.has_consumers()) {
+		pushStatsDelayed();
+	}
+}
+
+void DatabaseObject::recordAccess(const Entry *entry) {
+	if (!entry) {
+		++_usage.access.misses;
+		return;
+	}
+	++_usage.access.hits;
+	if (entry->tag) {
+		++_usage.accessTagged[entry->tag].hits;
+	}
+}
+
+void DatabaseObject::recordCompactorFinished() {
+	if (const auto started = base::take(_compactor.started)) {
+		++_usage.compactorRuns;
+		_usage.compactorTime += crl::profile() - started;
+	}
+}
+
 void DatabaseObject::pushStatsDelayed() {
 	if (_pushingStats) {
 		return;
@@ -681,6 +893,8 @@ void DatabaseObject::applyTimePoint(EstimatedTimePoint time) {
 void DatabaseObject::compactorDone(
 		const QString &path,
 		int64 originalReadTill) {
+	recordCompactorFinished();
+
 	const auto size = _binlog.size();
 	const auto binlog = binlogPath();
 	const auto ready = compactReadyPath();
@@ -696,6 +910,7 @@ void DatabaseObject::compactorDone(
 			return;
 		}
 	}
+	QFile(indexPath()).remove();
 	if (!File::Move(path, ready)) {
 		compactorFail();
 		return;
@@ -722,6 +937,8 @@ void DatabaseObject::compactorDone(
 }
 
 void DatabaseObject::compactorFail() {
+	recordCompactorFinished();
+
 	const auto delay = _compactor.delayAfterFailure;
 	_compactor = CompactorWrap();
 	_compactor.nextAttempt = crl::now() + delay;
@@ -734,6 +951,7 @@ void DatabaseObject::compactorFail() {
 void DatabaseObject::close(FnMut<void()> &&done) {
 	if (_binlog.isOpen()) {
 		writeBundles();
+		writeIndexSnapshot();
 		_binlog.close();
 	}
 	invokeCallback(done);
@@ -743,19 +961,18 @@ void DatabaseObject::close(FnMut<void()> &&done) {
 void DatabaseObject::clearState() {
 	_path = QString();
 	_key = {};
-	_map = {};
+	clearIndexState();
 	_removing = {};
 	_accessed = {};
 	_stale = {};
+	_combined = {};
+	_combinedWithTime = {};
+	_mapped = {};
 	_time = {};
-	_binlogExcessLength = 0;
-	_totalSize = 0;
-	_minimalEntryTime = 0;
-	_entriesWithMinimalTimeCount = 0;
-	_taggedStats = {};
 	_pushingStats = false;
 	_writeBundlesTimer.cancel();
 	_pruneTimer.cancel();
+	_writeCombinedTimer.cancel();
 	_compactor = CompactorWrap();
 }
 
@@ -767,6 +984,10 @@ void DatabaseObject::put(
 		remove(key, std::move(done));
 		return;
 	}
+	const auto started = crl::profile();
+	const auto guard = gsl::finally([&] {
+		recordOperation(_usage.put, started);
+	});
 	_removing.erase(key);
 	_stale.erase(ranges::remove(_stale, key), end(_stale));
 
@@ -834,6 +1055,7 @@ std::optional<QString> DatabaseObject::writeKeyPlaceGeneric(
 			&& readValueData(already.place, size) == value.bytes) {
 			return QString();
 		}
+		forgetMappedPlace(already.place);
 		record.place = already.place;
 	} else {
 		do {
@@ -841,13 +1063,22 @@ std::optional<QString> DatabaseObject::writeKeyPlaceGeneric(
 		} while (!isFreePlace(record.place));
 	}
 	const auto result = placePath(record.place);
-	auto writeable = record;
-	const auto success = _binlog.write(bytes::object_as_span(&writeable));
-	if (!success) {
-		_binlog.close();
-		return QString();
+	if (size <= _settings.writeCombinedSizeLimit) {
+		writeCombinedLazy(record);
+	} else {
+		// Keep the order of records for the same key in the binlog.
+		writeCombined();
+
+		auto writeable = record;
+		const auto success = _binlog.write(
+			bytes::object_as_span(&writeable));
+		if (!success) {
+			_binlog.close();
+			return QString();
+		}
+		_binlog.flush();
+		_usage.binlogBytesWritten += sizeof(writeable);
 	}
-	_binlog.flush();
 
 	const auto applied = processRecordStore(
 		&record,
@@ -897,6 +1128,8 @@ Error DatabaseObject::writeExistingPlaceGeneric(
 		}
 	}
 	record.place = entry.place;
+	writeCombined();
+
 	auto writeable = record;
 	const auto success = _binlog.write(bytes::object_as_span(&writeable));
 	if (!success) {
@@ -904,6 +1137,7 @@ Error DatabaseObject::writeExistingPlaceGeneric(
 		return ioError(binlogPath());
 	}
 	_binlog.flush();
+	_usage.binlogBytesWritten += sizeof(writeable);
 
 	const auto applied = processRecordStore(
 		&record,
@@ -935,26 +1169,79 @@ Error DatabaseObject::writeExistingPlace(
 void DatabaseObject::get(
 		const Key &key,
 		FnMut<void(TaggedValue&&)> &&done) {
+	const auto started = crl::profile();
+	const auto guard = gsl::finally([&] {
+		recordOperation(_usage.get, started);
+	});
 	const auto i = _map.find(key);
 	if (i == _map.end()) {
+		recordAccess(nullptr);
 		invokeCallback(done, TaggedValue());
 		return;
 	}
-	const auto &entry = i->second;
-
-	auto bytes = readValueData(entry.place, entry.size);
-	if (bytes.isEmpty()) {
-		remove(key, nullptr);
-		invokeCallback(done, TaggedValue());
-	} else if (CountChecksum(bytes::make_span(bytes)) != entry.checksum) {
+	auto value = readEntryValue(i->second);
+	if (value.bytes.isEmpty()) {
+		recordAccess(nullptr);
 		remove(key, nullptr);
 		invokeCallback(done, TaggedValue());
 	} else {
-		invokeCallback(done, TaggedValue(std::move(bytes), entry.tag));
+		recordAccess(&i->second);
+		invokeCallback(done, std::move(value));
 		recordEntryAccess(key);
 	}
 }
 
+void DatabaseObject::getMany(
+		const std::vector<Key> &keys,
+		FnMut<void(std::vector<TaggedValue>&&)> &&done) {
+	const auto started = crl::profile();
+	const auto guard = gsl::finally([&] {
+		recordOperation(_usage.get, started);
+	});
+	auto result = std::vector<TaggedValue>(keys.size());
+
+	// Read value files ordered by place to keep the disk access local.
+	auto found = std::vector<std::pair<const Entry*, int>>();
+	found.reserve(keys.size());
+	for (auto index = 0, count = int(keys.size()); index != count; ++index) {
+		if (const auto i = _map.find(keys[index]); i != end(_map)) {
+			found.emplace_back(&i->second, index);
+		}
+	}
+	ranges::sort(found, std::less<>(), [](const auto &pair) {
+		return pair.first->place;
+	});
+
+	auto accessed = std::vector<Key>();
+	auto broken = std::vector<Key>();
+	accessed.reserve(found.size());
+	for (const auto &[entry, index] : found) {
+		auto value = readEntryValue(*entry);
+		recordAccess(value.bytes.isEmpty() ? nullptr : entry);
+		if (value.bytes.isEmpty()) {
+			broken.push_back(keys[index]);
+		} else {
+			result[index] = std::move(value);
+			accessed.push_back(keys[index]);
+		}
+	}
+	_usage.access.misses += int64(keys.size() - found.size());
+	for (const auto &key : broken) {
+		remove(key, nullptr);
+	}
+	invokeCallback(done, std::move(result));
+	recordEntriesAccess(accessed);
+}
+
+TaggedValue DatabaseObject::readEntryValue(const Entry &entry) const {
+	auto bytes = readValueData(entry.place, entry.size);
+	if (bytes.isEmpty()
+		|| CountChecksum(bytes::make_span(bytes)) != entry.checksum) {
+		return TaggedValue();
+	}
+	return TaggedValue(std::move(bytes), entry.tag);
+}
+
 void DatabaseObject::getWithSizes(
 		const Key &key,
 		std::vector<Key> &&keys,
@@ -977,6 +1264,9 @@ void DatabaseObject::getWithSizes(
 QByteArray DatabaseObject::readValueData(
 		PlaceId place,
 		size_type size) const {
+	if (_settings.mappedPlacesLimit > 0) {
+		return readMappedValueData(place, size);
+	}
 	const auto path = placePath(place);
 	File data;
 	const auto result = data.open(path, File::Mode::Read, _key);
@@ -996,6 +1286,57 @@ QByteArray DatabaseObject::readValueData(
 	Unexpected("Result in DatabaseObject::get.");
 }
 
+QByteArray DatabaseObject::readMappedValueData(
+		PlaceId place,
+		size_type size) const {
+	const auto data = mappedPlace(place);
+	if (!data || !data->seek(0)) {
+		return QByteArray();
+	}
+	auto result = QByteArray(size, Qt::Uninitialized);
+	const auto bytes = bytes::make_detached_span(result);
+	const auto read = data->readWithPadding(bytes);
+	if (read != size) {
+		return QByteArray();
+	}
+	return result;
+}
+
+File *DatabaseObject::mappedPlace(PlaceId place) const {
+	Expects(_settings.mappedPlacesLimit > 0);
+
+	const auto i = _mapped.find(place);
+	if (i != end(_mapped)) {
+		i->second.lastUsed = ++_mappedUseCounter;
+		return i->second.file.get();
+	}
+	auto data = std::make_unique<File>();
+	const auto result = data->open(placePath(place), File::Mode::Read, _key);
+	if (result != File::Result::Success) {
+		return nullptr;
+	}
+
+	// If mapping fails we still keep the file open and read it directly.
+	data->map();
+
+	if (_mapped.size() >= _settings.mappedPlacesLimit) {
+		const auto oldest = ranges::min_element(
+			_mapped,
+			std::less<>(),
+			[](const auto &pair) { return pair.second.lastUsed; });
+		_mapped.erase(oldest);
+	}
+	const auto raw = data.get();
+	_mapped.emplace(place, MappedPlace{
+		std::move(data),
+		++_mappedUseCounter });
+	return raw;
+}
+
+void DatabaseObject::forgetMappedPlace(PlaceId place) {
+	_mapped.remove(place);
+}
+
 void DatabaseObject::recordEntryAccess(const Key &key) {
 	if (!_settings.trackEstimatedTime) {
 		return;
@@ -1005,13 +1346,32 @@ void DatabaseObject::recordEntryAccess(const Key &key) {
 	optimize();
 }
 
+void DatabaseObject::recordEntriesAccess(const std::vector<Key> &keys) {
+	if (!_settings.trackEstimatedTime || keys.empty()) {
+		return;
+	}
+	for (const auto &key : keys) {
+		_accessed.emplace(key);
+		if (_accessed.size() == _settings.maxBundledRecords) {
+			writeMultiAccess();
+		}
+	}
+	writeBundlesLazy();
+	optimize();
+}
+
 void DatabaseObject::remove(const Key &key, FnMut<void(Error)> &&done) {
+	const auto started = crl::profile();
+	const auto guard = gsl::finally([&] {
+		recordOperation(_usage.remove, started);
+	});
 	const auto i = _map.find(key);
 	if (i != _map.end()) {
 		_removing.emplace(key);
 		writeMultiRemoveLazy();
 
 		const auto path = placePath(i->second.place);
+		forgetMappedPlace(i->second.place);
 		eraseMapEntry(i);
 		if (QFile(path).remove() || !QFile(path).exists()) {
 			invokeCallback(done, Error::NoError());
@@ -1084,6 +1444,7 @@ Stats DatabaseObject::collectStats() const {
 	result.tagged = _taggedStats;
 	result.full.count = _map.size();
 	result.full.totalSize = _totalSize;
+	result.usage = _usage;
 	result.clearing = (_cleaner.object != nullptr) || !_stale.empty();
 	return result;
 }
@@ -1107,6 +1468,9 @@ Error DatabaseObject::writeMultiRemove() {
 
 	if (_removing.empty()) {
 		return Error::NoError();
+	} else if (const auto error = writeCombined()
+		; error.type != Error::Type::None) {
+		return error;
 	}
 	const auto size = _removing.size();
 	auto header = MultiRemove(size);
@@ -1118,8 +1482,10 @@ Error DatabaseObject::writeMultiRemove() {
 	if (_binlog.write(bytes::object_as_span(&header))
 		&& _binlog.write(bytes::make_span(list))) {
 		_binlog.flush();
-		_binlogExcessLength += bytes::object_as_span(&header).size()
+		const auto written = bytes::object_as_span(&header).size()
 			+ bytes::make_span(list).size();
+		_binlogExcessLength += written;
+		_usage.binlogBytesWritten += written;
 		return Error::NoError();
 	}
 	_binlog.close();
@@ -1145,6 +1511,9 @@ Error DatabaseObject::writeMultiAccessBlock() {
 	Expects(_settings.trackEstimatedTime);
 	Expects(_accessed.size() <= _settings.maxBundledRecords);
 
+	if (const auto error = writeCombined(); error.type != Error::Type::None) {
+		return error;
+	}
 	const auto time = countTimePoint();
 	const auto size = _accessed.size();
 	auto header = MultiAccess(time, size);
@@ -1165,7 +1534,55 @@ Error DatabaseObject::writeMultiAccessBlock() {
 	if (_binlog.write(bytes::object_as_span(&header))
 		&& (!size || _binlog.write(bytes::make_span(list)))) {
 		_binlog.flush();
-		_binlogExcessLength += bytes::object_as_span(&header).size()
+		const auto written = bytes::object_as_span(&header).size()
+			+ bytes::make_span(list).size();
+		_binlogExcessLength += written;
+		_usage.binlogBytesWritten += written;
+		return Error::NoError();
+	}
+	_binlog.close();
+	return ioError(binlogPath());
+}
+
+template <typename StoreRecord>
+void DatabaseObject::writeCombinedLazy(const StoreRecord &record) {
+	const auto count = [&] {
+		if constexpr (std::is_same_v<StoreRecord, StoreWithTime>) {
+			_combinedWithTime.push_back(record);
+			return _combinedWithTime.size();
+		} else {
+			_combined.push_back(record);
+			return _combined.size();
+		}
+	}();
+	if (count == _settings.maxBundledRecords) {
+		writeCombined();
+	} else if (!_writeCombinedTimer.isActive()) {
+		_writeCombinedTimer.callOnce(_settings.writeCombinedDelay);
+	}
+}
+
+Error DatabaseObject::writeCombined() {
+	_writeCombinedTimer.cancel();
+	return _settings.trackEstimatedTime
+		? writeCombinedRecords<MultiStoreWithTime>(_combinedWithTime)
+		: writeCombinedRecords<MultiStore>(_combined);
+}
+
+template <typename MultiRecord>
+Error DatabaseObject::writeCombinedRecords(
+		std::vector<typename MultiRecord::Part> &list) {
+	Expects(list.size() <= _settings.maxBundledRecords);
+
+	if (list.empty()) {
+		return Error::NoError();
+	}
+	auto header = MultiRecord(list.size());
+	const auto guard = gsl::finally([&] { list.clear(); });
+	if (_binlog.write(bytes::object_as_span(&header))
+		&& _binlog.write(bytes::make_span(list))) {
+		_binlog.flush();
+		_usage.binlogBytesWritten += bytes::object_as_span(&header).size()
 			+ bytes::make_span(list).size();
 		return Error::NoError();
 	}
@@ -1174,6 +1591,7 @@ Error DatabaseObject::writeMultiAccessBlock() {
 }
 
 void DatabaseObject::writeBundles() {
+	writeCombined();
 	writeMultiRemove();
 	if (_settings.trackEstimatedTime) {
 		writeMultiAccess();
@@ -1190,10 +1608,13 @@ void DatabaseObject::createCleaner() {
 		_base,
 		_cleaner.guard.make_guard(),
 		std::move(done));
+	_cleaner.started = crl::profile();
 	pushStatsDelayed();
 }
 
 void DatabaseObject::cleanerDone(Error error) {
+	++_usage.cleanerRuns;
+	_usage.cleanerTime += crl::profile() - _cleaner.started;
 	invokeCallback(_cleaner.done);
 	_cleaner = CleanerWrap();
 	pushStatsDelayed();
@@ -1223,6 +1644,7 @@ void DatabaseObject::checkCompactor() {
 		base::duplicate(_key),
 		info);
 	_compactor.excessLength = _binlogExcessLength;
+	_compactor.started = crl::profile();
 }
 
 void DatabaseObject::clear(FnMut<void(Error)> &&done) {
@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #pragma once
 
 #include "storage/cache/storage_cache_database.h"
+#include "storage/cache/storage_cache_flat_index.h"
 #include "storage/storage_encrypted_file.h"
 #include "base/binary_guard.h"
 #include "base/concurrent_timer.h"
@@ -41,6 +42,9 @@ public:
 		TaggedValue &&value,
 		FnMut<void(Error)> &&done);
 	void get(const Key &key, FnMut<void(TaggedValue&&)> &&done);
+	void getMany(
+		const std::vector<Key> &keys,
+		FnMut<void(std::vector<TaggedValue>&&)> &&done);
 	void remove(const Key &key, FnMut<void(Error)> &&done);
 
 	void putIfEmpty(
@@ -69,6 +73,7 @@ public:
 
 	static QString BinlogFilename();
 	static QString CompactReadyFilename();
+	static QString IndexFilename();
 
 	void compactorDone(const QString &path, int64 originalReadTill);
 	void compactorFail();
@@ -98,15 +103,21 @@ private:
 		std::unique_ptr<Cleaner> object;
 		base::binary_guard guard;
 		FnMut<void()> done;
+		crl::profile_time started = 0;
 	};
 	struct CompactorWrap {
 		std::unique_ptr<Compactor> object;
 		int64 excessLength = 0;
+		crl::profile_time started = 0;
 		crl::time nextAttempt = 0;
 		crl::time delayAfterFailure = 10 * crl::time(1000);
 		base::binary_guard guard;
 	};
-	using Map = std::unordered_map<Key, Entry>;
+	struct MappedPlace {
+		std::unique_ptr<File> file;
+		uint64 lastUsed = 0;
+	};
+	using Map = FlatIndex<Entry>;
 
 	template <typename Callback, typename ...Args>
 	void invokeCallback(Callback &&callback, Args &&...args) const;
@@ -119,6 +130,8 @@ private:
 	QString binlogPath() const;
 	QString compactReadyPath(Version version) const;
 	QString compactReadyPath() const;
+	QString indexPath(Version version) const;
+	QString indexPath() const;
 	Error openSomeBinlog(EncryptionKey &&key);
 	Error openNewBinlog(EncryptionKey &key);
 	File::Result openBinlog(
@@ -129,6 +142,14 @@ private:
 	bool writeHeader();
 
 	void readBinlog();
+	bool readIndexSnapshot();
+	template <typename Record>
+	bool readIndexSnapshotRecords(File &index, const IndexHeader &header);
+	void writeIndexSnapshot();
+	template <typename Record>
+	bool writeIndexSnapshotRecords(File &index);
+	std::optional<uint32> countBinlogChecksum(int64 till);
+	void clearIndexState();
 	template <typename Reader, typename ...Handlers>
 	void readBinlogHelper(Reader &reader, Handlers &&...handlers);
 	template <typename Record, typename Postprocess>
@@ -174,6 +195,9 @@ private:
 	void clearStaleChunk();
 
 	void updateStats(const Entry &was, const Entry &now);
+	void recordOperation(OperationStats &stats, crl::profile_time started);
+	void recordAccess(const Entry *entry);
+	void recordCompactorFinished();
 	Stats collectStats() const;
 	void pushStatsDelayed();
 	void pushStats();
@@ -181,7 +205,12 @@ private:
 	void setMapEntry(const Key &key, Entry &&entry);
 	void eraseMapEntry(const Map::const_iterator &i);
 	void recordEntryAccess(const Key &key);
+	void recordEntriesAccess(const std::vector<Key> &keys);
+	TaggedValue readEntryValue(const Entry &entry) const;
 	QByteArray readValueData(PlaceId place, size_type size) const;
+	QByteArray readMappedValueData(PlaceId place, size_type size) const;
+	File *mappedPlace(PlaceId place) const;
+	void forgetMappedPlace(PlaceId place);
 
 	Version findAvailableVersion() const;
 	QString versionPath() const;
@@ -216,6 +245,11 @@ private:
 	Error writeMultiAccessBlock();
 	void writeBundlesLazy();
 	void writeBundles();
+	template <typename StoreRecord>
+	void writeCombinedLazy(const StoreRecord &record);
+	Error writeCombined();
+	template <typename MultiRecord>
+	Error writeCombinedRecords(std::vector<typename MultiRecord::Part> &list);
 
 	void createCleaner();
 	void cleanerDone(Error error);
@@ -230,6 +264,11 @@ private:
 	std::set<Key> _removing;
 	std::set<Key> _accessed;
 	std::vector<Key> _stale;
+	std::vector<MultiStore::Part> _combined;
+	std::vector<MultiStoreWithTime::Part> _combinedWithTime;
+
+	mutable base::flat_map<PlaceId, MappedPlace> _mapped;
+	mutable uint64 _mappedUseCounter = 0;
 
 	EstimatedTimePoint _time;
 
@@ -239,12 +278,14 @@ private:
 	size_type _entriesWithMinimalTimeCount = 0;
 
 	base::flat_map<uint8, TaggedSummary> _taggedStats;
+	UsageStats _usage;
 	rpl::event_stream<Stats> _stats;
 	bool _pushingStats = false;
 	bool _clearingStale = false;
 
 	base::ConcurrentTimer _writeBundlesTimer;
 	base::ConcurrentTimer _pruneTimer;
+	base::ConcurrentTimer _writeCombinedTimer;
 
 	CleanerWrap _cleaner;
 	CompactorWrap _compactor;
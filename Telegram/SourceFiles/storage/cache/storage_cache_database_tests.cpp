@@ -13,6 +13,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/concurrent_timer.h"
 #include <crl/crl.h>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <QtWidgets/QApplication>
 #include <thread>
 
@@ -117,6 +118,18 @@ Database::TaggedValue GetWithTag(Database &db, const Key &key) {
 	return ValueWithTag;
 }
 
+auto Values = std::vector<QByteArray>();
+const auto GetValues = [](std::vector<QByteArray> values) {
+	Values = values;
+	Semaphore.release();
+};
+
+std::vector<QByteArray> GetMany(Database &db, std::vector<Key> keys) {
+	db.getMany(std::move(keys), GetValues);
+	Semaphore.acquire();
+	return Values;
+}
+
 Error Put(Database &db, const Key &key, QByteArray &&value) {
 	db.put(key, std::move(value), GetResult);
 	Semaphore.acquire();
@@ -483,6 +496,110 @@ TEST_CASE("encrypted cache db", "[storage_cache_database]") {
 		REQUIRE(same == next);
 		Close(db);
 	}
+	SECTION("reading many values from db") {
+		Database db(name, Settings);
+
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		const auto values = GetMany(
+			db,
+			{ Key{ 0, 1 }, Key{ 1, 1 }, Key{ 1, 0 }, Key{ 0, 1 } });
+		REQUIRE(values.size() == 4);
+		REQUIRE((values[0] == Test2()));
+		REQUIRE(values[1].isEmpty());
+		REQUIRE((values[2] == Test2()));
+		REQUIRE((values[3] == Test2()));
+		REQUIRE(GetMany(db, {}).empty());
+		Close(db);
+	}
+	SECTION("reading db with mapped places") {
+		auto settings = Settings;
+		settings.mappedPlacesLimit = 2;
+		Database db(name, settings);
+
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		REQUIRE((Get(db, Key{ 0, 1 }) == Test2()));
+		REQUIRE((Get(db, Key{ 1, 0 }) == Test2()));
+		REQUIRE((Get(db, Key{ 2, 0 }) == Test1()));
+		REQUIRE((Get(db, Key{ 0, 1 }) == Test2()));
+		REQUIRE(Put(db, Key{ 0, 1 }, Test1()).type == Error::Type::None);
+		REQUIRE((Get(db, Key{ 0, 1 }) == Test1()));
+		Remove(db, Key{ 2, 0 });
+		REQUIRE(Get(db, Key{ 2, 0 }).isEmpty());
+		REQUIRE(Put(db, Key{ 2, 0 }, Test2()).type == Error::Type::None);
+		REQUIRE((Get(db, Key{ 2, 0 }) == Test2()));
+		Close(db);
+	}
+	SECTION("reading db with index snapshot") {
+		auto settings = Settings;
+		settings.useIndexSnapshot = true;
+		settings.trackEstimatedTime = true;
+		Database db(name, settings);
+
+		REQUIRE(Clear(db).type == Error::Type::None);
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		REQUIRE(Put(db, Key{ 0, 1 }, Test1()).type == Error::Type::None);
+		REQUIRE(Put(db, Key{ 1, 0 }, Test2()).type == Error::Type::None);
+		REQUIRE(Put(db, Key{ 1, 1 }, Test1()).type == Error::Type::None);
+		Close(db);
+
+		const auto index = QFileInfo(GetBinlogPath()).absolutePath()
+			+ "/index";
+		REQUIRE(QFile(index).exists());
+
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		REQUIRE((Get(db, Key{ 0, 1 }) == Test1()));
+		REQUIRE((Get(db, Key{ 1, 0 }) == Test2()));
+		Remove(db, Key{ 1, 0 });
+		REQUIRE(Put(db, Key{ 2, 0 }, Test2()).type == Error::Type::None);
+		Close(db);
+
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		REQUIRE((Get(db, Key{ 0, 1 }) == Test1()));
+		REQUIRE(Get(db, Key{ 1, 0 }).isEmpty());
+		REQUIRE((Get(db, Key{ 1, 1 }) == Test1()));
+		REQUIRE((Get(db, Key{ 2, 0 }) == Test2()));
+		Close(db);
+
+		// Without the snapshot the full binlog is replayed.
+		QFile(index).remove();
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		REQUIRE((Get(db, Key{ 2, 0 }) == Test2()));
+		Close(db);
+	}
+	SECTION("reading db with combined stores") {
+		auto settings = Settings;
+		settings.writeCombinedSizeLimit = Test1().size();
+		settings.maxBundledRecords = 5;
+		Database db(name, settings);
+
+		const auto count = 12U;
+
+		REQUIRE(Clear(db).type == Error::Type::None);
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		for (auto i = 0U; i != count; ++i) {
+			auto value = Test1();
+			value[0] = char('A') + i;
+			const auto result = Put(db, Key{ i, i * 2 }, std::move(value));
+			REQUIRE(result.type == Error::Type::None);
+		}
+		Remove(db, Key{ 1, 2 });
+		REQUIRE(Put(db, Key{ 2, 4 }, Test2()).type == Error::Type::None);
+		Close(db);
+
+		REQUIRE(Open(db, key).type == Error::Type::None);
+		for (auto i = 0U; i != count; ++i) {
+			auto value = Test1();
+			value[0] = char('A') + i;
+			if (i == 1) {
+				REQUIRE(Get(db, Key{ i, i * 2 }).isEmpty());
+			} else if (i == 2) {
+				REQUIRE((Get(db, Key{ i, i * 2 }) == Test2()));
+			} else {
+				REQUIRE((Get(db, Key{ i, i * 2 }) == value));
+			}
+		}
+		Close(db);
+	}
 	SECTION("reading db in many chunks") {
 		auto settings = Settings;
 		settings.readBlockSize = 512;
@@ -0,0 +1,288 @@
+/*
+This file is part of Telegram Desktop,
+the official desktop application for the Telegram messaging service.
+
+For license and copyright information please follow this link:
+https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
+*/
+#pragma once
+
+#include "storage/cache/storage_cache_types.h"
+#include <vector>
+
+namespace Storage {
+namespace Cache {
+namespace details {
+
+// Open addressing (linear probing) hash table from Key to Value.
+// All elements live in one contiguous array, so there is no heap node
+// per element. Erasing uses backward shift, so there are no tombstones.
+// Any insertion or erasure invalidates iterators, pointers and references.
+template <typename Value>
+class FlatIndex {
+public:
+	using key_type = Key;
+	using mapped_type = Value;
+	using value_type = std::pair<Key, Value>;
+
+	template <bool IsConst>
+	class iterator_base {
+	public:
+		using owner_type = std::conditional_t<
+			IsConst,
+			const FlatIndex,
+			FlatIndex>;
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = FlatIndex::value_type;
+		using difference_type = std::ptrdiff_t;
+		using reference = std::conditional_t<
+			IsConst,
+			const value_type&,
+			value_type&>;
+		using pointer = std::conditional_t<
+			IsConst,
+			const value_type*,
+			value_type*>;
+
+		iterator_base() = default;
+		iterator_base(owner_type *owner, size_type index)
+		: _owner(owner)
+		, _index(index) {
+			skipEmpty();
+		}
+		template <
+			bool OtherConst,
+			typename = std::enable_if_t<IsConst && !OtherConst>>
+		iterator_base(const iterator_base<OtherConst> &other)
+		: _owner(other._owner)
+		, _index(other._index) {
+		}
+
+		reference operator*() const {
+			return _owner->_slots[_index];
+		}
+		pointer operator->() const {
+			return &_owner->_slots[_index];
+		}
+		iterator_base &operator++() {
+			++_index;
+			skipEmpty();
+			return *this;
+		}
+		iterator_base operator++(int) {
+			auto result = *this;
+			++*this;
+			return result;
+		}
+
+		friend inline bool operator==(
+				const iterator_base &a,
+				const iterator_base &b) {
+			return (a._index == b._index);
+		}
+		friend inline bool operator!=(
+				const iterator_base &a,
+				const iterator_base &b) {
+			return !(a == b);
+		}
+
+	private:
+		void skipEmpty() {
+			const auto capacity = size_type(_owner->_used.size());
+			while (_index < capacity && !_owner->_used[_index]) {
+				++_index;
+			}
+		}
+
+		owner_type *_owner = nullptr;
+		size_type _index = 0;
+
+		friend class FlatIndex;
+		template <bool OtherConst>
+		friend class iterator_base;
+
+	};
+	using iterator = iterator_base<false>;
+	using const_iterator = iterator_base<true>;
+
+	FlatIndex() = default;
+	FlatIndex(FlatIndex &&other) = default;
+	FlatIndex &operator=(FlatIndex &&other) = default;
+
+	size_type size() const {
+		return _size;
+	}
+	bool empty() const {
+		return !_size;
+	}
+
+	iterator begin() {
+		return iterator(this, 0);
+	}
+	iterator end() {
+		return iterator(this, capacity());
+	}
+	const_iterator begin() const {
+		return const_iterator(this, 0);
+	}
+	const_iterator end() const {
+		return const_iterator(this, capacity());
+	}
+	friend inline iterator begin(FlatIndex &index) {
+		return index.begin();
+	}
+	friend inline iterator end(FlatIndex &index) {
+		return index.end();
+	}
+	friend inline const_iterator begin(const FlatIndex &index) {
+		return index.begin();
+	}
+	friend inline const_iterator end(const FlatIndex &index) {
+		return index.end();
+	}
+
+	iterator find(const Key &key) {
+		const auto index = findIndex(key);
+		return (index >= 0) ? iterator(this, index) : end();
+	}
+	const_iterator find(const Key &key) const {
+		const auto index = findIndex(key);
+		return (index >= 0) ? const_iterator(this, index) : end();
+	}
+	bool contains(const Key &key) const {
+		return (findIndex(key) >= 0);
+	}
+
+	std::pair<iterator, bool> emplace(const Key &key, Value &&value) {
+		if (const auto index = findIndex(key); index >= 0) {
+			return { iterator(this, index), false };
+		}
+		reserve(_size + 1);
+		const auto index = insertNew(key, std::move(value));
+		return { iterator(this, index), true };
+	}
+	Value &operator[](const Key &key) {
+		return emplace(key, Value()).first->second;
+	}
+
+	void erase(const_iterator where) {
+		Expects(where._index < capacity() && _used[where._index]);
+
+		eraseIndex(where._index);
+	}
+	bool remove(const Key &key) {
+		if (const auto index = findIndex(key); index >= 0) {
+			eraseIndex(index);
+			return true;
+		}
+		return false;
+	}
+
+	// Makes room for at least 'count' elements without a rehash.
+	void reserve(size_type count) {
+		const auto required = RequiredCapacity(count);
+		if (required > capacity()) {
+			rehash(required);
+		}
+	}
+	void clear() {
+		_slots.clear();
+		_used.clear();
+		_size = 0;
+	}
+
+private:
+	static constexpr auto kMinCapacity = size_type(16);
+
+	// Load factor is kept below 3/4.
+	static size_type RequiredCapacity(size_type count) {
+		auto result = kMinCapacity;
+		while (result - (result / 4) <= count) {
+			result *= 2;
+		}
+		return result;
+	}
+	static size_type Hash(const Key &key) {
+		auto result = key.high * 0x9E3779B97F4A7C15ULL ^ key.low;
+		result ^= (result >> 33);
+		result *= 0xFF51AFD7ED558CCDULL;
+		result ^= (result >> 33);
+		return size_type(result);
+	}
+
+	size_type capacity() const {
+		return size_type(_used.size());
+	}
+	size_type mask() const {
+		return capacity() - 1;
+	}
+
+	index_type findIndex(const Key &key) const {
+		if (!_size) {
+			return -1;
+		}
+		for (auto index = Hash(key) & mask()
+			; _used[index]
+			; index = (index + 1) & mask()) {
+			if (_slots[index].first == key) {
+				return index;
+			}
+		}
+		return -1;
+	}
+	size_type insertNew(const Key &key, Value &&value) {
+		auto index = Hash(key) & mask();
+		while (_used[index]) {
+			index = (index + 1) & mask();
+		}
+		_slots[index] = value_type(key, std::move(value));
+		_used[index] = 1;
+		++_size;
+		return index;
+	}
+	void eraseIndex(size_type index) {
+		auto hole = index;
+		for (auto next = (hole + 1) & mask()
+			; _used[next]
+			; next = (next + 1) & mask()) {
+			const auto home = Hash(_slots[next].first) & mask();
+
+			// Move the element back if the hole lies between its
+			// home slot and its current slot (cyclically).
+			const auto distanceToNext = (next - home) & mask();
+			const auto distanceToHole = (hole - home) & mask();
+			if (distanceToHole < distanceToNext) {
+				_slots[hole] = std::move(_slots[next]);
+				hole = next;
+			}
+		}
+		_slots[hole] = value_type();
+		_used[hole] = 0;
+		--_size;
+	}
+	void rehash(size_type newCapacity) {
+		auto slots = std::exchange(
+			_slots,
+			std::vector<value_type>(newCapacity));
+		auto used = std::exchange(
+			_used,
+			std::vector<uint8>(newCapacity, uint8(0)));
+		_size = 0;
+		for (auto i = size_type(0), count = size_type(used.size())
+			; i != count
+			; ++i) {
+			if (used[i]) {
+				insertNew(slots[i].first, std::move(slots[i].second));
+			}
+		}
+	}
+
+	std::vector<value_type> _slots;
+	std::vector<uint8> _used;
+	size_type _size = 0;
+
+};
+
+} // namespace details
+} // namespace Cache
+} // namespace Storage
@@ -87,11 +87,46 @@ bool WriteVersionValue(const QString &base, Version value) {
 	return file.flush();
 }
 
+void LatencyHistogram::add(crl::profile_time duration) {
+	auto index = 0;
+	while (index + 1 < kBucketsCount
+		&& duration >= (crl::profile_time(1) << index)) {
+		++index;
+	}
+	++buckets[index];
+}
+
+crl::profile_time LatencyHistogram::percentile(float64 part) const {
+	Expects(part >= 0. && part <= 1.);
+
+	const auto total = ranges::accumulate(buckets, int64(0));
+	const auto required = int64(std::ceil(total * part));
+	auto counted = int64(0);
+	for (auto index = 0; index != kBucketsCount; ++index) {
+		counted += buckets[index];
+		if (counted >= required && counted > 0) {
+			return (crl::profile_time(1) << index);
+		}
+	}
+	return 0;
+}
+
+void OperationStats::add(crl::profile_time duration) {
+	++count;
+	totalTime += duration;
+	latency.add(duration);
+}
+
 BasicHeader::BasicHeader()
 : format(static_cast<uint32>(Format::Format_0))
 , flags(0) {
 }
 
+IndexHeader::IndexHeader()
+: format(static_cast<uint32>(Format::Format_0))
+, flags(0) {
+}
+
 void Store::setSize(size_type size) {
 	this->size = ReadTo<EntrySize>(size);
 }
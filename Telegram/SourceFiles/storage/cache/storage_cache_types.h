@@ -69,11 +69,19 @@ struct Settings {
 	size_type readBlockSize = 8 * 1024 * 1024;
 	size_type maxDataSize = (kDataSizeLimit - 1);
 	crl::time writeBundleDelay = 15 * 60 * crl::time(1000);
+
+	// Store records of values not larger than that are written in bundles.
+	size_type writeCombinedSizeLimit = 0;
+	crl::time writeCombinedDelay = crl::time(500);
 	size_type staleRemoveChunk = 256;
 
+	// Keep up to that count of value files mapped in memory, zero disables.
+	size_type mappedPlacesLimit = 0;
+
 	int64 compactAfterExcess = 8 * 1024 * 1024;
 	int64 compactAfterFullSize = 0;
 	size_type compactChunkSize = 16 * 1024;
+	int64 compactBytesPerSecond = 0; // Zero means no throttling.
 
 	bool trackEstimatedTime = true;
 	int64 totalSizeLimit = 1024 * 1024 * 1024;
@@ -82,6 +90,9 @@ struct Settings {
 	crl::time maxPruneCheckTimeout = 3600 * crl::time(1000);
 
 	bool clearOnWrongKey = false;
+
+	// Write the index on close and replay only the rest of binlog on open.
+	bool useIndexSnapshot = false;
 };
 
 struct SettingsUpdate {
@@ -101,9 +112,44 @@ struct TaggedSummary {
 	size_type count = 0;
 	int64 totalSize = 0;
 };
+
+// Bucket with index i counts operations that took less than 2^i mcs.
+struct LatencyHistogram {
+	static constexpr auto kBucketsCount = 24;
+
+	void add(crl::profile_time duration);
+	crl::profile_time percentile(float64 part) const;
+
+	std::array<int64, kBucketsCount> buckets = { { 0 } };
+};
+struct OperationStats {
+	void add(crl::profile_time duration);
+
+	int64 count = 0;
+	crl::profile_time totalTime = 0;
+	LatencyHistogram latency;
+};
+struct AccessSummary {
+	int64 hits = 0;
+	int64 misses = 0;
+};
+struct UsageStats {
+	OperationStats get;
+	OperationStats put;
+	OperationStats remove;
+	AccessSummary access;
+	base::flat_map<uint8, AccessSummary> accessTagged;
+	int64 binlogBytesWritten = 0;
+	int64 compactorRuns = 0;
+	crl::profile_time compactorTime = 0;
+	int64 cleanerRuns = 0;
+	crl::profile_time cleanerTime = 0;
+};
+
 struct Stats {
 	TaggedSummary full;
 	base::flat_map<uint8, TaggedSummary> tagged;
+	UsageStats usage;
 	bool clearing = false;
 };
 
@@ -223,6 +269,29 @@ struct MultiAccess {
 	size_type validateCount() const;
 };
 
+struct IndexHeader {
+	IndexHeader();
+
+	static constexpr auto kTrackEstimatedTime = 0x01U;
+
+	Format getFormat() const {
+		return static_cast<Format>(format);
+	}
+	void setFormat(Format format) {
+		this->format = static_cast<uint32>(format);
+	}
+
+	uint32 format : 8;
+	uint32 flags : 24;
+	uint32 count = 0;
+	int64 binlogOffset = 0;
+	int64 excessLength = 0;
+	EstimatedTimePoint time;
+	uint32 binlogChecksum = 0;
+	uint32 recordsChecksum = 0;
+	uint32 reserved = 0;
+};
+
 } // namespace details
 } // namespace Cache
 } // namespace Storage
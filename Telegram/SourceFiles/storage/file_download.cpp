@@ -28,18 +28,46 @@ namespace {
 // How much time without download causes additional session kill.
 constexpr auto kKillSessionTimeout = crl::time(5000);
 
+// How long we measure throughput before changing the sessions count.
+constexpr auto kSessionsCountWindow = crl::time(2000);
+
+// How long we don't add sessions after removing one.
+constexpr auto kSessionsIncreaseTimeout = 30 * crl::time(1000);
+
+// Added session should increase throughput at least by 1 / 10.
+constexpr auto kSessionsThroughputGainPart = 10;
+
+// Requests taking this much longer than the fastest ones mean congestion.
+constexpr auto kSessionsCongestionFactor = 4;
+
 // Max 16 file parts downloaded at the same time, 128 KB each.
 constexpr auto kMaxFileQueries = 16;
 
+// Up to 8 MB in flight for each dc, if the bandwidth-delay product is big.
+constexpr auto kMaxFileQueriesWindow = 64;
+
+// Keep twice the estimated bandwidth-delay product in flight,
+// so that the throughput may grow if the link allows it.
+constexpr auto kPartsInFlightMin = 4;
+constexpr auto kBandwidthDelayGain = 2;
+
 // Max 8 http[s] files downloaded at the same time.
 constexpr auto kMaxWebFileQueries = 8;
 
-// Different part sizes are not supported for now :(
-// Because we start downloading with some part size
-// and then we get a cdn-redirect where we support only
-// fixed part size download for hash checking.
+// Automatic downloads may take only that part of the queries of a queue.
+constexpr auto kAutoLoadingQueriesPercent = 50;
+
+// Cdn files are downloaded only by 128 KB parts, because we support
+// only fixed part size download for hash checking.
 constexpr auto kPartSize = 128 * 1024;
 
+// Bigger parts take fewer requests and round trips for big files.
+// A part can't cross a 1 MB boundary, so sizes divide 1 MB.
+constexpr auto kMaxPartSize = 1024 * 1024;
+constexpr auto kMediumPartSize = 512 * 1024;
+constexpr auto kMaxPartSizeFrom = 32 * 1024 * 1024;
+constexpr auto kMediumPartSizeFrom = 4 * 1024 * 1024;
+
 } // namespace
 
 Downloader::Downloader(not_null<ApiWrap*> api)
@@ -52,23 +80,143 @@ void Downloader::clearPriorities() {
 	++_priority;
 }
 
+auto Downloader::sessionsForDc(MTP::DcId dcId) -> DcSessions& {
+	const auto i = _sessions.find(dcId);
+	return (i != end(_sessions))
+		? i->second
+		: _sessions.emplace(dcId, DcSessions()).first->second;
+}
+
 void Downloader::requestedAmountIncrement(MTP::DcId dcId, int index, int amount) {
-	Expects(index >= 0 && index < MTP::kDownloadSessionsCount);
+	Expects(index >= 0 && index < MTP::kMaxDownloadSessionsCount);
 
 	using namespace rpl::mappers;
 
-	auto it = _requestedBytesAmount.find(dcId);
-	if (it == _requestedBytesAmount.cend()) {
-		it = _requestedBytesAmount.emplace(dcId, RequestedInDc { { 0 } }).first;
-	}
-	it->second[index] += amount;
+	auto &sessions = sessionsForDc(dcId);
+	auto &requested = sessions.requested[index];
+	requested += amount;
 	if (amount > 0) {
 		killDownloadSessionsStop(dcId);
-	} else if (ranges::find_if(it->second, _1 > 0) == end(it->second)) {
+	} else if (ranges::find_if(sessions.requested, _1 > 0)
+		== end(sessions.requested)) {
+		// Idle time should not be counted in the throughput.
+		sessions.windowStart = 0;
+		sessions.received = 0;
+		sessions.durationSum = 0;
+		sessions.durationCount = 0;
 		killDownloadSessionsStart(dcId);
+	} else if (index >= sessions.count && !requested) {
+		// This session was removed and finished all its requests.
+		MTP::stopSession(MTP::downloadDcId(dcId, index));
+	}
+}
+
+void Downloader::requestFinished(
+		MTP::DcId dcId,
+		int amount,
+		crl::time duration) {
+	auto &sessions = sessionsForDc(dcId);
+	const auto now = crl::now();
+	if (!sessions.windowStart) {
+		sessions.windowStart = now - duration;
+	}
+	sessions.received += amount;
+	sessions.durationSum += duration;
+	++sessions.durationCount;
+	if (!sessions.minDuration || sessions.minDuration > duration) {
+		sessions.minDuration = std::max(duration, crl::time(1));
+	}
+	if (now - sessions.windowStart >= kSessionsCountWindow) {
+		checkSessionsCount(dcId, sessions);
+	}
+}
+
+void Downloader::checkSessionsCount(MTP::DcId dcId, DcSessions &sessions) {
+	const auto now = crl::now();
+	const auto elapsed = now - sessions.windowStart;
+	const auto throughput = sessions.received * 1000 / elapsed;
+	const auto duration = sessions.durationSum / sessions.durationCount;
+	const auto inFlight = ranges::accumulate(sessions.requested, int64(0));
+
+	// Only the windows with all sessions busy tell us about the link.
+	const auto saturated = (inFlight >= sessions.count * kPartSize);
+	const auto congested = (duration
+		> sessions.minDuration * kSessionsCongestionFactor);
+	const auto gained = (throughput * kSessionsThroughputGainPart
+		> sessions.lastThroughput * (kSessionsThroughputGainPart + 1));
+	const auto count = [&] {
+		if (!saturated) {
+			return sessions.count;
+		} else if (sessions.count > MTP::kDownloadSessionsCount
+			&& (congested
+				|| (sessions.lastCount < sessions.count && !gained))) {
+			sessions.increaseAllowed = now + kSessionsIncreaseTimeout;
+			return sessions.count - 1;
+		} else if (sessions.count < MTP::kMaxDownloadSessionsCount
+			&& !congested
+			&& now >= sessions.increaseAllowed) {
+			return sessions.count + 1;
+		}
+		return sessions.count;
+	}();
+	const auto bandwidth = sessions.bandwidth;
+	accumulate_max(sessions.bandwidth, throughput);
+	sessions.lastThroughput = throughput;
+	sessions.lastCount = sessions.count;
+	sessions.windowStart = now;
+	sessions.received = 0;
+	sessions.durationSum = 0;
+	sessions.durationCount = 0;
+	if (count != sessions.count) {
+		DEBUG_LOG(("Downloader Info: dc %1 sessions %2 -> %3, "
+			"throughput %4 bytes/sec, request takes %5 ms (min %6 ms)."
+			).arg(dcId
+			).arg(sessions.count
+			).arg(count
+			).arg(throughput
+			).arg(duration
+			).arg(sessions.minDuration));
+		sessions.count = count;
+		refreshQueriesLimit(dcId);
+	} else if (bandwidth != sessions.bandwidth) {
+		refreshQueriesLimit(dcId);
+	}
+}
+
+int Downloader::queriesLimitForDc(MTP::DcId dcId) const {
+	const auto i = _sessions.find(dcId);
+	if (i == end(_sessions)) {
+		return kMaxFileQueries;
+	}
+	const auto minimal = kMaxFileQueries
+		* i->second.count
+		/ MTP::kDownloadSessionsCount;
+	if (!i->second.bandwidth || !i->second.minDuration) {
+		return minimal;
+	}
+	const auto product = i->second.bandwidth * i->second.minDuration / 1000;
+	const auto parts = (product * kBandwidthDelayGain + kPartSize - 1)
+		/ kPartSize;
+	return std::clamp(int(parts), minimal, kMaxFileQueriesWindow);
+}
+
+void Downloader::refreshQueriesLimit(MTP::DcId dcId) {
+	const auto i = _queuesForDc.find(dcId);
+	if (i != end(_queuesForDc)) {
+		i->second.queriesLimit = queriesLimitForDc(dcId);
 	}
 }
 
+int Downloader::QueriesForPart(int partSize) {
+	return std::max((partSize + kPartSize - 1) / kPartSize, 1);
+}
+
+int Downloader::AutoLoadingQueriesLimit(not_null<const Queue*> queue) {
+	return std::max(
+		queue->queriesLimit * kAutoLoadingQueriesPercent / 100,
+		QueriesForPart(kPartSize));
+}
+
 void Downloader::killDownloadSessionsStart(MTP::DcId dcId) {
 	if (!_killDownloadSessionTimes.contains(dcId)) {
 		_killDownloadSessionTimes.emplace(
@@ -93,9 +241,14 @@ void Downloader::killDownloadSessions() {
 	auto ms = crl::now(), left = MTP::kAckSendWaiting + kKillSessionTimeout;
 	for (auto i = _killDownloadSessionTimes.begin(); i != _killDownloadSessionTimes.end(); ) {
 		if (i->second <= ms) {
-			for (int j = 0; j < MTP::kDownloadSessionsCount; ++j) {
+			for (int j = 0; j < MTP::kMaxDownloadSessionsCount; ++j) {
 				MTP::stopSession(MTP::downloadDcId(i->first, j));
 			}
+			if (const auto j = _sessions.find(i->first); j != end(_sessions)) {
+				// Network conditions may be different next time.
+				j->second.minDuration = 0;
+				j->second.bandwidth = 0;
+			}
 			i = _killDownloadSessionTimes.erase(i);
 		} else {
 			if (i->second - ms < left) {
@@ -111,10 +264,11 @@ void Downloader::killDownloadSessions() {
 
 int Downloader::chooseDcIndexForRequest(MTP::DcId dcId) const {
 	auto result = 0;
-	auto it = _requestedBytesAmount.find(dcId);
-	if (it != _requestedBytesAmount.cend()) {
-		for (auto i = 1; i != MTP::kDownloadSessionsCount; ++i) {
-			if (it->second[i] < it->second[result]) {
+	auto it = _sessions.find(dcId);
+	if (it != _sessions.cend()) {
+		const auto &requested = it->second.requested;
+		for (auto i = 1; i != it->second.count; ++i) {
+			if (requested[i] < requested[result]) {
 				result = i;
 			}
 		}
@@ -122,11 +276,25 @@ int Downloader::chooseDcIndexForRequest(MTP::DcId dcId) const {
 	return result;
 }
 
+int Downloader::partsInFlightForDc(MTP::DcId dcId) const {
+	const auto i = _sessions.find(dcId);
+	if (i == end(_sessions)
+		|| !i->second.bandwidth
+		|| !i->second.minDuration) {
+		return kPartsInFlightMin;
+	}
+	const auto product = i->second.bandwidth * i->second.minDuration / 1000;
+	const auto parts = (product * kBandwidthDelayGain + kPartSize - 1)
+		/ kPartSize;
+	return std::clamp(int(parts), kPartsInFlightMin, kMaxFileQueries);
+}
+
 not_null<Downloader::Queue*> Downloader::queueForDc(MTP::DcId dcId) {
 	const auto i = _queuesForDc.find(dcId);
 	const auto result = (i != end(_queuesForDc))
 		? i
 		: _queuesForDc.emplace(dcId, Queue(kMaxFileQueries)).first;
+	result->second.queriesLimit = queriesLimitForDc(dcId);
 	return &result->second;
 }
 
@@ -149,6 +317,10 @@ WebLoadManager *webLoadManager() {
 }
 WebLoadMainManager *_webLoadMainManager = nullptr;
 
+// The first scan of a progressive JPEG usually has only DC coefficients,
+// it doesn't look better than the blurred thumbnail.
+constexpr auto kProgressiveMinScans = 2;
+
 } // namespace
 
 FileLoader::FileLoader(
@@ -211,6 +383,13 @@ QByteArray FileLoader::imageFormat(const QSize &shrinkBox) const {
 QImage FileLoader::imageData(const QSize &shrinkBox) const {
 	if (_imageData.isNull() && _locationType == UnknownFileLocation) {
 		readImage(shrinkBox);
+	} else if (!shrinkBox.isEmpty()
+		&& (_imageData.width() > shrinkBox.width()
+			|| _imageData.height() > shrinkBox.height())) {
+		return _imageData.scaled(
+			shrinkBox,
+			Qt::KeepAspectRatio,
+			Qt::SmoothTransformation);
 	}
 	return _imageData;
 }
@@ -317,15 +496,17 @@ void FileLoader::localLoaded(
 }
 
 void FileLoader::start() {
-	if (_finished || tryLoadLocal()) {
+	if (_finished || _imageDecoding || _fileReadingBack || tryLoadLocal()) {
 		return;
 	} else if (_fromCloud == LoadFromLocalOnly) {
 		cancel();
 		return;
 	}
 
-	if (!_filename.isEmpty() && _toCache == LoadToFileOnly && !_fileIsOpen) {
-		_fileIsOpen = _file.open(QIODevice::WriteOnly);
+	// Parts are written right to the file even if it goes to cache as well,
+	// the cached copy is read back from the file when it is complete.
+	if (!_filename.isEmpty() && !_fileIsOpen) {
+		_fileIsOpen = openFile();
 		if (!_fileIsOpen) {
 			return cancel(true);
 		}
@@ -471,6 +652,10 @@ void FileLoader::cancel() {
 void FileLoader::cancel(bool fail) {
 	const auto started = (currentOffset() > 0);
 	cancelRequests();
+	_imageDecoding = nullptr;
+	_fileReadingBack = nullptr;
+	_progressiveDecoding = nullptr;
+	_progressiveImage = QImage();
 	_cancelled = true;
 	_finished = true;
 	if (_fileIsOpen) {
@@ -478,6 +663,7 @@ void FileLoader::cancel(bool fail) {
 		_fileIsOpen = false;
 		_file.remove();
 	}
+	forgetPartialDownload();
 	_data = QByteArray();
 	removeFromQueue();
 
@@ -499,14 +685,140 @@ void FileLoader::cancel(bool fail) {
 }
 
 void FileLoader::startLoading() {
-	if ((_queue->queriesCount >= _queue->queriesLimit) || _finished) {
+	if (_finished) {
+		return;
+	} else if ((_queue->queriesCount >= _queue->queriesLimit)
+		&& !preemptStaleRequests()) {
 		return;
 	}
 	loadPart();
 }
 
+bool FileLoader::preemptStaleRequests() {
+	const auto currentPriority = _downloader->currentPriority();
+	if (_priority != currentPriority) {
+		return false;
+	}
+	for (auto i = _queue->end; i && i->_priority < currentPriority;) {
+		if (!i->preemptRequest()) {
+			i = i->_prev;
+		} else if (_queue->queriesCount < _queue->queriesLimit) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FileLoader::resumable() const {
+	return false;
+}
+
+bool FileLoader::openFile() {
+	if (resumable() && _size > 0) {
+		if (const auto key = fileLocationKey()) {
+			if (const auto download = Local::readPartialDownload(*key)) {
+				if (resumeFrom(*download)) {
+					return true;
+				}
+			}
+			_loadedParts = QByteArray(
+				(_size + Storage::kPartSize * 8 - 1) / (Storage::kPartSize * 8),
+				char(0));
+		}
+	}
+	return _file.open(QIODevice::WriteOnly);
+}
+
+bool FileLoader::resumeFrom(const Local::PartialDownload &download) {
+	const auto partsCount = (_size + Storage::kPartSize - 1)
+		/ Storage::kPartSize;
+	if (download.size != _size
+		|| download.parts.size() != (partsCount + 7) / 8
+		|| !QFile::exists(download.path)) {
+		return false;
+	} else if (download.path != _filename) {
+		// The file name could be chosen again, move the loaded parts there.
+		if (QFile::exists(_filename) && QFileInfo(_filename).size() > 0) {
+			return false;
+		}
+		QFile::remove(_filename);
+		if (!QFile::rename(download.path, _filename)) {
+			return false;
+		}
+	}
+	if (!_file.open(QIODevice::ReadWrite)) {
+		return false;
+	}
+	_loadedParts = download.parts;
+	auto loaded = int64(0);
+	for (auto i = 0; i != partsCount; ++i) {
+		if (partLoadedBefore(i * Storage::kPartSize)) {
+			loaded += std::min(Storage::kPartSize, _size - i * Storage::kPartSize);
+		}
+	}
+	if (loaded > _file.size()) {
+		_file.close();
+		_loadedParts = QByteArray();
+		return false;
+	}
+	_skippedBytes = _file.size() - loaded;
+	DEBUG_LOG(("Downloader Info: resuming %1, %2 of %3 bytes loaded."
+		).arg(_filename
+		).arg(loaded
+		).arg(_size));
+	return true;
+}
+
+bool FileLoader::partLoadedBefore(int offset) const {
+	const auto index = offset / Storage::kPartSize;
+	return (index / 8 < _loadedParts.size())
+		&& (uchar(_loadedParts[index / 8]) & (1 << (index % 8)));
+}
+
+int FileLoader::notLoadedSize(int offset, int maxSize) const {
+	auto result = 0;
+	while (result < maxSize
+		&& (!_size || offset + result < _size)
+		&& !partLoadedBefore(offset + result)) {
+		result += Storage::kPartSize;
+	}
+	return result;
+}
+
+void FileLoader::markPartLoaded(int offset, int size) {
+	if (_loadedParts.isEmpty() || size <= 0) {
+		return;
+	}
+	const auto till = offset + size;
+	const auto from = (offset + Storage::kPartSize - 1) / Storage::kPartSize;
+	const auto to = (till >= _size)
+		? ((till + Storage::kPartSize - 1) / Storage::kPartSize)
+		: (till / Storage::kPartSize);
+	for (auto index = from; index < to; ++index) {
+		if (index / 8 < _loadedParts.size()) {
+			_loadedParts[index / 8] |= char(1 << (index % 8));
+		}
+	}
+	if (const auto key = fileLocationKey()) {
+		Local::writePartialDownload(
+			*key,
+			{ _filename, _size, _loadedParts });
+	}
+}
+
+void FileLoader::forgetPartialDownload() {
+	if (_loadedParts.isEmpty()) {
+		return;
+	}
+	_loadedParts = QByteArray();
+	if (const auto key = fileLocationKey()) {
+		Local::removePartialDownload(*key);
+	}
+}
+
 int FileLoader::currentOffset() const {
-	return (_fileIsOpen ? _file.size() : _data.size()) - _skippedBytes;
+	const auto inFile = _fileIsOpen || _fileReadingBack;
+	return (inFile ? _file.size() : _data.size()) - _skippedBytes;
 }
 
 bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
@@ -527,9 +839,13 @@ bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
 			cancel(true);
 			return false;
 		}
+		markPartLoaded(offset, buffer.size());
 		return true;
 	}
-	_data.reserve(offset + buffer.size());
+	const auto till = offset + int(buffer.size());
+	if (_data.capacity() < till) {
+		_data.reserve(std::max({ _size, till, int(_data.capacity()) * 2 }));
+	}
 	if (offset > _data.size()) {
 		_skippedBytes += offset - _data.size();
 		_data.resize(offset);
@@ -546,9 +862,140 @@ bool FileLoader::writeResultPart(int offset, bytes::const_span buffer) {
 			buffer.size());
 		bytes::copy(dst, buffer);
 	}
+	if (!_skippedBytes) {
+		checkProgressiveScans();
+	}
 	return true;
 }
 
+QImage FileLoader::takeProgressiveImage() {
+	return base::take(_progressiveImage);
+}
+
+void FileLoader::ParseProgressiveJpeg(
+		const QByteArray &data,
+		ProgressiveJpeg &state) {
+	const auto bytes = reinterpret_cast<const uchar*>(data.constData());
+	const auto size = data.size();
+	if (!state.offset) {
+		if (size < 2) {
+			return;
+		} else if (bytes[0] != 0xFF || bytes[1] != 0xD8) {
+			state.failed = true;
+			return;
+		}
+		state.offset = 2;
+	}
+	auto &offset = state.offset;
+	while (!state.failed) {
+		if (state.inScan) {
+			// Entropy coded data has only stuffed 0xFF00, fill bytes
+			// and restart markers, anything else ends the scan.
+			for (; offset + 1 < size; ++offset) {
+				const auto next = bytes[offset + 1];
+				if (bytes[offset] == 0xFF
+					&& next != 0x00
+					&& next != 0xFF
+					&& (next < 0xD0 || next > 0xD7)) {
+					break;
+				}
+			}
+			if (offset + 1 >= size) {
+				return;
+			}
+			state.inScan = false;
+			state.scansEnd = offset;
+			++state.scans;
+			continue;
+		}
+		if (offset + 2 > size) {
+			return;
+		} else if (bytes[offset] != 0xFF) {
+			state.failed = true;
+			return;
+		}
+		const auto marker = bytes[offset + 1];
+		if (marker == 0xFF) {
+			++offset;
+			continue;
+		} else if (marker == 0xD9) {
+			state.failed = true;
+			return;
+		} else if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+			offset += 2;
+			continue;
+		} else if (offset + 4 > size) {
+			return;
+		}
+		const auto length = (int(bytes[offset + 2]) << 8)
+			| int(bytes[offset + 3]);
+		if (length < 2) {
+			state.failed = true;
+			return;
+		} else if (marker == 0xC2) {
+			state.progressive = true;
+		} else if (marker == 0xDA && !state.progressive) {
+			// Baseline JPEG, it is decoded only when fully loaded.
+			state.failed = true;
+			return;
+		}
+		if (offset + 2 + length > size) {
+			return;
+		}
+		offset += 2 + length;
+		if (marker == 0xDA) {
+			state.inScan = true;
+		}
+	}
+}
+
+void FileLoader::checkProgressiveScans() {
+	if (_finished
+		|| _locationType != UnknownFileLocation
+		|| _progressive.failed
+		|| _progressiveDecoding
+		|| _imageDecoding) {
+		return;
+	}
+	ParseProgressiveJpeg(_data, _progressive);
+	if (_progressive.failed
+		|| _progressive.scans < kProgressiveMinScans
+		|| _progressive.scans == _progressive.scansDecoded) {
+		return;
+	}
+	auto bytes = _data.left(_progressive.scansEnd);
+	bytes.append("\xFF\xD9", 2); // EOI marker after the loaded scans.
+	crl::async([
+		=,
+		bytes = std::move(bytes),
+		scans = _progressive.scans,
+		guard = _progressiveDecoding.make_guard()
+	]() mutable {
+		if (!guard) {
+			return;
+		}
+		auto image = App::readImage(bytes, nullptr, false);
+		crl::on_main(std::move(guard), [
+			=,
+			image = std::move(image)
+		]() mutable {
+			progressiveDecoded(std::move(image), scans);
+		});
+	});
+}
+
+void FileLoader::progressiveDecoded(QImage &&image, int scans) {
+	_progressiveDecoding = nullptr;
+	_progressive.scansDecoded = scans;
+	if (!image.isNull()) {
+		_progressiveImage = std::move(image);
+		_downloader->taskFinished().notify();
+	}
+	if (!_skippedBytes) {
+		checkProgressiveScans();
+	}
+}
+
 QByteArray FileLoader::readLoadedPartBack(int offset, int size) {
 	Expects(offset >= 0 && size > 0);
 
@@ -575,24 +1022,27 @@ QByteArray FileLoader::readLoadedPartBack(int offset, int size) {
 bool FileLoader::finalizeResult() {
 	Expects(!_finished);
 
-	if (!_filename.isEmpty() && (_toCache == LoadToCacheAsWell)) {
-		if (!_fileIsOpen) {
-			_fileIsOpen = _file.open(QIODevice::WriteOnly);
-		}
-		_file.seek(0);
+	if (!_filename.isEmpty()
+		&& (_toCache == LoadToCacheAsWell)
+		&& !_fileIsOpen) {
+		_fileIsOpen = _file.open(QIODevice::WriteOnly);
 		if (!_fileIsOpen || _file.write(_data) != qint64(_data.size())) {
 			cancel(true);
 			return false;
 		}
 	}
+	const auto readBack = _fileIsOpen
+		&& (_toCache == LoadToCacheAsWell)
+		&& _data.isEmpty()
+		&& (_file.size() <= Storage::kMaxFileInMemory);
 
-	_finished = true;
 	if (_fileIsOpen) {
 		_file.close();
 		_fileIsOpen = false;
 		Platform::File::PostprocessDownloaded(
 			QFileInfo(_file).absoluteFilePath());
 	}
+	forgetPartialDownload();
 	removeFromQueue();
 
 	if (_localStatus == LocalStatus::NotFound) {
@@ -602,6 +1052,7 @@ bool FileLoader::finalizeResult() {
 			}
 		}
 		if ((_toCache == LoadToCacheAsWell)
+			&& !readBack
 			&& (_data.size() <= Storage::kMaxFileInMemory)) {
 			session().data().cache().put(
 				cacheKey(),
@@ -610,10 +1061,100 @@ bool FileLoader::finalizeResult() {
 					_cacheTag));
 		}
 	}
-	_downloader->taskFinished().notify();
+	if (readBack) {
+		readBackAndFinish(_localStatus == LocalStatus::NotFound);
+	} else if (_locationType == UnknownFileLocation
+		&& _imageData.isNull()
+		&& !_data.isEmpty()) {
+		decodeImageAndFinish();
+	} else {
+		_finished = true;
+		_downloader->taskFinished().notify();
+	}
 	return true;
 }
 
+void FileLoader::readBackAndFinish(bool putToCache) {
+	crl::async([
+		=,
+		path = _filename,
+		guard = _fileReadingBack.make_guard()
+	]() mutable {
+		if (!guard) {
+			return;
+		}
+		auto file = QFile(path);
+		auto data = file.open(QIODevice::ReadOnly)
+			? file.readAll()
+			: QByteArray();
+		auto cached = putToCache ? base::duplicate(data) : QByteArray();
+		crl::on_main(std::move(guard), [
+			=,
+			data = std::move(data),
+			cached = std::move(cached)
+		]() mutable {
+			fileReadBack(std::move(data), std::move(cached));
+		});
+	});
+}
+
+void FileLoader::fileReadBack(QByteArray &&data, QByteArray &&cached) {
+	_fileReadingBack = nullptr;
+	_data = std::move(data);
+	if (!cached.isEmpty()) {
+		session().data().cache().put(
+			cacheKey(),
+			Storage::Cache::Database::TaggedValue(
+				std::move(cached),
+				_cacheTag));
+	}
+	if (_locationType == UnknownFileLocation
+		&& _imageData.isNull()
+		&& !_data.isEmpty()) {
+		decodeImageAndFinish();
+		return;
+	}
+	_finished = true;
+	_downloader->taskFinished().notify();
+	notifyAboutProgress();
+}
+
+void FileLoader::decodeImageAndFinish() {
+	crl::async([
+		=,
+		data = _data,
+		guard = _imageDecoding.make_guard()
+	]() mutable {
+		// Skip the work if the loader was destroyed or cancelled,
+		// for example when the image was unloaded out of view.
+		if (!guard) {
+			return;
+		}
+		auto format = QByteArray();
+		auto image = App::readImage(data, &format, false);
+		crl::on_main(std::move(guard), [
+			=,
+			image = std::move(image),
+			format = std::move(format)
+		]() mutable {
+			imageDecoded(std::move(image), std::move(format));
+		});
+	});
+}
+
+void FileLoader::imageDecoded(QImage &&image, QByteArray &&format) {
+	_imageDecoding = nullptr;
+	_progressiveDecoding = nullptr;
+	_progressiveImage = QImage();
+	if (!image.isNull()) {
+		_imageData = std::move(image);
+		_imageFormat = std::move(format);
+	}
+	_finished = true;
+	_downloader->taskFinished().notify();
+	notifyAboutProgress();
+}
+
 mtpFileLoader::mtpFileLoader(
 	const StorageFileLocation &location,
 	Data::FileOrigin origin,
@@ -698,19 +1239,47 @@ void mtpFileLoader::refreshFileReferenceFrom(
 		cancel(true);
 		return;
 	}
-	const auto offset = finishSentRequestGetOffset(requestId);
-	makeRequest(offset);
+	const auto requestData = finishSentRequest(requestId);
+	makeRequests(requestData.offset, requestData.limit);
+}
+
+bool mtpFileLoader::resumable() const {
+	return (_toCache == LoadToFileOnly)
+		&& (base::get_if<StorageFileLocation>(&_location) != nullptr);
+}
+
+void mtpFileLoader::skipLoadedParts() {
+	while (_size
+		&& _nextRequestOffset < _size
+		&& partLoadedBefore(_nextRequestOffset)) {
+		_nextRequestOffset += Storage::kPartSize;
+	}
 }
 
 bool mtpFileLoader::loadPart() {
-	if (_finished || _lastComplete || (!_sentRequests.empty() && !_size)) {
+	if (_finished
+		|| ((!_sentRequests.empty() || _cdnPartsDecrypting > 0) && !_size)) {
+		return false;
+	}
+	skipLoadedParts();
+	if (_autoLoading
+		&& (_queue->autoLoadingQueriesCount
+			>= Storage::Downloader::AutoLoadingQueriesLimit(_queue))) {
 		return false;
-	} else if (_size && _nextRequestOffset >= _size) {
+	} else if (!_preemptedRequests.empty()) {
+		const auto preempted = _preemptedRequests.front();
+		_preemptedRequests.pop_front();
+		makeRequests(preempted.offset, preempted.limit);
+		return true;
+	} else if (_lastComplete || (_size && _nextRequestOffset >= _size)) {
 		return false;
 	}
 
-	makeRequest(_nextRequestOffset);
-	_nextRequestOffset += Storage::kPartSize;
+	const auto limit = partSize(
+		_nextRequestOffset,
+		notLoadedSize(_nextRequestOffset, Storage::kMaxPartSize));
+	makeRequest(_nextRequestOffset, limit);
+	_nextRequestOffset += limit;
 	return true;
 }
 
@@ -721,19 +1290,40 @@ MTP::DcId mtpFileLoader::dcId() const {
 	return Global::WebFileDcId();
 }
 
-mtpFileLoader::RequestData mtpFileLoader::prepareRequest(int offset) const {
+int mtpFileLoader::partSize(int offset, int maxSize) const {
+	using namespace Storage;
+
+	const auto preferred = (_cdnDcId
+		|| !base::get_if<StorageFileLocation>(&_location))
+		? kPartSize
+		: (_size >= kMaxPartSizeFrom)
+		? kMaxPartSize
+		: (_size >= kMediumPartSizeFrom)
+		? kMediumPartSize
+		: kPartSize;
+	auto result = preferred;
+	while (result > kPartSize && (result > maxSize || (offset % result))) {
+		result /= 2;
+	}
+	return result;
+}
+
+mtpFileLoader::RequestData mtpFileLoader::prepareRequest(
+		int offset,
+		int limit) const {
 	auto result = RequestData();
 	result.dcId = _cdnDcId ? _cdnDcId : dcId();
 	result.dcIndex = _size
 		? _downloader->chooseDcIndexForRequest(result.dcId)
 		: 0;
 	result.offset = offset;
+	result.limit = limit;
 	return result;
 }
 
 mtpRequestId mtpFileLoader::sendRequest(const RequestData &requestData) {
 	const auto offset = requestData.offset;
-	const auto limit = Storage::kPartSize;
+	const auto limit = requestData.limit;
 	const auto shiftedDcId = MTP::downloadDcId(
 		requestData.dcId,
 		requestData.dcIndex);
@@ -795,13 +1385,25 @@ mtpRequestId mtpFileLoader::sendRequest(const RequestData &requestData) {
 	});
 }
 
-void mtpFileLoader::makeRequest(int offset) {
+void mtpFileLoader::makeRequest(int offset, int limit) {
 	Expects(!_finished);
 
-	auto requestData = prepareRequest(offset);
+	auto requestData = prepareRequest(offset, limit);
 	placeSentRequest(sendRequest(requestData), requestData);
 }
 
+void mtpFileLoader::makeRequests(int offset, int size) {
+	// After switching to or from cdn the part size may be different.
+	for (const auto till = offset + size; offset < till;) {
+		if (_size && offset >= _size) {
+			break;
+		}
+		const auto limit = partSize(offset, till - offset);
+		makeRequest(offset, limit);
+		offset += limit;
+	}
+}
+
 void mtpFileLoader::requestMoreCdnFileHashes() {
 	Expects(!_finished);
 
@@ -814,6 +1416,7 @@ void mtpFileLoader::requestMoreCdnFileHashes() {
 	requestData.dcId = dcId();
 	requestData.dcIndex = 0;
 	requestData.offset = offset;
+	requestData.limit = Storage::kPartSize;
 	auto shiftedDcId = MTP::downloadDcId(
 		requestData.dcId,
 		requestData.dcIndex);
@@ -833,12 +1436,12 @@ void mtpFileLoader::normalPartLoaded(
 	Expects(!_finished);
 	Expects(result.type() == mtpc_upload_fileCdnRedirect || result.type() == mtpc_upload_file);
 
-	auto offset = finishSentRequestGetOffset(requestId);
+	const auto requestData = finishSentRequest(requestId);
 	if (result.type() == mtpc_upload_fileCdnRedirect) {
-		return switchToCDN(offset, result.c_upload_fileCdnRedirect());
+		return switchToCDN(requestData, result.c_upload_fileCdnRedirect());
 	}
 	auto buffer = bytes::make_span(result.c_upload_file().vbytes().v);
-	return partLoaded(offset, buffer);
+	return partLoaded(requestData.offset, buffer);
 }
 
 void mtpFileLoader::webPartLoaded(
@@ -869,6 +1472,7 @@ void mtpFileLoader::cdnPartLoaded(const MTPupload_CdnFile &result, mtpRequestId
 		requestData.dcId = dcId();
 		requestData.dcIndex = 0;
 		requestData.offset = offset;
+		requestData.limit = Storage::kPartSize;
 		const auto shiftedDcId = MTP::downloadDcId(
 			requestData.dcId,
 			requestData.dcIndex);
@@ -881,52 +1485,85 @@ void mtpFileLoader::cdnPartLoaded(const MTPupload_CdnFile &result, mtpRequestId
 			shiftedDcId);
 		placeSentRequest(requestId, requestData);
 	}, [&](const MTPDupload_cdnFile &data) {
-		auto key = bytes::make_span(_cdnEncryptionKey);
-		auto iv = bytes::make_span(_cdnEncryptionIV);
-		Expects(key.size() == MTP::CTRState::KeySize);
-		Expects(iv.size() == MTP::CTRState::IvecSize);
-
-		auto state = MTP::CTRState();
-		auto ivec = bytes::make_span(state.ivec);
-		std::copy(iv.begin(), iv.end(), ivec.begin());
-
-		auto counterOffset = static_cast<uint32>(offset) >> 4;
-		state.ivec[15] = static_cast<uchar>(counterOffset & 0xFF);
-		state.ivec[14] = static_cast<uchar>((counterOffset >> 8) & 0xFF);
-		state.ivec[13] = static_cast<uchar>((counterOffset >> 16) & 0xFF);
-		state.ivec[12] = static_cast<uchar>((counterOffset >> 24) & 0xFF);
-
-		auto decryptInPlace = data.vbytes().v;
-		auto buffer = bytes::make_detached_span(decryptInPlace);
-		MTP::aesCtrEncrypt(buffer, key.data(), &state);
-
-		switch (checkCdnFileHash(offset, buffer)) {
-		case CheckCdnHashResult::NoHash: {
-			_cdnUncheckedParts.emplace(offset, decryptInPlace);
-			requestMoreCdnFileHashes();
-		} return;
-
-		case CheckCdnHashResult::Invalid: {
-			LOG(("API Error: Wrong cdnFileHash for offset %1.").arg(offset));
-			cancel(true);
-		} return;
+		Expects(_cdnEncryptionKey.size() == MTP::CTRState::KeySize);
+		Expects(_cdnEncryptionIV.size() == MTP::CTRState::IvecSize);
 
-		case CheckCdnHashResult::Good: {
-			partLoaded(offset, buffer);
-		} return;
-		}
-		Unexpected("Result of checkCdnFileHash()");
+		// Decrypt and hash the part in the background,
+		// the parts are fed to the file by offsets, in any order.
+		++_cdnPartsDecrypting;
+		crl::async([
+			=,
+			weak = make_weak(this),
+			key = _cdnEncryptionKey,
+			iv = _cdnEncryptionIV,
+			decryptInPlace = data.vbytes().v
+		]() mutable {
+			auto state = MTP::CTRState();
+			auto ivec = bytes::make_span(state.ivec);
+			bytes::copy(ivec, bytes::make_span(iv));
+
+			auto counterOffset = static_cast<uint32>(offset) >> 4;
+			state.ivec[15] = static_cast<uchar>(counterOffset & 0xFF);
+			state.ivec[14] = static_cast<uchar>((counterOffset >> 8) & 0xFF);
+			state.ivec[13] = static_cast<uchar>((counterOffset >> 16) & 0xFF);
+			state.ivec[12] = static_cast<uchar>((counterOffset >> 24) & 0xFF);
+
+			auto buffer = bytes::make_detached_span(decryptInPlace);
+			MTP::aesCtrEncrypt(buffer, key.constData(), &state);
+			auto hash = openssl::Sha256(buffer);
+			crl::on_main(weak, [
+				=,
+				decrypted = std::move(decryptInPlace),
+				hash = std::move(hash)
+			]() mutable {
+				cdnPartDecrypted(offset, std::move(decrypted), hash);
+			});
+		});
 	});
 }
 
+void mtpFileLoader::cdnPartDecrypted(
+		int offset,
+		QByteArray &&decrypted,
+		const bytes::vector &hash) {
+	--_cdnPartsDecrypting;
+	if (_finished) {
+		return;
+	}
+	switch (checkCdnPartHash(offset, hash)) {
+	case CheckCdnHashResult::NoHash: {
+		_cdnUncheckedParts.emplace(offset, std::move(decrypted));
+		requestMoreCdnFileHashes();
+	} return;
+
+	case CheckCdnHashResult::Invalid: {
+		LOG(("API Error: Wrong cdnFileHash for offset %1.").arg(offset));
+		cancel(true);
+	} return;
+
+	case CheckCdnHashResult::Good: {
+		partLoaded(offset, bytes::make_span(decrypted));
+	} return;
+	}
+	Unexpected("Result of checkCdnPartHash()");
+}
+
 mtpFileLoader::CheckCdnHashResult mtpFileLoader::checkCdnFileHash(
 		int offset,
 		bytes::const_span buffer) {
+	if (_cdnFileHashes.find(offset) == _cdnFileHashes.cend()) {
+		return CheckCdnHashResult::NoHash;
+	}
+	return checkCdnPartHash(offset, openssl::Sha256(buffer));
+}
+
+mtpFileLoader::CheckCdnHashResult mtpFileLoader::checkCdnPartHash(
+		int offset,
+		bytes::const_span realHash) {
 	const auto cdnFileHashIt = _cdnFileHashes.find(offset);
 	if (cdnFileHashIt == _cdnFileHashes.cend()) {
 		return CheckCdnHashResult::NoHash;
 	}
-	const auto realHash = openssl::Sha256(buffer);
 	const auto receivedHash = bytes::make_span(cdnFileHashIt->second.hash);
 	if (bytes::compare(realHash, receivedHash)) {
 		return CheckCdnHashResult::Invalid;
@@ -939,7 +1576,7 @@ void mtpFileLoader::reuploadDone(
 		mtpRequestId requestId) {
 	auto offset = finishSentRequestGetOffset(requestId);
 	addCdnHashes(result.v);
-	makeRequest(offset);
+	makeRequest(offset, Storage::kPartSize);
 }
 
 void mtpFileLoader::getCdnFileHashesDone(
@@ -1009,12 +1646,20 @@ void mtpFileLoader::placeSentRequest(
 	_downloader->requestedAmountIncrement(
 		requestData.dcId,
 		requestData.dcIndex,
-		Storage::kPartSize);
-	++_queue->queriesCount;
-	_sentRequests.emplace(requestId, requestData);
+		requestData.limit);
+	_queue->queriesCount += Storage::Downloader::QueriesForPart(
+		requestData.limit);
+	if (_autoLoading) {
+		_queue->autoLoadingQueriesCount
+			+= Storage::Downloader::QueriesForPart(requestData.limit);
+	}
+	auto &sent = _sentRequests.emplace(requestId, requestData).first->second;
+	sent.sent = crl::now();
+	sent.autoLoading = _autoLoading;
 }
 
-int mtpFileLoader::finishSentRequestGetOffset(mtpRequestId requestId) {
+auto mtpFileLoader::finishSentRequest(mtpRequestId requestId)
+-> RequestData {
 	auto it = _sentRequests.find(requestId);
 	Assert(it != _sentRequests.cend());
 
@@ -1022,12 +1667,25 @@ int mtpFileLoader::finishSentRequestGetOffset(mtpRequestId requestId) {
 	_downloader->requestedAmountIncrement(
 		requestData.dcId,
 		requestData.dcIndex,
-		-Storage::kPartSize);
+		-requestData.limit);
+	_downloader->requestFinished(
+		requestData.dcId,
+		requestData.limit,
+		crl::now() - requestData.sent);
 
-	--_queue->queriesCount;
+	_queue->queriesCount -= Storage::Downloader::QueriesForPart(
+		requestData.limit);
+	if (requestData.autoLoading) {
+		_queue->autoLoadingQueriesCount
+			-= Storage::Downloader::QueriesForPart(requestData.limit);
+	}
 	_sentRequests.erase(it);
 
-	return requestData.offset;
+	return requestData;
+}
+
+int mtpFileLoader::finishSentRequestGetOffset(mtpRequestId requestId) {
+	return finishSentRequest(requestId).offset;
 }
 
 bool mtpFileLoader::feedPart(int offset, bytes::const_span buffer) {
@@ -1037,8 +1695,11 @@ bool mtpFileLoader::feedPart(int offset, bytes::const_span buffer) {
 	if (buffer.empty() || (buffer.size() % 1024)) { // bad next offset
 		_lastComplete = true;
 	}
+	skipLoadedParts();
 	const auto finished = _sentRequests.empty()
 		&& _cdnUncheckedParts.empty()
+		&& !_cdnPartsDecrypting
+		&& _preemptedRequests.empty()
 		&& (_lastComplete || (_size && _nextRequestOffset >= _size));
 	if (finished && !finalizeResult()) {
 		return false;
@@ -1094,9 +1755,9 @@ bool mtpFileLoader::cdnPartFailed(
 	}
 	if (error.type() == qstr("FILE_TOKEN_INVALID")
 		|| error.type() == qstr("REQUEST_TOKEN_INVALID")) {
-		auto offset = finishSentRequestGetOffset(requestId);
+		const auto requestData = finishSentRequest(requestId);
 		changeCDNParams(
-			offset,
+			requestData,
 			0,
 			QByteArray(),
 			QByteArray(),
@@ -1113,13 +1774,37 @@ void mtpFileLoader::cancelRequests() {
 		MTP::cancel(requestId);
 		finishSentRequestGetOffset(requestId);
 	}
+	_preemptedRequests.clear();
+}
+
+bool mtpFileLoader::preemptRequest() {
+	if (!_size || _finished) {
+		return false;
+	}
+
+	// The part with the largest offset is the one needed the latest.
+	auto latest = end(_sentRequests);
+	for (auto i = begin(_sentRequests); i != end(_sentRequests); ++i) {
+		if (i->first != _cdnHashesRequestId
+			&& (latest == end(_sentRequests)
+				|| i->second.offset > latest->second.offset)) {
+			latest = i;
+		}
+	}
+	if (latest == end(_sentRequests)) {
+		return false;
+	}
+	const auto requestId = latest->first;
+	MTP::cancel(requestId);
+	_preemptedRequests.push_front(finishSentRequest(requestId));
+	return true;
 }
 
 void mtpFileLoader::switchToCDN(
-		int offset,
+		const RequestData &requestData,
 		const MTPDupload_fileCdnRedirect &redirect) {
 	changeCDNParams(
-		offset,
+		requestData,
 		redirect.vdc_id().v,
 		redirect.vfile_token().v,
 		redirect.vencryption_key().v,
@@ -1138,7 +1823,7 @@ void mtpFileLoader::addCdnHashes(const QVector<MTPFileHash> &hashes) {
 }
 
 void mtpFileLoader::changeCDNParams(
-		int offset,
+		const RequestData &requestData,
 		MTP::DcId dcId,
 		const QByteArray &token,
 		const QByteArray &encryptionKey,
@@ -1163,19 +1848,18 @@ void mtpFileLoader::changeCDNParams(
 	addCdnHashes(hashes);
 
 	if (resendAllRequests && !_sentRequests.empty()) {
-		auto resendOffsets = std::vector<int>();
-		resendOffsets.reserve(_sentRequests.size());
+		auto resendRequests = std::vector<RequestData>();
+		resendRequests.reserve(_sentRequests.size());
 		while (!_sentRequests.empty()) {
 			auto requestId = _sentRequests.begin()->first;
 			MTP::cancel(requestId);
-			auto resendOffset = finishSentRequestGetOffset(requestId);
-			resendOffsets.push_back(resendOffset);
+			resendRequests.push_back(finishSentRequest(requestId));
 		}
-		for (auto resendOffset : resendOffsets) {
-			makeRequest(resendOffset);
+		for (const auto &resend : resendRequests) {
+			makeRequests(resend.offset, resend.limit);
 		}
 	}
-	makeRequest(offset);
+	makeRequests(requestData.offset, requestData.limit);
 }
 
 Storage::Cache::Key mtpFileLoader::cacheKey() const {
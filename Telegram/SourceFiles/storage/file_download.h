@@ -16,6 +16,10 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 class ApiWrap;
 
+namespace Local {
+struct PartialDownload;
+} // namespace Local
+
 namespace Main {
 class Session;
 } // namespace Main
@@ -41,6 +45,7 @@ public:
 		}
 		int queriesCount = 0;
 		int queriesLimit = 0;
+		int autoLoadingQueriesCount = 0;
 		FileLoader *start = nullptr;
 		FileLoader *end = nullptr;
 	};
@@ -62,12 +67,48 @@ public:
 	}
 
 	void requestedAmountIncrement(MTP::DcId dcId, int index, int amount);
+	void requestFinished(MTP::DcId dcId, int amount, crl::time duration);
 	int chooseDcIndexForRequest(MTP::DcId dcId) const;
 
+	// Parts to keep in flight to fill the bandwidth-delay product.
+	[[nodiscard]] int partsInFlightForDc(MTP::DcId dcId) const;
+
+	// Parts in Queue::queriesLimit are counted in the smallest part size.
+	[[nodiscard]] static int QueriesForPart(int partSize);
+
+	// Automatic downloads leave a part of the queries to the ones
+	// requested by the user, like opening a file or playing a video.
+	[[nodiscard]] static int AutoLoadingQueriesLimit(
+		not_null<const Queue*> queue);
+
 	not_null<Queue*> queueForDc(MTP::DcId dcId);
 	not_null<Queue*> queueForWeb();
 
 private:
+	struct DcSessions {
+		using Requested = std::array<int64, MTP::kMaxDownloadSessionsCount>;
+
+		Requested requested = { { 0 } };
+		int count = MTP::kDownloadSessionsCount;
+
+		// Measurements in the current window.
+		crl::time windowStart = 0;
+		int64 received = 0;
+		crl::time durationSum = 0;
+		int durationCount = 0;
+
+		crl::time minDuration = 0;
+		int64 bandwidth = 0;
+		int64 lastThroughput = 0;
+		int lastCount = 0;
+		crl::time increaseAllowed = 0;
+	};
+
+	DcSessions &sessionsForDc(MTP::DcId dcId);
+	void checkSessionsCount(MTP::DcId dcId, DcSessions &sessions);
+	[[nodiscard]] int queriesLimitForDc(MTP::DcId dcId) const;
+	void refreshQueriesLimit(MTP::DcId dcId);
+
 	void killDownloadSessionsStart(MTP::DcId dcId);
 	void killDownloadSessionsStop(MTP::DcId dcId);
 	void killDownloadSessions();
@@ -77,8 +118,7 @@ private:
 	base::Observable<void> _taskFinishedObservable;
 	int _priority = 1;
 
-	using RequestedInDc = std::array<int64, MTP::kDownloadSessionsCount>;
-	std::map<MTP::DcId, RequestedInDc> _requestedBytesAmount;
+	std::map<MTP::DcId, DcSessions> _sessions;
 
 	base::flat_map<MTP::DcId, crl::time> _killDownloadSessionTimes;
 	base::Timer _killDownloadSessionsTimer;
@@ -132,6 +172,9 @@ public:
 	}
 	QByteArray imageFormat(const QSize &shrinkBox = QSize()) const;
 	QImage imageData(const QSize &shrinkBox = QSize()) const;
+
+	// Partially decoded progressive JPEG, available while loading.
+	QImage takeProgressiveImage();
 	QString fileName() const {
 		return _filename;
 	}
@@ -182,7 +225,26 @@ protected:
 		Loaded,
 	};
 
+	struct ProgressiveJpeg {
+		int offset = 0;
+		int scans = 0;
+		int scansEnd = 0;
+		int scansDecoded = 0;
+		bool progressive = false;
+		bool inScan = false;
+		bool failed = false;
+	};
+
 	void readImage(const QSize &shrinkBox) const;
+	void decodeImageAndFinish();
+	void readBackAndFinish(bool putToCache);
+	void fileReadBack(QByteArray &&data, QByteArray &&cached);
+	void imageDecoded(QImage &&image, QByteArray &&format);
+	static void ParseProgressiveJpeg(
+		const QByteArray &data,
+		ProgressiveJpeg &state);
+	void checkProgressiveScans();
+	void progressiveDecoded(QImage &&image, int scans);
 
 	bool tryLoadLocal();
 	void loadLocal(const Storage::Cache::Key &key);
@@ -198,6 +260,23 @@ protected:
 	static void LoadNextFromQueue(not_null<Queue*> queue);
 	virtual bool loadPart() = 0;
 
+	// Loaders not painted since the last Downloader::clearPriorities()
+	// give their in-flight requests away to the currently shown ones.
+	[[nodiscard]] bool preemptStaleRequests();
+	virtual bool preemptRequest() {
+		return false;
+	}
+
+	// Loaders that request only the missing parts may resume
+	// a partially downloaded file after the app restart.
+	[[nodiscard]] virtual bool resumable() const;
+	[[nodiscard]] bool openFile();
+	[[nodiscard]] bool resumeFrom(const Local::PartialDownload &download);
+	[[nodiscard]] bool partLoadedBefore(int offset) const;
+	[[nodiscard]] int notLoadedSize(int offset, int maxSize) const;
+	void markPartLoaded(int offset, int size);
+	void forgetPartialDownload();
+
 	bool writeResultPart(int offset, bytes::const_span buffer);
 	bool finalizeResult();
 	[[nodiscard]] QByteArray readLoadedPartBack(int offset, int size);
@@ -218,6 +297,7 @@ protected:
 	QString _filename;
 	QFile _file;
 	bool _fileIsOpen = false;
+	QByteArray _loadedParts;
 
 	LoadToCacheSetting _toCache;
 	LoadFromCloudSetting _fromCloud;
@@ -229,6 +309,11 @@ protected:
 	LocationType _locationType = LocationType();
 
 	base::binary_guard _localLoading;
+	base::binary_guard _imageDecoding;
+	base::binary_guard _fileReadingBack;
+	ProgressiveJpeg _progressive;
+	base::binary_guard _progressiveDecoding;
+	QImage _progressiveImage;
 	mutable QByteArray _imageFormat;
 	mutable QImage _imageData;
 
@@ -280,6 +365,9 @@ private:
 		MTP::DcId dcId = 0;
 		int dcIndex = 0;
 		int offset = 0;
+		int limit = 0;
+		crl::time sent = 0;
+		bool autoLoading = false;
 	};
 	struct CdnFileHash {
 		CdnFileHash(int limit, QByteArray hash) : limit(limit), hash(hash) {
@@ -292,10 +380,15 @@ private:
 	void cancelRequests() override;
 
 	MTP::DcId dcId() const;
-	RequestData prepareRequest(int offset) const;
-	void makeRequest(int offset);
+	bool resumable() const override;
+	void skipLoadedParts();
+	RequestData prepareRequest(int offset, int limit) const;
+	[[nodiscard]] int partSize(int offset, int maxSize) const;
+	void makeRequest(int offset, int limit);
+	void makeRequests(int offset, int size);
 
 	bool loadPart() override;
+	bool preemptRequest() override;
 	void normalPartLoaded(const MTPupload_File &result, mtpRequestId requestId);
 	void webPartLoaded(const MTPupload_WebFile &result, mtpRequestId requestId);
 	void cdnPartLoaded(const MTPupload_CdnFile &result, mtpRequestId requestId);
@@ -312,10 +405,11 @@ private:
 
 	mtpRequestId sendRequest(const RequestData &requestData);
 	void placeSentRequest(mtpRequestId requestId, const RequestData &requestData);
+	RequestData finishSentRequest(mtpRequestId requestId);
 	int finishSentRequestGetOffset(mtpRequestId requestId);
-	void switchToCDN(int offset, const MTPDupload_fileCdnRedirect &redirect);
+	void switchToCDN(const RequestData &requestData, const MTPDupload_fileCdnRedirect &redirect);
 	void addCdnHashes(const QVector<MTPFileHash> &hashes);
-	void changeCDNParams(int offset, MTP::DcId dcId, const QByteArray &token, const QByteArray &encryptionKey, const QByteArray &encryptionIV, const QVector<MTPFileHash> &hashes);
+	void changeCDNParams(const RequestData &requestData, MTP::DcId dcId, const QByteArray &token, const QByteArray &encryptionKey, const QByteArray &encryptionIV, const QVector<MTPFileHash> &hashes);
 
 	enum class CheckCdnHashResult {
 		NoHash,
@@ -323,8 +417,16 @@ private:
 		Good,
 	};
 	CheckCdnHashResult checkCdnFileHash(int offset, bytes::const_span buffer);
+	CheckCdnHashResult checkCdnPartHash(
+		int offset,
+		bytes::const_span realHash);
+	void cdnPartDecrypted(
+		int offset,
+		QByteArray &&decrypted,
+		const bytes::vector &hash);
 
 	std::map<mtpRequestId, RequestData> _sentRequests;
+	std::deque<RequestData> _preemptedRequests;
 
 	bool _lastComplete = false;
 	int32 _nextRequestOffset = 0;
@@ -342,6 +444,7 @@ private:
 	QByteArray _cdnEncryptionIV;
 	std::map<int, CdnFileHash> _cdnFileHashes;
 	std::map<int, QByteArray> _cdnUncheckedParts;
+	int _cdnPartsDecrypting = 0;
 	mtpRequestId _cdnHashesRequestId = 0;
 
 };
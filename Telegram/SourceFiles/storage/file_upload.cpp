@@ -18,9 +18,16 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Storage {
 namespace {
 
-// max 512kb uploaded at the same time in each session
+// min 512kb uploaded at the same time in each session
 constexpr auto kMaxUploadFileParallelSize = MTP::kUploadSessionsCount * 512 * 1024;
 
+// up to 2mb in each session while the responses don't slow down
+constexpr auto kMaxUploadWindowSize = MTP::kUploadSessionsCount * 2048 * 1024;
+constexpr auto kUploadWindowStep = 128 * 1024;
+
+// How much of the document parts are read and hashed ahead.
+constexpr auto kMaxPrefetchSize = 4 * 1024 * 1024;
+
 constexpr auto kDocumentMaxPartsCount = 3000;
 
 // 32kb for tiny document ( < 1mb )
@@ -44,6 +51,172 @@ constexpr auto kUploadRequestInterval = crl::time(500);
 // How much time without upload causes additional session kill.
 constexpr auto kKillSessionTimeout = crl::time(5000);
 
+// Reads and hashes the document parts ahead in a background thread.
+class PartsReader final {
+public:
+	PartsReader(
+		const QString &path,
+		int partSize,
+		int partsCount,
+		bool hash,
+		Fn<void()> ready);
+	PartsReader(const PartsReader &other) = delete;
+	PartsReader &operator=(const PartsReader &other) = delete;
+	~PartsReader();
+
+	[[nodiscard]] std::optional<QByteArray> take();
+	[[nodiscard]] bool failed() const;
+	[[nodiscard]] QByteArray md5Hex() const;
+
+private:
+	struct State {
+		QFile file;
+		HashMd5 md5;
+		int partSize = 0;
+		int partsCount = 0;
+		bool hash = false;
+		Fn<void()> ready;
+
+		mutable QMutex mutex;
+		std::deque<QByteArray> parts;
+		QByteArray md5Hex;
+		int size = 0;
+		int readParts = 0;
+		bool reading = false;
+		bool failed = false;
+		bool stopped = false;
+	};
+
+	static void Read(const std::shared_ptr<State> &state);
+	static void Notify(const std::shared_ptr<State> &state);
+
+	std::shared_ptr<State> _state;
+
+};
+
+PartsReader::PartsReader(
+	const QString &path,
+	int partSize,
+	int partsCount,
+	bool hash,
+	Fn<void()> ready)
+: _state(std::make_shared<State>()) {
+	_state->file.setFileName(path);
+	_state->partSize = partSize;
+	_state->partsCount = partsCount;
+	_state->hash = hash;
+	_state->ready = std::move(ready);
+	_state->reading = true;
+	crl::async([state = _state] { Read(state); });
+}
+
+PartsReader::~PartsReader() {
+	QMutexLocker lock(&_state->mutex);
+	_state->stopped = true;
+}
+
+std::optional<QByteArray> PartsReader::take() {
+	auto result = std::optional<QByteArray>();
+	auto start = false;
+	{
+		QMutexLocker lock(&_state->mutex);
+		if (!_state->parts.empty()) {
+			result = std::move(_state->parts.front());
+			_state->parts.pop_front();
+			_state->size -= result->size();
+		}
+		if (!_state->reading
+			&& !_state->failed
+			&& _state->readParts < _state->partsCount
+			&& _state->size < kMaxPrefetchSize) {
+			_state->reading = start = true;
+		}
+	}
+	if (start) {
+		crl::async([state = _state] { Read(state); });
+	}
+	return result;
+}
+
+bool PartsReader::failed() const {
+	QMutexLocker lock(&_state->mutex);
+	return _state->failed;
+}
+
+QByteArray PartsReader::md5Hex() const {
+	QMutexLocker lock(&_state->mutex);
+	return _state->md5Hex;
+}
+
+void PartsReader::Read(const std::shared_ptr<State> &state) {
+	// Only one reader at a time works with the file and the hash.
+	if (!state->file.isOpen() && !state->file.open(QIODevice::ReadOnly)) {
+		{
+			QMutexLocker lock(&state->mutex);
+			state->failed = true;
+			state->reading = false;
+		}
+		Notify(state);
+		return;
+	}
+	while (true) {
+		auto index = 0;
+		{
+			QMutexLocker lock(&state->mutex);
+			if (state->stopped
+				|| state->readParts == state->partsCount
+				|| state->size >= kMaxPrefetchSize) {
+				state->reading = false;
+				return;
+			}
+			index = state->readParts;
+		}
+		auto part = state->file.read(state->partSize);
+		const auto last = (index + 1 == state->partsCount);
+		const auto good = (part.size() <= state->partSize)
+			&& (part.size() == state->partSize || last);
+		auto md5Hex = QByteArray();
+		if (good && state->hash) {
+			state->md5.feed(part.constData(), part.size());
+			if (last) {
+				md5Hex.resize(32);
+				hashMd5Hex(state->md5.result(), md5Hex.data());
+			}
+		}
+		auto notify = !good;
+		{
+			QMutexLocker lock(&state->mutex);
+			if (!good) {
+				state->failed = true;
+				state->reading = false;
+			} else {
+				notify = state->parts.empty();
+				state->size += part.size();
+				state->parts.push_back(std::move(part));
+				++state->readParts;
+				if (last) {
+					state->md5Hex = md5Hex;
+				}
+			}
+		}
+		if (notify) {
+			Notify(state);
+		}
+		if (!good) {
+			return;
+		}
+	}
+}
+
+void PartsReader::Notify(const std::shared_ptr<State> &state) {
+	crl::on_main([=] {
+		// The reader is destroyed in the main thread before its owner.
+		if (!state->stopped) {
+			state->ready();
+		}
+	});
+}
+
 } // namespace
 
 struct Uploader::File {
@@ -65,7 +238,7 @@ struct Uploader::File {
 
 	HashMd5 md5Hash;
 
-	std::unique_ptr<QFile> docFile;
+	std::unique_ptr<PartsReader> docReader;
 	int32 docSentParts = 0;
 	int32 docSize = 0;
 	int32 docPartSize = 0;
@@ -142,6 +315,7 @@ const QString &Uploader::File::filename() const {
 
 Uploader::Uploader(not_null<ApiWrap*> api)
 : _api(api) {
+	_windowSize = kMaxUploadFileParallelSize;
 	nextTimer.setSingleShot(true);
 	connect(&nextTimer, SIGNAL(timeout()), this, SLOT(sendNext()));
 	stopSessionsTimer.setSingleShot(true);
@@ -235,6 +409,7 @@ void Uploader::currentFailed() {
 	requestsSent.clear();
 	docRequestsSent.clear();
 	dcMap.clear();
+	_sentAt.clear();
 	uploadingId = FullMsgId();
 	sentSize = 0;
 	for (int i = 0; i < MTP::kUploadSessionsCount; ++i) {
@@ -251,7 +426,7 @@ void Uploader::stopSessions() {
 }
 
 void Uploader::sendNext() {
-	if (sentSize >= kMaxUploadFileParallelSize || _pausedId.msg) return;
+	if (sentSize >= _windowSize || _pausedId.msg) return;
 
 	bool stopping = stopSessionsTimer.isActive();
 	if (queue.empty()) {
@@ -321,8 +496,15 @@ void Uploader::sendNext() {
 				} else if (uploadingData.type() == SendMediaType::File
 					|| uploadingData.type() == SendMediaType::ThemeFile
 					|| uploadingData.type() == SendMediaType::Audio) {
-					QByteArray docMd5(32, Qt::Uninitialized);
-					hashMd5Hex(uploadingData.md5Hash.result(), docMd5.data());
+					auto docMd5 = QByteArray();
+					if (uploadingData.docReader) {
+						docMd5 = uploadingData.docReader->md5Hex();
+					} else {
+						docMd5.resize(32);
+						hashMd5Hex(
+							uploadingData.md5Hash.result(),
+							docMd5.data());
+					}
 
 					const auto file = (uploadingData.docSize > kUseBigFilesFrom)
 						? MTP_inputFileBig(
@@ -377,20 +559,27 @@ void Uploader::sendNext() {
 			: uploadingData.media.data;
 		QByteArray toSend;
 		if (content.isEmpty()) {
-			if (!uploadingData.docFile) {
+			if (!uploadingData.docReader) {
 				const auto filepath = uploadingData.file
 					? uploadingData.file->filepath
 					: uploadingData.media.file;
-				uploadingData.docFile = std::make_unique<QFile>(filepath);
-				if (!uploadingData.docFile->open(QIODevice::ReadOnly)) {
-					currentFailed();
-					return;
-				}
+				uploadingData.docReader = std::make_unique<PartsReader>(
+					filepath,
+					uploadingData.docPartSize,
+					uploadingData.docPartsCount,
+					(uploadingData.docSize <= kUseBigFilesFrom),
+					[=] { sendNext(); });
 			}
-			toSend = uploadingData.docFile->read(uploadingData.docPartSize);
-			if (uploadingData.docSize <= kUseBigFilesFrom) {
-				uploadingData.md5Hash.feed(toSend.constData(), toSend.size());
+			if (uploadingData.docReader->failed()) {
+				currentFailed();
+				return;
+			}
+			auto part = uploadingData.docReader->take();
+			if (!part) {
+				// We'll be notified when the next part is read.
+				return;
 			}
+			toSend = std::move(*part);
 		} else {
 			const auto offset = uploadingData.docSentParts
 				* uploadingData.docPartSize;
@@ -431,6 +620,7 @@ void Uploader::sendNext() {
 		}
 		docRequestsSent.emplace(requestId, uploadingData.docSentParts);
 		dcMap.emplace(requestId, todc);
+		_sentAt.emplace(requestId, crl::now());
 		sentSize += uploadingData.docPartSize;
 		sentSizes[todc] += uploadingData.docPartSize;
 
@@ -448,11 +638,16 @@ void Uploader::sendNext() {
 			MTP::uploadDcId(todc));
 		requestsSent.emplace(requestId, part.value());
 		dcMap.emplace(requestId, todc);
+		_sentAt.emplace(requestId, crl::now());
 		sentSize += part.value().size();
 		sentSizes[todc] += part.value().size();
 
 		parts.erase(part);
 	}
+	if (sentSize < _windowSize) {
+		// Keep the window full without waiting for the timer.
+		crl::on_main(this, [=] { sendNext(); });
+	}
 	nextTimer.start(kUploadRequestInterval);
 }
 
@@ -489,6 +684,9 @@ void Uploader::clear() {
 	}
 	docRequestsSent.clear();
 	dcMap.clear();
+	_sentAt.clear();
+	_windowSize = kMaxUploadFileParallelSize;
+	_minRequestDuration = 0;
 	sentSize = 0;
 	for (int i = 0; i < MTP::kUploadSessionsCount; ++i) {
 		MTP::stopSession(MTP::uploadDcId(i));
@@ -515,6 +713,9 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 			}
 			auto dc = dcIt->second;
 			dcMap.erase(dcIt);
+			if (const auto sentAt = _sentAt.take(requestId)) {
+				updateWindow(crl::now() - *sentAt);
+			}
 
 			int32 sentPartSize = 0;
 			auto k = queue.find(uploadingId);
@@ -562,6 +763,24 @@ void Uploader::partLoaded(const MTPBool &result, mtpRequestId requestId) {
 	sendNext();
 }
 
+void Uploader::updateWindow(crl::time duration) {
+	// Grow the window while the parts are saved as fast as the best
+	// ones were and shrink it back when the requests start to queue up.
+	duration = std::max(duration, crl::time(1));
+	if (!_minRequestDuration || duration < _minRequestDuration) {
+		_minRequestDuration = duration;
+	}
+	if (duration * 2 <= _minRequestDuration * 3) {
+		_windowSize = std::min(
+			_windowSize + kUploadWindowStep,
+			uint32(kMaxUploadWindowSize));
+	} else if (duration >= _minRequestDuration * 3) {
+		_windowSize = std::max(
+			_windowSize - std::min(_windowSize, uint32(kUploadWindowStep)),
+			uint32(kMaxUploadFileParallelSize));
+	}
+}
+
 bool Uploader::partFailed(const RPCError &error, mtpRequestId requestId) {
 	if (MTP::isDefaultHandledError(error)) return false;
 
@@ -113,6 +113,7 @@ private:
 	bool partFailed(const RPCError &err, mtpRequestId requestId);
 
 	void currentFailed();
+	void updateWindow(crl::time duration);
 
 	not_null<ApiWrap*> _api;
 	base::flat_map<mtpRequestId, QByteArray> requestsSent;
@@ -120,6 +121,9 @@ private:
 	base::flat_map<mtpRequestId, int32> dcMap;
 	uint32 sentSize = 0;
 	uint32 sentSizes[MTP::kUploadSessionsCount] = { 0 };
+	base::flat_map<mtpRequestId, crl::time> _sentAt;
+	uint32 _windowSize = 0;
+	crl::time _minRequestDuration = 0;
 
 	FullMsgId uploadingId;
 	FullMsgId _pausedId;
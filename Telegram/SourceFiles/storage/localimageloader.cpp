@@ -146,6 +146,21 @@ MTPInputSingleMedia PrepareAlbumItemMedia(
 		sentEntities);
 }
 
+// A local file is identified by its path, size and modification time,
+// so that it is not read twice, data from memory by its MD5.
+QByteArray ComputeContentKey(const QFileInfo &info, const QByteArray &content) {
+	if (info.exists()) {
+		return "file:"
+			+ info.absoluteFilePath().toUtf8()
+			+ ':' + QByteArray::number(info.size())
+			+ ':' + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+	} else if (content.isEmpty()) {
+		return QByteArray();
+	}
+	auto md5 = QByteArray(32, Qt::Uninitialized);
+	hashMd5Hex(content.constData(), content.size(), md5.data());
+	return "data:" + md5 + ':' + QByteArray::number(content.size());
+}
 
 } // namespace
 
@@ -245,7 +260,8 @@ SendMediaReady PreparePeerPhoto(PeerId peerId, QImage &&image) {
 		0);
 }
 
-TaskQueue::TaskQueue(crl::time stopTimeoutMs) {
+TaskQueue::TaskQueue(crl::time stopTimeoutMs, int workersCount)
+: _workersCount(std::max(workersCount, 1)) {
 	if (stopTimeoutMs > 0) {
 		_stopTimer = new QTimer(this);
 		connect(_stopTimer, SIGNAL(timeout()), this, SLOT(stop()));
@@ -278,16 +294,19 @@ void TaskQueue::addTasks(std::vector<std::unique_ptr<Task>> &&tasks) {
 }
 
 void TaskQueue::wakeThread() {
-	if (!_thread) {
-		_thread = new QThread();
-
-		_worker = new TaskQueueWorker(this);
-		_worker->moveToThread(_thread);
-
-		connect(this, SIGNAL(taskAdded()), _worker, SLOT(onTaskAdded()));
-		connect(_worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
-
-		_thread->start();
+	if (_threads.empty()) {
+		for (auto i = 0; i != _workersCount; ++i) {
+			const auto thread = new QThread();
+			const auto worker = new TaskQueueWorker(this);
+			worker->moveToThread(thread);
+
+			connect(this, SIGNAL(taskAdded()), worker, SLOT(onTaskAdded()));
+			connect(worker, SIGNAL(taskProcessed()), this, SLOT(onTaskProcessed()));
+
+			thread->start();
+			_threads.push_back(thread);
+			_workers.push_back(worker);
+		}
 	}
 	if (_stopTimer) _stopTimer->stop();
 	emit taskAdded();
@@ -303,15 +322,43 @@ void TaskQueue::cancelTask(TaskId id) {
 			queue.erase(i);
 		}
 	};
+	auto finishProcessed = false;
 	{
 		QMutexLocker lock(&_tasksToProcessMutex);
 		removeFrom(_tasksToProcess);
-		if (_taskInProcessId == id) {
-			_taskInProcessId = TaskId();
+		const auto i = ranges::find(_tasksInProcess, id);
+		if (i != _tasksInProcess.end()) {
+			_tasksInProcess.erase(i);
+			_tasksProcessed.remove(id);
+
+			// The cancelled task could hold the processed ones after it.
+			finishProcessed = moveProcessedToFinish();
 		}
 	}
+	{
+		QMutexLocker lock(&_tasksToFinishMutex);
+		removeFrom(_tasksToFinish);
+	}
+	if (finishProcessed) {
+		crl::on_main(this, [=] { onTaskProcessed(); });
+	}
+}
+
+bool TaskQueue::moveProcessedToFinish() {
 	QMutexLocker lock(&_tasksToFinishMutex);
-	removeFrom(_tasksToFinish);
+	const auto wasEmpty = _tasksToFinish.empty();
+	auto moved = false;
+	while (!_tasksInProcess.empty()) {
+		const auto i = _tasksProcessed.find(_tasksInProcess.front());
+		if (i == _tasksProcessed.end()) {
+			break;
+		}
+		_tasksToFinish.push_back(std::move(i->second));
+		_tasksProcessed.erase(i);
+		_tasksInProcess.pop_front();
+		moved = true;
+	}
+	return wasEmpty && moved;
 }
 
 void TaskQueue::onTaskProcessed() {
@@ -328,24 +375,33 @@ void TaskQueue::onTaskProcessed() {
 
 	if (_stopTimer) {
 		QMutexLocker lock(&_tasksToProcessMutex);
-		if (_tasksToProcess.empty() && !_taskInProcessId) {
+		if (_tasksToProcess.empty() && _tasksInProcess.empty()) {
 			_stopTimer->start();
 		}
 	}
 }
 
 void TaskQueue::stop() {
-	if (_thread) {
-		_thread->requestInterruption();
-		_thread->quit();
+	for (const auto thread : _threads) {
+		thread->requestInterruption();
+		thread->quit();
+	}
+	if (!_threads.empty()) {
 		DEBUG_LOG(("Waiting for taskThread to finish"));
-		_thread->wait();
-		delete base::take(_worker);
-		delete base::take(_thread);
+	}
+	for (const auto thread : _threads) {
+		thread->wait();
+	}
+	for (const auto worker : base::take(_workers)) {
+		delete worker;
+	}
+	for (const auto thread : base::take(_threads)) {
+		delete thread;
 	}
 	_tasksToProcess.clear();
 	_tasksToFinish.clear();
-	_taskInProcessId = TaskId();
+	_tasksInProcess.clear();
+	_tasksProcessed.clear();
 }
 
 TaskQueue::~TaskQueue() {
@@ -365,7 +421,7 @@ void TaskQueueWorker::onTaskAdded() {
 			if (!_queue->_tasksToProcess.empty()) {
 				task = std::move(_queue->_tasksToProcess.front());
 				_queue->_tasksToProcess.pop_front();
-				_queue->_taskInProcessId = task->id();
+				_queue->_tasksInProcess.push_back(task->id());
 			}
 		}
 
@@ -374,14 +430,13 @@ void TaskQueueWorker::onTaskAdded() {
 			bool emitTaskProcessed = false;
 			{
 				QMutexLocker lockToProcess(&_queue->_tasksToProcessMutex);
-				if (_queue->_taskInProcessId == task->id()) {
-					_queue->_taskInProcessId = TaskId();
-					someTasksLeft = !_queue->_tasksToProcess.empty();
-
-					QMutexLocker lockToFinish(&_queue->_tasksToFinishMutex);
-					emitTaskProcessed = _queue->_tasksToFinish.empty();
-					_queue->_tasksToFinish.push_back(std::move(task));
+				const auto id = task->id();
+				const auto &inProcess = _queue->_tasksInProcess;
+				if (ranges::find(inProcess, id) != inProcess.end()) {
+					_queue->_tasksProcessed.emplace(id, std::move(task));
+					emitTaskProcessed = _queue->moveProcessedToFinish();
 				}
+				someTasksLeft = !_queue->_tasksToProcess.empty();
 			}
 			if (emitTaskProcessed) {
 				emit taskProcessed();
@@ -921,6 +976,10 @@ void FileLoadTask::process() {
 		_type = SendMediaType::File;
 	}
 
+	if (_type == SendMediaType::File && !_album && _msgIdToEdit <= 0) {
+		_result->contentKey = ComputeContentKey(info, _content);
+	}
+
 	_result->type = _type;
 	_result->filepath = _filepath;
 	_result->content = _content;
@@ -105,7 +105,10 @@ class TaskQueue : public QObject {
 	Q_OBJECT
 
 public:
-	explicit TaskQueue(crl::time stopTimeoutMs = 0); // <= 0 - never stop worker
+	// stopTimeoutMs <= 0 - never stop workers.
+	// With several workers the tasks are processed in parallel,
+	// but finish() is still called in the order the tasks were added.
+	explicit TaskQueue(crl::time stopTimeoutMs = 0, int workersCount = 1);
 
 	TaskId addTask(std::unique_ptr<Task> &&task);
 	void addTasks(std::vector<std::unique_ptr<Task>> &&tasks);
@@ -125,12 +128,17 @@ private:
 
 	void wakeThread();
 
+	// Requires _tasksToProcessMutex locked.
+	[[nodiscard]] bool moveProcessedToFinish();
+
 	std::deque<std::unique_ptr<Task>> _tasksToProcess;
 	std::deque<std::unique_ptr<Task>> _tasksToFinish;
-	TaskId _taskInProcessId = TaskId();
+	std::deque<TaskId> _tasksInProcess;
+	base::flat_map<TaskId, std::unique_ptr<Task>> _tasksProcessed;
 	QMutex _tasksToProcessMutex, _tasksToFinishMutex;
-	QThread *_thread = nullptr;
-	TaskQueueWorker *_worker = nullptr;
+	int _workersCount = 1;
+	std::vector<QThread*> _threads;
+	std::vector<TaskQueueWorker*> _workers;
 	QTimer *_stopTimer = nullptr;
 
 };
@@ -213,6 +221,9 @@ struct FileLoadResult {
 	QByteArray filemd5;
 	int32 partssize;
 
+	// Same for the same file content, empty if it can't be sent as is.
+	QByteArray contentKey;
+
 	uint64 thumbId = 0; // id is always file-id of media, thumbId is file-id of thumb ( == id for photos)
 	QString thumbname;
 	UploadFileParts thumbparts;
@@ -30,6 +30,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "media/audio/media_audio.h"
 #include "mtproto/dc_options.h"
 #include "core/application.h"
+#include "core/core_trace.h"
 #include "apiwrap.h"
 #include "main/main_session.h"
 #include "window/themes/window_theme.h"
@@ -44,6 +45,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 extern "C" {
 #include <openssl/evp.h>
+#include <lz4.h>
 } // extern "C"
 
 namespace Local {
@@ -54,8 +56,17 @@ constexpr auto kFileLoaderQueueStopTimeout = crl::time(5000);
 constexpr auto kDefaultStickerInstallDate = TimeId(1);
 constexpr auto kProxyTypeShift = 1024;
 constexpr auto kWriteMapTimeout = crl::time(1000);
+constexpr auto kWriteDelayedTimeout = crl::time(3000);
+constexpr auto kCacheCompactBytesPerSecond = int64(8 * 1024 * 1024);
+constexpr auto kCacheWriteCombinedSizeLimit = 128 * 1024;
 constexpr auto kSavedBackgroundFormat = QImage::Format_ARGB32_Premultiplied;
 
+// Large files may be LZ4-compressed before encryption, the high bit of
+// the decrypted length marks them. The original size follows the length.
+constexpr auto kCompressedDataFlag = uint32(0x80000000U);
+constexpr auto kCompressMinSize = 16 * 1024;
+constexpr auto kCompressedSizeLimit = uint32(64 * 1024 * 1024);
+
 constexpr auto kWallPaperLegacySerializeTagId = int32(-111);
 constexpr auto kWallPaperSerializeTagId = int32(-112);
 constexpr auto kWallPaperSidesLimit = 10'000;
@@ -103,6 +114,28 @@ bool _userWorking() {
 	return _manager && !_basePath.isEmpty() && !_userBasePath.isEmpty();
 }
 
+// Sticker sets and saved gifs change many times in a row while used,
+// so their files are written once for all the changes, a bit later.
+base::flat_set<void(*)()> _delayedWrites;
+
+void _writeDelayed(void(*method)()) {
+	if (!_manager) {
+		return;
+	}
+	_delayedWrites.emplace(method);
+	_manager->writeDelayed();
+}
+
+void _writeDelayedNow() {
+	if (!Main::Session::Exists()) {
+		_delayedWrites.clear();
+		return;
+	}
+	for (const auto method : base::take(_delayedWrites)) {
+		method();
+	}
+}
+
 enum class FileOption {
 	User = (1 << 0),
 	Safe = (1 << 1),
@@ -233,6 +266,8 @@ struct EncryptedDescriptor {
 	}
 };
 
+void _dropPrefetchedFile(const QString &path);
+
 struct FileWriteDescriptor {
 	FileWriteDescriptor(const FileKey &key, FileOptions options = FileOption::User | FileOption::Safe) {
 		init(toFilePart(key), options);
@@ -246,6 +281,9 @@ struct FileWriteDescriptor {
 		} else {
 			if (!_working()) return;
 		}
+		_dropPrefetchedFile(
+			((options & FileOption::User) ? _userBasePath : _basePath)
+			+ name);
 
 		// detect order of read attempts and file version
 		QString toTry[2];
@@ -293,9 +331,34 @@ struct FileWriteDescriptor {
 
 		return true;
 	}
-	static QByteArray prepareEncrypted(EncryptedDescriptor &data, const MTP::AuthKeyPtr &key = LocalKey) {
+	static bool compress(QByteArray &data) {
+		const auto original = data.size() - int(sizeof(uint32));
+		if (original < kCompressMinSize) {
+			return false;
+		}
+		const auto header = int(2 * sizeof(uint32));
+		auto compressed = QByteArray(
+			header + LZ4_compressBound(original),
+			Qt::Uninitialized);
+		const auto size = LZ4_compress_default(
+			data.constData() + sizeof(uint32),
+			compressed.data() + header,
+			original,
+			compressed.size() - header);
+		if (size <= 0 || header + size >= data.size()) {
+			return false;
+		}
+		compressed.resize(header + size);
+		*(uint32*)(compressed.data() + sizeof(uint32)) = uint32(original);
+		data = std::move(compressed);
+		return true;
+	}
+	static QByteArray prepareEncrypted(EncryptedDescriptor &data, const MTP::AuthKeyPtr &key = LocalKey, bool compressed = false) {
 		data.finish();
 		QByteArray &toEncrypt(data.data);
+		if (compressed) {
+			compressed = compress(toEncrypt);
+		}
 
 		// prepare for encryption
 		uint32 size = toEncrypt.size(), fullSize = size;
@@ -304,7 +367,9 @@ struct FileWriteDescriptor {
 			toEncrypt.resize(fullSize);
 			memset_rand(toEncrypt.data() + size, fullSize - size);
 		}
-		*(uint32*)toEncrypt.data() = size;
+		*(uint32*)toEncrypt.data() = compressed
+			? (size | kCompressedDataFlag)
+			: size;
 		QByteArray encrypted(0x10 + fullSize, Qt::Uninitialized); // 128bit of sha1 - key128, sizeof(data), data
 		hashSha1(toEncrypt.constData(), toEncrypt.size(), encrypted.data());
 		MTP::aesEncryptLocal(toEncrypt.constData(), encrypted.data() + 0x10, fullSize, key, encrypted.constData());
@@ -314,9 +379,13 @@ struct FileWriteDescriptor {
 	bool writeEncrypted(EncryptedDescriptor &data, const MTP::AuthKeyPtr &key = LocalKey) {
 		return writeData(prepareEncrypted(data, key));
 	}
+	bool writeEncryptedCompressed(EncryptedDescriptor &data) {
+		return writeData(prepareEncrypted(data, LocalKey, true));
+	}
 	void finish() {
 		if (!file.isOpen()) return;
 
+		const auto trace = Core::Trace::Scope("Local::FileWriteDescriptor");
 		stream.setDevice(nullptr);
 
 		md5.feed(&dataSize, sizeof(dataSize));
@@ -343,20 +412,23 @@ struct FileWriteDescriptor {
 	}
 };
 
-bool readFile(FileReadDescriptor &result, const QString &name, FileOptions options = FileOption::User | FileOption::Safe) {
-	if (options & FileOption::User) {
-		if (!_userWorking()) return false;
-	} else {
-		if (!_working()) return false;
-	}
+struct RawFile {
+	QByteArray data;
+	qint32 version = 0;
+};
 
+// Doesn't touch any global state, so it can be called from any thread.
+std::optional<RawFile> ReadRawFile(
+		const QString &base,
+		const QString &name,
+		FileOptions options) {
 	// detect order of read attempts
 	QString toTry[2];
-	toTry[0] = ((options & FileOption::User) ? _userBasePath : _basePath) + name + '0';
+	toTry[0] = base + name + '0';
 	if (options & FileOption::Safe) {
 		QFileInfo toTry0(toTry[0]);
 		if (toTry0.exists()) {
-			toTry[1] = ((options & FileOption::User) ? _userBasePath : _basePath) + name + '1';
+			toTry[1] = base + name + '1';
 			QFileInfo toTry1(toTry[1]);
 			if (toTry1.exists()) {
 				QDateTime mod0 = toTry0.lastModified(), mod1 = toTry1.lastModified();
@@ -422,22 +494,112 @@ bool readFile(FileReadDescriptor &result, const QString &name, FileOptions optio
 		}
 
 		bytes.resize(dataSize);
-		result.data = bytes;
-		bytes = QByteArray();
-
-		result.version = version;
-		result.buffer.setBuffer(&result.data);
-		result.buffer.open(QIODevice::ReadOnly);
-		result.stream.setDevice(&result.buffer);
-		result.stream.setVersion(QDataStream::Qt_5_1);
 
 		if ((i == 0 && !toTry[1].isEmpty()) || i == 1) {
 			QFile::remove(toTry[1 - i]);
 		}
 
-		return true;
+		return RawFile{ std::move(bytes), version };
 	}
-	return false;
+	return std::nullopt;
+}
+
+// Files needed at start are read on worker threads, all at once,
+// while the main thread decrypts and parses the ones it already has.
+struct PrefetchedFile {
+	FileOptions options;
+	std::optional<RawFile> result;
+	crl::semaphore ready;
+};
+base::flat_map<QString, std::shared_ptr<PrefetchedFile>> _prefetchedFiles;
+
+QString _filesBasePath(FileOptions options) {
+	return (options & FileOption::User) ? _userBasePath : _basePath;
+}
+
+void _prefetchFile(
+		const QString &name,
+		FileOptions options = FileOption::User | FileOption::Safe) {
+	const auto base = _filesBasePath(options);
+	const auto file = std::make_shared<PrefetchedFile>();
+	file->options = options;
+	_prefetchedFiles.emplace(base + name, file);
+	crl::async([=] {
+		file->result = ReadRawFile(base, name, options);
+		file->ready.release();
+	});
+}
+
+std::shared_ptr<PrefetchedFile> _takePrefetchedFile(const QString &path) {
+	const auto i = _prefetchedFiles.find(path);
+	if (i == end(_prefetchedFiles)) {
+		return nullptr;
+	}
+	auto result = std::move(i->second);
+	_prefetchedFiles.erase(i);
+	result->ready.acquire();
+	return result;
+}
+
+void _dropPrefetchedFile(const QString &path) {
+	_takePrefetchedFile(path);
+}
+
+void _clearPrefetchedFiles() {
+	for (const auto &[path, file] : base::take(_prefetchedFiles)) {
+		file->ready.acquire();
+	}
+}
+
+bool readFile(FileReadDescriptor &result, const QString &name, FileOptions options = FileOption::User | FileOption::Safe) {
+	if (options & FileOption::User) {
+		if (!_userWorking()) return false;
+	} else {
+		if (!_working()) return false;
+	}
+
+	const auto base = _filesBasePath(options);
+	const auto prefetched = _takePrefetchedFile(base + name);
+	auto raw = (prefetched && prefetched->options == options)
+		? std::move(prefetched->result)
+		: ReadRawFile(base, name, options);
+	if (!raw) {
+		return false;
+	}
+
+	result.data = std::move(raw->data);
+	result.version = raw->version;
+	result.buffer.setBuffer(&result.data);
+	result.buffer.open(QIODevice::ReadOnly);
+	result.stream.setDevice(&result.buffer);
+	result.stream.setVersion(QDataStream::Qt_5_1);
+	return true;
+}
+
+bool decompressLocal(QByteArray &data) {
+	const auto header = int(2 * sizeof(uint32));
+	if (data.size() <= header) {
+		LOG(("App Error: bad compressed part size: %1").arg(data.size()));
+		return false;
+	}
+	const auto original = *(const uint32*)(data.constData() + sizeof(uint32));
+	if (!original || original > kCompressedSizeLimit) {
+		LOG(("App Error: bad uncompressed part size: %1").arg(original));
+		return false;
+	}
+	auto result = QByteArray(sizeof(uint32) + original, Qt::Uninitialized);
+	const auto size = LZ4_decompress_safe(
+		data.constData() + header,
+		result.data() + sizeof(uint32),
+		data.size() - header,
+		int(original));
+	if (size != int(original)) {
+		LOG(("App Error: could not decompress part, result: %1").arg(size));
+		return false;
+	}
+	*(uint32*)result.data() = uint32(result.size());
+	data = std::move(result);
+	return true;
 }
 
 bool decryptLocal(EncryptedDescriptor &result, const QByteArray &encrypted, const MTP::AuthKeyPtr &key = LocalKey) {
@@ -458,12 +620,19 @@ bool decryptLocal(EncryptedDescriptor &result, const QByteArray &encrypted, cons
 	}
 
 	uint32 dataLen = *(const uint32*)decrypted.constData();
+	const auto compressed = (dataLen & kCompressedDataFlag) != 0;
+	dataLen &= ~kCompressedDataFlag;
 	if (dataLen > uint32(decrypted.size()) || dataLen <= fullLen - 16 || dataLen < sizeof(uint32)) {
 		LOG(("App Error: bad decrypted part size: %1, fullLen: %2, decrypted size: %3").arg(dataLen).arg(fullLen).arg(decrypted.size()));
 		return false;
 	}
 
 	decrypted.resize(dataLen);
+	if (compressed) {
+		if (!decompressLocal(decrypted)) {
+			return false;
+		}
+	}
 	result.data = decrypted;
 	decrypted = QByteArray();
 
@@ -535,6 +704,7 @@ enum { // Local Storage Keys
 	lskExportSettings = 0x13, // no data
 	lskBackground = 0x14, // no data
 	lskSelfSerialized = 0x15, // serialized self
+	lskPartialDownloads = 0x16, // no data
 };
 
 enum {
@@ -696,6 +866,10 @@ bool NoTimeLimit(qint32 storedLimitValue) {
 
 FileKey _exportSettingsKey = 0;
 
+FileKey _partialDownloadsKey = 0;
+std::map<MediaKey, PartialDownload> _partialDownloads;
+bool _partialDownloadsRead = false;
+
 FileKey _langPackKey = 0;
 FileKey _languagesKey = 0;
 
@@ -788,7 +962,7 @@ void _writeLocations(WriteMapWhen when = WriteMapWhen::Soon) {
 		}
 
 		FileWriteDescriptor file(_locationsKey);
-		file.writeEncrypted(data);
+		file.writeEncryptedCompressed(data);
 	}
 }
 
@@ -2267,6 +2441,7 @@ ReadMapState _readMap(const QByteArray &pass) {
 	quint64 savedGifsKey = 0;
 	quint64 backgroundKeyDay = 0, backgroundKeyNight = 0;
 	quint64 userSettingsKey = 0, recentHashtagsAndBotsKey = 0, exportSettingsKey = 0;
+	quint64 partialDownloadsKey = 0;
 	while (!map.stream.atEnd()) {
 		quint32 keyType;
 		map.stream >> keyType;
@@ -2358,6 +2533,9 @@ ReadMapState _readMap(const QByteArray &pass) {
 		case lskExportSettings: {
 			map.stream >> exportSettingsKey;
 		} break;
+		case lskPartialDownloads: {
+			map.stream >> partialDownloadsKey;
+		} break;
 		default:
 		LOG(("App Error: unknown key type in encrypted map: %1").arg(keyType));
 		return ReadMapFailed;
@@ -2385,6 +2563,7 @@ ReadMapState _readMap(const QByteArray &pass) {
 	_userSettingsKey = userSettingsKey;
 	_recentHashtagsAndBotsKey = recentHashtagsAndBotsKey;
 	_exportSettingsKey = exportSettingsKey;
+	_partialDownloadsKey = partialDownloadsKey;
 	_oldMapVersion = mapData.version;
 	if (_oldMapVersion < AppVersion) {
 		_mapChanged = true;
@@ -2393,6 +2572,21 @@ ReadMapState _readMap(const QByteArray &pass) {
 		_mapChanged = false;
 	}
 
+	const auto prefetch = [](FileKey key) {
+		if (key) {
+			_prefetchFile(toFilePart(key));
+		}
+	};
+	prefetch(_locationsKey);
+	prefetch(_userSettingsKey);
+	_prefetchFile(toFilePart(_dataNameKey), FileOption::Safe);
+	prefetch(_installedStickersKey);
+	prefetch(_featuredStickersKey);
+	prefetch(_recentStickersKey);
+	prefetch(_favedStickersKey);
+	prefetch(_savedGifsKey);
+	prefetch(_exportSettingsKey);
+
 	if (_locationsKey) {
 		_readLocations();
 	}
@@ -2485,6 +2679,7 @@ void _writeMap(WriteMapWhen when) {
 	if (_userSettingsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_recentHashtagsAndBotsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 	if (_exportSettingsKey) mapSize += sizeof(quint32) + sizeof(quint64);
+	if (_partialDownloadsKey) mapSize += sizeof(quint32) + sizeof(quint64);
 
 	EncryptedDescriptor mapData(mapSize);
 	if (!self.isEmpty()) {
@@ -2536,6 +2731,9 @@ void _writeMap(WriteMapWhen when) {
 	if (_exportSettingsKey) {
 		mapData.stream << quint32(lskExportSettings) << quint64(_exportSettingsKey);
 	}
+	if (_partialDownloadsKey) {
+		mapData.stream << quint32(lskPartialDownloads) << quint64(_partialDownloadsKey);
+	}
 	map.writeEncrypted(mapData);
 
 	_mapChanged = false;
@@ -2547,6 +2745,7 @@ void finish() {
 	if (_manager) {
 		_writeMap(WriteMapWhen::Now);
 		_manager->finish();
+		_clearPrefetchedFiles();
 		_manager->deleteLater();
 		_manager = nullptr;
 		delete base::take(_localLoader);
@@ -2801,12 +3000,17 @@ void reset() {
 	_backgroundKeyDay = _backgroundKeyNight = 0;
 	Window::Theme::Background()->reset();
 	_userSettingsKey = _recentHashtagsAndBotsKey = _exportSettingsKey = 0;
+	_partialDownloadsKey = 0;
+	_partialDownloads.clear();
+	_partialDownloadsRead = false;
 	_oldMapVersion = _oldSettingsVersion = 0;
 	_cacheTotalSizeLimit = Database::Settings().totalSizeLimit;
 	_cacheTotalTimeLimit = Database::Settings().totalTimeLimit;
 	_cacheBigFileTotalSizeLimit = Database::Settings().totalSizeLimit;
 	_cacheBigFileTotalTimeLimit = Database::Settings().totalTimeLimit;
 	StoredSessionSettings.reset();
+	_delayedWrites.clear();
+	_clearPrefetchedFiles();
 	_mapChanged = true;
 	_writeMap(WriteMapWhen::Now);
 
@@ -2848,6 +3052,7 @@ base::flat_set<QString> CollectGoodNames() {
 		_backgroundKeyDay,
 		_recentHashtagsAndBotsKey,
 		_exportSettingsKey,
+		_partialDownloadsKey,
 		_trustedBotsKey
 	};
 	auto result = base::flat_set<QString>{ "map0", "map1" };
@@ -3161,6 +3366,114 @@ FileLocation readFileLocation(MediaKey location) {
 	return FileLocation();
 }
 
+void _readPartialDownloads() {
+	if (_partialDownloadsRead) {
+		return;
+	}
+	_partialDownloadsRead = true;
+	if (!_partialDownloadsKey) {
+		return;
+	}
+
+	FileReadDescriptor file;
+	if (!readEncryptedFile(file, _partialDownloadsKey)) {
+		clearKey(_partialDownloadsKey);
+		_partialDownloadsKey = 0;
+		_writeMap();
+		return;
+	}
+
+	quint32 count = 0;
+	file.stream >> count;
+	for (auto i = quint32(0); i != count; ++i) {
+		quint64 first = 0, second = 0;
+		auto download = PartialDownload();
+		file.stream
+			>> first
+			>> second
+			>> download.path
+			>> download.size
+			>> download.parts;
+		if (!_checkStreamStatus(file.stream)) {
+			_partialDownloads.clear();
+			return;
+		}
+		_partialDownloads.emplace(
+			MediaKey(first, second),
+			std::move(download));
+	}
+}
+
+void _writePartialDownloads() {
+	if (!_working()) return;
+
+	_readPartialDownloads();
+	if (_partialDownloads.empty()) {
+		if (_partialDownloadsKey) {
+			clearKey(_partialDownloadsKey);
+			_partialDownloadsKey = 0;
+			_mapChanged = true;
+		}
+		_writeMap();
+	} else {
+		quint32 size = sizeof(quint32);
+		for (const auto &[location, download] : _partialDownloads) {
+			size += sizeof(quint64) * 2
+				+ Serialize::stringSize(download.path)
+				+ sizeof(qint32)
+				+ Serialize::bytearraySize(download.parts);
+		}
+
+		if (!_partialDownloadsKey) {
+			_partialDownloadsKey = genKey();
+			_mapChanged = true;
+			_writeMap(WriteMapWhen::Fast);
+		}
+		EncryptedDescriptor data(size);
+		data.stream << quint32(_partialDownloads.size());
+		for (const auto &[location, download] : _partialDownloads) {
+			data.stream
+				<< quint64(location.first)
+				<< quint64(location.second)
+				<< download.path
+				<< qint32(download.size)
+				<< download.parts;
+		}
+		FileWriteDescriptor file(_partialDownloadsKey);
+		file.writeEncrypted(data);
+	}
+}
+
+void writePartialDownload(MediaKey location, const PartialDownload &download) {
+	if (!_working()) return;
+
+	_readPartialDownloads();
+	_partialDownloads[location] = download;
+
+	// Parts are written many times a second, so save them with a delay.
+	_writeDelayed(_writePartialDownloads);
+}
+
+std::optional<PartialDownload> readPartialDownload(MediaKey location) {
+	if (!_working()) return std::nullopt;
+
+	_readPartialDownloads();
+	const auto i = _partialDownloads.find(location);
+	if (i == end(_partialDownloads)) {
+		return std::nullopt;
+	}
+	return i->second;
+}
+
+void removePartialDownload(MediaKey location) {
+	if (!_working()) return;
+
+	_readPartialDownloads();
+	if (_partialDownloads.erase(location)) {
+		_writeDelayed(_writePartialDownloads);
+	}
+}
+
 Storage::EncryptionKey cacheKey() {
 	Expects(LocalKey != nullptr);
 
@@ -3183,6 +3496,9 @@ Storage::Cache::Database::Settings cacheSettings() {
 	result.totalSizeLimit = _cacheTotalSizeLimit;
 	result.totalTimeLimit = _cacheTotalTimeLimit;
 	result.maxDataSize = Storage::kMaxFileInMemory;
+	result.useIndexSnapshot = true;
+	result.compactBytesPerSecond = kCacheCompactBytesPerSecond;
+	result.writeCombinedSizeLimit = kCacheWriteCombinedSizeLimit;
 	return result;
 }
 
@@ -3219,6 +3535,8 @@ Storage::Cache::Database::Settings cacheBigFileSettings() {
 	result.totalSizeLimit = _cacheBigFileTotalSizeLimit;
 	result.totalTimeLimit = _cacheBigFileTotalTimeLimit;
 	result.maxDataSize = Storage::kMaxFileInMemory;
+	result.useIndexSnapshot = true;
+	result.compactBytesPerSecond = kCacheCompactBytesPerSecond;
 	return result;
 }
 
@@ -3432,7 +3750,7 @@ void _writeStickerSets(FileKey &stickersKey, CheckSet checkSet, const Stickers::
 	data.stream << order;
 
 	FileWriteDescriptor file(stickersKey);
-	file.writeEncrypted(data);
+	file.writeEncryptedCompressed(data);
 }
 
 void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr, MTPDstickerSet::Flags readingFlags = 0) {
@@ -3646,7 +3964,7 @@ void _readStickerSets(FileKey &stickersKey, Stickers::Order *outOrder = nullptr,
 	}
 }
 
-void writeInstalledStickers() {
+void _writeInstalledStickers() {
 	if (!Global::started()) return;
 
 	_writeStickerSets(_installedStickersKey, [](const Stickers::Set &set) {
@@ -3667,7 +3985,7 @@ void writeInstalledStickers() {
 	}, Auth().data().stickerSetsOrder());
 }
 
-void writeFeaturedStickers() {
+void _writeFeaturedStickers() {
 	if (!Global::started()) return;
 
 	_writeStickerSets(_featuredStickersKey, [](const Stickers::Set &set) {
@@ -3686,7 +4004,7 @@ void writeFeaturedStickers() {
 	}, Auth().data().featuredStickerSetsOrder());
 }
 
-void writeRecentStickers() {
+void _writeRecentStickers() {
 	if (!Global::started()) return;
 
 	_writeStickerSets(_recentStickersKey, [](const Stickers::Set &set) {
@@ -3697,7 +4015,7 @@ void writeRecentStickers() {
 	}, Stickers::Order());
 }
 
-void writeFavedStickers() {
+void _writeFavedStickers() {
 	if (!Global::started()) return;
 
 	_writeStickerSets(_favedStickersKey, [](const Stickers::Set &set) {
@@ -3708,7 +4026,7 @@ void writeFavedStickers() {
 	}, Stickers::Order());
 }
 
-void writeArchivedStickers() {
+void _writeArchivedStickers() {
 	if (!Global::started()) return;
 
 	_writeStickerSets(_archivedStickersKey, [](const Stickers::Set &set) {
@@ -3719,6 +4037,26 @@ void writeArchivedStickers() {
 	}, Auth().data().archivedStickerSetsOrder());
 }
 
+void writeInstalledStickers() {
+	_writeDelayed(_writeInstalledStickers);
+}
+
+void writeFeaturedStickers() {
+	_writeDelayed(_writeFeaturedStickers);
+}
+
+void writeRecentStickers() {
+	_writeDelayed(_writeRecentStickers);
+}
+
+void writeFavedStickers() {
+	_writeDelayed(_writeFavedStickers);
+}
+
+void writeArchivedStickers() {
+	_writeDelayed(_writeArchivedStickers);
+}
+
 void importOldRecentStickers() {
 	if (!_recentStickersKeyOld) return;
 
@@ -3937,7 +4275,7 @@ int32 countSavedGifsHash() {
 	return countDocumentVectorHash(Auth().data().savedGifs());
 }
 
-void writeSavedGifs() {
+void _writeSavedGifs() {
 	if (!_working()) return;
 
 	auto &saved = Auth().data().savedGifs();
@@ -3965,10 +4303,14 @@ void writeSavedGifs() {
 			Serialize::Document::writeToStream(data.stream, gif);
 		}
 		FileWriteDescriptor file(_savedGifsKey);
-		file.writeEncrypted(data);
+		file.writeEncryptedCompressed(data);
 	}
 }
 
+void writeSavedGifs() {
+	_writeDelayed(_writeSavedGifs);
+}
+
 void readSavedGifs() {
 	if (!_savedGifsKey) return;
 
@@ -5098,6 +5440,8 @@ Manager::Manager() {
 	connect(&_mapWriteTimer, SIGNAL(timeout()), this, SLOT(mapWriteTimeout()));
 	_locationsWriteTimer.setSingleShot(true);
 	connect(&_locationsWriteTimer, SIGNAL(timeout()), this, SLOT(locationsWriteTimeout()));
+	_delayedWriteTimer.setSingleShot(true);
+	connect(&_delayedWriteTimer, SIGNAL(timeout()), this, SLOT(delayedWriteTimeout()));
 }
 
 void Manager::writeMap(bool fast) {
@@ -5124,6 +5468,12 @@ void Manager::writingLocations() {
 	_locationsWriteTimer.stop();
 }
 
+void Manager::writeDelayed() {
+	if (!_delayedWriteTimer.isActive()) {
+		_delayedWriteTimer.start(kWriteDelayedTimeout);
+	}
+}
+
 void Manager::mapWriteTimeout() {
 	_writeMap(WriteMapWhen::Now);
 }
@@ -5132,7 +5482,16 @@ void Manager::locationsWriteTimeout() {
 	_writeLocations(WriteMapWhen::Now);
 }
 
+void Manager::delayedWriteTimeout() {
+	_writeDelayedNow();
+}
+
 void Manager::finish() {
+	// Delayed writes may add new keys to the map, so they go first.
+	if (_delayedWriteTimer.isActive()) {
+		_delayedWriteTimer.stop();
+		delayedWriteTimeout();
+	}
 	if (_mapWriteTimer.isActive()) {
 		mapWriteTimeout();
 	}
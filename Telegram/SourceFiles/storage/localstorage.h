@@ -114,6 +114,16 @@ void writeFileLocation(MediaKey location, const FileLocation &local);
 FileLocation readFileLocation(MediaKey location);
 void removeFileLocation(MediaKey location);
 
+// Parts of a download written to the file so far, to resume after restart.
+struct PartialDownload {
+	QString path;
+	int32 size = 0;
+	QByteArray parts; // Bitmap of the loaded parts.
+};
+void writePartialDownload(MediaKey location, const PartialDownload &download);
+std::optional<PartialDownload> readPartialDownload(MediaKey location);
+void removePartialDownload(MediaKey location);
+
 Storage::EncryptionKey cacheKey();
 QString cachePath();
 Storage::Cache::Database::Settings cacheSettings();
@@ -192,15 +202,18 @@ public:
 	void writingMap();
 	void writeLocations(bool fast);
 	void writingLocations();
+	void writeDelayed();
 	void finish();
 
 public slots:
 	void mapWriteTimeout();
 	void locationsWriteTimeout();
+	void delayedWriteTimeout();
 
 private:
 	QTimer _mapWriteTimer;
 	QTimer _locationsWriteTimer;
+	QTimer _delayedWriteTimer;
 
 };
 
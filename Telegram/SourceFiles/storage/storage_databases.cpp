@@ -10,6 +10,15 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/cache/storage_cache_database.h"
 
 namespace Storage {
+namespace {
+
+// Each database keeps 1 / kHeadroomPart of its own limit free to grow.
+constexpr auto kHeadroomPart = 8;
+
+// Limits are not updated for changes less than 1 / kPrecisionPart.
+constexpr auto kPrecisionPart = 64;
+
+} // namespace
 
 DatabasePointer::DatabasePointer(
 	not_null<Databases*> owner,
@@ -62,8 +71,13 @@ void DatabasePointer::destroy() {
 	}
 }
 
-Databases::Kept::Kept(std::unique_ptr<Cache::Database> &&database)
+Databases::Kept::Kept(
+	std::unique_ptr<Cache::Database> &&database,
+	const Cache::details::Settings &settings)
 : database(std::move(database)) {
+	configured.totalSizeLimit = settings.totalSizeLimit;
+	configured.totalTimeLimit = settings.totalTimeLimit;
+	totalSizeLimit = settings.totalSizeLimit;
 }
 
 DatabasePointer Databases::get(
@@ -74,20 +88,118 @@ DatabasePointer Databases::get(
 		Assert(kept.destroying.alive());
 		kept.destroying = nullptr;
 		kept.database->reconfigure(settings);
+		kept.configured.totalSizeLimit = settings.totalSizeLimit;
+		kept.configured.totalTimeLimit = settings.totalTimeLimit;
+		kept.totalSizeLimit = settings.totalSizeLimit;
 		return DatabasePointer(this, kept.database);
 	}
 	const auto [i, ok] = _map.emplace(
-		path,
-		std::make_unique<Cache::Database>(path, settings));
+		std::piecewise_construct,
+		std::forward_as_tuple(path),
+		std::forward_as_tuple(
+			std::make_unique<Cache::Database>(path, settings),
+			settings));
 	return DatabasePointer(this, i->second.database);
 }
 
+auto Databases::find(not_null<Cache::Database*> database) -> Kept* {
+	for (auto &[path, kept] : _map) {
+		if (kept.database.get() == database) {
+			return &kept;
+		}
+	}
+	return nullptr;
+}
+
+void Databases::updateSettings(
+		not_null<Cache::Database*> database,
+		const Cache::details::SettingsUpdate &update) {
+	const auto kept = find(database);
+	Assert(kept != nullptr);
+
+	kept->configured = update;
+	if (kept->budget) {
+		kept->totalSizeLimit = 0;
+		applyBudget(kept->budget);
+	} else {
+		kept->totalSizeLimit = update.totalSizeLimit;
+		database->updateSettings(update);
+	}
+}
+
+void Databases::shareBudget(
+		const std::vector<not_null<Cache::Database*>> &list) {
+	const auto budget = ++_budgetsCounter;
+	for (const auto database : list) {
+		const auto kept = find(database);
+		Assert(kept != nullptr);
+
+		kept->budget = budget;
+		kept->budgetLifetime.destroy();
+		database->statsOnMain(
+		) | rpl::start_with_next([=](const Cache::Database::Stats &stats) {
+			kept->totalSize = stats.full.totalSize;
+			applyBudget(budget);
+		}, kept->budgetLifetime);
+	}
+}
+
+void Databases::applyBudget(int budget) {
+	auto list = std::vector<not_null<Kept*>>();
+	for (auto &[path, kept] : _map) {
+		if (kept.budget == budget) {
+			if (!kept.configured.totalSizeLimit) {
+				return; // One of the databases is not limited at all.
+			}
+			list.push_back(&kept);
+		}
+	}
+
+	// Databases that don't need all of their limits give the rest
+	// to the databases that would have to evict entries otherwise.
+	const auto keep = [](not_null<Kept*> kept) {
+		const auto limit = kept->configured.totalSizeLimit;
+		return std::min(limit, kept->totalSize + limit / kHeadroomPart);
+	};
+	auto spare = int64(0);
+	auto pressured = int64(0);
+	for (const auto kept : list) {
+		const auto limit = kept->configured.totalSizeLimit;
+		if (const auto needed = keep(kept); needed < limit) {
+			spare += limit - needed;
+		} else {
+			pressured += limit;
+		}
+	}
+	for (const auto kept : list) {
+		const auto limit = kept->configured.totalSizeLimit;
+		const auto computed = !pressured
+			? limit
+			: (keep(kept) < limit)
+			? keep(kept)
+			: (limit + (spare * limit / pressured));
+		const auto precision = limit / kPrecisionPart;
+		if (std::abs(computed - kept->totalSizeLimit) <= precision
+			&& kept->totalSizeLimit) {
+			continue;
+		}
+		kept->totalSizeLimit = computed;
+		auto update = kept->configured;
+		update.totalSizeLimit = computed;
+		kept->database->updateSettings(update);
+	}
+}
+
 void Databases::destroy(Cache::Database *database) {
 	for (auto &entry : _map) {
 		const auto &path = entry.first; // Need to capture it in lambda.
 		auto &kept = entry.second;
 		if (kept.database.get() == database) {
 			Assert(!kept.destroying.alive());
+			if (const auto budget = base::take(kept.budget)) {
+				kept.budgetLifetime.destroy();
+				applyBudget(budget);
+			}
 			database->close();
 			database->waitForCleaner([
 				=,
@@ -51,20 +51,38 @@ public:
 	DatabasePointer get(
 		const QString &path,
 		const Cache::details::Settings &settings);
+	void updateSettings(
+		not_null<Cache::Database*> database,
+		const Cache::details::SettingsUpdate &update);
+
+	// Databases sharing a budget lend the unused parts of their size
+	// limits to each other. While one of them is almost empty another
+	// one is allowed to grow beyond its own limit instead of evicting.
+	void shareBudget(const std::vector<not_null<Cache::Database*>> &list);
 
 private:
 	friend class DatabasePointer;
 
 	struct Kept {
-		Kept(std::unique_ptr<Cache::Database> &&database);
+		Kept(
+			std::unique_ptr<Cache::Database> &&database,
+			const Cache::details::Settings &settings);
 
 		std::unique_ptr<Cache::Database> database;
 		base::binary_guard destroying;
+		Cache::details::SettingsUpdate configured;
+		int64 totalSizeLimit = 0;
+		int64 totalSize = 0;
+		int budget = 0;
+		rpl::lifetime budgetLifetime;
 	};
 
+	Kept *find(not_null<Cache::Database*> database);
+	void applyBudget(int budget);
 	void destroy(Cache::Database *database);
 
 	std::map<QString, Kept> _map;
+	int _budgetsCounter = 0;
 
 };
 
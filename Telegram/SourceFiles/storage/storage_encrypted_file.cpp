@@ -8,6 +8,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_encrypted_file.h"
 
 #include "base/openssl_help.h"
+#include "base/algorithm.h"
 
 namespace Storage {
 namespace {
@@ -171,6 +172,15 @@ File::Result File::readHeader(const EncryptionKey &key) {
 }
 
 size_type File::readPlain(bytes::span bytes) {
+	if (_mapped) {
+		const auto available = std::max(_mappedSize - _mappedOffset, 0LL);
+		const auto count = std::min(int64(bytes.size()), available);
+		if (count > 0) {
+			memcpy(bytes.data(), _mapped + _mappedOffset, count);
+			_mappedOffset += count;
+		}
+		return size_type(count);
+	}
 	return _data.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
 }
 
@@ -180,6 +190,21 @@ size_type File::writePlain(bytes::const_span bytes) {
 		bytes.size());
 }
 
+int64 File::plainOffset() const {
+	return _mapped ? _mappedOffset : _data.pos();
+}
+
+bool File::seekPlain(int64 offset) {
+	if (_mapped) {
+		if (offset < 0 || offset > _mappedSize) {
+			return false;
+		}
+		_mappedOffset = offset;
+		return true;
+	}
+	return _data.seek(offset);
+}
+
 void File::decrypt(bytes::span bytes) {
 	Expects(_state.has_value());
 
@@ -199,7 +224,7 @@ size_type File::read(bytes::span bytes) {
 
 	auto count = readPlain(bytes);
 	if (const auto back = -(count % kBlockSize)) {
-		if (!_data.seek(_data.pos() + back)) {
+		if (!seekPlain(plainOffset() + back)) {
 			return 0;
 		}
 		count += back;
@@ -212,6 +237,7 @@ size_type File::read(bytes::span bytes) {
 
 bool File::write(bytes::span bytes) {
 	Expects(bytes.size() % kBlockSize == 0);
+	Expects(!_mapped);
 
 	if (!isOpen()) {
 		return false;
@@ -290,7 +316,33 @@ bool File::flush() {
 	return _data.flush();
 }
 
+bool File::map() {
+	Expects(_state.has_value());
+	Expects(_data.openMode() == QIODevice::ReadOnly);
+
+	if (_mapped) {
+		return true;
+	}
+	const auto size = _data.size();
+	const auto offset = _data.pos();
+	_mapped = _data.map(0, size);
+	if (!_mapped) {
+		return false;
+	}
+	_mappedSize = size;
+	_mappedOffset = offset;
+	return true;
+}
+
+bool File::isMapped() const {
+	return (_mapped != nullptr);
+}
+
 void File::close() {
+	if (_mapped) {
+		_data.unmap(base::take(_mapped));
+		_mappedSize = _mappedOffset = 0;
+	}
 	_lock.unlock();
 	_data.close();
 	_data.setFileName(QString());
@@ -316,7 +368,7 @@ bool File::seek(int64 offset) {
 	const auto realOffset = sizeof(BasicHeader) + offset;
 	if (offset < 0 || offset > _dataSize) {
 		return false;
-	} else if (!_data.seek(FileLock::kSkipBytes + realOffset)) {
+	} else if (!seekPlain(FileLock::kSkipBytes + realOffset)) {
 		return false;
 	}
 	_encryptionOffset = realOffset - kSaltSize;
@@ -42,6 +42,10 @@ public:
 	int64 offset() const;
 	bool seek(int64 offset);
 
+	// Available only in Mode::Read, reads are served from the mapping.
+	bool map();
+	bool isMapped() const;
+
 	void close();
 
 	static bool Move(const QString &from, const QString &to);
@@ -57,6 +61,8 @@ private:
 
 	size_type readPlain(bytes::span bytes);
 	size_type writePlain(bytes::const_span bytes);
+	int64 plainOffset() const;
+	bool seekPlain(int64 offset);
 	void decrypt(bytes::span bytes);
 	void encrypt(bytes::span bytes);
 	void decryptBack(bytes::span bytes);
@@ -66,6 +72,10 @@ private:
 	int64 _encryptionOffset = 0;
 	int64 _dataSize = 0;
 
+	uchar *_mapped = nullptr;
+	int64 _mappedSize = 0;
+	int64 _mappedOffset = 0;
+
 	std::optional<CtrState> _state;
 
 };
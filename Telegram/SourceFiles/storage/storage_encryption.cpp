@@ -19,11 +19,51 @@ CtrState::CtrState(bytes::const_span key, bytes::const_span iv) {
 	bytes::copy(_iv, iv);
 }
 
-template <typename Method>
-void CtrState::process(bytes::span data, int64 offset, Method method) {
+void CtrState::process(bytes::span data, int64 offset) {
 	Expects((data.size() % kBlockSize) == 0);
 	Expects((offset % kBlockSize) == 0);
 
+	const auto blockIndex = offset / kBlockSize;
+	const auto processed = processEvp(data, incrementedIv(blockIndex));
+	if (processed < data.size()) {
+		auto iv = incrementedIv(blockIndex + processed / kBlockSize);
+		processLegacy(data.subspan(processed), iv);
+	}
+}
+
+size_type CtrState::processEvp(
+		bytes::span data,
+		bytes::const_span iv) const {
+	// EVP picks AES-NI / ARMv8 crypto extensions implementation when
+	// they are available and processes the whole span in one pass.
+	const auto context = EVP_CIPHER_CTX_new();
+	if (!context) {
+		return 0;
+	}
+	const auto guard = gsl::finally([&] { EVP_CIPHER_CTX_free(context); });
+	if (EVP_EncryptInit_ex(
+			context,
+			EVP_aes_256_ctr(),
+			nullptr,
+			reinterpret_cast<const uchar*>(_key.data()),
+			reinterpret_cast<const uchar*>(iv.data())) != 1) {
+		return 0;
+	}
+	auto result = size_type(0);
+	while (result < data.size()) {
+		const auto from = reinterpret_cast<uchar*>(data.data() + result);
+		const auto chunk = std::min(data.size() - result, kEvpChunkSize);
+		auto processed = 0;
+		if (EVP_EncryptUpdate(context, from, &processed, from, int(chunk)) != 1
+			|| processed != chunk) {
+			break;
+		}
+		result += chunk;
+	}
+	return result;
+}
+
+void CtrState::processLegacy(bytes::span data, bytes::span iv) const {
 	AES_KEY aes;
 	AES_set_encrypt_key(
 		reinterpret_cast<const uchar*>(_key.data()),
@@ -32,8 +72,6 @@ void CtrState::process(bytes::span data, int64 offset, Method method) {
 
 	unsigned char ecountBuf[kBlockSize] = { 0 };
 	unsigned int offsetInBlock = 0;
-	const auto blockIndex = offset / kBlockSize;
-	auto iv = incrementedIv(blockIndex);
 
 	CRYPTO_ctr128_encrypt(
 		reinterpret_cast<const uchar*>(data.data()),
@@ -43,7 +81,7 @@ void CtrState::process(bytes::span data, int64 offset, Method method) {
 		reinterpret_cast<unsigned char*>(iv.data()),
 		ecountBuf,
 		&offsetInBlock,
-		(block128_f)method);
+		(block128_f)AES_encrypt);
 }
 
 auto CtrState::incrementedIv(int64 blockIndex)
@@ -66,11 +104,11 @@ auto CtrState::incrementedIv(int64 blockIndex)
 }
 
 void CtrState::encrypt(bytes::span data, int64 offset) {
-	return process(data, offset, AES_encrypt);
+	return process(data, offset);
 }
 
 void CtrState::decrypt(bytes::span data, int64 offset) {
-	return process(data, offset, AES_encrypt);
+	return process(data, offset);
 }
 
 EncryptionKey::EncryptionKey(bytes::vector &&data)
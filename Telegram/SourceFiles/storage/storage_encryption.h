@@ -25,12 +25,14 @@ public:
 	void decrypt(bytes::span data, int64 offset);
 
 private:
-	template <typename Method>
-	void process(bytes::span data, int64 offset, Method method);
+	void process(bytes::span data, int64 offset);
+	size_type processEvp(bytes::span data, bytes::const_span iv) const;
+	void processLegacy(bytes::span data, bytes::span iv) const;
 
 	bytes::array<kIvSize> incrementedIv(int64 blockIndex);
 
 	static constexpr auto EcountSize = kBlockSize;
+	static constexpr auto kEvpChunkSize = size_type(1024 * 1024 * 1024);
 
 	bytes::array<kKeySize> _key;
 	bytes::array<kIvSize> _iv;
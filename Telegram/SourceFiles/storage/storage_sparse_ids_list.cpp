@@ -8,9 +8,203 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "storage/storage_sparse_ids_list.h"
 
 namespace Storage {
+namespace {
+
+constexpr auto kIdsInBlock = 128;
+
+} // namespace
+
+void SparseIdsSet::merge(const SparseIdsSet &other) {
+	mergeSorted(other.slice(0, other.size()));
+}
+
+bool SparseIdsSet::remove(MsgId id) {
+	if (empty() || id < front() || id > back()) {
+		return false;
+	}
+	const auto index = blockIndex(id);
+	auto ids = std::vector<MsgId>();
+	Decode(_blocks[index], ids);
+	const auto i = ranges::lower_bound(ids, id);
+	if (i == end(ids) || *i != id) {
+		return false;
+	}
+	ids.erase(i);
+	--_size;
+	if (ids.empty()) {
+		_blocks.erase(begin(_blocks) + index);
+	} else {
+		_blocks[index] = Encode(begin(ids), end(ids));
+	}
+	return true;
+}
+
+MsgId SparseIdsSet::front() const {
+	Expects(!empty());
+
+	return _blocks.front().first;
+}
+
+MsgId SparseIdsSet::back() const {
+	Expects(!empty());
+
+	return _blocks.back().last;
+}
+
+int SparseIdsSet::lowerBound(MsgId id) const {
+	auto result = 0;
+	for (const auto &block : _blocks) {
+		if (block.last < id) {
+			result += block.count;
+		} else if (block.first < id) {
+			auto ids = std::vector<MsgId>();
+			Decode(block, ids);
+			return result + int(ranges::lower_bound(ids, id) - begin(ids));
+		} else {
+			break;
+		}
+	}
+	return result;
+}
+
+std::vector<MsgId> SparseIdsSet::slice(int from, int till) const {
+	Expects(from >= 0 && from <= till && till <= size());
+
+	auto result = std::vector<MsgId>();
+	result.reserve(till - from);
+	auto skipped = 0;
+	for (const auto &block : _blocks) {
+		if (skipped + block.count <= from) {
+			skipped += block.count;
+			continue;
+		} else if (skipped >= till) {
+			break;
+		}
+		const auto wasSize = int(result.size());
+		Decode(block, result);
+		const auto blockFrom = wasSize + std::max(from - skipped, 0);
+		const auto blockTill = wasSize
+			+ std::min(till - skipped, block.count);
+		result.erase(begin(result) + blockTill, end(result));
+		result.erase(begin(result) + wasSize, begin(result) + blockFrom);
+		skipped += block.count;
+	}
+	return result;
+}
+
+void SparseIdsSet::mergeSorted(std::vector<MsgId> &&ids) {
+	if (ids.empty()) {
+		return;
+	} else if (_blocks.empty()) {
+		replaceBlock(0, ids);
+		return;
+	}
+
+	// Go from the end, so that splitting a block keeps previous indices.
+	auto till = ids.cend();
+	while (till != ids.cbegin()) {
+		const auto index = blockIndex(*(till - 1));
+		const auto from = index
+			? std::lower_bound(ids.cbegin(), till, _blocks[index].first)
+			: ids.cbegin();
+		mergeToBlock(index, from, till);
+		till = from;
+	}
+}
+
+void SparseIdsSet::mergeToBlock(
+		int index,
+		std::vector<MsgId>::const_iterator from,
+		std::vector<MsgId>::const_iterator till) {
+	auto was = std::vector<MsgId>();
+	Decode(_blocks[index], was);
+	auto merged = std::vector<MsgId>();
+	merged.reserve(was.size() + (till - from));
+	std::set_union(
+		begin(was),
+		end(was),
+		from,
+		till,
+		std::back_inserter(merged));
+	_size -= int(was.size());
+	replaceBlock(index, merged);
+}
+
+void SparseIdsSet::replaceBlock(int index, const std::vector<MsgId> &ids) {
+	Expects(!ids.empty());
+
+	auto blocks = std::vector<Block>();
+	for (auto i = ids.cbegin(); i != ids.cend();) {
+		const auto till = i + std::min(int(ids.cend() - i), kIdsInBlock);
+		blocks.push_back(Encode(i, till));
+		i = till;
+	}
+	if (index < int(_blocks.size())) {
+		_blocks[index] = std::move(blocks.front());
+		_blocks.insert(
+			begin(_blocks) + index + 1,
+			std::make_move_iterator(begin(blocks) + 1),
+			std::make_move_iterator(end(blocks)));
+	} else {
+		_blocks.insert(
+			end(_blocks),
+			std::make_move_iterator(begin(blocks)),
+			std::make_move_iterator(end(blocks)));
+	}
+	_size += int(ids.size());
+}
+
+int SparseIdsSet::blockIndex(MsgId id) const {
+	const auto i = ranges::upper_bound(
+		_blocks,
+		id,
+		std::less<>(),
+		&Block::first);
+	return (i == begin(_blocks)) ? 0 : int(i - begin(_blocks) - 1);
+}
+
+void SparseIdsSet::Decode(const Block &block, std::vector<MsgId> &to) {
+	auto id = block.first;
+	to.push_back(id);
+	auto delta = uint32(0);
+	auto shift = 0;
+	for (const auto byte : block.deltas) {
+		delta |= uint32(byte & 0x7F) << shift;
+		if (byte & 0x80) {
+			shift += 7;
+			continue;
+		}
+		id += MsgId(delta);
+		to.push_back(id);
+		delta = 0;
+		shift = 0;
+	}
+}
+
+auto SparseIdsSet::Encode(
+		std::vector<MsgId>::const_iterator from,
+		std::vector<MsgId>::const_iterator till) -> Block {
+	Expects(from != till);
+
+	auto result = Block();
+	result.first = *from;
+	result.last = *(till - 1);
+	result.count = int(till - from);
+	result.deltas.reserve(result.count);
+	for (auto i = from + 1; i != till; ++i) {
+		auto delta = uint32(*i - *(i - 1));
+		while (delta >= 0x80) {
+			result.deltas.push_back(uchar(delta & 0x7F) | 0x80);
+			delta >>= 7;
+		}
+		result.deltas.push_back(uchar(delta));
+	}
+	result.deltas.shrink_to_fit();
+	return result;
+}
 
 SparseIdsList::Slice::Slice(
-	base::flat_set<MsgId> &&messages,
+	SparseIdsSet &&messages,
 	MsgRange range)
 : messages(std::move(messages))
 , range(range) {
@@ -23,7 +217,7 @@ void SparseIdsList::Slice::merge(
 	Expects(moreNoSkipRange.from <= range.till);
 	Expects(range.from <= moreNoSkipRange.till);
 
-	messages.merge(std::begin(moreMessages), std::end(moreMessages));
+	messages.merge(moreMessages);
 	range = {
 		qMin(range.from, moreNoSkipRange.from),
 		qMax(range.till, moreNoSkipRange.till)
@@ -79,9 +273,7 @@ SparseIdsList::AddResult SparseIdsList::addRangeItemsAndCountNew(
 		return uniteAndAdd(update, uniteFrom, uniteTill, messages, noSkipRange);
 	}
 
-	auto sliceMessages = base::flat_set<MsgId> {
-		std::begin(messages),
-		std::end(messages) };
+	auto sliceMessages = SparseIdsSet(messages);
 	auto slice = _slices.emplace(
 		std::move(sliceMessages),
 		noSkipRange
@@ -159,7 +351,7 @@ void SparseIdsList::removeOne(MsgId messageId) {
 
 void SparseIdsList::removeAll() {
 	_slices.clear();
-	_slices.emplace(base::flat_set<MsgId>{}, MsgRange { 0, ServerMaxMsgId });
+	_slices.emplace(SparseIdsSet(), MsgRange { 0, ServerMaxMsgId });
 	_count = 0;
 }
 
@@ -208,12 +400,14 @@ SparseIdsListResult SparseIdsList::queryFromSlice(
 		const SparseIdsListQuery &query,
 		const Slice &slice) const {
 	auto result = SparseIdsListResult {};
-	auto position = ranges::lower_bound(slice.messages, query.aroundId);
-	auto haveBefore = int(position - slice.messages.begin());
-	auto haveEqualOrAfter = int(slice.messages.end() - position);
+	auto position = slice.messages.lowerBound(query.aroundId);
+	auto haveBefore = position;
+	auto haveEqualOrAfter = slice.messages.size() - position;
 	auto before = qMin(haveBefore, query.limitBefore);
 	auto equalOrAfter = qMin(haveEqualOrAfter, query.limitAfter + 1);
-	auto ids = std::vector<MsgId>(position - before, position + equalOrAfter);
+	auto ids = slice.messages.slice(
+		position - before,
+		position + equalOrAfter);
 	result.messageIds.merge(ids.begin(), ids.end());
 	if (slice.range.from == 0) {
 		result.skippedBefore = haveBefore - before;
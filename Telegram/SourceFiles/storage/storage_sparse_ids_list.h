@@ -9,6 +9,66 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 namespace Storage {
 
+// Sorted set of message ids, packed in blocks of varint encoded deltas.
+// Large shared media lists take a small part of the flat_set memory and
+// slices are decoded only around the requested position.
+class SparseIdsSet {
+public:
+	SparseIdsSet() = default;
+	template <typename Range>
+	explicit SparseIdsSet(const Range &ids) {
+		merge(ids);
+	}
+
+	template <typename Range>
+	void merge(const Range &ids) {
+		auto sorted = std::vector<MsgId>(std::begin(ids), std::end(ids));
+		ranges::sort(sorted);
+		sorted.erase(std::unique(begin(sorted), end(sorted)), end(sorted));
+		mergeSorted(std::move(sorted));
+	}
+	void merge(const SparseIdsSet &other);
+	bool remove(MsgId id);
+
+	[[nodiscard]] int size() const {
+		return _size;
+	}
+	[[nodiscard]] bool empty() const {
+		return !_size;
+	}
+	[[nodiscard]] MsgId front() const;
+	[[nodiscard]] MsgId back() const;
+
+	// Count of the ids less than the given one.
+	[[nodiscard]] int lowerBound(MsgId id) const;
+	[[nodiscard]] std::vector<MsgId> slice(int from, int till) const;
+
+private:
+	struct Block {
+		MsgId first = 0;
+		MsgId last = 0;
+		int count = 0;
+		std::vector<uchar> deltas;
+	};
+
+	void mergeSorted(std::vector<MsgId> &&ids);
+	void mergeToBlock(
+		int index,
+		std::vector<MsgId>::const_iterator from,
+		std::vector<MsgId>::const_iterator till);
+	void replaceBlock(int index, const std::vector<MsgId> &ids);
+	[[nodiscard]] int blockIndex(MsgId id) const;
+
+	static void Decode(const Block &block, std::vector<MsgId> &to);
+	[[nodiscard]] static Block Encode(
+		std::vector<MsgId>::const_iterator from,
+		std::vector<MsgId>::const_iterator till);
+
+	std::vector<Block> _blocks;
+	int _size = 0;
+
+};
+
 struct SparseIdsListQuery {
 	SparseIdsListQuery(
 		MsgId aroundId,
@@ -33,7 +93,7 @@ struct SparseIdsListResult {
 };
 
 struct SparseIdsSliceUpdate {
-	const base::flat_set<MsgId> *messages = nullptr;
+	const SparseIdsSet *messages = nullptr;
 	MsgRange range;
 	std::optional<int> count;
 };
@@ -54,12 +114,12 @@ public:
 
 private:
 	struct Slice {
-		Slice(base::flat_set<MsgId> &&messages, MsgRange range);
+		Slice(SparseIdsSet &&messages, MsgRange range);
 
 		template <typename Range>
 		void merge(const Range &moreMessages, MsgRange moreNoSkipRange);
 
-		base::flat_set<MsgId> messages;
+		SparseIdsSet messages;
 		MsgRange range;
 
 		inline bool operator<(const Slice &other) const {
@@ -492,6 +492,7 @@ void Templates::load() {
 		]() mutable {
 			setData(std::move(result.result));
 			_index = std::move(result.index);
+			_queryCache = QueryCache();
 			_errors.fire(std::move(result.errors));
 			crl::on_main(this, [=] {
 				if (base::take(_reloadAfterRead)) {
@@ -566,10 +567,15 @@ void Templates::updateRequestFinished(QNetworkReply *reply) {
 	LOG(("Got template from url '%1'"
 		).arg(reply->url().toDisplayString()));
 	const auto content = reply->readAll();
-	crl::async([=, weak = base::make_weak(this)]{
+	crl::async([
+		=,
+		weak = base::make_weak(this),
+		was = _data.files.at(path)
+	]{
 		auto result = ReadFromBlob(content);
 		auto one = TemplatesData();
 		one.files.emplace(path, std::move(result.result));
+		MoveKeys(one.files.at(path), was);
 		auto index = ComputeIndex(one);
 		crl::on_main(weak,[
 			=,
@@ -579,8 +585,8 @@ void Templates::updateRequestFinished(QNetworkReply *reply) {
 		]() mutable {
 			auto &existing = _data.files.at(path);
 			auto &parsed = one.files.at(path);
-			MoveKeys(parsed, existing);
-			ReplaceFileIndex(_index, ComputeIndex(one), path);
+			ReplaceFileIndex(_index, std::move(index), path);
+			_queryCache = QueryCache();
 			if (!errors.isEmpty()) {
 				_errors.fire(std::move(errors));
 			}
@@ -665,6 +671,9 @@ auto Templates::matchFromEnd(QString query) const
 Templates::~Templates() = default;
 
 auto Templates::query(const QString &text) const -> std::vector<Question> {
+	using Id = TemplatesIndex::Id;
+	using Term = TemplatesIndex::Term;
+
 	const auto words = TextUtilities::PrepareSearchWords(text);
 	const auto questions = [&](const QString &word) {
 		const auto i = _index.first.find(word[0]);
@@ -672,14 +681,29 @@ auto Templates::query(const QString &text) const -> std::vector<Question> {
 	};
 	const auto best = ranges::min_element(words, std::less<>(), questions);
 	if (best == std::end(words)) {
+		_queryCache = QueryCache();
 		return {};
 	}
-	const auto narrowed = _index.first.find((*best)[0]);
-	if (narrowed == end(_index.first)) {
-		return {};
+
+	// While the query is only typed further each previous word is still
+	// a prefix of some new word, so all matches are among previous ones.
+	const auto refined = !_queryCache.words.isEmpty()
+		&& ranges::all_of(_queryCache.words, [&](const QString &was) {
+			return ranges::any_of(words, [&](const QString &word) {
+				return word.startsWith(was);
+			});
+		});
+	auto candidates = std::vector<Id>();
+	if (refined) {
+		candidates = std::move(_queryCache.ids);
+	} else {
+		const auto narrowed = _index.first.find((*best)[0]);
+		if (narrowed == end(_index.first)) {
+			_queryCache = QueryCache();
+			return {};
+		}
+		candidates = narrowed->second;
 	}
-	using Id = TemplatesIndex::Id;
-	using Term = TemplatesIndex::Term;
 	const auto questionById = [&](const Id &id) {
 		return _data.files.at(id.first).questions.at(id.second);
 	};
@@ -730,11 +754,17 @@ auto Templates::query(const QString &text) const -> std::vector<Question> {
 			return (a.first.second < b.first.second);
 		}
 	};
-	const auto good = narrowed->second | ranges::view::transform(
+	const auto good = candidates | ranges::view::transform(
 		pairById
 	) | ranges::view::filter([](const Pair &pair) {
 		return pair.second > 0;
 	}) | ranges::to_vector | ranges::action::stable_sort(sorter);
+
+	_queryCache.words = words;
+	_queryCache.ids = good | ranges::view::transform([](const Pair &pair) {
+		return pair.first;
+	}) | ranges::to_vector;
+
 	return good | ranges::view::transform([&](const Pair &pair) {
 		return questionById(pair.first);
 	}) | ranges::view::take(kQueryLimit) | ranges::to_vector;
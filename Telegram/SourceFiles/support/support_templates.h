@@ -71,6 +71,10 @@ public:
 
 private:
 	struct Updates;
+	struct QueryCache {
+		QStringList words;
+		std::vector<details::TemplatesIndex::Id> ids;
+	};
 
 	void load();
 	void update();
@@ -83,6 +87,7 @@ private:
 
 	details::TemplatesData _data;
 	details::TemplatesIndex _index;
+	mutable QueryCache _queryCache;
 	rpl::event_stream<QStringList> _errors;
 	base::binary_guard _reading;
 	bool _reloadAfterRead = false;
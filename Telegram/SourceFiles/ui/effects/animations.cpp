@@ -9,12 +9,29 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "core/application.h"
 
+#include <QtGui/QGuiApplication>
+#include <QtGui/QScreen>
+
 namespace Ui {
 namespace Animations {
 namespace {
 
 constexpr auto kAnimationTick = crl::time(1000) / 120;
+constexpr auto kMinAnimationTick = crl::time(1000) / 240;
+constexpr auto kMinRefreshRate = 24.;
 constexpr auto kIgnoreUpdatesTimeout = crl::time(4);
+constexpr auto kBackgroundAnimationTick = crl::time(1000) / 4;
+
+// There is no sense in updating animations more often than the display
+// is refreshed, so all of them are updated once per refresh interval.
+[[nodiscard]] crl::time ComputeAnimationTick() {
+	const auto screen = QGuiApplication::primaryScreen();
+	const auto rate = screen ? screen->refreshRate() : 0.;
+	if (rate < kMinRefreshRate) {
+		return kAnimationTick;
+	}
+	return std::max(crl::time(std::round(1000. / rate)), kMinAnimationTick);
+}
 
 } // namespace
 
@@ -54,16 +71,36 @@ void Basic::markStopped() {
 	_started = -1;
 }
 
-Manager::Manager() {
+Manager::Manager() : _tick(kAnimationTick) {
 	crl::on_main_update_requests(
 	) | rpl::filter([=] {
-		return (_lastUpdateTime + kIgnoreUpdatesTimeout < crl::now());
+		const auto ignore = _background ? _tick : kIgnoreUpdatesTimeout;
+		return (_lastUpdateTime + ignore < crl::now());
 	}) | rpl::start_with_next([=] {
 		update();
 	}, _lifetime);
 }
 
+void Manager::setBackgroundMode(bool background) {
+	if (_background == background) {
+		return;
+	}
+	_background = background;
+	_tick = _background ? kBackgroundAnimationTick : ComputeAnimationTick();
+	if (!_background && !empty(_active)) {
+		_forceImmediateUpdate = true;
+		if (!_updating) {
+			schedule();
+		}
+	}
+}
+
 void Manager::start(not_null<Basic*> animation) {
+	if (_background) {
+		_tick = kBackgroundAnimationTick;
+	} else if (empty(_active) && empty(_starting)) {
+		_tick = ComputeAnimationTick();
+	}
 	_forceImmediateUpdate = true;
 	if (_updating) {
 		_starting.emplace_back(animation.get());
@@ -118,6 +155,10 @@ void Manager::update() {
 			std::make_move_iterator(end(_starting)));
 		_starting.clear();
 	}
+	if (empty(_active)) {
+		// Nothing to animate, don't wake up until the next start().
+		stopTimer();
+	}
 }
 
 void Manager::updateQueued() {
@@ -141,11 +182,13 @@ void Manager::schedule() {
 	_scheduled = true;
 	Ui::PostponeCall(delayedCallGuard(), [=] {
 		_scheduled = false;
-		if (_forceImmediateUpdate) {
+		if (empty(_active)) {
+			return;
+		} else if (_forceImmediateUpdate) {
 			_forceImmediateUpdate = false;
 			updateQueued();
 		} else {
-			const auto next = _lastUpdateTime + kAnimationTick;
+			const auto next = _lastUpdateTime + _tick;
 			const auto now = crl::now();
 			if (now < next) {
 				_timerId = startTimer(next - now, Qt::PreciseTimer);
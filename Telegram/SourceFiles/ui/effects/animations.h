@@ -107,6 +107,10 @@ public:
 
 	void update();
 
+	// While no window is shown animations are updated rarely, they
+	// still finish in time, but intermediate frames aren't computed.
+	void setBackgroundMode(bool background);
+
 private:
 	class ActiveBasicPointer {
 	public:
@@ -165,10 +169,12 @@ private:
 	not_null<const QObject*> delayedCallGuard() const;
 
 	crl::time _lastUpdateTime = 0;
+	crl::time _tick = 0;
 	int _timerId = 0;
 	bool _updating = false;
 	bool _scheduled = false;
 	bool _forceImmediateUpdate = false;
+	bool _background = false;
 	std::vector<ActiveBasicPointer> _active;
 	std::vector<ActiveBasicPointer> _starting;
 	rpl::lifetime _lifetime;
@@ -14,6 +14,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 #include "base/bytes.h"
 #include "base/openssl_help.h"
 #include "base/parse_helper.h"
+#include "base/timer.h"
+#include "base/memory_usage.h"
 #include "main/main_session.h"
 
 #include <QtCore/QJsonDocument>
@@ -34,6 +36,9 @@ constexpr auto kMaxId = uint32(1 << 8);
 
 constexpr auto kScaleForTouchBar = 150;
 
+// Sprites that were not painted for that long are read from cache again.
+constexpr auto kUnloadSpritesTimeout = 5 * 60 * crl::time(1000);
+
 const auto kSets = {
 	Set{ 0,   0,         0, "Mac",      ":/gui/emoji/set0_preview.webp" },
 	Set{ 1, 246, 7'336'383, "Android",  ":/gui/emoji/set1_preview.webp" },
@@ -47,20 +52,35 @@ const auto kSets = {
 class Instance {
 public:
 	explicit Instance(int size);
+	~Instance();
 
 	bool cached() const;
 	void draw(QPainter &p, EmojiPtr emoji, int x, int y);
 
 private:
+	struct Sprite {
+		QPixmap pixmap; // Null until it is painted, then read from cache.
+		bool used = false;
+	};
+
 	void readCache();
 	void generateCache();
 	void checkUniversalImages();
 	void pushSprite(QImage &&data);
+	[[nodiscard]] bool ensureSpriteLoaded(int index);
+	void unloadUnusedSprites();
+	void accountMemory();
 
 	int _id = 0;
 	int _size = 0;
-	std::vector<QPixmap> _sprites;
+	std::vector<Sprite> _sprites;
 	base::binary_guard _generating;
+	base::Timer _unloadTimer;
+
+	// Emoji scaled from the universal images while sprites are generated.
+	base::flat_map<int, QPixmap> _singles;
+
+	int64 _memoryUsage = 0;
 
 };
 
@@ -212,6 +232,29 @@ void SaveToFile(int id, const QImage &image, int size, int index) {
 	}
 }
 
+bool CacheFileValid(int id, int size, int index) {
+	const auto rows = RowsCount(index);
+	const auto width = kImagesPerRow * size;
+	const auto height = rows * size;
+	const auto fileSize = 4 * sizeof(uint32)
+		+ (width * height * 4)
+		+ openssl::kSha256Size;
+	QFile f(CacheFilePath(size, index));
+	if (!f.exists()
+		|| f.size() != fileSize
+		|| !f.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	uint32 header[4] = { 0 };
+	const auto span = bytes::make_span(header);
+	return (f.read(reinterpret_cast<char*>(span.data()), span.size())
+			== span.size())
+		&& (header[0] == ComputeVersion(id))
+		&& (header[1] == size)
+		&& (header[2] == width)
+		&& (header[3] == height);
+}
+
 QImage LoadFromFile(int id, int size, int index) {
 	const auto rows = RowsCount(index);
 	const auto width = kImagesPerRow * size;
@@ -440,6 +483,12 @@ void UniversalImages::draw(
 		int size,
 		int x,
 		int y) const {
+	auto image = single(emoji, size);
+	image.setDevicePixelRatio(p.device()->devicePixelRatio());
+	p.drawImage(x, y, image);
+}
+
+QImage UniversalImages::single(EmojiPtr emoji, int size) const {
 	Expects(emoji->sprite() < _sprites.size());
 
 	const auto large = kUniversalSize;
@@ -449,7 +498,7 @@ void UniversalImages::draw(
 	const auto format = original.format();
 	const auto row = emoji->row();
 	const auto column = emoji->column();
-	auto single = QImage(
+	return QImage(
 		data + (row * kImagesPerRow * large + column) * large * 4,
 		large,
 		large,
@@ -460,8 +509,6 @@ void UniversalImages::draw(
 		size,
 		Qt::IgnoreAspectRatio,
 		Qt::SmoothTransformation);
-	single.setDevicePixelRatio(p.device()->devicePixelRatio());
-	p.drawImage(x, y, single);
 }
 
 QImage UniversalImages::generate(int size, int index) const {
@@ -931,7 +978,10 @@ void Draw(QPainter &p, EmojiPtr emoji, int size, int x, int y) {
 	}
 }
 
-Instance::Instance(int size) : _id(Universal->id()), _size(size) {
+Instance::Instance(int size)
+: _id(Universal->id())
+, _size(size)
+, _unloadTimer([=] { unloadUnusedSprites(); }) {
 	Expects(Universal != nullptr);
 
 	readCache();
@@ -940,6 +990,12 @@ Instance::Instance(int size) : _id(Universal->id()), _size(size) {
 	}
 }
 
+Instance::~Instance() {
+	base::memory_usage::Add(
+		base::memory_usage::Category::EmojiSprites,
+		-_memoryUsage);
+}
+
 bool Instance::cached() const {
 	Expects(Universal != nullptr);
 
@@ -951,25 +1007,90 @@ void Instance::draw(QPainter &p, EmojiPtr emoji, int x, int y) {
 		generateCache();
 	}
 	const auto sprite = emoji->sprite();
-	if (sprite >= _sprites.size()) {
+	if (sprite >= _sprites.size() || !ensureSpriteLoaded(sprite)) {
 		Assert(Universal != nullptr);
-		Universal->draw(p, emoji, _size, x, y);
+
+		auto i = _singles.find(emoji->index());
+		if (i == end(_singles)) {
+			auto pixmap = App::pixmapFromImageInPlace(
+				Universal->single(emoji, _size));
+			pixmap.setDevicePixelRatio(cRetinaFactor());
+			i = _singles.emplace(emoji->index(), std::move(pixmap)).first;
+			accountMemory();
+		}
+		p.drawPixmap(QPoint(x, y), i->second);
 		return;
 	}
+	auto &data = _sprites[sprite];
+	data.used = true;
 	p.drawPixmap(
 		QPoint(x, y),
-		_sprites[sprite],
+		data.pixmap,
 		QRect(emoji->column() * _size, emoji->row() * _size, _size, _size));
 }
 
 void Instance::readCache() {
+	// Only check the cache files here, the sprites are read when painted.
 	for (auto i = 0; i != SpritesCount; ++i) {
-		auto image = LoadFromFile(_id, _size, i);
-		if (image.isNull()) {
+		if (!CacheFileValid(_id, _size, i)) {
 			return;
 		}
-		pushSprite(std::move(image));
+		_sprites.emplace_back();
+	}
+}
+
+bool Instance::ensureSpriteLoaded(int index) {
+	Expects(index >= 0 && index < _sprites.size());
+
+	auto &sprite = _sprites[index];
+	if (!sprite.pixmap.isNull()) {
+		return true;
+	}
+	auto image = LoadFromFile(_id, _size, index);
+	if (image.isNull()) {
+		// The cache file was removed, generate it and the next ones again.
+		_sprites.resize(index);
+		accountMemory();
+		generateCache();
+		return false;
+	}
+	sprite.pixmap = App::pixmapFromImageInPlace(std::move(image));
+	sprite.pixmap.setDevicePixelRatio(cRetinaFactor());
+	accountMemory();
+	if (!_unloadTimer.isActive()) {
+		_unloadTimer.callEach(kUnloadSpritesTimeout);
+	}
+	return true;
+}
+
+void Instance::unloadUnusedSprites() {
+	auto loaded = false;
+	for (auto &sprite : _sprites) {
+		if (!base::take(sprite.used)) {
+			sprite.pixmap = QPixmap();
+		}
+		loaded = loaded || !sprite.pixmap.isNull();
+	}
+	if (!loaded) {
+		_unloadTimer.cancel();
+	}
+	accountMemory();
+}
+
+void Instance::accountMemory() {
+	const auto usage = [](const QPixmap &pixmap) {
+		return int64(pixmap.width()) * pixmap.height() * 4;
+	};
+	auto now = int64(0);
+	for (const auto &sprite : _sprites) {
+		now += usage(sprite.pixmap);
 	}
+	for (const auto &[index, single] : _singles) {
+		now += usage(single);
+	}
+	base::memory_usage::Add(
+		base::memory_usage::Category::EmojiSprites,
+		now - std::exchange(_memoryUsage, now));
 }
 
 void Instance::checkUniversalImages() {
@@ -979,6 +1100,8 @@ void Instance::checkUniversalImages() {
 		_id = Universal->id();
 		_generating = nullptr;
 		_sprites.clear();
+		_singles.clear();
+		accountMemory();
 	}
 	if (!Universal->ensureLoaded() && Universal->id() != 0) {
 		ClearCurrentSetIdSync();
@@ -1013,8 +1136,15 @@ void Instance::generateCache() {
 }
 
 void Instance::pushSprite(QImage &&data) {
-	_sprites.push_back(App::pixmapFromImageInPlace(std::move(data)));
-	_sprites.back().setDevicePixelRatio(cRetinaFactor());
+	_sprites.push_back({ App::pixmapFromImageInPlace(std::move(data)) });
+	_sprites.back().pixmap.setDevicePixelRatio(cRetinaFactor());
+	if (!_unloadTimer.isActive()) {
+		_unloadTimer.callEach(kUnloadSpritesTimeout);
+	}
+	if (cached()) {
+		_singles.clear();
+	}
+	accountMemory();
 }
 
 const std::shared_ptr<UniversalImages> &SourceImages() {
@@ -130,7 +130,24 @@ inline EmojiPtr FromUrl(const QString &url) {
 	return nullptr;
 }
 
+// Plain text is mostly made of characters that can't start an emoji,
+// those are skipped here without calling the generated matcher.
+[[nodiscard]] inline bool CantStart(QChar ch) {
+	// Below U+203C only keycaps, copyright and registered are emoji.
+	constexpr auto kFirstOtherStart = ushort(0x203C);
+	const auto code = ch.unicode();
+	return (code < kFirstOtherStart)
+		&& (code != '#')
+		&& (code != '*')
+		&& (code < '0' || code > '9')
+		&& (code != 0xA9) // copyright
+		&& (code != 0xAE); // registered
+}
+
 inline EmojiPtr Find(const QChar *start, const QChar *end, int *outLength = nullptr) {
+	if (start == end || CantStart(*start)) {
+		return nullptr;
+	}
 	return internal::Find(start, end, outLength);
 }
 
@@ -176,6 +193,7 @@ public:
 	void clear();
 
 	void draw(QPainter &p, EmojiPtr emoji, int size, int x, int y) const;
+	QImage single(EmojiPtr emoji, int size) const;
 
 	// This method must be thread safe and so it is called after
 	// the _id value is fixed and all _sprites are loaded.
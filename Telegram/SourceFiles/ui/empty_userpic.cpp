@@ -14,6 +14,47 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Ui {
 namespace {
 
+// Many chats share colors and initials, so the circles painted for them
+// are kept in one cache for all the lists that show empty userpics.
+constexpr auto kCirclesCacheLimit = 256;
+constexpr auto kCirclesCacheMaxSize = 128;
+
+struct CircleKey {
+	QRgb bg = 0;
+	QRgb fg = 0;
+	int size = 0;
+	QString string;
+
+	inline bool operator<(const CircleKey &other) const {
+		return std::tie(bg, fg, size, string)
+			< std::tie(other.bg, other.fg, other.size, other.string);
+	}
+};
+
+struct CircleEntry {
+	QPixmap pixmap;
+	uint64 lastUsed = 0;
+};
+
+template <typename Generator>
+const QPixmap &CachedCircle(CircleKey &&key, Generator &&generator) {
+	static auto Cache = base::flat_map<CircleKey, CircleEntry>();
+	static auto Counter = uint64(0);
+
+	auto i = Cache.find(key);
+	if (i == end(Cache)) {
+		if (Cache.size() >= kCirclesCacheLimit) {
+			Cache.erase(ranges::min_element(
+				Cache,
+				ranges::less(),
+				[](const auto &pair) { return pair.second.lastUsed; }));
+		}
+		i = Cache.emplace(std::move(key), CircleEntry{ generator() }).first;
+	}
+	i->second.lastUsed = ++Counter;
+	return i->second.pixmap;
+}
+
 void PaintSavedMessagesInner(
 		Painter &p,
 		int x,
@@ -141,9 +182,26 @@ void EmptyUserpic::paint(
 		int y,
 		int outerWidth,
 		int size) const {
-	paint(p, x, y, outerWidth, size, [&p, x, y, size] {
-		p.drawEllipse(x, y, size, size);
+	if (size > kCirclesCacheMaxSize) {
+		paint(p, x, y, outerWidth, size, [&p, x, y, size] {
+			p.drawEllipse(x, y, size, size);
+		});
+		return;
+	}
+	auto key = CircleKey{
+		_color->c.rgba(),
+		st::historyPeerUserpicFg->c.rgba(),
+		size * cIntRetinaFactor(),
+		_string
+	};
+	const auto &circle = CachedCircle(std::move(key), [&] {
+		return Generate(size, [&](Painter &p) {
+			paint(p, 0, 0, size, size, [&p, size] {
+				p.drawEllipse(0, 0, size, size);
+			});
+		});
 	});
+	p.drawPixmapLeft(x, y, outerWidth, circle);
 }
 
 void EmptyUserpic::paintRounded(Painter &p, int x, int y, int outerWidth, int size) const {
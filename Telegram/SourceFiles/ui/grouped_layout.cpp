@@ -10,6 +10,17 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 namespace Ui {
 namespace {
 
+// Views of the same albums are created again on each chat opening.
+constexpr auto kCachedLayoutsCount = 64;
+
+struct CachedLayout {
+	std::vector<QSize> sizes;
+	int maxWidth = 0;
+	int minWidth = 0;
+	int spacing = 0;
+	std::vector<GroupMediaLayout> layout;
+};
+
 int Round(float64 value) {
 	return int(std::round(value));
 }
@@ -572,7 +583,29 @@ std::vector<GroupMediaLayout> LayoutMediaGroup(
 		int maxWidth,
 		int minWidth,
 		int spacing) {
-	return Layouter(sizes, maxWidth, minWidth, spacing).layout();
+	// Albums are laid out only from the main thread.
+	static auto Cache = std::deque<CachedLayout>();
+	const auto i = ranges::find_if(Cache, [&](const CachedLayout &cached) {
+		return (cached.maxWidth == maxWidth)
+			&& (cached.minWidth == minWidth)
+			&& (cached.spacing == spacing)
+			&& (cached.sizes == sizes);
+	});
+	if (i != end(Cache)) {
+		auto result = i->layout;
+		if (i != begin(Cache)) {
+			auto found = std::move(*i);
+			Cache.erase(i);
+			Cache.push_front(std::move(found));
+		}
+		return result;
+	}
+	auto result = Layouter(sizes, maxWidth, minWidth, spacing).layout();
+	Cache.push_front({ sizes, maxWidth, minWidth, spacing, result });
+	if (Cache.size() > size_t(kCachedLayoutsCount)) {
+		Cache.pop_back();
+	}
+	return result;
 }
 
 RectParts GetCornersFromSides(RectParts sides) {
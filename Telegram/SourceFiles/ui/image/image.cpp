@@ -23,6 +23,10 @@ namespace {
 // After 128 MB of unpacked images we try to clear some memory.
 constexpr auto kMemoryForCache = 128 * 1024 * 1024;
 
+// Each image keeps only a few last used prepared pixmaps,
+// so that resizing a window doesn't accumulate stale sizes.
+constexpr auto kSizesCacheLimit = 8;
+
 std::map<QString, std::unique_ptr<Image>> LocalFileImages;
 std::map<QString, std::unique_ptr<Image>> WebUrlImages;
 std::unordered_map<InMemoryKey, std::unique_ptr<Image>> StorageImages;
@@ -44,6 +48,7 @@ int64 ComputeUsage(const QImage &image) {
 [[nodiscard]] Core::MediaActiveCache<const Image> &ActiveCache() {
 	static auto Instance = Core::MediaActiveCache<const Image>(
 		kMemoryForCache,
+		base::memory_usage::Category::ImagesCache,
 		[](const Image *image) { image->unload(); });
 	return Instance;
 }
@@ -554,15 +559,13 @@ const QPixmap &Image::pix(
 		h *= cIntRetinaFactor();
 	}
 	auto options = Option::Smooth | Option::None;
-	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
-		auto p = pixNoCache(origin, w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+	const auto k = PixKey(w, h, options);
+	if (const auto cached = findInSizesCache(k)) {
+		return *cached;
 	}
-	return i.value();
+	auto p = pixNoCache(origin, w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return putToSizesCache(k, std::move(p));
 }
 
 const QPixmap &Image::pixRounded(
@@ -593,15 +596,13 @@ const QPixmap &Image::pixRounded(
 	} else if (radius == ImageRoundRadius::Ellipse) {
 		options |= Option::Circled | cornerOptions(corners);
 	}
-	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
-		auto p = pixNoCache(origin, w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+	const auto k = PixKey(w, h, options);
+	if (const auto cached = findInSizesCache(k)) {
+		return *cached;
 	}
-	return i.value();
+	auto p = pixNoCache(origin, w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return putToSizesCache(k, std::move(p));
 }
 
 const QPixmap &Image::pixCircled(
@@ -617,15 +618,13 @@ const QPixmap &Image::pixCircled(
 		h *= cIntRetinaFactor();
 	}
 	auto options = Option::Smooth | Option::Circled;
-	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
-		auto p = pixNoCache(origin, w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+	const auto k = PixKey(w, h, options);
+	if (const auto cached = findInSizesCache(k)) {
+		return *cached;
 	}
-	return i.value();
+	auto p = pixNoCache(origin, w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return putToSizesCache(k, std::move(p));
 }
 
 const QPixmap &Image::pixBlurredCircled(
@@ -641,15 +640,13 @@ const QPixmap &Image::pixBlurredCircled(
 		h *= cIntRetinaFactor();
 	}
 	auto options = Option::Smooth | Option::Circled | Option::Blurred;
-	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
-		auto p = pixNoCache(origin, w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+	const auto k = PixKey(w, h, options);
+	if (const auto cached = findInSizesCache(k)) {
+		return *cached;
 	}
-	return i.value();
+	auto p = pixNoCache(origin, w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return putToSizesCache(k, std::move(p));
 }
 
 const QPixmap &Image::pixBlurred(
@@ -665,15 +662,13 @@ const QPixmap &Image::pixBlurred(
 		h *= cIntRetinaFactor();
 	}
 	auto options = Option::Smooth | Option::Blurred;
-	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
-		auto p = pixNoCache(origin, w, h, options);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+	const auto k = PixKey(w, h, options);
+	if (const auto cached = findInSizesCache(k)) {
+		return *cached;
 	}
-	return i.value();
+	auto p = pixNoCache(origin, w, h, options);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return putToSizesCache(k, std::move(p));
 }
 
 const QPixmap &Image::pixColored(
@@ -690,15 +685,13 @@ const QPixmap &Image::pixColored(
 		h *= cIntRetinaFactor();
 	}
 	auto options = Option::Smooth | Option::Colored;
-	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
-		auto p = pixColoredNoCache(origin, add, w, h, true);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+	const auto k = PixKey(w, h, options);
+	if (const auto cached = findInSizesCache(k)) {
+		return *cached;
 	}
-	return i.value();
+	auto p = pixColoredNoCache(origin, add, w, h, true);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return putToSizesCache(k, std::move(p));
 }
 
 const QPixmap &Image::pixBlurredColored(
@@ -715,15 +708,13 @@ const QPixmap &Image::pixBlurredColored(
 		h *= cIntRetinaFactor();
 	}
 	auto options = Option::Blurred | Option::Smooth | Option::Colored;
-	auto k = PixKey(w, h, options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend()) {
-		auto p = pixBlurredColoredNoCache(origin, add, w, h);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+	const auto k = PixKey(w, h, options);
+	if (const auto cached = findInSizesCache(k)) {
+		return *cached;
 	}
-	return i.value();
+	auto p = pixBlurredColoredNoCache(origin, add, w, h);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return putToSizesCache(k, std::move(p));
 }
 
 const QPixmap &Image::pixSingle(
@@ -762,18 +753,16 @@ const QPixmap &Image::pixSingle(
 		options |= Option::Colored;
 	}
 
-	auto k = SinglePixKey(options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend() || i->width() != (outerw * cIntRetinaFactor()) || i->height() != (outerh * cIntRetinaFactor())) {
-		if (i != _sizesCache.cend()) {
-			ActiveCache().decrement(ComputeUsage(*i));
-		}
-		auto p = pixNoCache(origin, w, h, options, outerw, outerh, colored);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+	const auto k = SinglePixKey(options);
+	const auto cached = findInSizesCache(k);
+	if (cached
+		&& cached->width() == (outerw * cIntRetinaFactor())
+		&& cached->height() == (outerh * cIntRetinaFactor())) {
+		return *cached;
 	}
-	return i.value();
+	auto p = pixNoCache(origin, w, h, options, outerw, outerh, colored);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return putToSizesCache(k, std::move(p));
 }
 
 const QPixmap &Image::pixBlurredSingle(
@@ -808,18 +797,16 @@ const QPixmap &Image::pixBlurredSingle(
 		options |= Option::Circled | cornerOptions(corners);
 	}
 
-	auto k = SinglePixKey(options);
-	auto i = _sizesCache.constFind(k);
-	if (i == _sizesCache.cend() || i->width() != (outerw * cIntRetinaFactor()) || i->height() != (outerh * cIntRetinaFactor())) {
-		if (i != _sizesCache.cend()) {
-			ActiveCache().decrement(ComputeUsage(*i));
-		}
-		auto p = pixNoCache(origin, w, h, options, outerw, outerh);
-		p.setDevicePixelRatio(cRetinaFactor());
-		i = _sizesCache.insert(k, p);
-		ActiveCache().increment(ComputeUsage(*i));
+	const auto k = SinglePixKey(options);
+	const auto cached = findInSizesCache(k);
+	if (cached
+		&& cached->width() == (outerw * cIntRetinaFactor())
+		&& cached->height() == (outerh * cIntRetinaFactor())) {
+		return *cached;
 	}
-	return i.value();
+	auto p = pixNoCache(origin, w, h, options, outerw, outerh);
+	p.setDevicePixelRatio(cRetinaFactor());
+	return putToSizesCache(k, std::move(p));
 }
 
 QPixmap Image::pixNoCache(
@@ -965,14 +952,26 @@ std::optional<Storage::Cache::Key> Image::cacheKey() const {
 
 bool Image::loaded() const {
 	checkSource();
-	return !_data.isNull();
+	return !_data.isNull() && !_progressive;
+}
+
+bool Image::loadedProgressive() const {
+	checkSource();
+	return !_data.isNull() && _progressive;
 }
 
 void Image::checkSource() const {
 	auto data = _source->takeLoaded();
-	if (_data.isNull() && !data.isNull()) {
+	auto progressive = false;
+	if (data.isNull() && (_data.isNull() || _progressive)) {
+		data = _source->takeProgressive();
+		progressive = true;
+	}
+	if ((_data.isNull() || _progressive) && !data.isNull()) {
 		invalidateSizeCache();
+		ActiveCache().decrement(ComputeUsage(_data));
 		_data = std::move(data);
+		_progressive = progressive;
 		ActiveCache().increment(ComputeUsage(_data));
 	}
 
@@ -984,6 +983,7 @@ void Image::unload() const {
 	invalidateSizeCache();
 	ActiveCache().decrement(ComputeUsage(_data));
 	_data = QImage();
+	_progressive = false;
 }
 
 void Image::setDelayedStorageLocation(
@@ -1000,10 +1000,35 @@ void Image::setImageBytes(const QByteArray &bytes) {
 	checkSource();
 }
 
+const QPixmap *Image::findInSizesCache(uint64 key) const {
+	const auto i = ranges::find(_sizesCache, key, &SizesCacheEntry::key);
+	if (i == end(_sizesCache)) {
+		return nullptr;
+	}
+	// Keep the most recently used variants at the end of the list.
+	_sizesCache.splice(end(_sizesCache), _sizesCache, i);
+	return &i->pixmap;
+}
+
+const QPixmap &Image::putToSizesCache(uint64 key, QPixmap &&pixmap) const {
+	auto &cache = ActiveCache();
+	const auto i = ranges::find(_sizesCache, key, &SizesCacheEntry::key);
+	if (i != end(_sizesCache)) {
+		cache.decrement(ComputeUsage(i->pixmap));
+		_sizesCache.erase(i);
+	} else if (int(_sizesCache.size()) >= kSizesCacheLimit) {
+		cache.decrement(ComputeUsage(_sizesCache.front().pixmap));
+		_sizesCache.pop_front();
+	}
+	cache.increment(ComputeUsage(pixmap));
+	_sizesCache.push_back({ key, std::move(pixmap) });
+	return _sizesCache.back().pixmap;
+}
+
 void Image::invalidateSizeCache() const {
 	auto &cache = ActiveCache();
-	for (const auto &image : std::as_const(_sizesCache)) {
-		cache.decrement(ComputeUsage(image));
+	for (const auto &entry : _sizesCache) {
+		cache.decrement(ComputeUsage(entry.pixmap));
 	}
 	_sizesCache.clear();
 }
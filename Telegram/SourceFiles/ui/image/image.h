@@ -9,6 +9,8 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "ui/image/image_prepare.h"
 
+#include <list>
+
 class HistoryItem;
 
 namespace Images {
@@ -59,6 +61,7 @@ public:
 	virtual void load(Data::FileOrigin origin) = 0;
 	virtual void loadEvenCancelled(Data::FileOrigin origin) = 0;
 	virtual QImage takeLoaded() = 0;
+	virtual QImage takeProgressive() = 0;
 	virtual void unload() = 0;
 
 	virtual void automaticLoad(
@@ -223,6 +226,7 @@ public:
 	}
 
 	bool loaded() const;
+	[[nodiscard]] bool loadedProgressive() const;
 	bool isNull() const;
 	void unload() const;
 	void setDelayedStorageLocation(
@@ -233,11 +237,21 @@ public:
 	~Image();
 
 private:
+	struct SizesCacheEntry {
+		uint64 key = 0;
+		QPixmap pixmap;
+	};
+
 	void checkSource() const;
+	[[nodiscard]] const QPixmap *findInSizesCache(uint64 key) const;
+	const QPixmap &putToSizesCache(uint64 key, QPixmap &&pixmap) const;
 	void invalidateSizeCache() const;
 
 	std::unique_ptr<Images::Source> _source;
-	mutable QMap<uint64, QPixmap> _sizesCache;
+
+	// Least recently used first, references stay valid until eviction.
+	mutable std::list<SizesCacheEntry> _sizesCache;
 	mutable QImage _data;
+	mutable bool _progressive = false;
 
 };
@@ -7,6 +7,14 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 */
 #include "ui/image/image_prepare.h"
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define IMAGE_PREPARE_USE_SSE2
+#include <emmintrin.h>
+#elif defined __ARM_NEON
+#define IMAGE_PREPARE_USE_NEON
+#include <arm_neon.h>
+#endif // __SSE2__ || _M_X64 || _M_IX86_FP >= 2 || __ARM_NEON
+
 namespace Images {
 namespace {
 
@@ -14,6 +22,140 @@ TG_FORCE_INLINE uint64 blurGetColors(const uchar *p) {
 	return (uint64)p[0] + ((uint64)p[1] << 16) + ((uint64)p[2] << 32) + ((uint64)p[3] << 48);
 }
 
+// Blurs two neighbour columns at once, each in its own 64 bit lane,
+// with exactly the same arithmetic as the scalar loop in prepareBlur.
+// Returns the first column that is left for the scalar loop.
+int BlurColumnPairs(uchar *pix, const uint64 *rgb, int w, int h, int radius) {
+	const auto r1 = radius + 1;
+	const auto stride = w * 4;
+	auto x = 0;
+#if defined IMAGE_PREPARE_USE_SSE2 || defined IMAGE_PREPARE_USE_NEON
+	const auto he = h - r1;
+	for (; x + 2 <= w; x += 2) {
+		uint64 allsums[2], sums[2];
+		for (auto j = 0; j != 2; ++j) {
+			allsums[j] = -radius * rgb[x + j];
+			sums[j] = rgb[x + j] * ((r1 * (r1 + 1)) >> 1);
+			for (auto i = 1; i <= radius; i++) {
+				sums[j] += rgb[i * w + x + j] * (r1 - i);
+				allsums[j] += rgb[i * w + x + j];
+			}
+		}
+		auto yi = x * 4;
+#if defined IMAGE_PREPARE_USE_SSE2
+		const auto mask = _mm_set1_epi16(0x00FF);
+		const auto load = [&](int row) {
+			return _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(rgb + row * w + x));
+		};
+		auto rgballsum = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(allsums));
+		auto rgbsum = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sums));
+		const auto update = [&](int start, int middle, int end) {
+			const auto res = _mm_and_si128(_mm_srli_epi64(rgbsum, 4), mask);
+			_mm_storel_epi64(
+				reinterpret_cast<__m128i*>(pix + yi),
+				_mm_packus_epi16(res, res));
+			const auto twice = load(middle);
+			rgballsum = _mm_add_epi64(
+				_mm_sub_epi64(
+					_mm_add_epi64(rgballsum, load(start)),
+					_mm_add_epi64(twice, twice)),
+				load(end));
+			rgbsum = _mm_add_epi64(rgbsum, rgballsum);
+			yi += stride;
+		};
+#elif defined IMAGE_PREPARE_USE_NEON
+		const auto mask = vdupq_n_u16(0x00FF);
+		const auto load = [&](int row) {
+			return vld1q_u64(
+				reinterpret_cast<const uint64_t*>(rgb + row * w + x));
+		};
+		auto rgballsum = vld1q_u64(reinterpret_cast<const uint64_t*>(allsums));
+		auto rgbsum = vld1q_u64(reinterpret_cast<const uint64_t*>(sums));
+		const auto update = [&](int start, int middle, int end) {
+			const auto res = vandq_u16(
+				vreinterpretq_u16_u64(vshrq_n_u64(rgbsum, 4)),
+				mask);
+			vst1_u8(pix + yi, vmovn_u16(res));
+			rgballsum = vaddq_u64(
+				vsubq_u64(
+					vaddq_u64(rgballsum, load(start)),
+					vshlq_n_u64(load(middle), 1)),
+				load(end));
+			rgbsum = vaddq_u64(rgbsum, rgballsum);
+			yi += stride;
+		};
+#endif // IMAGE_PREPARE_USE_SSE2 || IMAGE_PREPARE_USE_NEON
+		auto y = 0;
+		for (; y < r1; ++y) {
+			update(0, y, y + r1);
+		}
+		for (; y < he; ++y) {
+			update(y - r1, y, y + r1);
+		}
+		for (; y < h; ++y) {
+			update(y - r1, y, h - 1);
+		}
+	}
+#endif // IMAGE_PREPARE_USE_SSE2 || IMAGE_PREPARE_USE_NEON
+	return x;
+}
+
+// Multiplies each channel by (opacity + 1) / 256, like anim::shifted().
+void MaskCornerLine(
+		uint32 *ints,
+		const uchar *mask,
+		int maskBytesPerPixel,
+		int width) {
+	const auto till = ints + width;
+#if defined IMAGE_PREPARE_USE_SSE2
+	const auto zero = _mm_setzero_si128();
+	for (; ints + 4 <= till; ints += 4) {
+		const auto opacity = [&](int index) {
+			return short(mask[index * maskBytesPerPixel]) + 1;
+		};
+		const auto o0 = opacity(0), o1 = opacity(1);
+		const auto o2 = opacity(2), o3 = opacity(3);
+		mask += 4 * maskBytesPerPixel;
+
+		const auto pixels = reinterpret_cast<__m128i*>(ints);
+		const auto colors = _mm_loadu_si128(pixels);
+		const auto low = _mm_srli_epi16(_mm_mullo_epi16(
+			_mm_unpacklo_epi8(colors, zero),
+			_mm_set_epi16(o1, o1, o1, o1, o0, o0, o0, o0)), 8);
+		const auto high = _mm_srli_epi16(_mm_mullo_epi16(
+			_mm_unpackhi_epi8(colors, zero),
+			_mm_set_epi16(o3, o3, o3, o3, o2, o2, o2, o2)), 8);
+		_mm_storeu_si128(pixels, _mm_packus_epi16(low, high));
+	}
+#elif defined IMAGE_PREPARE_USE_NEON
+	for (; ints + 4 <= till; ints += 4) {
+		const auto opacity = [&](int index) {
+			return vdup_n_u16(uint16_t(mask[index * maskBytesPerPixel]) + 1);
+		};
+		const auto lowOpacity = vcombine_u16(opacity(0), opacity(1));
+		const auto highOpacity = vcombine_u16(opacity(2), opacity(3));
+		mask += 4 * maskBytesPerPixel;
+
+		const auto pixels = reinterpret_cast<uint8_t*>(ints);
+		const auto colors = vld1q_u8(pixels);
+		const auto low = vshrq_n_u16(
+			vmulq_u16(vmovl_u8(vget_low_u8(colors)), lowOpacity),
+			8);
+		const auto high = vshrq_n_u16(
+			vmulq_u16(vmovl_u8(vget_high_u8(colors)), highOpacity),
+			8);
+		vst1q_u8(pixels, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+	}
+#endif // IMAGE_PREPARE_USE_SSE2 || IMAGE_PREPARE_USE_NEON
+	for (; ints != till; ++ints) {
+		auto opacity = static_cast<anim::ShiftedMultiplier>(*mask) + 1;
+		*ints = anim::unshifted(anim::shifted(*ints) * opacity);
+		mask += maskBytesPerPixel;
+	}
+}
+
 const QImage &circleMask(QSize size) {
 	Assert(Global::started());
 
@@ -128,7 +270,7 @@ x++;
 			}
 
 			const int he = h - r1;
-			for (x = 0; x < w; x++) {
+			for (x = BlurColumnPairs(pix, rgb, w, h, radius); x < w; x++) {
 				uint64 rgballsum = -radius * rgb[x];
 				uint64 rgbsum = rgb[x] * ((r1 * (r1 + 1)) >> 1);
 				for (i = 1; i <= radius; i++) {
@@ -436,14 +578,9 @@ void prepareRound(
 		auto imageIntsAdded = imageIntsPerLine - maskWidth * imageIntsPerPixel;
 		Assert(imageIntsAdded >= 0);
 		for (auto y = 0; y != maskHeight; ++y) {
-			for (auto x = 0; x != maskWidth; ++x) {
-				auto opacity = static_cast<anim::ShiftedMultiplier>(*maskBytes) + 1;
-				*imageInts = anim::unshifted(anim::shifted(*imageInts) * opacity);
-				maskBytes += maskBytesPerPixel;
-				imageInts += imageIntsPerPixel;
-			}
-			maskBytes += maskBytesAdded;
-			imageInts += imageIntsAdded;
+			MaskCornerLine(imageInts, maskBytes, maskBytesPerPixel, maskWidth);
+			maskBytes += maskBytesPerLine;
+			imageInts += imageIntsPerLine;
 		}
 	};
 	if (corners & RectPart::TopLeft) maskCorner(intsTopLeft, cornerMasks[0]);
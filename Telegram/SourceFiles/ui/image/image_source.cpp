@@ -41,6 +41,10 @@ QImage ImageSource::takeLoaded() {
 	return _data;
 }
 
+QImage ImageSource::takeProgressive() {
+	return QImage();
+}
+
 void ImageSource::unload() {
 	if (_bytes.isEmpty() && !_data.isNull()) {
 		if (_format != "JPG") {
@@ -180,6 +184,10 @@ QImage LocalFileSource::takeLoaded() {
 	return std::move(_data);
 }
 
+QImage LocalFileSource::takeProgressive() {
+	return QImage();
+}
+
 void LocalFileSource::unload() {
 	_data = QImage();
 }
@@ -295,6 +303,10 @@ QImage RemoteSource::takeLoaded() {
 	return data;
 }
 
+QImage RemoteSource::takeProgressive() {
+	return _loader ? _loader->takeProgressiveImage() : QImage();
+}
+
 void RemoteSource::destroyLoader() {
 	if (!_loader) {
 		return;
@@ -18,6 +18,7 @@ public:
 	void load(Data::FileOrigin origin) override;
 	void loadEvenCancelled(Data::FileOrigin origin) override;
 	QImage takeLoaded() override;
+	QImage takeProgressive() override;
 	void unload() override;
 
 	void automaticLoad(
@@ -67,6 +68,7 @@ public:
 	void load(Data::FileOrigin origin) override;
 	void loadEvenCancelled(Data::FileOrigin origin) override;
 	QImage takeLoaded() override;
+	QImage takeProgressive() override;
 	void unload() override;
 
 	void automaticLoad(
@@ -113,6 +115,7 @@ public:
 	void load(Data::FileOrigin origin) override;
 	void loadEvenCancelled(Data::FileOrigin origin) override;
 	QImage takeLoaded() override;
+	QImage takeProgressive() override;
 	void unload() override;
 
 	void automaticLoad(
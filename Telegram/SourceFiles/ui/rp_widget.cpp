@@ -114,10 +114,16 @@ bool RpWidgetMethods::handleEvent(QEvent *event) {
 	case QEvent::Move:
 	case QEvent::Resize:
 		if (auto streams = _eventStreams.get()) {
-			auto that = callCreateWeak();
-			streams->geometry.fire_copy(callGetGeometry());
-			if (!that) {
-				return true;
+			// setGeometry() sends both Move and Resize with the final
+			// geometry already applied, fire the layout chains only once.
+			const auto geometry = callGetGeometry();
+			if (geometry != streams->lastGeometry) {
+				streams->lastGeometry = geometry;
+				auto that = callCreateWeak();
+				streams->geometry.fire_copy(geometry);
+				if (!that) {
+					return true;
+				}
 			}
 		}
 		break;
@@ -152,6 +158,7 @@ void RpWidgetMethods::visibilityChangedHook(bool wasVisible, bool nowVisible) {
 auto RpWidgetMethods::eventStreams() const -> EventStreams& {
 	if (!_eventStreams) {
 		_eventStreams = std::make_unique<EventStreams>();
+		_eventStreams->lastGeometry = callGetGeometry();
 	}
 	return *_eventStreams;
 }
@@ -143,6 +143,7 @@ private:
 	friend class RpWidgetWrap;
 
 	struct EventStreams {
+		QRect lastGeometry;
 		rpl::event_stream<QRect> geometry;
 		rpl::event_stream<QRect> paint;
 		rpl::event_stream<bool> shown;
@@ -2728,7 +2728,8 @@ String::String(const String &other)
 , _text(other._text)
 , _st(other._st)
 , _links(other._links)
-, _startDir(other._startDir) {
+, _startDir(other._startDir)
+, _lineLayouts(other._lineLayouts) {
 	_blocks.reserve(other._blocks.size());
 	for (auto &block : other._blocks) {
 		_blocks.push_back(block->clone());
@@ -2743,7 +2744,8 @@ String::String(String &&other)
 , _st(other._st)
 , _blocks(std::move(other._blocks))
 , _links(other._links)
-, _startDir(other._startDir) {
+, _startDir(other._startDir)
+, _lineLayouts(other._lineLayouts) {
 	other.clearFields();
 }
 
@@ -2756,6 +2758,7 @@ String &String::operator=(const String &other) {
 	_blocks = TextBlocks(other._blocks.size());
 	_links = other._links;
 	_startDir = other._startDir;
+	_lineLayouts = other._lineLayouts;
 	for (int32 i = 0, l = _blocks.size(); i < l; ++i) {
 		_blocks[i] = other._blocks.at(i)->clone();
 	}
@@ -2771,6 +2774,7 @@ String &String::operator=(String &&other) {
 	_blocks = std::move(other._blocks);
 	_links = other._links;
 	_startDir = other._startDir;
+	_lineLayouts = other._lineLayouts;
 	other.clearFields();
 	return *this;
 }
@@ -2787,6 +2791,8 @@ void String::setText(const style::TextStyle &st, const QString &text, const Text
 void String::recountNaturalSize(bool initial, Qt::LayoutDirection optionsDir) {
 	NewlineBlock *lastNewline = 0;
 
+	_lineLayouts = {};
+
 	_maxWidth = _minHeight = 0;
 	int32 lineHeight = 0;
 	int32 result = 0, lastNewlineStart = 0;
@@ -2946,24 +2952,37 @@ int String::countWidth(int width) const {
 		return _maxWidth.ceil().toInt();
 	}
 
-	QFixed maxLineWidth = 0;
-	enumerateLines(width, [&maxLineWidth](QFixed lineWidth, int lineHeight) {
-		if (lineWidth > maxLineWidth) {
-			maxLineWidth = lineWidth;
-		}
-	});
-	return maxLineWidth.ceil().toInt();
+	return countLineLayout(width).maxLineWidth;
 }
 
 int String::countHeight(int width) const {
 	if (QFixed(width) >= _maxWidth) {
 		return _minHeight;
 	}
-	int result = 0;
-	enumerateLines(width, [&result](QFixed lineWidth, int lineHeight) {
-		result += lineHeight;
+	return countLineLayout(width).height;
+}
+
+auto String::countLineLayout(int width) const -> const LineLayout & {
+	auto &first = _lineLayouts.front();
+	if (first.width == width) {
+		return first;
+	}
+	auto &second = _lineLayouts.back();
+	if (second.width == width) {
+		std::swap(first, second);
+		return first;
+	}
+	auto height = 0;
+	auto maxLineWidth = QFixed(0);
+	enumerateLines(width, [&](QFixed lineWidth, int lineHeight) {
+		height += lineHeight;
+		accumulate_max(maxLineWidth, lineWidth);
 	});
-	return result;
+	second = first;
+	first.width = width;
+	first.height = height;
+	first.maxLineWidth = maxLineWidth.ceil().toInt();
+	return first;
 }
 
 void String::countLineWidths(int width, QVector<int> *lineWidths) const {
@@ -3343,6 +3362,7 @@ void String::clearFields() {
 	_links.clear();
 	_maxWidth = _minHeight = 0;
 	_startDir = Qt::LayoutDirectionAuto;
+	_lineLayouts = {};
 }
 
 String::~String() = default;
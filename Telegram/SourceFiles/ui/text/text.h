@@ -222,6 +222,15 @@ private:
 	template <typename Callback>
 	void enumerateLines(int w, Callback callback) const;
 
+	struct LineLayout {
+		int width = -1;
+		int height = 0;
+		int maxLineWidth = 0;
+	};
+
+	// Last results of enumerateLines() for countWidth() and countHeight().
+	const LineLayout &countLineLayout(int width) const;
+
 	void recountNaturalSize(bool initial, Qt::LayoutDirection optionsDir = Qt::LayoutDirectionAuto);
 
 	// clear() deletes all blocks and calls this method
@@ -245,6 +254,9 @@ private:
 
 	Qt::LayoutDirection _startDir = Qt::LayoutDirectionAuto;
 
+	// Most recently used first, messages are resized to a couple of widths.
+	mutable std::array<LineLayout, 2> _lineLayouts;
+
 	friend class Parser;
 	friend class Renderer;
 
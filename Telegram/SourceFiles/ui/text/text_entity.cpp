@@ -1616,6 +1616,32 @@ void ParseEntities(TextWithEntities &result, int32 flags, bool rich) {
 	int32 len = result.text.size(), commandOffset = rich ? 0 : len;
 	bool inLink = false, commandIsLink = false;
 	const QChar *start = result.text.constData(), *end = start + result.text.size();
+
+	// The text doesn't change, so an expression is matched again only
+	// when the offset passes its last match, till then it is the same.
+	struct Cached {
+		QRegularExpressionMatch match;
+		int from = -1;
+	};
+	const auto refresh = [&](
+			Cached &cached,
+			const QRegularExpression &expression,
+			int from) -> const QRegularExpressionMatch& {
+		if (cached.from < 0
+			|| from < cached.from
+			|| (cached.match.hasMatch()
+				&& cached.match.capturedStart() < from)) {
+			cached.match = expression.match(result.text, from);
+			cached.from = from;
+		}
+		return cached.match;
+	};
+	auto cachedDomain = Cached();
+	auto cachedExplicitDomain = Cached();
+	auto cachedHashtag = Cached();
+	auto cachedMention = Cached();
+	auto cachedBotCommand = Cached();
+
 	for (int32 offset = 0, matchOffset = offset, mentionSkip = 0; offset < len;) {
 		if (commandOffset <= offset) {
 			for (commandOffset = offset; commandOffset < len; ++commandOffset) {
@@ -1626,11 +1652,26 @@ void ParseEntities(TextWithEntities &result, int32 flags, bool rich) {
 				}
 			}
 		}
-		auto mDomain = qthelp::RegExpDomain().match(result.text, matchOffset);
-		auto mExplicitDomain = qthelp::RegExpDomainExplicit().match(result.text, matchOffset);
-		auto mHashtag = withHashtags ? RegExpHashtag().match(result.text, matchOffset) : QRegularExpressionMatch();
-		auto mMention = withMentions ? RegExpMention().match(result.text, qMax(mentionSkip, matchOffset)) : QRegularExpressionMatch();
-		auto mBotCommand = withBotCommands ? RegExpBotCommand().match(result.text, matchOffset) : QRegularExpressionMatch();
+		auto mDomain = refresh(
+			cachedDomain,
+			qthelp::RegExpDomain(),
+			matchOffset);
+		auto mExplicitDomain = refresh(
+			cachedExplicitDomain,
+			qthelp::RegExpDomainExplicit(),
+			matchOffset);
+		auto mHashtag = withHashtags
+			? refresh(cachedHashtag, RegExpHashtag(), matchOffset)
+			: QRegularExpressionMatch();
+		auto mMention = withMentions
+			? refresh(
+				cachedMention,
+				RegExpMention(),
+				qMax(mentionSkip, matchOffset))
+			: QRegularExpressionMatch();
+		auto mBotCommand = withBotCommands
+			? refresh(cachedBotCommand, RegExpBotCommand(), matchOffset)
+			: QRegularExpressionMatch();
 
 		auto lnkType = EntityType::Url;
 		int32 lnkStart = 0, lnkLength = 0;
@@ -1670,7 +1711,10 @@ void ParseEntities(TextWithEntities &result, int32 flags, bool rich) {
 			}
 			if (!(start + mentionStart + 1)->isLetter() || !(start + mentionEnd - 1)->isLetterOrNumber()) {
 				mentionSkip = mentionEnd;
-				mMention = RegExpMention().match(result.text, qMax(mentionSkip, matchOffset));
+				mMention = refresh(
+					cachedMention,
+					RegExpMention(),
+					qMax(mentionSkip, matchOffset));
 				if (mMention.hasMatch()) {
 					mentionStart = mMention.capturedStart();
 					mentionEnd = mMention.capturedEnd();
@@ -35,6 +35,8 @@ namespace Ui {
 namespace {
 
 constexpr auto kMaxUsernameLength = 32;
+constexpr auto kDelayedChangeTextLength = 16 * 1024;
+constexpr auto kDelayedChangeTimeout = crl::time(200);
 constexpr auto kInstantReplaceRandomId = QTextFormat::UserProperty;
 constexpr auto kInstantReplaceWhatId = QTextFormat::UserProperty + 1;
 constexpr auto kInstantReplaceWithId = QTextFormat::UserProperty + 2;
@@ -1310,6 +1312,12 @@ InputField::InputField(
 	_inner->setAcceptRichText(false);
 	resize(_st.width, _minHeight);
 
+	_contentsChangeTimer.setCallback([=] {
+		if (_contentsChangePending) {
+			handleContentsChanged();
+		}
+	});
+
 	if (_st.textBg->c.alphaF() >= 1.) {
 		setAttribute(Qt::WA_OpaquePaintEvent);
 	}
@@ -2244,7 +2252,14 @@ void InputField::onDocumentContentsChange(
 	const auto guard = gsl::finally([&] {
 		_correcting = false;
 		QTextCursor(document->docHandle(), 0).endEditBlock();
-		handleContentsChanged();
+		if (document->characterCount() < kDelayedChangeTextLength) {
+			handleContentsChanged();
+		} else {
+			_contentsChangePending = true;
+			if (!_contentsChangeTimer.isActive()) {
+				_contentsChangeTimer.callOnce(kDelayedChangeTimeout);
+			}
+		}
 	});
 
 	chopByMaxLength(insertPosition, insertLength);
@@ -2300,7 +2315,16 @@ void InputField::chopByMaxLength(int insertPosition, int insertLength) {
 	}
 }
 
+void InputField::applyPendingContentsChange() const {
+	if (_contentsChangePending && !_correcting) {
+		const_cast<InputField*>(this)->handleContentsChanged();
+	}
+}
+
 void InputField::handleContentsChanged() {
+	_contentsChangePending = false;
+	_contentsChangeTimer.cancel();
+
 	setErrorShown(false);
 
 	auto tagsChanged = false;
@@ -2512,6 +2536,7 @@ TextWithTags InputField::getTextWithTagsPart(int start, int end) const {
 }
 
 TextWithTags InputField::getTextWithAppliedMarkdown() const {
+	applyPendingContentsChange();
 	if (!_markdownEnabled || _lastMarkdownTags.empty()) {
 		return getTextWithTags();
 	}
@@ -9,6 +9,7 @@ https://github.com/telegramdesktop/tdesktop/blob/master/LEGAL
 
 #include "ui/rp_widget.h"
 #include "ui/effects/animations.h"
+#include "base/timer.h"
 #include "styles/style_widgets.h"
 
 #include <QtWidgets/QLineEdit>
@@ -190,15 +191,18 @@ public:
 	void setMaxHeight(int maxHeight);
 
 	const TextWithTags &getTextWithTags() const {
+		applyPendingContentsChange();
 		return _lastTextWithTags;
 	}
 	const std::vector<MarkdownTag> &getMarkdownTags() const {
+		applyPendingContentsChange();
 		return _lastMarkdownTags;
 	}
 	TextWithTags getTextWithTagsPart(int start, int end = -1) const;
 	TextWithTags getTextWithAppliedMarkdown() const;
 	void insertTag(const QString &text, QString tagId = QString());
 	bool empty() const {
+		applyPendingContentsChange();
 		return _lastTextWithTags.text.isEmpty();
 	}
 	enum class HistoryAction {
@@ -249,6 +253,7 @@ public:
 	static bool IsValidMarkdownLink(const QString &link);
 
 	const QString &getLastText() const {
+		applyPendingContentsChange();
 		return _lastTextWithTags.text;
 	}
 	void setPlaceholder(
@@ -350,6 +355,7 @@ private:
 	friend class Inner;
 
 	void handleContentsChanged();
+	void applyPendingContentsChange() const;
 	bool viewportEventInner(QEvent *e);
 	void handleTouchEvent(QTouchEvent *e);
 
@@ -502,6 +508,12 @@ private:
 	QPoint _touchStart;
 
 	bool _correcting = false;
+
+	// Collecting text and tags of a huge text takes long, so it is done
+	// at most once in a while, or as soon as somebody asks for them.
+	base::Timer _contentsChangeTimer;
+	bool _contentsChangePending = false;
+
 	MimeDataHook _mimeDataHook;
 	base::unique_qptr<Ui::PopupMenu> _contextMenu;
 
@@ -41,6 +41,7 @@ namespace {
 
 constexpr auto kInactivePressTimeout = crl::time(200);
 constexpr auto kSaveWindowPositionTimeout = crl::time(1000);
+constexpr auto kUnreadCounterUpdateTimeout = crl::time(300);
 
 } // namespace
 
@@ -131,7 +132,7 @@ MainWindow::MainWindow(not_null<Controller*> controller)
 		}
 	});
 	subscribe(Global::RefUnreadCounterUpdate(), [=] {
-		updateUnreadCounter();
+		requestUnreadCounterUpdate();
 	});
 	subscribe(Global::RefWorkMode(), [=](DBIWorkMode mode) {
 		workmodeUpdated(mode);
@@ -155,6 +156,7 @@ MainWindow::MainWindow(not_null<Controller*> controller)
 	}
 
 	_isActiveTimer.setCallback([this] { updateIsActive(0); });
+	_unreadCounterTimer.setCallback([=] { updateUnreadCounter(); });
 	_inactivePressTimer.setCallback([this] { setInactivePress(false); });
 }
 
@@ -318,6 +320,11 @@ void MainWindow::init() {
 		&QWindow::windowStateChanged,
 		this,
 		[=](Qt::WindowState state) { handleStateChanged(state); });
+	connect(
+		windowHandle(),
+		&QWindow::visibleChanged,
+		this,
+		[=] { handleVisibleChanged(); });
 
 	updatePalette();
 
@@ -337,6 +344,13 @@ void MainWindow::handleStateChanged(Qt::WindowState state) {
 		minimizeToTray();
 	}
 	savePosition(state);
+	handleVisibleChanged();
+}
+
+void MainWindow::handleVisibleChanged() {
+	const auto hidden = !windowHandle()->isVisible()
+		|| (windowHandle()->windowState() == Qt::WindowMinimized);
+	Core::App().animationManager().setBackgroundMode(hidden);
 }
 
 void MainWindow::handleActiveChanged() {
@@ -494,9 +508,27 @@ void MainWindow::updateControlsGeometry() {
 	_body->setGeometry(0, bodyTop, bodyWidth, height() - bodyTop);
 }
 
+void MainWindow::requestUnreadCounterUpdate() {
+	// Tray and taskbar icons are rendered and sent to the system on each
+	// update, so while messages flood in apply the counter a few times a
+	// second, the last value always gets applied by the timer.
+	if (_unreadCounterTimer.isActive()) {
+		return;
+	}
+	const auto passed = crl::now() - _unreadCounterUpdated;
+	if (passed >= kUnreadCounterUpdateTimeout) {
+		updateUnreadCounter();
+	} else {
+		_unreadCounterTimer.callOnce(kUnreadCounterUpdateTimeout - passed);
+	}
+}
+
 void MainWindow::updateUnreadCounter() {
 	if (!Global::started() || App::quitting()) return;
 
+	_unreadCounterTimer.cancel();
+	_unreadCounterUpdated = crl::now();
+
 	const auto counter = account().sessionExists()
 		? account().session().data().unreadBadge()
 		: 0;
@@ -109,6 +109,7 @@ protected:
 	void savePosition(Qt::WindowState state = Qt::WindowActive);
 	void handleStateChanged(Qt::WindowState state);
 	void handleActiveChanged();
+	void handleVisibleChanged();
 
 	virtual void initHook() {
 	}
@@ -159,6 +160,7 @@ protected:
 
 private:
 	void updatePalette();
+	void requestUnreadCounterUpdate();
 	void updateUnreadCounter();
 	void initSize();
 
@@ -183,6 +185,8 @@ private:
 	QIcon _icon;
 	bool _usingSupportIcon = false;
 	QString _titleText;
+	base::Timer _unreadCounterTimer;
+	crl::time _unreadCounterUpdated = 0;
 
 	bool _isActive = false;
 	base::Timer _isActiveTimer;
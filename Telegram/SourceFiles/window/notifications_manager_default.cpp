@@ -33,6 +33,9 @@ namespace Notifications {
 namespace Default {
 namespace {
 
+// Coalesces the repaints requested by bursts of setting or lock changes.
+constexpr auto kUpdateAllDelay = crl::time(50);
+
 int notificationMaxHeight() {
 	return st::notifyMinHeight + st::notifyReplyArea.heightMax + st::notifyBorderWidth;
 }
@@ -59,7 +62,8 @@ std::unique_ptr<Manager> Create(System *system) {
 
 Manager::Manager(System *system)
 : Notifications::Manager(system)
-, _inputCheckTimer([=] { checkLastInput(); }) {
+, _inputCheckTimer([=] { checkLastInput(); })
+, _updateAllTimer([=] { updateAllNow(); }) {
 	subscribe(system->session().downloader().taskFinished(), [this] {
 		for (const auto &notification : _notifications) {
 			notification->updatePeerPhoto();
@@ -301,7 +305,22 @@ void Manager::removeWidget(internal::Widget *remove) {
 void Manager::doShowNotification(
 		not_null<HistoryItem*> item,
 		int forwardedCount) {
-	_queuedNotifications.emplace_back(item, forwardedCount);
+	auto queued = QueuedNotification(item, forwardedCount);
+
+	// While a chat floods the queue only its latest message waits there,
+	// it takes the place of the earlier one not to jump over other chats.
+	const auto i = ranges::find_if(_queuedNotifications, [&](
+			const QueuedNotification &already) {
+		return (already.history == queued.history)
+			&& (already.forwardedCount < 2)
+			&& (queued.forwardedCount < 2)
+			&& (already.fromScheduled == queued.fromScheduled);
+	});
+	if (i != end(_queuedNotifications)) {
+		*i = std::move(queued);
+	} else {
+		_queuedNotifications.push_back(std::move(queued));
+	}
 	showNextFromQueue();
 }
 
@@ -353,6 +372,12 @@ void Manager::doClearFromItem(not_null<HistoryItem*> item) {
 }
 
 void Manager::doUpdateAll() {
+	if (!_updateAllTimer.isActive()) {
+		_updateAllTimer.callOnce(kUpdateAllDelay);
+	}
+}
+
+void Manager::updateAllNow() {
 	for_const (auto &notification, _notifications) {
 		notification->updateNotifyDisplay();
 	}
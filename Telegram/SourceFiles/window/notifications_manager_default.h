@@ -52,6 +52,7 @@ private:
 	QPixmap hiddenUserpicPlaceholder() const;
 
 	void doUpdateAll() override;
+	void updateAllNow();
 	void doShowNotification(
 		not_null<HistoryItem*> item,
 		int forwardedCount) override;
@@ -83,6 +84,7 @@ private:
 
 	bool _positionsOutdated = false;
 	base::Timer _inputCheckTimer;
+	base::Timer _updateAllTimer;
 
 	struct QueuedNotification {
 		QueuedNotification(not_null<HistoryItem*> item, int forwardedCount);
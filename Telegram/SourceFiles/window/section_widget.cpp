@@ -106,6 +106,14 @@ void SectionWidget::PaintBackground(not_null<QWidget*> widget, QRect clip) {
 					p.drawPixmap(QPointF(i * w, fromy + j * h), pix);
 				}
 			}
+		} else if (const auto &last = App::main()->lastCachedBackground();
+			!last.isNull()) {
+			// Stretch the previous cache while a new one is not ready,
+			// scaling the full size background on each frame is too slow.
+			QRect to, from;
+			Window::Theme::ComputeBackgroundRects(fill, last.size(), to, from);
+			to.moveTop(to.top() + fromy);
+			p.drawPixmap(to, last, from);
 		} else {
 			PainterHighQualityEnabler hq(p);
 
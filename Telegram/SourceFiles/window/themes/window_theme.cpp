@@ -1121,13 +1121,18 @@ void Uninitialize() {
 	GlobalApplying = Applying();
 }
 
-bool Apply(
+void Apply(
 		const QString &filepath,
 		const Data::CloudTheme &cloud) {
-	if (auto preview = PreviewFromFile(QByteArray(), filepath, cloud)) {
-		return Apply(std::move(preview));
-	}
-	return false;
+	crl::async([=] {
+		auto preview = PreviewFromFile(QByteArray(), filepath, cloud);
+		if (!preview) {
+			return;
+		}
+		crl::on_main([preview = std::move(preview)]() mutable {
+			Apply(std::move(preview));
+		});
+	});
 }
 
 bool Apply(std::unique_ptr<Preview> preview) {
@@ -57,7 +57,8 @@ struct Preview {
 	QImage preview;
 };
 
-bool Apply(
+// Reads and parses the theme file in the background.
+void Apply(
 	const QString &filepath,
 	const Data::CloudTheme &cloud = Data::CloudTheme());
 bool Apply(std::unique_ptr<Preview> preview);
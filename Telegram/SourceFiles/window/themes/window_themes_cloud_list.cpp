@@ -104,6 +104,13 @@ constexpr auto kShowPerRow = 4;
 	return result;
 }
 
+// Parsed previews are kept for the whole app run, a theme document
+// never changes its content, saving it creates a new document.
+[[nodiscard]] base::flat_map<DocumentId, CloudListColors> &ColorsCache() {
+	static auto result = base::flat_map<DocumentId, CloudListColors>();
+	return result;
+}
+
 [[nodiscard]] CloudListColors ColorsFromCurrentTheme() {
 	auto result = CloudListColors();
 	auto background = Background()->createCurrentImage();
@@ -598,17 +605,44 @@ bool CloudList::amCreator(const Data::CloudTheme &theme) const {
 void CloudList::refreshColorsFromDocument(
 		Element &element,
 		not_null<DocumentData*> document) {
-	auto colors = ColorsFromTheme(
-		document->filepath(),
-		document->data());
+	const auto id = document->id;
+	const auto &cache = ColorsCache();
+	if (const auto i = cache.find(id); i != end(cache)) {
+		element.check->setColors(i->second);
+		setWaiting(element, false);
+		return;
+	} else if (!_colorsParsing.emplace(id).second) {
+		return;
+	}
+
+	// Theme parsing decodes the background image, do it off the main thread.
+	const auto path = document->filepath();
+	const auto data = document->data();
+	crl::async([=, guard = base::make_weak(this)] {
+		auto colors = ColorsFromTheme(path, data);
+		crl::on_main(guard, [=, colors = std::move(colors)]() mutable {
+			colorsParsed(id, std::move(colors));
+		});
+	});
+}
+
+void CloudList::colorsParsed(
+		DocumentId id,
+		std::optional<CloudListColors> &&colors) {
+	_colorsParsing.remove(id);
 	if (!colors) {
 		return;
 	}
 	if (colors->background.isNull()) {
 		colors->background = ColorsFromCurrentTheme().background;
 	}
-	element.check->setColors(*colors);
-	setWaiting(element, false);
+	ColorsCache().emplace(id, *colors);
+	for (auto &element : _elements) {
+		if (element.theme.documentId == id) {
+			element.check->setColors(*colors);
+			setWaiting(element, false);
+		}
+	}
 }
 
 void CloudList::subscribeToDownloadFinished() {
@@ -626,7 +660,6 @@ void CloudList::subscribeToDownloadFinished() {
 				return true;
 			}
 			refreshColorsFromDocument(element, document);
-			element.waiting = false;
 			return false;
 		});
 		if (!still) {
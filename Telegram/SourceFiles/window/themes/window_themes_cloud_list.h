@@ -70,7 +70,7 @@ private:
 
 };
 
-class CloudList final {
+class CloudList final : public base::has_weak_ptr {
 public:
 	CloudList(
 		not_null<QWidget*> parent,
@@ -107,6 +107,9 @@ private:
 	void refreshColorsFromDocument(
 		Element &element,
 		not_null<DocumentData*> document);
+	void colorsParsed(
+		DocumentId id,
+		std::optional<CloudListColors> &&colors);
 	void setWaiting(Element &element, bool waiting);
 	void subscribeToDownloadFinished();
 	int resizeGetHeight(int newWidth);
@@ -124,6 +127,7 @@ private:
 	std::vector<Element> _elements;
 	std::vector<uint64> _idByGroupValue;
 	base::flat_map<uint64, int> _groupValueById;
+	base::flat_set<DocumentId> _colorsParsing;
 	rpl::lifetime _downloadFinishedLifetime;
 	base::unique_qptr<Ui::PopupMenu> _contextMenu;
 
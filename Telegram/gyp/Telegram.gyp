@@ -113,6 +113,7 @@
       '<(submodules_loc)/variant/include',
       '<(submodules_loc)/crl/src',
       '<(submodules_loc)/xxHash',
+      '<(submodules_loc)/lz4/lib',
     ],
     'sources': [
       '<@(qrc_files)',
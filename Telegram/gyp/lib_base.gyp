@@ -60,6 +60,8 @@
       '<(src_loc)/base/invoke_queued.h',
       '<(src_loc)/base/last_used_cache.h',
       '<(src_loc)/base/match_method.h',
+      '<(src_loc)/base/memory_usage.cpp',
+      '<(src_loc)/base/memory_usage.h',
       '<(src_loc)/base/observer.cpp',
       '<(src_loc)/base/observer.h',
       '<(src_loc)/base/ordered_set.h',
@@ -73,6 +75,8 @@
       '<(src_loc)/base/qthelp_url.h',
       '<(src_loc)/base/runtime_composer.cpp',
       '<(src_loc)/base/runtime_composer.h',
+      '<(src_loc)/base/task_lanes.cpp',
+      '<(src_loc)/base/task_lanes.h',
       '<(src_loc)/base/thread_safe_wrap.h',
       '<(src_loc)/base/timer.cpp',
       '<(src_loc)/base/timer.h',
@@ -71,6 +71,7 @@
       '<(src_loc)/storage/cache/storage_cache_database.h',
       '<(src_loc)/storage/cache/storage_cache_database_object.cpp',
       '<(src_loc)/storage/cache/storage_cache_database_object.h',
+      '<(src_loc)/storage/cache/storage_cache_flat_index.h',
       '<(src_loc)/storage/cache/storage_cache_types.cpp',
       '<(src_loc)/storage/cache/storage_cache_types.h',
     ],
@@ -139,5 +139,55 @@
         '<(src_loc)/platform/win/windows_dlls.h',
       ],
     }]],
+  }, {
+    # Not a part of 'tests', run benchmarks_base manually.
+    'target_name': 'benchmarks_base',
+    'includes': [
+      'common_test.gypi',
+    ],
+    'sources': [
+      '<(src_loc)/base/containers_benchmarks.cpp',
+      '<(src_loc)/base/observer.cpp',
+      '<(src_loc)/base/observer.h',
+      '<(src_loc)/rpl/rpl_benchmarks.cpp',
+    ],
+  }, {
+    # Not a part of 'tests', run benchmarks_storage manually.
+    'target_name': 'benchmarks_storage',
+    'includes': [
+      'common_test.gypi',
+      '../openssl.gypi',
+    ],
+    'dependencies': [
+      '../lib_storage.gyp:lib_storage',
+    ],
+    'sources': [
+      '<(src_loc)/storage/cache/storage_cache_database_benchmarks.cpp',
+      '<(src_loc)/platform/win/windows_dlls.cpp',
+      '<(src_loc)/platform/win/windows_dlls.h',
+    ],
+    'conditions': [[ 'not build_win', {
+      'sources!': [
+        '<(src_loc)/platform/win/windows_dlls.cpp',
+        '<(src_loc)/platform/win/windows_dlls.h',
+      ],
+    }]],
+  }, {
+    # Not a part of 'tests', run benchmarks_lottie manually.
+    'target_name': 'benchmarks_lottie',
+    'includes': [
+      'common_test.gypi',
+      '../openssl.gypi',
+    ],
+    'dependencies': [
+      '../lib_lottie.gyp:lib_lottie',
+    ],
+    'include_dirs': [
+      '<(libs_loc)/ffmpeg',
+      '<(submodules_loc)/rlottie/inc',
+    ],
+    'sources': [
+      '<(src_loc)/lottie/lottie_benchmarks.cpp',
+    ],
   }],
 }